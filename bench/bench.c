@@ -0,0 +1,1093 @@
+/* Benchmarks
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ *
+ * Usage: bench [-f FILTER] [-m MAX_SIZE] [-t MIN_TIME] [-o JSON] [-c BASELINE [-r %]]
+ *
+ *     -f  Run only the benchmarks whose names contain FILTER
+ *     -m  Largest matrix size (default: 16384); Sizes are square, from 4 x 4 up to
+ *         MAX_SIZE x MAX_SIZE, in steps of 4x
+ *     -t  Minimum time (in seconds) spent per benchmark and size (default: 0.25)
+ *     -o  Write the results to JSON (as one result per line)
+ *     -c  Compare the results with a baseline previously written with `-o`; The exit
+ *         status is non-zero if any regression is found
+ *     -r  Median slowdown (in percent) above which a result is a regression
+ *         (default: 10)
+ *
+ * Results of some benchmarks are also compared with those of a reference
+ * implementation (see `references`), run at the same size; The exit status is
+ * non-zero if any is slower than its reference beyond the same threshold.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/mat47/async.h"
+#include "../src/mat47/band.h"
+#include "../src/mat47/blas.h"
+#include "../src/mat47/broadcast.h"
+#include "../src/mat47/error.h"
+#include "../src/mat47/linalg.h"
+#include "../src/mat47/matrix.h"
+#include "../src/mat47/packed.h"
+#include "../src/mat47/quant.h"
+#include "../src/mat47/reduce.h"
+#include "../src/mat47/utils.h"
+
+#define MIN_SIZE 4
+#define MIN_SAMPLES 5
+#define MAX_SAMPLES 100000
+#define NAME_MAX_LEN 63
+
+// Number of vectors multiplied by `gemv_batch`
+#define BATCH 8
+
+// Number of diagonals below and above the main diagonal, for `b_solve`
+#define BAND_W 8
+
+struct fixture {
+    unsigned int n;
+    mat47_t *a;
+    mat47_t *b;
+    mat47_t *c;
+    mat47q_t *qa;
+    mat47q_t *qb;
+    mat47p_t *pa;  // `a`, packed
+    mat47b_t *ba;
+    double **array;  // Row pointers into `a`
+    FILE *null_stream;
+    mat47_workspace_t *ws;
+};
+
+struct bench {
+    const char *name;
+
+    // Largest size, for benchmarks that would take too long (or too much memory)
+    // for larger sizes
+    unsigned int max_n;
+
+    // Amount of work done by `run()`, in units of `unit` x seconds (e.g GB or GFLOP)
+    double (*work)(unsigned int n);
+    const char *unit;
+
+    // Returns false if the fixture can't be set up (e.g due to lack of memory)
+    bool (*setup)(struct fixture *f);
+
+    // Returns a matrix to be deallocated after the timing, if any
+    mat47_t *(*run)(struct fixture *f);
+};
+
+// Holds the results of reductions, such that they can't be optimized out
+static volatile double sink;
+
+struct result {
+    char name[NAME_MAX_LEN + 1];
+    unsigned int n;
+    size_t n_samples;
+    double min, mean, p50, p90, p99;  // In nanoseconds
+    double throughput;  // Based on the median
+    const char *unit;
+};
+
+
+/* Fixtures */
+
+static bool setup_a(struct fixture *f)
+{
+    unsigned int i, j;
+
+    if (!(f->a = mat47__new(f->n, f->n, false))) return false;
+    for (i = 0; i < f->n; i++)
+        for (j = 0; j < f->n; j++) f->a->data[i][j] = (double)rand() / RAND_MAX - 0.5;
+
+    return true;
+}
+
+// `a` with contiguous storage, owned by the matrix
+static bool setup_flat(struct fixture *f)
+{
+    size_t size = (size_t)f->n * f->n;
+    double *buf;
+
+    if (!(buf = malloc(sizeof(double) * size))) return false;
+    if (!(f->a = mat47_adopt(f->n, f->n, buf, free))) {
+        free(buf);
+        return false;
+    }
+    for (size_t e = 0; e < size; e++) buf[e] = (double)rand() / RAND_MAX - 0.5;
+
+    return true;
+}
+
+static bool setup_none(struct fixture *f)
+{
+    (void)f;
+    return true;
+}
+
+static bool setup_array(struct fixture *f)
+{
+    return setup_a(f) && (f->array = f->a->data);
+}
+
+static bool setup_a_b(struct fixture *f)
+{
+    return setup_a(f) && (f->b = mat47_zero(f->n, f->n));
+}
+
+// Diagonally dominant (hence well-conditioned), with a single right-hand side
+static bool setup_system(struct fixture *f)
+{
+    if (!(setup_a(f) && (f->b = mat47_zero(f->n, 1)))) return false;
+    for (unsigned int i = 0; i < f->n; i++) {
+        f->a->data[i][i] += f->n;
+        f->b->data[i][0] = i % 7;
+    }
+
+    return true;
+}
+
+// A system, with the cache of `mat47_solve()` enabled
+static bool setup_system_cached(struct fixture *f)
+{
+    mat47_set_solve_cache_limit((size_t)128 << 20);
+    return setup_system(f);
+}
+
+// A system, with a workspace for its size
+static bool setup_system_ws(struct fixture *f)
+{
+    return setup_system(f) && (f->ws = mat47_workspace_new(f->n));
+}
+
+// `a` lower-triangular, with a positive diagonal (i.e a Cholesky factor)
+static bool setup_factor(struct fixture *f)
+{
+    if (!setup_system(f)) return false;
+    for (unsigned int i = 0; i < f->n; i++)
+        for (unsigned int j = i + 1; j < f->n; j++) f->a->data[i][j] = 0;
+
+    return true;
+}
+
+static bool setup_symmetric(struct fixture *f)
+{
+    if (!setup_a(f)) return false;
+    for (unsigned int i = 0; i < f->n; i++)
+        for (unsigned int j = 0; j < i; j++) f->a->data[j][i] = f->a->data[i][j];
+
+    return true;
+}
+
+static bool setup_a_row(struct fixture *f)
+{
+    return setup_a(f) && (f->b = mat47_zero(1, f->n));
+}
+
+// `n_vecs` random vectors `b` (one per row) and as many zeroed results `c`
+static bool setup_vecs(struct fixture *f, unsigned int n_vecs)
+{
+    if (
+        !(setup_a(f) && (f->b = mat47__new(n_vecs, f->n, false))
+        && (f->c = mat47_zero(n_vecs, f->n)))
+    ) return false;
+    for (unsigned int i = 0; i < n_vecs; i++)
+        for (unsigned int j = 0; j < f->n; j++)
+            f->b->data[i][j] = (double)rand() / RAND_MAX;
+
+    return true;
+}
+
+static bool setup_vec(struct fixture *f)
+{
+    return setup_vecs(f, 1);
+}
+
+static bool setup_batch(struct fixture *f)
+{
+    return setup_vecs(f, BATCH);
+}
+
+// A diagonally dominant banded matrix, with a single right-hand side
+static bool setup_band(struct fixture *f)
+{
+    unsigned int i, j;
+
+    if (
+        !((f->ba = mat47b_zero(f->n, min(BAND_W, f->n - 1), min(BAND_W, f->n - 1)))
+        && (f->b = mat47_zero(f->n, 1)))
+    ) return false;
+    for (i = 0; i < f->n; i++) {
+        for (j = 0; j <= f->ba->kl + f->ba->ku; j++)
+            f->ba->data[i * (f->ba->kl + f->ba->ku + 1) + j] =
+                (double)rand() / RAND_MAX - 0.5;
+        f->ba->data[i * (f->ba->kl + f->ba->ku + 1) + f->ba->kl] += 2 * BAND_W + 1;
+        f->b->data[i][0] = i % 7;
+    }
+
+    return true;
+}
+
+// Tridiagonal systems, one per column: `a` as the off-diagonals, `b` as the main
+// diagonals (diagonally dominant) and `c` as the right-hand sides
+static bool setup_tridiag_batch(struct fixture *f)
+{
+    if (!(setup_a_b(f) && (f->c = mat47__new(f->n, f->n, false)))) return false;
+    for (unsigned int i = 0; i < f->n; i++)
+        for (unsigned int j = 0; j < f->n; j++) f->b->data[i][j] = 3 + (i + j) % 5;
+
+    return true;
+}
+
+// The symmetric part of `a`, packed, and a random vector
+static bool setup_packed(struct fixture *f)
+{
+    return setup_vec(f) && (f->pa = mat47p_pack(f->a, MAT47P_SYMMETRIC));
+}
+
+static bool setup_null_stream(struct fixture *f)
+{
+    return setup_a(f) && (f->null_stream = fopen("/dev/null", "w"));
+}
+
+static bool setup_quant(struct fixture *f)
+{
+    return (
+        setup_a(f)
+        && (f->qa = mat47q_quantize(f->a, MAT47Q_INT8, MAT47Q_PER_ROW))
+        && (f->qb = mat47q_quantize(f->a, MAT47Q_INT8, MAT47Q_PER_ROW))
+    );
+}
+
+// `a` scaled to a 1-norm of about `1 / 4`, such that its powers stay finite, `b` and
+// a workspace for them
+static bool setup_workspace(struct fixture *f)
+{
+    if (!(setup_a_b(f) && (f->ws = mat47_workspace_new(f->n)))) return false;
+    for (unsigned int i = 0; i < f->n; i++)
+        for (unsigned int j = 0; j < f->n; j++) f->a->data[i][j] /= f->n;
+
+    return true;
+}
+
+static void teardown(struct fixture *f)
+{
+    mat47_del(f->a);
+    mat47_del(f->b);
+    mat47_del(f->c);
+    mat47q_del(f->qa);
+    mat47q_del(f->qb);
+    mat47p_del(f->pa);
+    mat47b_del(f->ba);
+    if (f->null_stream) fclose(f->null_stream);
+    mat47_workspace_del(f->ws);
+    *f = (struct fixture){0};
+}
+
+
+/* Work */
+
+static double elem_bytes(unsigned int n)
+{
+    return sizeof(double) * (double)n * n / 1e9;
+}
+
+// Read and written
+static double copy_bytes(unsigned int n)
+{
+    return 2 * elem_bytes(n);
+}
+
+static double n_elems(unsigned int n)
+{
+    return (double)n * n / 1e6;
+}
+
+// For benchmarks independent of the size
+static double one_call(unsigned int n)
+{
+    (void)n;
+    return 1e-3;
+}
+
+// LU factorization and solve, with a single right-hand side
+static double solve_flops(unsigned int n)
+{
+    return (2.0 / 3 * n * n * n + 2.0 * n * n) / 1e9;
+}
+
+static double gemv_flops(unsigned int n)
+{
+    return 2.0 * n * n / 1e9;
+}
+
+static double gemv_batch_flops(unsigned int n)
+{
+    return BATCH * gemv_flops(n);
+}
+
+static double cholesky_flops(unsigned int n)
+{
+    return (double)n * n * n / 3 / 1e9;
+}
+
+static double lu_flops(unsigned int n)
+{
+    return 2 * cholesky_flops(n);
+}
+
+// Factorization and generation of `q`
+static double qr_flops(unsigned int n)
+{
+    return 8 * cholesky_flops(n);
+}
+
+static double mul_ops(unsigned int n)
+{
+    return 2.0 * n * n * n / 1e9;
+}
+
+
+/* Benchmarks */
+
+static mat47_t *run_new(struct fixture *f)
+{
+    return mat47__new(f->n, f->n, false);
+}
+
+static mat47_t *run_zero(struct fixture *f)
+{
+    return mat47_zero(f->n, f->n);
+}
+
+static mat47_t *run_init_double(struct fixture *f)
+{
+    return mat47_init(f->n, f->n, f->array);
+}
+
+// `a` is contiguous
+static mat47_t *run_init_flat(struct fixture *f)
+{
+    return mat47_init_double_flat(f->n, f->n, f->a->data[0], f->n);
+}
+
+static mat47_t *run_copy(struct fixture *f)
+{
+    return mat47_copy(f->a);
+}
+
+static mat47_t *run_copy_into(struct fixture *f)
+{
+    mat47_copy_into(f->b, f->a);
+    return NULL;
+}
+
+static mat47_t *run_get_submat(struct fixture *f)
+{
+    return mat47_get_submat(f->a, 1, 1, f->n, f->n);
+}
+
+static mat47_t *run_set_submat(struct fixture *f)
+{
+    mat47_set_submat(f->b, 1, 1, f->n, f->n, f->a);
+    return NULL;
+}
+
+// Streaming ingestion, a row at a time
+static mat47_t *run_append_rows(struct fixture *f)
+{
+    mat47_t *m = mat47__new(1, f->n, false);
+
+    for (unsigned int i = 1; m && i < f->n; i++) mat47_append_rows(m, f->b);
+    return m;
+}
+
+static mat47_t *run_fprintf(struct fixture *f)
+{
+    mat47_fprintf(f->a, f->null_stream, MAT47_ELEM_FMT);
+    return NULL;
+}
+
+static mat47_t *run_stats_json(struct fixture *f)
+{
+    mat47_stats_t stats;
+
+    mat47_stats_snapshot(&stats);
+    mat47_stats_fprint_json(&stats, f->null_stream);
+    return NULL;
+}
+
+// Band LU factorization and solve, with a single right-hand side
+static double band_solve_flops(unsigned int n)
+{
+    double w = min(BAND_W, n - 1);
+
+    return (2.0 * n * w * 2 * w + 2.0 * n * 3 * w) / 1e9;
+}
+
+// Half of the full product
+static double syrk_ops(unsigned int n)
+{
+    return mul_ops(n) / 2;
+}
+
+
+static mat47_t *run_solve_mixed(struct fixture *f)
+{
+    return mat47_solve_mixed(f->a, f->b, NULL);
+}
+
+// Repeated with the same matrix, hence solved with its cached factorization
+static mat47_t *run_solve(struct fixture *f)
+{
+    return mat47_solve(f->a, f->b);
+}
+
+static mat47_t *run_gemv(struct fixture *f)
+{
+    mat47_gemv(f->c, 1, f->a, f->b, 0);
+    return NULL;
+}
+
+static mat47_t *run_gemv_t(struct fixture *f)
+{
+    mat47_gemv_t(f->c, 1, f->a, f->b, 0);
+    return NULL;
+}
+
+static mat47_t *run_gemv_batch(struct fixture *f)
+{
+    mat47_gemv_batch(f->c, 1, f->a, f->b, 0);
+    return NULL;
+}
+
+static mat47_t *run_mul(struct fixture *f)
+{
+    mat47_mul_into(f->b, f->a, f->a, f->ws);
+    return NULL;
+}
+
+// With the given Strassen-Winograd crossover
+static void mul_crossover(struct fixture *f, unsigned int n)
+{
+    unsigned int crossover = mat47_get_strassen_crossover();
+
+    mat47_set_strassen_crossover(n);
+    mat47_mul_into(f->b, f->a, f->a, f->ws);
+    mat47_set_strassen_crossover(crossover);
+}
+
+static mat47_t *run_mul_classical(struct fixture *f)
+{
+    mul_crossover(f, MAT47_STRASSEN_OFF);
+    return NULL;
+}
+
+/* Candidate crossovers, on both sides of `MAT47_STRASSEN_DEFAULT_CROSSOVER`; Each
+ * size is then computed with zero to several levels of recursion.
+ */
+
+static mat47_t *run_mul_x128(struct fixture *f)
+{
+    mul_crossover(f, 128);
+    return NULL;
+}
+
+static mat47_t *run_mul_x256(struct fixture *f)
+{
+    mul_crossover(f, 256);
+    return NULL;
+}
+
+static mat47_t *run_mul_x512(struct fixture *f)
+{
+    mul_crossover(f, 512);
+    return NULL;
+}
+
+static mat47_t *run_mul_x1024(struct fixture *f)
+{
+    mul_crossover(f, 1024);
+    return NULL;
+}
+
+static mat47_t *run_b_solve(struct fixture *f)
+{
+    return mat47b_solve(f->ba, f->b);
+}
+
+static mat47_t *run_b_tridiag_batch(struct fixture *f)
+{
+    mat47_copy_into(f->c, f->a);
+    mat47b_tridiag_solve_batch(f->c, f->a, f->b, f->a);
+    return NULL;
+}
+
+static mat47_t *run_cholesky(struct fixture *f)
+{
+    return mat47_cholesky(f->a);
+}
+
+// An update followed by a downdate, by the same vector
+static mat47_t *run_chol_update(struct fixture *f)
+{
+    mat47_cholesky_update(f->a, f->b);
+    mat47_cholesky_downdate(f->a, f->b);
+    return NULL;
+}
+
+static mat47_t *run_inv_update(struct fixture *f)
+{
+    mat47_inv_update(f->a, f->b, f->b, f->ws);
+    return NULL;
+}
+
+static mat47_t *run_lu(struct fixture *f)
+{
+    unsigned int *piv = malloc(sizeof(unsigned int) * f->n);
+    mat47_t *lu = piv ? mat47_lu(f->a, piv) : NULL;
+
+    free(piv);
+    return lu;
+}
+
+static mat47_t *run_qr(struct fixture *f)
+{
+    mat47_t *r = NULL, *q = mat47_qr(f->a, &r);
+
+    mat47_del(r);
+    return q;
+}
+
+// Number of eigenpairs computed by the `eigsh` benchmark
+#define EIGSH_K 10
+
+static mat47_t *run_eigsh(struct fixture *f)
+{
+    mat47_t *vecs, *values = mat47_eigsh(f->a, EIGSH_K, MAT47_EIGSH_LARGEST, &vecs);
+
+    mat47_del(vecs);
+    return values;
+}
+
+// Exponent of the `pow` benchmark
+#define POW_K 100
+
+static mat47_t *run_pow(struct fixture *f)
+{
+    mat47_pow_into(f->b, f->a, POW_K, f->ws);
+    return NULL;
+}
+
+static mat47_t *run_expm(struct fixture *f)
+{
+    mat47_expm_into(f->b, f->a, f->ws);
+    return NULL;
+}
+
+// Rank, oversampling and number of power iterations of the `rsvd` benchmark
+#define RSVD_K 10
+#define RSVD_OVERSAMPLE 10
+#define RSVD_POWER_ITERS 2
+
+static mat47_t *run_rsvd(struct fixture *f)
+{
+    mat47_t *u, *vt, *s = mat47_rsvd(
+        f->a, RSVD_K, RSVD_OVERSAMPLE, RSVD_POWER_ITERS, &u, &vt
+    );
+
+    mat47_del(u);
+    mat47_del(vt);
+    return s;
+}
+
+static mat47_t *run_p_gemv(struct fixture *f)
+{
+    mat47p_gemv(f->c, 1, f->pa, f->b, 0);
+    return NULL;
+}
+
+static mat47_t *run_p_syrk(struct fixture *f)
+{
+    mat47p_syrk(f->pa, 1, f->a, 0);
+    return NULL;
+}
+
+static mat47_t *run_quantize(struct fixture *f)
+{
+    mat47q_del(mat47q_quantize(f->a, MAT47Q_INT8, MAT47Q_PER_ROW));
+    return NULL;
+}
+
+static mat47_t *run_async_mul(struct fixture *f)
+{
+    return mat47_future_wait(mat47_async_mul(f->a, f->b));
+}
+
+static mat47_t *run_q_mul_t(struct fixture *f)
+{
+    return mat47q_mul_t(f->qa, f->qb);
+}
+
+static mat47_t *run_sum_fast(struct fixture *f)
+{
+    sink = mat47_sum(f->a, MAT47_SUM_FAST);
+    return NULL;
+}
+
+static mat47_t *run_sum_pairwise(struct fixture *f)
+{
+    sink = mat47_sum(f->a, MAT47_SUM_PAIRWISE);
+    return NULL;
+}
+
+static mat47_t *run_sum_kahan(struct fixture *f)
+{
+    sink = mat47_sum(f->a, MAT47_SUM_KAHAN);
+    return NULL;
+}
+
+static mat47_t *run_norm_1(struct fixture *f)
+{
+    sink = mat47_norm_1(f->a);
+    return NULL;
+}
+
+static mat47_t *run_norm_inf(struct fixture *f)
+{
+    sink = mat47_norm_inf(f->a);
+    return NULL;
+}
+
+static mat47_t *run_max(struct fixture *f)
+{
+    sink = mat47_max(f->a, NULL, NULL);
+    return NULL;
+}
+
+// The reference for `max`
+static mat47_t *run_max_scalar(struct fixture *f)
+{
+    double best = -INFINITY;
+    unsigned int i, j, row = 0, col = 0;
+
+    for (i = 0; i < f->n; i++)
+        for (j = 0; j < f->n; j++)
+            if (f->a->data[i][j] > best) {
+                best = f->a->data[i][j];
+                row = i;
+                col = j;
+            }
+    sink = best + row + col;
+    return NULL;
+}
+
+static mat47_t *run_row_sums(struct fixture *f)
+{
+    return mat47_row_sums(f->a, MAT47_SUM_FAST);
+}
+
+static mat47_t *run_col_sums(struct fixture *f)
+{
+    return mat47_col_sums(f->a, MAT47_SUM_FAST);
+}
+
+static mat47_t *run_col_sums_kahan(struct fixture *f)
+{
+    return mat47_col_sums(f->a, MAT47_SUM_KAHAN);
+}
+
+static mat47_t *run_col_var(struct fixture *f)
+{
+    return mat47_col_var(f->a, 1, NULL);
+}
+
+static mat47_t *run_bcast_row(struct fixture *f)
+{
+    mat47_bcast_row(f->a, MAT47_BCAST_SUB, f->b);
+    return NULL;
+}
+
+static mat47_t *run_standardize(struct fixture *f)
+{
+    mat47_standardize(f->a, 1, NULL, NULL);
+    return NULL;
+}
+
+static const struct bench benches[] = {
+    {"new_uninit", UINT32_MAX, elem_bytes, "GB/s", setup_none, run_new},
+    {"new_zeroed", UINT32_MAX, elem_bytes, "GB/s", setup_none, run_zero},
+    {"init_double", UINT32_MAX, copy_bytes, "GB/s", setup_array, run_init_double},
+    {"init_double_flat", UINT32_MAX, copy_bytes, "GB/s", setup_flat, run_init_flat},
+    {"copy", UINT32_MAX, copy_bytes, "GB/s", setup_a, run_copy},
+    {"copy_into", UINT32_MAX, copy_bytes, "GB/s", setup_a_b, run_copy_into},
+    {"get_submat", UINT32_MAX, copy_bytes, "GB/s", setup_a, run_get_submat},
+    {"set_submat", UINT32_MAX, copy_bytes, "GB/s", setup_a_b, run_set_submat},
+    {"append_rows", UINT32_MAX, elem_bytes, "GB/s", setup_a_row, run_append_rows},
+    {"fprintf", 1024, n_elems, "Melem/s", setup_null_stream, run_fprintf},
+    {"stats_json", 4, one_call, "Kcall/s", setup_null_stream, run_stats_json},
+    {"solve_mixed", 2048, solve_flops, "GFLOP/s", setup_system, run_solve_mixed},
+    {"solve", 4096, n_elems, "Melem/s", setup_system_cached, run_solve},
+    {"cholesky", 4096, cholesky_flops, "GFLOP/s", setup_system, run_cholesky},
+    {"chol_update", 4096, n_elems, "Melem/s", setup_factor, run_chol_update},
+    {"inv_update", 4096, n_elems, "Melem/s", setup_system_ws, run_inv_update},
+    {"lu", 4096, lu_flops, "GFLOP/s", setup_system, run_lu},
+    {"qr", 2048, qr_flops, "GFLOP/s", setup_a, run_qr},
+    {"b_solve", UINT32_MAX, band_solve_flops, "GFLOP/s", setup_band, run_b_solve},
+    {
+        "b_tridiag_batch", 4096, n_elems, "Melem/s", setup_tridiag_batch,
+        run_b_tridiag_batch
+    },
+    {"eigsh", 4096, n_elems, "Melem/s", setup_symmetric, run_eigsh},
+    {"rsvd", 8192, n_elems, "Melem/s", setup_a, run_rsvd},
+    {"pow", 2048, n_elems, "Melem/s", setup_workspace, run_pow},
+    {"expm", 2048, n_elems, "Melem/s", setup_workspace, run_expm},
+    {"gemv", UINT32_MAX, gemv_flops, "GFLOP/s", setup_vec, run_gemv},
+    {"gemv_t", UINT32_MAX, gemv_flops, "GFLOP/s", setup_vec, run_gemv_t},
+    {
+        "gemv_batch", UINT32_MAX, gemv_batch_flops, "GFLOP/s", setup_batch,
+        run_gemv_batch
+    },
+    {"mul", 4096, mul_ops, "GFLOP/s", setup_workspace, run_mul},
+    {"mul_classical", 4096, mul_ops, "GFLOP/s", setup_workspace, run_mul_classical},
+    {"mul_x128", 4096, mul_ops, "GFLOP/s", setup_workspace, run_mul_x128},
+    {"mul_x256", 4096, mul_ops, "GFLOP/s", setup_workspace, run_mul_x256},
+    {"mul_x512", 4096, mul_ops, "GFLOP/s", setup_workspace, run_mul_x512},
+    {"mul_x1024", 4096, mul_ops, "GFLOP/s", setup_workspace, run_mul_x1024},
+    {"async_mul", 4096, mul_ops, "GFLOP/s", setup_a_b, run_async_mul},
+    {"p_gemv", UINT32_MAX, gemv_flops, "GFLOP/s", setup_packed, run_p_gemv},
+    {"p_syrk", 4096, syrk_ops, "GFLOP/s", setup_packed, run_p_syrk},
+    {"q_quantize", UINT32_MAX, n_elems, "Melem/s", setup_a, run_quantize},
+    {"q_mul_t", 2048, mul_ops, "GOP/s", setup_quant, run_q_mul_t},
+    {"sum_fast", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_sum_fast},
+    {"sum_pairwise", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_sum_pairwise},
+    {"sum_kahan", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_sum_kahan},
+    {"norm_1", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_norm_1},
+    {"norm_inf", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_norm_inf},
+    {"max", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_max},
+    {"max_scalar", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_max_scalar},
+    {"row_sums", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_row_sums},
+    {"col_sums", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_col_sums},
+    {"col_sums_kahan", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_col_sums_kahan},
+    {"col_var", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_col_var},
+    {"bcast_row", UINT32_MAX, copy_bytes, "GB/s", setup_a_row, run_bcast_row},
+    {"standardize", UINT32_MAX, elem_bytes, "GB/s", setup_a, run_standardize},
+};
+
+// Benchmarks expected to be at least as fast as a reference implementation
+static const struct {
+    const char *name;
+    const char *reference;
+} references[] = {
+    {"max", "max_scalar"},
+};
+
+
+/* Measurement */
+
+static double now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const double *samples, size_t n, double p)
+{
+    size_t rank = ceil(p / 100 * n);
+
+    return samples[rank ? rank - 1 : 0];
+}
+
+// Returns false if the fixture can't be set up or a run fails
+static bool
+measure(const struct bench *b, unsigned int n, double min_time, struct result *r)
+{
+    static double samples[MAX_SAMPLES];
+    struct fixture f = {.n = n};
+    double start, elapsed, total = 0;
+    size_t i;
+    mat47_t *out;
+    bool ok = false;
+
+    mat47_errno = 0;
+    if (!b->setup(&f)) goto cleanup;
+
+    // Warm-up
+    mat47_del(b->run(&f));
+    if (mat47_errno) goto cleanup;
+
+    for (i = 0; i < MAX_SAMPLES && (i < MIN_SAMPLES || total < min_time * 1e9); i++) {
+        start = now();
+        out = b->run(&f);
+        total += samples[i] = now() - start;
+        mat47_del(out);
+    }
+
+    qsort(samples, i, sizeof(double), compare_doubles);
+    snprintf(r->name, sizeof(r->name), "%s", b->name);
+    r->n = n;
+    r->n_samples = i;
+    r->min = samples[0];
+    r->mean = total / i;
+    r->p50 = percentile(samples, i, 50);
+    r->p90 = percentile(samples, i, 90);
+    r->p99 = percentile(samples, i, 99);
+    elapsed = r->p50 / 1e9;
+    r->throughput = b->work(n) / elapsed;
+    r->unit = b->unit;
+    ok = !mat47_errno;
+
+cleanup:
+    teardown(&f);
+    return ok;
+}
+
+
+/* Output and comparison */
+
+static void print_header(void)
+{
+    printf(
+        "%-18s %7s %8s %12s %12s %12s %12s %14s\n",
+        "benchmark", "size", "samples", "min (us)", "p50 (us)", "p90 (us)", "p99 (us)",
+        "throughput"
+    );
+}
+
+static void print_result(const struct result *r)
+{
+    printf(
+        "%-18s %7u %8zu %12.3f %12.3f %12.3f %12.3f %8.3f %s\n",
+        r->name, r->n, r->n_samples, r->min / 1e3, r->p50 / 1e3, r->p90 / 1e3,
+        r->p99 / 1e3, r->throughput, r->unit
+    );
+}
+
+static void write_json(FILE *stream, const struct result *results, size_t n)
+{
+    const struct result *r;
+
+    fprintf(stream, "{\"results\": [\n");
+    for (size_t i = 0; i < n; i++) {
+        r = &results[i];
+        fprintf(
+            stream,
+            "{\"name\": \"%s\", \"n\": %u, \"samples\": %zu, \"min_ns\": %.0f, "
+            "\"mean_ns\": %.0f, \"p50_ns\": %.0f, \"p90_ns\": %.0f, \"p99_ns\": %.0f, "
+            "\"throughput\": %g, \"unit\": \"%s\"}%s\n",
+            r->name, r->n, r->n_samples, r->min, r->mean, r->p50, r->p90, r->p99,
+            r->throughput, r->unit, (i + 1 < n ? "," : "")
+        );
+    }
+    fprintf(stream, "]}\n");
+}
+
+/* Reads results written by `write_json()`.
+ *
+ * Returns the number of results read or -1 on failure.
+ */
+static long read_json(const char *path, struct result **results)
+{
+    char line[1024];
+    size_t n = 0, cap = 64;
+    struct result *r;
+    FILE *stream;
+
+    if (!(stream = fopen(path, "r"))) return -1;
+    if (!(*results = malloc(sizeof(struct result) * cap))) {
+        fclose(stream);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), stream)) {
+        if (n == cap) {
+            if (!(r = realloc(*results, sizeof(struct result) * (cap *= 2)))) break;
+            *results = r;
+        }
+        r = &(*results)[n];
+        if (
+            sscanf(
+                line,
+                "{\"name\": \"%63[^\"]\", \"n\": %u, \"samples\": %zu, "
+                "\"min_ns\": %lf, \"mean_ns\": %lf, \"p50_ns\": %lf, \"p90_ns\": %lf, "
+                "\"p99_ns\": %lf",
+                r->name, &r->n, &r->n_samples, &r->min, &r->mean, &r->p50, &r->p90,
+                &r->p99
+            ) == 8
+        ) n++;
+    }
+    fclose(stream);
+
+    return n;
+}
+
+// Returns the number of regressions
+static unsigned int compare(
+    const struct result *results, size_t n,
+    const struct result *baseline, size_t n_baseline, double threshold
+) {
+    const struct result *r, *base;
+    unsigned int n_regressions = 0;
+    double change;
+
+    printf(
+        "\n%-18s %7s %12s %12s %9s\n",
+        "benchmark", "size", "base (us)", "p50 (us)", "change"
+    );
+    for (size_t i = 0; i < n; i++) {
+        r = &results[i];
+        base = NULL;
+        for (size_t j = 0; j < n_baseline; j++)
+            if (!strcmp(baseline[j].name, r->name) && baseline[j].n == r->n) {
+                base = &baseline[j];
+                break;
+            }
+        if (!base) continue;
+
+        change = (r->p50 / base->p50 - 1) * 100;
+        printf(
+            "%-18s %7u %12.3f %12.3f %+8.1f%%%s\n",
+            r->name, r->n, base->p50 / 1e3, r->p50 / 1e3, change,
+            (change > threshold ? "  REGRESSION" : "")
+        );
+        n_regressions += change > threshold;
+    }
+
+    return n_regressions;
+}
+
+// Returns the number of results slower than their reference (at the same size)
+static unsigned int
+compare_references(const struct result *results, size_t n, double threshold)
+{
+    const struct result *r, *ref;
+    unsigned int n_slower = 0;
+    bool header = false;
+    double change;
+
+    for (size_t k = 0; k < sizeof_arr(references); k++)
+        for (size_t i = 0; i < n; i++) {
+            r = &results[i];
+            if (strcmp(r->name, references[k].name)) continue;
+            for (size_t j = 0; j < n; j++) {
+                ref = &results[j];
+                if (strcmp(ref->name, references[k].reference) || ref->n != r->n)
+                    continue;
+
+                if (!header) {
+                    printf(
+                        "\n%-18s %7s %12s %12s %9s\n",
+                        "benchmark", "size", "ref (us)", "p50 (us)", "change"
+                    );
+                    header = true;
+                }
+                change = (r->p50 / ref->p50 - 1) * 100;
+                printf(
+                    "%-18s %7u %12.3f %12.3f %+8.1f%%  vs %s%s\n",
+                    r->name, r->n, ref->p50 / 1e3, r->p50 / 1e3, change, ref->name,
+                    (change > threshold ? "  SLOWER" : "")
+                );
+                n_slower += change > threshold;
+            }
+        }
+
+    return n_slower;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *filter = NULL, *json_path = NULL, *baseline_path = NULL;
+    unsigned int max_n = 16384, n, n_regressions = 0, n_slower;
+    double min_time = 0.25, threshold = 10;
+    struct result *results, *baseline;
+    size_t n_results = 0, cap;
+    long n_baseline;
+    FILE *json;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:m:t:o:c:r:")) != -1) {
+        switch (opt) {
+        case 'f': filter = optarg; break;
+        case 'm': max_n = strtoul(optarg, NULL, 10); break;
+        case 't': min_time = strtod(optarg, NULL); break;
+        case 'o': json_path = optarg; break;
+        case 'c': baseline_path = optarg; break;
+        case 'r': threshold = strtod(optarg, NULL); break;
+        default:
+            fprintf(
+                stderr,
+                "Usage: %s [-f FILTER] [-m MAX_SIZE] [-t MIN_TIME] [-o JSON] "
+                "[-c BASELINE [-r %%]]\n",
+                argv[0]
+            );
+            return 2;
+        }
+    }
+
+    cap = sizeof_arr(benches) * 16;
+    if (!(results = malloc(sizeof(struct result) * cap))) return 1;
+
+    srand(47);
+    mat47_log_set_level(MAT47_LOG_LEVEL_NONE);
+    print_header();
+    for (size_t i = 0; i < sizeof_arr(benches); i++) {
+        if (filter && !strstr(benches[i].name, filter)) continue;
+        for (n = MIN_SIZE; n <= min(max_n, benches[i].max_n); n *= 4) {
+            if (measure(&benches[i], n, min_time, &results[n_results])) {
+                print_result(&results[n_results]);
+                n_results++;
+            } else {
+                printf(
+                    "%-18s %7u  skipped: %s\n",
+                    benches[i].name, n,
+                    (mat47_errno ? mat47_strerror(mat47_errno) : "Setup failed")
+                );
+            }
+            fflush(stdout);
+            if (n > UINT32_MAX / 4) break;
+        }
+    }
+
+    n_slower = compare_references(results, n_results, threshold);
+
+    if (json_path) {
+        if (!(json = fopen(json_path, "w"))) {
+            perror(json_path);
+            return 1;
+        }
+        write_json(json, results, n_results);
+        fclose(json);
+    }
+
+    if (baseline_path) {
+        if ((n_baseline = read_json(baseline_path, &baseline)) < 0) {
+            perror(baseline_path);
+            return 1;
+        }
+        n_regressions = compare(results, n_results, baseline, n_baseline, threshold);
+        printf("\n%u regression(s) above %g%%\n", n_regressions, threshold);
+        free(baseline);
+    }
+
+    free(results);
+
+    return n_regressions || n_slower;
+}
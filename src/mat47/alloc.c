@@ -0,0 +1,112 @@
+/* Allocation policy
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include "alloc.h"
+#include "error.h"
+#include "utils.h"
+
+#define ALL_FLAGS (MAT47_ALLOC_HUGEPAGES | MAT47_ALLOC_HUGETLB)
+
+// Size of the default huge pages on most systems; Lengths of `MAP_HUGETLB` mappings
+// must be multiples of it.
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+// Size of the header preceding the elements in a mapping; Keeps them aligned to a
+// cache line.
+#define HEADER_SIZE 64
+
+// Precedes the elements in a mapping
+struct header {
+    void *base;
+    size_t length;
+};
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static struct mat47_alloc_policy policy = {
+    MAT47_ALLOC_DEFAULT_THRESHOLD, MAT47_ALLOC_DEFAULT_FLAGS
+};
+
+
+struct mat47_alloc_policy mat47_get_alloc_policy(void)
+{
+    struct mat47_alloc_policy p;
+
+    pthread_mutex_lock(&lock);
+    p = policy;
+    pthread_mutex_unlock(&lock);
+
+    return p;
+}
+
+
+void mat47_set_alloc_policy(struct mat47_alloc_policy p)
+{
+    if (
+        check(
+            !(p.flags & ~ALL_FLAGS), MAT47_ERR_INVALID_ARG, ": flags=%#x", p.flags
+        )
+    ) return;
+
+    pthread_mutex_lock(&lock);
+    policy = p;
+    pthread_mutex_unlock(&lock);
+}
+
+
+double *mat47__map_elements(unsigned int n_rows, unsigned int n_cols)
+{
+    struct mat47_alloc_policy p = mat47_get_alloc_policy();
+    size_t size = sizeof(double) * n_rows * n_cols, length;
+    char *base = MAP_FAILED;
+
+    if (size < p.threshold) return NULL;
+
+#ifdef MAP_HUGETLB
+    if (p.flags & MAT47_ALLOC_HUGETLB) {
+        length = (HEADER_SIZE + size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE
+            * HUGE_PAGE_SIZE;
+        base = mmap(
+            NULL, length, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0
+        );
+        if (base == MAP_FAILED) debug("`MAP_HUGETLB` failed; Falling back");
+    }
+#endif
+    if (base == MAP_FAILED) {
+        // Rounded up to whole pages by the kernel
+        length = HEADER_SIZE + size;
+        base = mmap(
+            NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+        );
+        if (base == MAP_FAILED) {
+            debug("Failed to map %zu bytes", length);
+            return NULL;
+        }
+#ifdef MADV_HUGEPAGE
+        if (p.flags & MAT47_ALLOC_HUGEPAGES) madvise(base, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    *(struct header *)base = (struct header){base, length};
+    debug("Mapped %zu bytes @ %p, flags=%#x", length, (void *)base, p.flags);
+
+    return (double *)(base + HEADER_SIZE);
+}
+
+
+void mat47__unmap_elements(void *elements)
+{
+    struct header *h = (struct header *)((char *)elements - HEADER_SIZE);
+
+    debug("Unmapping %zu bytes @ %p", h->length, h->base);
+    munmap(h->base, h->length);
+}
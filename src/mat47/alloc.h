@@ -0,0 +1,80 @@
+/* Allocation policy
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_ALLOC_H
+#define MAT47_ALLOC_H
+
+#include <stddef.h>
+
+/** Flags controlling how the storage of large matrices is allocated */
+enum mat47_alloc_flags {
+    /**
+     * Advises the kernel to back the storage with transparent huge pages
+     * (``madvise(MADV_HUGEPAGE)``), which greatly reduces TLB misses on large
+     * matrices.
+     */
+    MAT47_ALLOC_HUGEPAGES = 1 << 0,
+
+    /**
+     * Maps the storage from the pool of pre-reserved huge pages (``MAP_HUGETLB``),
+     * falling back to a regular mapping (with :c:enumerator:`MAT47_ALLOC_HUGEPAGES`
+     * applied, if set) if the pool can't satisfy the allocation.
+     */
+    MAT47_ALLOC_HUGETLB = 1 << 1,
+};
+
+/** Allocation policy for large matrices */
+struct mat47_alloc_policy {
+    /**
+     * Size (in bytes) of the elements of a matrix, from which its storage is
+     * allocated as a single memory mapping (subject to :c:member:`flags`) instead of
+     * row by row from the heap; ``SIZE_MAX`` disables mappings.
+     */
+    size_t threshold;
+
+    /** Bitwise OR of zero or more of :c:enum:`mat47_alloc_flags` */
+    unsigned int flags;
+};
+
+/** The default allocation threshold (in bytes): 32 MiB */
+#define MAT47_ALLOC_DEFAULT_THRESHOLD ((size_t)32 << 20)
+
+/** The default allocation flags: Transparent huge pages */
+#define MAT47_ALLOC_DEFAULT_FLAGS MAT47_ALLOC_HUGEPAGES
+
+/** The default allocation policy */
+#define MAT47_ALLOC_POLICY_DEFAULT ((struct mat47_alloc_policy){ \
+    MAT47_ALLOC_DEFAULT_THRESHOLD, MAT47_ALLOC_DEFAULT_FLAGS \
+})
+
+/**
+ * Returns the allocation policy.
+ *
+ * Returns:
+ *     The policy last set with :c:func:`mat47_set_alloc_policy` or, if unset,
+ *     :c:macro:`MAT47_ALLOC_POLICY_DEFAULT`.
+ */
+struct mat47_alloc_policy mat47_get_alloc_policy(void);
+
+/**
+ * Sets the allocation policy.
+ *
+ * Args:
+ *     policy: The policy
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *policy* has unknown
+ *       flags
+ *
+ * The policy applies to matrices allocated afterwards, by any thread.
+ *
+ * Note:
+ *     The storage of a matrix allocated as a mapping is contiguous but can't be
+ *     released (see :c:func:`mat47_release`).
+ */
+void mat47_set_alloc_policy(struct mat47_alloc_policy policy);
+
+#endif  // MAT47_ALLOC_H
@@ -0,0 +1,360 @@
+/* Asynchronous operations
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "async.h"
+#include "blas.h"
+#include "linalg.h"
+#include "parallel.h"
+#include "utils.h"
+
+typedef mat47_t *job_fn(mat47_future_t *f);
+
+struct mat47_future {
+    job_fn *run;
+    union {
+        struct {
+            mat47_async_fn *fn;
+            void *arg;
+        } call;
+        struct {
+            mat47_then_fn *fn;
+            void *arg;
+            mat47_t *input;  // The result of the antecedent
+        } then;
+        struct {
+            const mat47_t *a, *b;
+            void *out;
+        } op;
+    } job;
+
+    // Set once complete
+    mat47_t *result;
+    unsigned int errnum;
+    bool done;
+
+    // Once complete: If `detached`, the future is deallocated along with its result;
+    // Otherwise, if `cont` isn't null, its result is handed over to `cont` and it's
+    // deallocated.
+    bool detached;
+    mat47_future_t *cont;
+
+    mat47_future_t *next;  // In the queue
+};
+
+/* The pool.
+ *
+ * Futures are queued in order of submission. A thread is started whenever there are
+ * more queued futures than idle threads, up to the limit; Threads are detached and
+ * never exit.
+ */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t completed = PTHREAD_COND_INITIALIZER;
+static mat47_future_t *head, *tail;
+static unsigned int n_queued, n_idle, n_started;
+
+// Set in the threads of the pool
+static _Thread_local bool in_pool;
+
+static void *work(void *arg);
+
+
+// Queues a future; Returns false if the caller must run it itself, as no thread
+// could be started. `lock` must be held.
+static bool enqueue(mat47_future_t *f)
+{
+    unsigned int limit = max(mat47_get_num_threads(), MAT47_ASYNC_MIN_THREADS);
+    pthread_attr_t attr;
+    pthread_t thread;
+
+    if (n_queued + 1 > n_idle && n_started < limit && !pthread_attr_init(&attr)) {
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if (!pthread_create(&thread, &attr, work, NULL)) {
+            n_started++;
+            debug("Started async thread #%u", n_started);
+        }
+        pthread_attr_destroy(&attr);
+    }
+    if (!n_started) return false;
+
+    f->next = NULL;
+    if (tail) tail->next = f;
+    else head = f;
+    tail = f;
+    n_queued++;
+    pthread_cond_signal(&queued);
+    // Threads of the pool waiting for a future help with queued ones
+    pthread_cond_broadcast(&completed);
+
+    return true;
+}
+
+// `lock` must be held
+static mat47_future_t *dequeue(void)
+{
+    mat47_future_t *f = head;
+
+    if ((head = f->next) == NULL) tail = NULL;
+    n_queued--;
+
+    return f;
+}
+
+/* Handles the completion of a future (which may be a continuation completing with
+ * the error of its antecedent); `lock` must be held.
+ *
+ * Returns a continuation the caller must run itself (see `enqueue()`), if any.
+ */
+static mat47_future_t *settle(mat47_future_t *f)
+{
+    mat47_future_t *g;
+
+    for (;;) {
+        if (f->detached) {
+            mat47_del(f->result);
+            free(f);
+            return NULL;
+        }
+        if (!(g = f->cont)) return NULL;
+
+        g->job.then.input = f->result;
+        g->errnum = f->errnum;
+        free(f);
+        if (!g->errnum) return enqueue(g) ? NULL : g;
+
+        // Propagate the error without running the continuation
+        g->result = NULL;
+        g->done = true;
+        f = g;
+    }
+}
+
+// Runs a future and the continuations that can't be queued
+static void run(mat47_future_t *f)
+{
+    unsigned int saved_errno = mat47_errno;
+    mat47_t *result;
+
+    do {
+        mat47_errno = 0;
+        result = f->run(f);
+
+        pthread_mutex_lock(&lock);
+        f->result = result;
+        f->errnum = mat47_errno;
+        f->done = true;
+        f = settle(f);
+        pthread_cond_broadcast(&completed);
+        pthread_mutex_unlock(&lock);
+    } while (f);
+
+    mat47_errno = saved_errno;
+}
+
+static void *work(void *arg)
+{
+    mat47_future_t *f;
+
+    (void)arg;
+    in_pool = true;
+
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        while (!head) {
+            n_idle++;
+            pthread_cond_wait(&queued, &lock);
+            n_idle--;
+        }
+        f = dequeue();
+        pthread_mutex_unlock(&lock);
+        run(f);
+        pthread_mutex_lock(&lock);
+    }
+
+    return NULL;
+}
+
+static mat47_future_t *new_future(job_fn *run)
+{
+    mat47_future_t *f;
+
+    if (!(f = calloc(1, sizeof(mat47_future_t)))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for future");
+        return NULL;
+    }
+    f->run = run;
+
+    return f;
+}
+
+static mat47_future_t *submit(mat47_future_t *f)
+{
+    bool is_queued;
+
+    if (!f) return NULL;
+
+    pthread_mutex_lock(&lock);
+    is_queued = enqueue(f);
+    pthread_mutex_unlock(&lock);
+    if (!is_queued) {
+        debug("No async thread; Running future @ %p synchronously", (void *)f);
+        run(f);
+    }
+
+    return f;
+}
+
+
+static mat47_t *run_call(mat47_future_t *f)
+{
+    return f->job.call.fn(f->job.call.arg);
+}
+
+mat47_future_t *mat47_async_call(mat47_async_fn *fn, void *arg)
+{
+    mat47_future_t *f;
+
+    if (check_ptr(fn)) return NULL;
+
+    if ((f = new_future(run_call))) f->job.call.fn = fn, f->job.call.arg = arg;
+
+    return submit(f);
+}
+
+
+static mat47_t *run_cholesky(mat47_future_t *f)
+{
+    return mat47_cholesky(f->job.op.a);
+}
+
+mat47_future_t *mat47_async_cholesky(const mat47_t *a)
+{
+    mat47_future_t *f;
+
+    if ((f = new_future(run_cholesky))) f->job.op.a = a;
+
+    return submit(f);
+}
+
+
+static mat47_t *run_lu(mat47_future_t *f)
+{
+    return mat47_lu(f->job.op.a, f->job.op.out);
+}
+
+mat47_future_t *mat47_async_lu(const mat47_t *a, unsigned int *piv)
+{
+    mat47_future_t *f;
+
+    if ((f = new_future(run_lu))) f->job.op.a = a, f->job.op.out = piv;
+
+    return submit(f);
+}
+
+
+static mat47_t *run_mul(mat47_future_t *f)
+{
+    return mat47_mul(f->job.op.a, f->job.op.b);
+}
+
+mat47_future_t *mat47_async_mul(const mat47_t *a, const mat47_t *b)
+{
+    mat47_future_t *f;
+
+    if ((f = new_future(run_mul))) f->job.op.a = a, f->job.op.b = b;
+
+    return submit(f);
+}
+
+
+static mat47_t *run_qr(mat47_future_t *f)
+{
+    return mat47_qr(f->job.op.a, f->job.op.out);
+}
+
+mat47_future_t *mat47_async_qr(const mat47_t *a, mat47_t **r)
+{
+    mat47_future_t *f;
+
+    if ((f = new_future(run_qr))) f->job.op.a = a, f->job.op.out = r;
+
+    return submit(f);
+}
+
+
+bool mat47_future_done(const mat47_future_t *f)
+{
+    bool done;
+
+    if (check_ptr(f)) return false;
+
+    pthread_mutex_lock(&lock);
+    done = f->done;
+    pthread_mutex_unlock(&lock);
+
+    return done;
+}
+
+
+static mat47_t *run_then(mat47_future_t *f)
+{
+    return f->job.then.fn(f->job.then.input, f->job.then.arg);
+}
+
+mat47_future_t *mat47_future_then(mat47_future_t *f, mat47_then_fn *fn, void *arg)
+{
+    mat47_future_t *g = NULL, *to_run;
+
+    if (check_ptr(f)) return NULL;
+
+    if (!check_ptr(fn) && (g = new_future(run_then)))
+        g->job.then.fn = fn, g->job.then.arg = arg;
+
+    pthread_mutex_lock(&lock);
+    if (g) f->cont = g;
+    else f->detached = true;
+    to_run = f->done ? settle(f) : NULL;
+    pthread_mutex_unlock(&lock);
+    if (to_run) run(to_run);
+
+    return g;
+}
+
+
+mat47_t *mat47_future_wait(mat47_future_t *f)
+{
+    mat47_future_t *g;
+    mat47_t *result;
+
+    if (check_ptr(f)) return NULL;
+
+    pthread_mutex_lock(&lock);
+    while (!f->done) {
+        // Waiting within an operation; Help, as the operation waited for may be
+        // queued behind others, with all the threads of the pool waiting.
+        if (in_pool && head) {
+            g = dequeue();
+            pthread_mutex_unlock(&lock);
+            run(g);
+            pthread_mutex_lock(&lock);
+        } else {
+            pthread_cond_wait(&completed, &lock);
+        }
+    }
+    pthread_mutex_unlock(&lock);
+
+    result = f->result;
+    if (f->errnum) mat47_errno = f->errnum;
+    free(f);
+
+    return result;
+}
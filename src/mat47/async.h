@@ -0,0 +1,191 @@
+/* Asynchronous operations
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_ASYNC_H
+#define MAT47_ASYNC_H
+
+#include <stdbool.h>
+
+#include "matrix.h"
+
+/**
+ * The pending result of an asynchronous operation: A matrix (or null) and the error
+ * raised by the operation, if any.
+ *
+ * A future is consumed, exactly once, by either :c:func:`mat47_future_wait` or
+ * :c:func:`mat47_future_then`; It must not be used afterwards.
+ */
+typedef struct mat47_future mat47_future_t;
+
+/** An operation run by :c:func:`mat47_async_call` */
+typedef mat47_t *mat47_async_fn(void *arg);
+
+/** A continuation run by :c:func:`mat47_future_then` */
+typedef mat47_t *mat47_then_fn(mat47_t *result, void *arg);
+
+/**
+ * Minimum number of threads in the pool on which asynchronous operations run, such
+ * that an operation blocked on I/O doesn't hold back computations.
+ */
+#define MAT47_ASYNC_MIN_THREADS 2
+
+/**
+ * Runs an arbitrary operation asynchronously.
+ *
+ * Args:
+ *     fn: The operation, called as ``fn(arg)``; Its return value is the result of the
+ *       future and any error it raises (i.e sets in :c:data:`mat47_errno`, which is
+ *       zero when it's called) is delivered through the future.
+ *     arg: The argument passed to *fn*
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new future.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *fn* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Operations are queued and run in order of submission, on a pool of threads started
+ * as needed, up to :c:func:`mat47_get_num_threads` (but at least
+ * :c:macro:`MAT47_ASYNC_MIN_THREADS`) threads; If no thread can be started, the
+ * operation is run before this function returns. Library functions called by
+ * operations are parallelized as usual.
+ *
+ * Typically used for I/O e.g loading the next matrix while computing on the current
+ * one.
+ */
+mat47_future_t *mat47_async_call(mat47_async_fn *fn, void *arg);
+
+/**
+ * Computes the Cholesky factorization of a matrix asynchronously.
+ *
+ * Args:
+ *     a: The matrix
+ *
+ * Returns:
+ *     Same as :c:func:`mat47_async_call`.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The future's result and error are those of :c:func:`mat47_cholesky`. *a* must not
+ * be modified or deallocated until the future is complete.
+ */
+mat47_future_t *mat47_async_cholesky(const mat47_t *a);
+
+/**
+ * Computes the LU factorization of a matrix asynchronously.
+ *
+ * Args:
+ *     a: The matrix
+ *     piv: The location to store the row interchanges in
+ *
+ * Returns:
+ *     Same as :c:func:`mat47_async_call`.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The future's result and error are those of :c:func:`mat47_lu`. *a* must not be
+ * modified or deallocated, nor *piv* accessed, until the future is complete.
+ */
+mat47_future_t *mat47_async_lu(const mat47_t *a, unsigned int *piv);
+
+/**
+ * Multiplies two matrices asynchronously.
+ *
+ * Args:
+ *     a: The left operand
+ *     b: The right operand
+ *
+ * Returns:
+ *     Same as :c:func:`mat47_async_call`.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The future's result and error are those of :c:func:`mat47_mul`. The operands must
+ * not be modified or deallocated until the future is complete.
+ */
+mat47_future_t *mat47_async_mul(const mat47_t *a, const mat47_t *b);
+
+/**
+ * Computes the QR factorization of a matrix asynchronously.
+ *
+ * Args:
+ *     a: The matrix
+ *     r: The location to store a pointer to *r* in
+ *
+ * Returns:
+ *     Same as :c:func:`mat47_async_call`.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The future's result (*q*) and error are those of :c:func:`mat47_qr`. *a* must not
+ * be modified or deallocated, nor *r* accessed, until the future is complete.
+ */
+mat47_future_t *mat47_async_qr(const mat47_t *a, mat47_t **r);
+
+/**
+ * Checks whether a future is complete, without blocking.
+ *
+ * Args:
+ *     f: The future
+ *
+ * Returns:
+ *     ``true`` if the operation has completed (such that :c:func:`mat47_future_wait`
+ *     won't block), otherwise ``false``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *f* is null
+ */
+bool mat47_future_done(const mat47_future_t *f);
+
+/**
+ * Chains a continuation to a future.
+ *
+ * Args:
+ *     f: The future; It's consumed, even if any error occurs.
+ *     fn: The continuation, called as ``fn(result, arg)`` with the result of *f*
+ *       once it's complete, like an operation run by :c:func:`mat47_async_call`
+ *     arg: The second argument passed to *fn*
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new future of the result of *fn*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *f* or *fn* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * If *f* completes with an error, *fn* is not called and the new future completes
+ * with the same error and a null result. If any error occurs here, the result of *f*
+ * is deallocated once it's complete.
+ */
+mat47_future_t *mat47_future_then(mat47_future_t *f, mat47_then_fn *fn, void *arg);
+
+/**
+ * Waits for a future to complete and consumes it.
+ *
+ * Args:
+ *     f: The future
+ *
+ * Returns:
+ *     The result of the future's operation (possibly null), which is then owned by
+ *     the caller.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *f* is null
+ *     - Any error raised by the future's operation (or any it's chained to)
+ *
+ * While waiting, a thread of the pool (i.e an operation waiting for another) runs
+ * queued operations, such that chains of operations can't deadlock the pool.
+ */
+mat47_t *mat47_future_wait(mat47_future_t *f);
+
+#endif  // MAT47_ASYNC_H
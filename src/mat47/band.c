@@ -0,0 +1,526 @@
+/* Banded matrix definitions
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "band.h"
+#include "error.h"
+#include "matrix.h"
+#include "utils.h"
+
+#define width(b) ((size_t)(b)->kl + (b)->ku + 1)
+
+// Element `(i, j)`, within the band; The elements of a row are contiguous.
+static inline double *elem(const mat47b_t *b, unsigned int i, unsigned int j)
+{
+    return b->data + (i * width(b) + b->kl + j - i);
+}
+
+// The first and last columns of row `i` within the band and the matrix
+static inline unsigned int first(const mat47b_t *b, unsigned int i)
+{
+    return i > b->kl ? i - b->kl : 0;
+}
+
+static inline unsigned int last(const mat47b_t *b, unsigned int i)
+{
+    return min(b->n - 1, i + b->ku);
+}
+
+static bool check_band(unsigned int n, unsigned int kl, unsigned int ku)
+{
+    return check(
+        kl < n && ku < n, MAT47_ERR_INVALID_ARG, ": kl=%u, ku=%u for n=%u", kl, ku, n
+    );
+}
+
+
+/**
+ * Allocates memory for a new banded matrix, with all elements initialized to zero.
+ *
+ * Args:
+ *     n: Number of rows (and columns)
+ *     kl: Number of diagonals below the main diagonal
+ *     ku: Number of diagonals above the main diagonal
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a newly allocated banded matrix.
+ *
+ * Raises:
+ *     MAT47_ERR_ZERO_SIZE: *n* is zero.
+ *     MAT47_ERR_INVALID_ARG: *kl* or *ku* is not less than *n*.
+ *     MAT47_ERR_ALLOC: Unable to allocate memory.
+ */
+static mat47b_t *mat47b_new(unsigned int n, unsigned int kl, unsigned int ku)
+{
+    mat47b_t *b;
+
+    if (check(n, MAT47_ERR_ZERO_SIZE, ": n=0") || check_band(n, kl, ku)) return NULL;
+
+    if (!(b = malloc(sizeof(mat47b_t)))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for banded matrix object");
+        return NULL;
+    }
+    *b = (mat47b_t){n, kl, ku, NULL};
+    if (!(b->data = calloc(n * width(b), sizeof(double)))) {
+        free(b);
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for banded elements");
+        return NULL;
+    }
+    stats_alloc(2, sizeof(mat47b_t) + sizeof(double) * n * width(b));
+
+    debug(
+        "Allocated %u x %u banded matrix @ %p, kl=%u, ku=%u", n, n, (void *)b, kl, ku
+    );
+
+    return b;
+}
+
+
+void mat47b_del(mat47b_t *b)
+{
+    stats(B_DEL);
+
+    if (b) {
+        stats_free(sizeof(mat47b_t) + sizeof(double) * b->n * width(b));
+        free(b->data);
+        debug("Deallocated banded matrix @ %p", (void *)b);
+        free(b);
+    }
+}
+
+
+mat47b_t *mat47b_zero(unsigned int n, unsigned int kl, unsigned int ku)
+{
+    stats(B_ZERO);
+
+    return mat47b_new(n, kl, ku);
+}
+
+
+mat47b_t *mat47b_pack(const mat47_t *m, unsigned int kl, unsigned int ku)
+{
+    stats(B_PACK);
+    mat47b_t *b;
+    unsigned int i, j0;
+
+    if (check_ptr(m) || check_eq(m->n_rows, m->n_cols)) return NULL;
+    if (!(b = mat47b_new(m->n_rows, kl, ku))) return NULL;
+
+    for (i = 0; i < b->n; i++) {
+        j0 = first(b, i);
+        memcpy(
+            elem(b, i, j0), m->data[i] + j0, sizeof(double) * (last(b, i) - j0 + 1)
+        );
+    }
+    stats_copy(sizeof(double) * b->n * width(b));
+
+    return b;
+}
+
+
+mat47_t *mat47b_unpack(const mat47b_t *b)
+{
+    stats(B_UNPACK);
+    mat47_t *m;
+    unsigned int i, j0;
+
+    if (check_ptr(b)) return NULL;
+    if (!(m = mat47__new(b->n, b->n, true))) return NULL;
+
+    for (i = 0; i < b->n; i++) {
+        j0 = first(b, i);
+        memcpy(
+            m->data[i] + j0, elem(b, i, j0), sizeof(double) * (last(b, i) - j0 + 1)
+        );
+    }
+    stats_copy(sizeof(double) * b->n * width(b));
+
+    return m;
+}
+
+
+/* Band LU factorization, as by LAPACK's `DGBTRF` (unblocked).
+ *
+ * At step `k`, the pivot is searched for among the `kl` rows below the diagonal,
+ * interchanged with row `k` over columns `k` onwards only, and eliminated from those
+ * rows. Since the pivot row extends `kl` columns further right than row `k` did, the
+ * upper band of the factors is `kl + ku` wide. The multipliers are stored where they
+ * eliminated the elements, hence aren't permuted by later interchanges.
+ */
+
+// `f` holds `a`, with its upper band widened
+static bool lu(mat47b_t *f, unsigned int *piv)
+{
+    unsigned int n = f->n, i, k, p, r, end, bottom;
+    double *restrict row_k, *restrict row_r, max, pivot, l, t;
+
+    for (k = 0; k < n; k++) {
+        end = last(f, k);
+        bottom = min(n - 1, k + f->kl);
+        for (max = fabs(*elem(f, k, k)), p = k, r = k + 1; r <= bottom; r++)
+            if (fabs(*elem(f, r, k)) > max) max = fabs(*elem(f, p = r, k));
+        piv[k] = p;
+        if (max == 0) return false;
+
+        row_k = elem(f, k, k);
+        if (p != k)
+            for (row_r = elem(f, p, k), i = 0; i <= end - k; i++) {
+                t = row_k[i];
+                row_k[i] = row_r[i];
+                row_r[i] = t;
+            }
+
+        for (pivot = row_k[0], r = k + 1; r <= bottom; r++) {
+            row_r = elem(f, r, k);
+            if ((l = row_r[0] /= pivot) == 0) continue;
+            for (i = 1; i <= end - k; i++) row_r[i] -= l * row_k[i];
+        }
+    }
+
+    return true;
+}
+
+mat47b_t *mat47b_lu(const mat47b_t *a, unsigned int *piv)
+{
+    stats(B_LU);
+    mat47b_t *f;
+    unsigned int i, j0;
+
+    if (check_ptr(a) || check_ptr(piv)) return NULL;
+    if (!(f = mat47b_new(a->n, a->kl, min(a->n - 1, a->kl + a->ku)))) return NULL;
+
+    for (i = 0; i < a->n; i++) {
+        j0 = first(a, i);
+        memcpy(
+            elem(f, i, j0), elem(a, i, j0), sizeof(double) * (last(a, i) - j0 + 1)
+        );
+    }
+
+    if (!lu(f, piv)) {
+        mat47b_del(f);
+        mat47_errno = MAT47_ERR_SINGULAR;
+        error(": zero pivot");
+        return NULL;
+    }
+
+    return f;
+}
+
+
+// `dst[:n] -= alpha * src[:n]`
+static inline void sub_scaled(
+    double *restrict dst, double alpha, const double *restrict src, unsigned int n
+) {
+    for (unsigned int j = 0; j < n; j++) dst[j] -= alpha * src[j];
+}
+
+// `x` holds `b`
+static void lu_solve(const mat47b_t *lu, const unsigned int *piv, mat47_t *x)
+{
+    unsigned int n = lu->n, k = x->n_cols, i, j, r;
+    double **rows = x->data, t, u;
+
+    for (i = 0; i < n; i++) {
+        if (piv[i] != i)
+            for (j = 0; j < k; j++) {
+                t = rows[i][j];
+                rows[i][j] = rows[piv[i]][j];
+                rows[piv[i]][j] = t;
+            }
+        for (r = i + 1; r <= min(n - 1, i + lu->kl); r++)
+            if ((t = *elem(lu, r, i))) sub_scaled(rows[r], t, rows[i], k);
+    }
+
+    for (i = n; i-- > 0;) {
+        for (r = i + 1; r <= last(lu, i); r++)
+            if ((t = *elem(lu, i, r))) sub_scaled(rows[i], t, rows[r], k);
+        for (u = *elem(lu, i, i), j = 0; j < k; j++) rows[i][j] /= u;
+    }
+}
+
+mat47_t *mat47b_lu_solve(const mat47b_t *lu, const unsigned int *piv, const mat47_t *b)
+{
+    stats(B_LU_SOLVE);
+    mat47_t *x;
+
+    if (check_ptr(lu) || check_ptr(piv) || check_ptr(b) || check_eq(b->n_rows, lu->n))
+        return NULL;
+    if (!(x = mat47_copy(b))) return NULL;
+    lu_solve(lu, piv, x);
+
+    return x;
+}
+
+
+// Returns true (with `mat47_errno` set) if `dst` can't hold the solution for `b`
+static bool check_solve_into(const mat47_t *dst, const mat47_t *b, unsigned int n)
+{
+    return (
+        check_ptr(dst) || check_ptr(b) || check_eq(b->n_rows, n)
+        || check_eq(dst->n_rows, b->n_rows) || check_eq(dst->n_cols, b->n_cols)
+    );
+}
+
+void mat47b_lu_solve_into(
+    mat47_t *dst, const mat47b_t *lu, const unsigned int *piv, const mat47_t *b
+) {
+    stats(B_LU_SOLVE_INTO);
+
+    if (check_ptr(lu) || check_ptr(piv) || check_solve_into(dst, b, lu->n)) return;
+
+    mat47_copy_into(dst, b);
+    bump_version(dst);
+    lu_solve(lu, piv, dst);
+}
+
+
+// Returns the factors of `a`, storing the row interchanges in `*piv`, or null on error
+static mat47b_t *factorize(const mat47b_t *a, unsigned int **piv)
+{
+    mat47b_t *f;
+
+    if (!(*piv = malloc(sizeof(unsigned int) * a->n))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for row interchanges");
+        return NULL;
+    }
+    if (!(f = mat47b_lu(a, *piv))) {
+        free(*piv);
+        *piv = NULL;
+    }
+
+    return f;
+}
+
+mat47_t *mat47b_solve(const mat47b_t *a, const mat47_t *b)
+{
+    stats(B_SOLVE);
+    mat47b_t *f;
+    mat47_t *x = NULL;
+    unsigned int *piv;
+
+    if (check_ptr(a) || check_ptr(b) || check_eq(b->n_rows, a->n)) return NULL;
+    if (!(f = factorize(a, &piv))) return NULL;
+
+    if ((x = mat47_copy(b))) lu_solve(f, piv, x);
+    mat47b_del(f);
+    free(piv);
+
+    return x;
+}
+
+
+void mat47b_solve_into(mat47_t *dst, const mat47b_t *a, const mat47_t *b)
+{
+    stats(B_SOLVE_INTO);
+    mat47b_t *f;
+    unsigned int *piv;
+
+    if (check_ptr(a) || check_solve_into(dst, b, a->n)) return;
+    if (!(f = factorize(a, &piv))) return;
+
+    mat47_copy_into(dst, b);
+    bump_version(dst);
+    lu_solve(f, piv, dst);
+    mat47b_del(f);
+    free(piv);
+}
+
+
+/* Thomas algorithm: Gaussian elimination of a tridiagonal system without pivoting.
+ *
+ * The forward sweep replaces the upper diagonal with `c'[i] = u[i] / den[i]` and the
+ * right-hand side with `d'[i] = (b[i] - l[i] * d'[i - 1]) / den[i]`, where
+ * `den[i] = d[i] - l[i] * c'[i - 1]`; The backward sweep substitutes
+ * `x[i] = d'[i] - c'[i] * x[i + 1]`.
+ */
+
+// Returns true (with `mat47_errno` set) if `a` isn't tridiagonal
+static bool check_tridiag(const mat47b_t *a)
+{
+    return check(
+        a->kl <= 1 && a->ku <= 1, MAT47_ERR_INVALID_ARG,
+        ": kl=%u, ku=%u isn't tridiagonal", a->kl, a->ku
+    );
+}
+
+/* Stores the solution for `b` in `x`; Returns false, with `mat47_errno` set and `x`
+ * unchanged, on error. `x` may be `b`.
+ *
+ * `c'` and `den` depend on `a` only, hence they're computed (and the pivots checked)
+ * before `x` is written.
+ */
+static bool tridiag_solve(const mat47b_t *a, mat47_t *x, const mat47_t *b)
+{
+    unsigned int n = a->n, k = x->n_cols, i, j;
+    double *cp, *den, **rows = x->data, l;
+
+    if (!(cp = malloc(sizeof(double) * 2 * n))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the eliminated diagonal");
+        return false;
+    }
+    den = cp + n;
+
+    for (i = 0; i < n; i++) {
+        l = i && a->kl ? *elem(a, i, i - 1) : 0;
+        if ((den[i] = *elem(a, i, i) - (i ? l * cp[i - 1] : 0)) == 0) {
+            free(cp);
+            mat47_errno = MAT47_ERR_SINGULAR;
+            error(": zero pivot at row %u", i);
+            return false;
+        }
+        cp[i] = i < n - 1 && a->ku ? *elem(a, i, i + 1) / den[i] : 0;
+    }
+
+    mat47_copy_into(x, b);
+    for (i = 0; i < n; i++) {
+        l = i && a->kl ? *elem(a, i, i - 1) : 0;
+        for (j = 0; j < k; j++)
+            rows[i][j] = (rows[i][j] - (i ? l * rows[i - 1][j] : 0)) / den[i];
+    }
+    for (i = n - 1; i-- > 0;)
+        if (cp[i] != 0) sub_scaled(rows[i], cp[i], rows[i + 1], k);
+    free(cp);
+
+    return true;
+}
+
+mat47_t *mat47b_tridiag_solve(const mat47b_t *a, const mat47_t *b)
+{
+    stats(B_TRIDIAG_SOLVE);
+    mat47_t *x;
+
+    if (check_ptr(a) || check_ptr(b) || check_tridiag(a) || check_eq(b->n_rows, a->n))
+        return NULL;
+
+    if (!(x = mat47__new(b->n_rows, b->n_cols, false))) return NULL;
+    if (!tridiag_solve(a, x, b)) {
+        mat47_del(x);
+        return NULL;
+    }
+
+    return x;
+}
+
+
+void mat47b_tridiag_solve_into(mat47_t *dst, const mat47b_t *a, const mat47_t *b)
+{
+    stats(B_TRIDIAG_SOLVE_INTO);
+
+    if (check_ptr(a) || check_tridiag(a) || check_solve_into(dst, b, a->n)) return;
+    if (tridiag_solve(a, dst, b)) bump_version(dst);
+}
+
+
+struct batch {
+    mat47_t *x;
+    const mat47_t *dl, *d, *du;
+    double *cp, *dp;  // `c'` and `d'`, `n x k` each
+    unsigned int n, k;
+    atomic_bool singular;
+};
+
+// The forward sweep for systems [begin, end), into `cp` and `dp`
+static void batch_forward(void *arg, size_t begin, size_t end)
+{
+    struct batch *t = arg;
+    unsigned int n = t->n, i;
+    size_t k = t->k, s;
+    const double *restrict dl, *restrict d, *restrict du, *restrict b;
+    const double *restrict cp_prev, *restrict dp_prev;
+    double *restrict cp = t->cp, *restrict dp = t->dp, den;
+    bool singular = false;
+
+    for (d = t->d->data[0], du = t->du->data[0], b = t->x->data[0], s = begin; s < end;
+         s++) {
+        singular |= d[s] == 0;
+        cp[s] = n > 1 ? du[s] / d[s] : 0;
+        dp[s] = b[s] / d[s];
+    }
+    for (i = 1; i < n; i++) {
+        dl = t->dl->data[i], d = t->d->data[i], du = t->du->data[i];
+        b = t->x->data[i];
+        cp_prev = cp, dp_prev = dp;
+        cp += k, dp += k;
+        for (s = begin; s < end; s++) {
+            den = d[s] - dl[s] * cp_prev[s];
+            singular |= den == 0;
+            cp[s] = i < n - 1 ? du[s] / den : 0;
+            dp[s] = (b[s] - dl[s] * dp_prev[s]) / den;
+        }
+    }
+    if (singular) atomic_store(&t->singular, true);
+}
+
+// The backward sweep for systems [begin, end), into `x`
+static void batch_backward(void *arg, size_t begin, size_t end)
+{
+    struct batch *t = arg;
+    unsigned int n = t->n, i;
+    size_t k = t->k, s;
+    const double *restrict cp, *restrict dp, *restrict next;
+    double *restrict x;
+
+    memcpy(
+        t->x->data[n - 1] + begin, t->dp + (n - 1) * k + begin,
+        sizeof(double) * (end - begin)
+    );
+    for (i = n - 1; i-- > 0;) {
+        x = t->x->data[i], next = t->x->data[i + 1];
+        cp = t->cp + i * k, dp = t->dp + i * k;
+        for (s = begin; s < end; s++) x[s] = dp[s] - cp[s] * next[s];
+    }
+}
+
+void mat47b_tridiag_solve_batch(
+    mat47_t *x, const mat47_t *dl, const mat47_t *d, const mat47_t *du
+) {
+    stats(B_TRIDIAG_SOLVE_BATCH);
+    struct batch t;
+    size_t grain;
+
+    if (check_ptr(x) || check_ptr(dl) || check_ptr(d) || check_ptr(du)) return;
+    if (
+        check(
+            x != dl && x != d && x != du, MAT47_ERR_INVALID_ARG,
+            ": x @ %p is also a diagonal", (void *)x
+        )
+    ) return;
+    if (
+        check_eq(dl->n_rows, x->n_rows) || check_eq(dl->n_cols, x->n_cols)
+        || check_eq(d->n_rows, x->n_rows) || check_eq(d->n_cols, x->n_cols)
+        || check_eq(du->n_rows, x->n_rows) || check_eq(du->n_cols, x->n_cols)
+    ) return;
+
+    t = (struct batch){x, dl, d, du, NULL, NULL, x->n_rows, x->n_cols, false};
+    if (!(t.cp = malloc(sizeof(double) * 2 * t.n * t.k))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the eliminated systems");
+        return;
+    }
+    t.dp = t.cp + (size_t)t.n * t.k;
+
+    grain = PARALLEL_GRAIN / t.n + 1;
+    mat47__parallel_for(t.k, grain, batch_forward, &t);
+    if (atomic_load(&t.singular)) {
+        mat47_errno = MAT47_ERR_SINGULAR;
+        error(": zero pivot");
+    } else {
+        bump_version(x);
+        mat47__parallel_for(t.k, grain, batch_backward, &t);
+    }
+    free(t.cp);
+}
@@ -0,0 +1,315 @@
+/* Banded matrix definitions
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_BAND_H
+#define MAT47_BAND_H
+
+#include "matrix.h"
+
+/**
+ * The banded matrix type definition: A square matrix of which only the elements
+ * within ``kl`` diagonals below the main diagonal and ``ku`` above it are stored, i.e
+ * ``n * (kl + ku + 1)`` elements instead of ``n * n``.
+ *
+ * Every row stores ``kl + ku + 1`` elements, rows following one another: Row ``i``
+ * holds columns ``i - kl`` to ``i + ku``, from ``data + i * (kl + ku + 1)``; i.e
+ * element ``(i, j)`` is ``data[i * (kl + ku + 1) + kl + j - i]``. The slots of columns
+ * outside the matrix (in the first ``kl`` and last ``ku`` rows) are zero.
+ */
+struct mat47b {
+
+    /** Number of rows (and columns) */
+    unsigned int n;
+
+    /** Number of diagonals below the main diagonal (lower bandwidth) */
+    unsigned int kl;
+
+    /** Number of diagonals above the main diagonal (upper bandwidth) */
+    unsigned int ku;
+
+    /** Stored elements, contiguous */
+    double *data;
+};
+
+/** The banded matrix type (Alias of :c:struct:`struct mat47b<mat47b>`) */
+typedef struct mat47b mat47b_t;
+
+/**
+ * Deallocates memory used by a banded matrix.
+ *
+ * Args:
+ *     b: The banded matrix to be deallocated
+ */
+void mat47b_del(mat47b_t *b);
+
+/**
+ * Computes the LU factorization of a banded matrix, with partial pivoting.
+ *
+ * Args:
+ *     a: The banded matrix
+ *     piv: The location to store the row interchanges in, with room for ``a->n``
+ *       elements; As by :c:func:`mat47_lu`.
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new banded matrix with ``a->kl`` diagonals below
+ *       the main diagonal and ``a->kl + a->ku`` (at most ``a->n - 1``) above it,
+ *       holding *u* in its upper band and the multipliers of *l* in its lower band,
+ *       to be used with :c:func:`mat47b_lu_solve`.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *piv* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: *a* is singular
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The row interchanges widen the upper band of *u* by ``kl`` diagonals, which is why
+ * the factors have more diagonals than *a*. Takes ``O(n * kl * (kl + ku))``
+ * floating-point operations, instead of ``O(n^3)`` for :c:func:`mat47_lu`.
+ *
+ * Unlike that of :c:func:`mat47_lu`, *l* isn't permuted by the later interchanges,
+ * as by LAPACK's ``DGBTRF``: Element ``(r, c)`` of the lower band is the multiplier
+ * of row ``r`` at step ``c``, i.e after interchange ``c``.
+ */
+mat47b_t *mat47b_lu(const mat47b_t *a, unsigned int *piv);
+
+/**
+ * Solves a banded system of linear equations, given the LU factorization of its
+ * coefficient matrix.
+ *
+ * Args:
+ *     lu: The factors, as returned by :c:func:`mat47b_lu`
+ *     piv: The row interchanges, as stored by :c:func:`mat47b_lu`
+ *     b: The right-hand side(s), one per column, with ``lu->n`` rows
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix *x* such that ``a * x = b``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the arguments is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *b* doesn't have
+ *       ``lu->n`` rows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Takes ``O(n * (2 * kl + ku) * k)`` floating-point operations for ``k`` right-hand
+ * sides; Hence, a factorization may be reused for many of them.
+ */
+mat47_t *mat47b_lu_solve(const mat47b_t *lu, const unsigned int *piv, const mat47_t *b);
+
+/**
+ * Solves a banded system of linear equations, given the LU factorization of its
+ * coefficient matrix, into an existing matrix.
+ *
+ * Args:
+ *     dst: The matrix into which to store the solution; May be *b*.
+ *     lu: The factors, as returned by :c:func:`mat47b_lu`
+ *     piv: The row interchanges, as stored by :c:func:`mat47b_lu`
+ *     b: The right-hand side(s), one per column, with ``lu->n`` rows
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the arguments is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *b* doesn't have
+ *       ``lu->n`` rows, or *dst* and *b* have different dimensions
+ *
+ * See :c:func:`mat47b_lu_solve` and :c:func:`mat47_copy_into`.
+ */
+void mat47b_lu_solve_into(
+    mat47_t *dst, const mat47b_t *lu, const unsigned int *piv, const mat47_t *b
+);
+
+/**
+ * Packs the band of a square matrix.
+ *
+ * Args:
+ *     m: The matrix
+ *     kl: Number of diagonals below the main diagonal, less than the size of *m*
+ *     ku: Number of diagonals above the main diagonal, less than the size of *m*
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new banded matrix holding the band of *m*; The other
+ *       elements are ignored.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *m* is not square
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *kl* or *ku* is out of
+ *       range
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ */
+mat47b_t *mat47b_pack(const mat47_t *m, unsigned int kl, unsigned int ku);
+
+/**
+ * Solves a banded system of linear equations.
+ *
+ * Args:
+ *     a: The banded coefficient matrix
+ *     b: The right-hand side(s), one per column, with ``a->n`` rows
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix *x* such that ``a * x = b``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *b* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *b* doesn't have
+ *       ``a->n`` rows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: *a* is singular
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Equivalent to :c:func:`mat47b_lu` followed by :c:func:`mat47b_lu_solve`.
+ */
+mat47_t *mat47b_solve(const mat47b_t *a, const mat47_t *b);
+
+/**
+ * Solves a banded system of linear equations, into an existing matrix.
+ *
+ * Args:
+ *     dst: The matrix into which to store the solution; May be *b*.
+ *     a: The banded coefficient matrix
+ *     b: The right-hand side(s), one per column, with ``a->n`` rows
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the arguments is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *b* doesn't have
+ *       ``a->n`` rows, or *dst* and *b* have different dimensions
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: *a* is singular
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Allocates the factors of *a* and its row interchanges, like :c:func:`mat47b_solve`;
+ * Only the solution isn't allocated. :c:func:`mat47b_lu` and
+ * :c:func:`mat47b_lu_solve_into` allocate nothing per right-hand side.
+ *
+ * See :c:func:`mat47_copy_into`.
+ */
+void mat47b_solve_into(mat47_t *dst, const mat47b_t *a, const mat47_t *b);
+
+/**
+ * Solves a tridiagonal system of linear equations, with the Thomas algorithm.
+ *
+ * Args:
+ *     a: The banded coefficient matrix, with at most one diagonal below and one
+ *       above the main diagonal
+ *     b: The right-hand side(s), one per column, with ``a->n`` rows
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix *x* such that ``a * x = b``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *b* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *a* has more than one
+ *       diagonal below or above the main diagonal
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *b* doesn't have
+ *       ``a->n`` rows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: A zero pivot occurs
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The elimination isn't pivoted, which is stable for diagonally dominant and
+ * symmetric positive-definite matrices, as those of many discretizations; Otherwise,
+ * :c:func:`mat47b_solve` should be used. Takes ``O(n * k)`` floating-point operations
+ * for ``k`` right-hand sides and no more memory than the solution and ``2 * n``
+ * elements.
+ */
+mat47_t *mat47b_tridiag_solve(const mat47b_t *a, const mat47_t *b);
+
+/**
+ * Solves many independent tridiagonal systems of linear equations, in place.
+ *
+ * Args:
+ *     x: The right-hand sides, replaced with the solutions; An ``n x k`` matrix, of
+ *       which column ``s`` belongs to system ``s``.
+ *     dl: The diagonals below the main diagonals, with the same dimensions as *x*;
+ *       ``dl[i][s]`` is element ``(i, i - 1)`` of system ``s`` and the first row is
+ *       ignored.
+ *     d: The main diagonals, with the same dimensions as *x*
+ *     du: The diagonals above the main diagonals, with the same dimensions as *x*;
+ *       ``du[i][s]`` is element ``(i, i + 1)`` of system ``s`` and the last row is
+ *       ignored.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the arguments is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *dl*, *d* or *du* has
+ *       different dimensions from *x*
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *x* is the same matrix as
+ *       *dl*, *d* or *du*
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: A zero pivot occurs in any
+ *       of the systems
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * See :c:func:`mat47b_tridiag_solve`. With the systems interleaved, every step of the
+ * elimination is done for all of them over contiguous elements, which vectorizes;
+ * Blocks of systems are solved in parallel. Memory for twice as many elements as *x*
+ * is allocated. If any error occurs, *x* is left unchanged.
+ */
+void mat47b_tridiag_solve_batch(
+    mat47_t *x, const mat47_t *dl, const mat47_t *d, const mat47_t *du
+);
+
+/**
+ * Solves a tridiagonal system of linear equations, with the Thomas algorithm, into an
+ * existing matrix.
+ *
+ * Args:
+ *     dst: The matrix into which to store the solution; May be *b*.
+ *     a: The banded coefficient matrix, with at most one diagonal below and one
+ *       above the main diagonal
+ *     b: The right-hand side(s), one per column, with ``a->n`` rows
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the arguments is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *a* has more than one
+ *       diagonal below or above the main diagonal
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *b* doesn't have
+ *       ``a->n`` rows, or *dst* and *b* have different dimensions
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: A zero pivot occurs
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Allocates ``2 * n`` elements, for the eliminated diagonal; The pivots are all
+ * checked before *dst* is written.
+ *
+ * See :c:func:`mat47b_tridiag_solve` and :c:func:`mat47_copy_into`.
+ */
+void mat47b_tridiag_solve_into(mat47_t *dst, const mat47b_t *a, const mat47_t *b);
+
+/**
+ * Converts a banded matrix to a regular matrix.
+ *
+ * Args:
+ *     b: The banded matrix
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix with all the elements of *b*, including
+ *       the zero ones outside the band.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *b* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ */
+mat47_t *mat47b_unpack(const mat47b_t *b);
+
+/**
+ * Creates a new banded matrix with all elements initialized to zero.
+ *
+ * Args:
+ *     n: Number of rows (and columns)
+ *     kl: Number of diagonals below the main diagonal, less than *n*
+ *     ku: Number of diagonals above the main diagonal, less than *n*
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new banded matrix.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: *n* is zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *kl* or *ku* is not less
+ *       than *n*
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ */
+mat47b_t *mat47b_zero(unsigned int n, unsigned int kl, unsigned int ku);
+
+#endif  // MAT47_BAND_H
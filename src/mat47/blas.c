@@ -0,0 +1,733 @@
+/* Matrix-vector and matrix-matrix products
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blas.h"
+#include "error.h"
+#include "linalg.h"
+#include "matrix.h"
+#include "utils.h"
+
+// Elements per vector; Vectors wider than the target's registers would only be split
+#ifdef __AVX__
+#define W 4
+#else
+#define W 2
+#endif
+
+// Number of elements of a vector operand processed per pass; Chunks of column vectors
+// are gathered into buffers of this size on the stack.
+#define CHUNK 1024
+
+// Number of columns processed per pass by the matrix-multiply kernel; A pair of rows
+// of the matrix stays in the L1 cache while all the vectors go through it.
+#define GEMM_DEPTH 256
+
+typedef double vec __attribute__((vector_size(W * sizeof(double))));
+
+typedef struct mat47__view view;
+
+#define row(v, i) mat47__row(v, i)
+
+// The view of the block from row `i` and column `j`
+static inline view sub(view v, size_t i, size_t j)
+{
+    return (view){v.rows + i, v.col + j};
+}
+
+static inline vec load(const double *p)
+{
+    vec v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store(double *p, vec v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline double hsum(vec v)
+{
+    double s = 0;
+
+    for (int l = 0; l < W; l++) s += v[l];
+    return s;
+}
+
+
+/* Vector operands.
+ *
+ * Vectors are either row vectors (contiguous) or column vectors (one element per row).
+ */
+
+// Returns true (with `mat47_errno` set) if `v` is not a vector of `n` elements
+static bool check_vector(const mat47_t *v, unsigned int n)
+{
+    return check(
+        (v->n_rows == 1 && v->n_cols == n) || (v->n_cols == 1 && v->n_rows == n),
+        MAT47_ERR_DIM_MISMATCH, ": %u x %u matrix is not a vector of %u elements",
+        v->n_rows, v->n_cols, n
+    );
+}
+
+static inline double *vector_elem(const mat47_t *v, size_t k)
+{
+    return v->n_rows == 1 ? v->data[0] + k : v->data[k];
+}
+
+/* Returns a pointer to `n` contiguous elements of `v`, from `begin`; Those of column
+ * vectors are copied into `buf`.
+ */
+static const double *
+gather(const mat47_t *v, unsigned int begin, unsigned int n, double *restrict buf)
+{
+    if (v->n_rows == 1) return v->data[0] + begin;
+
+    for (unsigned int k = 0; k < n; k++) buf[k] = v->data[begin + k][0];
+    return buf;
+}
+
+// Scales `n` elements of `v` from `begin` by `beta`; Zero sets them to zero.
+static void scale(const mat47_t *v, size_t begin, size_t n, double beta)
+{
+    double *e;
+
+    for (; n; n--, begin++) {
+        e = vector_elem(v, begin);
+        *e = beta == 0 ? 0 : beta * *e;
+    }
+}
+
+static bool check_product(const mat47_t *y, const mat47_t *a, const mat47_t *x)
+{
+    return (
+        check_ptr(y) || check_ptr(a) || check_ptr(x)
+        || check(
+            y != a && y != x, MAT47_ERR_INVALID_ARG,
+            ": y @ %p is also an operand", (void *)y
+        )
+    );
+}
+
+
+/* Matrix-vector products */
+
+struct gemv_args {
+    mat47_t *y;
+    double alpha;
+    const mat47_t *a;
+    const mat47_t *x;
+    double beta;
+};
+
+// Computes the dot products of four rows with `x`; `x` is loaded once for all four.
+static void dot4(
+    const double *restrict a0, const double *restrict a1, const double *restrict a2,
+    const double *restrict a3, const double *restrict x, unsigned int n, double *dots
+) {
+    vec s0 = {0}, s1 = {0}, s2 = {0}, s3 = {0}, xv;
+    double d0, d1, d2, d3;
+    unsigned int j = 0;
+
+    for (; j + W <= n; j += W) {
+        xv = load(x + j);
+        s0 += load(a0 + j) * xv;
+        s1 += load(a1 + j) * xv;
+        s2 += load(a2 + j) * xv;
+        s3 += load(a3 + j) * xv;
+    }
+    d0 = hsum(s0); d1 = hsum(s1); d2 = hsum(s2); d3 = hsum(s3);
+    for (; j < n; j++) {
+        d0 += a0[j] * x[j];
+        d1 += a1[j] * x[j];
+        d2 += a2[j] * x[j];
+        d3 += a3[j] * x[j];
+    }
+    dots[0] = d0; dots[1] = d1; dots[2] = d2; dots[3] = d3;
+}
+
+static void gemv_range(void *args, size_t begin, size_t end)
+{
+    struct gemv_args *g = args;
+    double **a = g->a->data, buf[CHUNK], dots[4];
+    unsigned int c, len, n = g->a->n_cols;
+    size_t i, r, last = end - 1;
+    const double *x;
+
+    scale(g->y, begin, end - begin, g->beta);
+    for (c = 0; c < n; c += CHUNK) {
+        len = min(CHUNK, n - c);
+        x = gather(g->x, c, len, buf);
+        // Missing rows of the last group are replaced with the last row
+        for (i = begin; i < end; i += 4) {
+            dot4(
+                a[i] + c, a[min(i + 1, last)] + c, a[min(i + 2, last)] + c,
+                a[min(i + 3, last)] + c, x, len, dots
+            );
+            for (r = 0; r < 4 && i + r < end; r++)
+                *vector_elem(g->y, i + r) += g->alpha * dots[r];
+        }
+    }
+}
+
+void mat47_gemv(
+    mat47_t *y, double alpha, const mat47_t *a, const mat47_t *x, double beta
+) {
+    stats(GEMV);
+
+    if (check_product(y, a, x)) return;
+    if (check_vector(x, a->n_cols) || check_vector(y, a->n_rows)) return;
+
+    bump_version(y);
+    mat47__parallel_for(
+        a->n_rows, PARALLEL_GRAIN / a->n_cols + 1, gemv_range,
+        &(struct gemv_args){y, alpha, a, x, beta}
+    );
+}
+
+
+// `acc += x0 * a0 + x1 * a1 + x2 * a2 + x3 * a3`; `acc` is loaded once for all four.
+static void axpy4(
+    double *restrict acc, const double *restrict a0, const double *restrict a1,
+    const double *restrict a2, const double *restrict a3, const double *x,
+    unsigned int n
+) {
+    vec x0 = {0}, x1 = {0}, x2 = {0}, x3 = {0};
+    unsigned int j = 0;
+
+    x0 += x[0]; x1 += x[1]; x2 += x[2]; x3 += x[3];  // Broadcast
+    for (; j + W <= n; j += W)
+        store(
+            acc + j,
+            load(acc + j) + x0 * load(a0 + j) + x1 * load(a1 + j)
+            + x2 * load(a2 + j) + x3 * load(a3 + j)
+        );
+    for (; j < n; j++)
+        acc[j] += x[0] * a0[j] + x[1] * a1[j] + x[2] * a2[j] + x[3] * a3[j];
+}
+
+static void gemv_t_range(void *args, size_t begin, size_t end)
+{
+    struct gemv_args *g = args;
+    double **a = g->a->data, acc[CHUNK], xs[4], *e;
+    unsigned int i, j, k, len, m = g->a->n_rows;
+
+    for (; begin < end; begin += len) {
+        len = min(CHUNK, end - begin);
+        memset(acc, 0, sizeof(double) * len);
+        for (i = 0; i + 4 <= m; i += 4) {
+            for (k = 0; k < 4; k++) xs[k] = *vector_elem(g->x, i + k);
+            axpy4(
+                acc, a[i] + begin, a[i + 1] + begin, a[i + 2] + begin, a[i + 3] + begin,
+                xs, len
+            );
+        }
+        // Remaining rows, one at a time
+        for (; i < m; i++)
+            for (xs[0] = *vector_elem(g->x, i), j = 0; j < len; j++)
+                acc[j] += xs[0] * a[i][begin + j];
+
+        for (j = 0; j < len; j++) {
+            e = vector_elem(g->y, begin + j);
+            *e = g->alpha * acc[j] + (g->beta == 0 ? 0 : g->beta * *e);
+        }
+    }
+}
+
+void mat47_gemv_t(
+    mat47_t *y, double alpha, const mat47_t *a, const mat47_t *x, double beta
+) {
+    stats(GEMV_T);
+
+    if (check_product(y, a, x)) return;
+    if (check_vector(x, a->n_rows) || check_vector(y, a->n_cols)) return;
+
+    bump_version(y);
+    mat47__parallel_for(
+        a->n_cols, PARALLEL_GRAIN / a->n_rows + 1, gemv_t_range,
+        &(struct gemv_args){y, alpha, a, x, beta}
+    );
+}
+
+
+/* Matrix multiplication kernel: `c = alpha * x * transpose(a) + beta * c`.
+ *
+ * Every row of `x` is multiplied by every row of `a` (i.e both operands are traversed
+ * in memory order), in tiles of four rows of `x` by two rows of `a`, such that every
+ * load of `a` is reused four times and every load of `x` twice. The columns are
+ * processed in chunks of `GEMM_DEPTH`, going through all rows of `x` for every pair
+ * of rows of `a`, such that the pair stays in the L1 cache and `a` is read from memory
+ * only once.
+ */
+
+struct gemm_args {
+    struct mat47__view c, x, a;
+    unsigned int n_x, depth;
+    double alpha, beta;
+};
+
+// Computes the 4 x 2 dot products of `x0..x3` with `a0` and `a1`
+static void dot4x2(
+    const double *restrict x0, const double *restrict x1, const double *restrict x2,
+    const double *restrict x3, const double *restrict a0, const double *restrict a1,
+    unsigned int n, double dots[4][2]
+) {
+    vec s00 = {0}, s01 = {0}, s10 = {0}, s11 = {0};
+    vec s20 = {0}, s21 = {0}, s30 = {0}, s31 = {0}, av0, av1, xv;
+    unsigned int j = 0;
+
+    for (; j + W <= n; j += W) {
+        av0 = load(a0 + j);
+        av1 = load(a1 + j);
+        xv = load(x0 + j); s00 += xv * av0; s01 += xv * av1;
+        xv = load(x1 + j); s10 += xv * av0; s11 += xv * av1;
+        xv = load(x2 + j); s20 += xv * av0; s21 += xv * av1;
+        xv = load(x3 + j); s30 += xv * av0; s31 += xv * av1;
+    }
+    dots[0][0] = hsum(s00); dots[0][1] = hsum(s01);
+    dots[1][0] = hsum(s10); dots[1][1] = hsum(s11);
+    dots[2][0] = hsum(s20); dots[2][1] = hsum(s21);
+    dots[3][0] = hsum(s30); dots[3][1] = hsum(s31);
+    for (; j < n; j++) {
+        dots[0][0] += x0[j] * a0[j]; dots[0][1] += x0[j] * a1[j];
+        dots[1][0] += x1[j] * a0[j]; dots[1][1] += x1[j] * a1[j];
+        dots[2][0] += x2[j] * a0[j]; dots[2][1] += x2[j] * a1[j];
+        dots[3][0] += x3[j] * a0[j]; dots[3][1] += x3[j] * a1[j];
+    }
+}
+
+// Over a range of rows of `a` (i.e columns of `c`)
+static void gemm_nt_range(void *args, size_t begin, size_t end)
+{
+    struct gemm_args *g = args;
+    unsigned int d, len, b, q, n = g->depth, n_x = g->n_x, last_b = n_x - 1;
+    size_t i, r, last = end - 1;
+    double dots[4][2], *c_b;
+
+    if (g->beta != 1)
+        for (b = 0; b < n_x; b++)
+            for (c_b = row(g->c, b), i = begin; i < end; i++)
+                c_b[i] = g->beta == 0 ? 0 : g->beta * c_b[i];
+
+    for (d = 0; d < n; d += GEMM_DEPTH) {
+        len = min(GEMM_DEPTH, n - d);
+        // Missing rows of the last groups are replaced with the last rows
+        for (i = begin; i < end; i += 2)
+            for (b = 0; b < n_x; b += 4) {
+                dot4x2(
+                    row(g->x, b) + d, row(g->x, min(b + 1, last_b)) + d,
+                    row(g->x, min(b + 2, last_b)) + d,
+                    row(g->x, min(b + 3, last_b)) + d, row(g->a, i) + d,
+                    row(g->a, min(i + 1, last)) + d, len, dots
+                );
+                for (q = 0; q < 4 && b + q < n_x; q++)
+                    for (c_b = row(g->c, b + q), r = 0; r < 2 && i + r < end; r++)
+                        c_b[i + r] += g->alpha * dots[q][r];
+            }
+    }
+}
+
+void mat47__gemm_nt(
+    struct mat47__view c, struct mat47__view a, struct mat47__view b, unsigned int m,
+    unsigned int k, unsigned int n, double alpha
+) {
+    mat47__parallel_for(
+        n, PARALLEL_GRAIN / ((size_t)k * m) + 1, gemm_nt_range,
+        &(struct gemm_args){c, a, b, m, k, alpha, 1}
+    );
+}
+
+
+void mat47_gemv_batch(
+    mat47_t *y, double alpha, const mat47_t *a, const mat47_t *x, double beta
+) {
+    stats(GEMV_BATCH);
+
+    if (check_product(y, a, x)) return;
+    if (
+        check_eq(x->n_cols, a->n_cols)
+        || check_eq(y->n_rows, x->n_rows)
+        || check_eq(y->n_cols, a->n_rows)
+    ) return;
+
+    bump_version(y);
+    if (x->n_rows < MAT47_GEMV_BATCH_GEMM) {
+        for (unsigned int k = 0; k < x->n_rows; k++) {
+            // Views of the k-th rows
+            mat47_t x_k = {.n_rows = 1, .n_cols = x->n_cols, .data = &x->data[k]};
+            mat47_t y_k = {.n_rows = 1, .n_cols = y->n_cols, .data = &y->data[k]};
+
+            mat47__parallel_for(
+                a->n_rows, PARALLEL_GRAIN / a->n_cols + 1, gemv_range,
+                &(struct gemv_args){&y_k, alpha, a, &x_k, beta}
+            );
+        }
+        return;
+    }
+
+    debug("Using matrix multiplication for %u vectors", x->n_rows);
+    mat47__parallel_for(
+        a->n_rows, PARALLEL_GRAIN / ((size_t)a->n_cols * x->n_rows) + 1,
+        gemm_nt_range,
+        &(struct gemm_args){
+            {y->data, 0}, {x->data, 0}, {a->data, 0}, x->n_rows, a->n_cols, alpha, beta
+        }
+    );
+}
+
+
+/* Matrix multiplication.
+ *
+ * Operands are accessed through views (row pointers and a column offset), such that
+ * quadrants of matrices, and temporaries in a workspace, are multiplied without
+ * copying.
+ */
+
+static atomic_uint strassen_crossover;
+
+
+unsigned int mat47_get_strassen_crossover(void)
+{
+    unsigned int n = atomic_load_explicit(&strassen_crossover, memory_order_relaxed);
+
+    return n ? n : MAT47_STRASSEN_DEFAULT_CROSSOVER;
+}
+
+
+void mat47_set_strassen_crossover(unsigned int n)
+{
+    atomic_store_explicit(&strassen_crossover, n, memory_order_relaxed);
+}
+
+
+/* Classical multiplication kernel: `c = a * b` or `c += a * b`.
+ *
+ * Scaled rows of `b` are added into rows of `c`, four at a time and for two rows of
+ * `c` at once, such that every load of `b` is reused twice and every load and store
+ * of `c` four times. `b` is processed in panels of `MUL_DEPTH x MUL_WIDTH`, which stay
+ * in the L2 cache while all the rows of `c` go through them.
+ */
+
+#define MUL_DEPTH 128
+#define MUL_WIDTH 512
+
+struct mul_args {
+    view c, a, b;
+    unsigned int k, n;
+    double alpha;
+    bool accumulate;
+};
+
+// `c0 += a0[0..3] * b0..b3` and `c1 += a1[0..3] * b0..b3`
+static void axpy4x2(
+    double *restrict c0, double *restrict c1, const double *restrict b0,
+    const double *restrict b1, const double *restrict b2, const double *restrict b3,
+    const double *a0, const double *a1, unsigned int n
+) {
+    vec x00 = {0}, x01 = {0}, x02 = {0}, x03 = {0};
+    vec x10 = {0}, x11 = {0}, x12 = {0}, x13 = {0}, v0, v1, v2, v3;
+    unsigned int j = 0;
+
+    x00 += a0[0]; x01 += a0[1]; x02 += a0[2]; x03 += a0[3];  // Broadcast
+    x10 += a1[0]; x11 += a1[1]; x12 += a1[2]; x13 += a1[3];
+    for (; j + W <= n; j += W) {
+        v0 = load(b0 + j); v1 = load(b1 + j); v2 = load(b2 + j); v3 = load(b3 + j);
+        store(c0 + j, load(c0 + j) + x00 * v0 + x01 * v1 + x02 * v2 + x03 * v3);
+        store(c1 + j, load(c1 + j) + x10 * v0 + x11 * v1 + x12 * v2 + x13 * v3);
+    }
+    for (; j < n; j++) {
+        c0[j] += a0[0] * b0[j] + a0[1] * b1[j] + a0[2] * b2[j] + a0[3] * b3[j];
+        c1[j] += a1[0] * b0[j] + a1[1] * b1[j] + a1[2] * b2[j] + a1[3] * b3[j];
+    }
+}
+
+// Over a range of rows of `c`
+static void mul_range(void *args, size_t begin, size_t end)
+{
+    struct mul_args *g = args;
+    unsigned int j, p, q, r, len, depth, k = g->k, n = g->n;
+    const double *a0, *a1, *b[4];
+    double *c0, *c1, x0[4], x1[4], alpha = g->alpha;
+    size_t i;
+
+    if (!g->accumulate)
+        for (i = begin; i < end; i++) memset(row(g->c, i), 0, sizeof(double) * n);
+
+    for (j = 0; j < n; j += MUL_WIDTH) {
+        len = min(MUL_WIDTH, n - j);
+        for (p = 0; p < k; p += MUL_DEPTH) {
+            depth = min(MUL_DEPTH, k - p);
+            for (i = begin; i < end; i += 2) {
+                c0 = row(g->c, i) + j;
+                a0 = row(g->a, i) + p;
+                c1 = i + 1 < end ? row(g->c, i + 1) + j : NULL;
+                a1 = i + 1 < end ? row(g->a, i + 1) + p : NULL;
+                for (q = 0; q + 4 <= depth; q += 4) {
+                    for (r = 0; r < 4; r++) {
+                        b[r] = row(g->b, p + q + r) + j;
+                        x0[r] = alpha * a0[q + r];
+                        if (c1) x1[r] = alpha * a1[q + r];
+                    }
+                    if (c1)
+                        axpy4x2(c0, c1, b[0], b[1], b[2], b[3], x0, x1, len);
+                    else
+                        axpy4(c0, b[0], b[1], b[2], b[3], x0, len);
+                }
+                // Remaining rows of the panel, one at a time
+                for (; q < depth; q++) {
+                    mat47__axpy(c0, alpha * a0[q], row(g->b, p + q) + j, len);
+                    if (c1) mat47__axpy(c1, alpha * a1[q], row(g->b, p + q) + j, len);
+                }
+            }
+        }
+    }
+}
+
+void mat47__gemm(
+    view c, view a, view b, unsigned int m, unsigned int k, unsigned int n,
+    double alpha, bool accumulate
+) {
+    mat47__parallel_for(
+        m, PARALLEL_GRAIN / ((size_t)k * n + 1) + 1, mul_range,
+        &(struct mul_args){c, a, b, k, n, alpha, accumulate}
+    );
+}
+
+// `c = a * b` or, if `accumulate`, `c += a * b`, where `a` is `m x k`
+static void mul(
+    view c, view a, view b, unsigned int m, unsigned int k, unsigned int n,
+    bool accumulate
+) {
+    mat47__gemm(c, a, b, m, k, n, 1, accumulate);
+}
+
+
+/* Strassen-Winograd multiplication.
+ *
+ * The Winograd variant (seven products and fifteen additions of quadrants), with the
+ * schedule of Douglas et al. (1994), which needs only two temporaries per level, `X`
+ * (`m/2 x max(k/2, n/2)`) and `Y` (`k/2 x n/2`), the quadrants of `c` holding the
+ * others. Odd dimensions are handled by peeling off the last row or column, and
+ * adding its contribution with the classical kernel. Recursion stops once any
+ * dimension is at most the crossover.
+ */
+
+struct workspace {
+    double *elems;
+    double **rows;
+};
+
+// `dst = x + sign * y`, over a range of rows
+struct add_args {
+    view dst, x, y;
+    double sign;
+    unsigned int n;
+};
+
+static void add_range(void *args, size_t begin, size_t end)
+{
+    struct add_args *g = args;
+    double *d, sign = g->sign;
+    const double *x, *y;
+
+    for (size_t i = begin; i < end; i++) {
+        d = row(g->dst, i); x = row(g->x, i); y = row(g->y, i);
+        for (unsigned int j = 0; j < g->n; j++) d[j] = x[j] + sign * y[j];
+    }
+}
+
+static void add(
+    view dst, view x, view y, double sign, unsigned int m,
+    unsigned int n
+) {
+    mat47__parallel_for(
+        m, PARALLEL_GRAIN / n + 1, add_range, &(struct add_args){dst, x, y, sign, n}
+    );
+}
+
+// Number of elements and row pointers of the workspace needed to multiply `m x k`
+// and `k x n` matrices
+static void workspace_size(
+    unsigned int m, unsigned int k, unsigned int n, unsigned int crossover,
+    size_t *n_elems, size_t *n_rows
+) {
+    *n_elems = *n_rows = 0;
+    for (; m > crossover && k > crossover && n > crossover; m /= 2, k /= 2, n /= 2) {
+        *n_elems += (size_t)(m / 2) * max(k / 2, n / 2) + (size_t)(k / 2) * (n / 2);
+        *n_rows += m / 2 + k / 2;
+    }
+}
+
+// Views of `n_rows` rows of `n_cols` elements, taken from `ws`
+static view take(struct workspace *ws, unsigned int n_rows, unsigned int n_cols)
+{
+    view v = {ws->rows, 0};
+
+    for (unsigned int i = 0; i < n_rows; i++, ws->elems += n_cols)
+        ws->rows[i] = ws->elems;
+    ws->rows += n_rows;
+
+    return v;
+}
+
+static void strassen(
+    view c, view a, view b, unsigned int m, unsigned int k,
+    unsigned int n, unsigned int crossover, struct workspace ws
+) {
+    unsigned int m2 = m / 2, k2 = k / 2, n2 = n / 2;
+    view x, y;
+
+    if (m <= crossover || k <= crossover || n <= crossover) {
+        mul(c, a, b, m, k, n, false);
+        return;
+    }
+
+    view
+        a11 = a, a12 = sub(a, 0, k2), a21 = sub(a, m2, 0), a22 = sub(a, m2, k2),
+        b11 = b, b12 = sub(b, 0, n2), b21 = sub(b, k2, 0), b22 = sub(b, k2, n2),
+        c11 = c, c12 = sub(c, 0, n2), c21 = sub(c, m2, 0), c22 = sub(c, m2, n2);
+
+    x = take(&ws, m2, max(k2, n2));
+    y = take(&ws, k2, n2);
+
+    add(x, a11, a21, -1, m2, k2);                           // S3 = A11 - A21
+    add(y, b22, b12, -1, k2, n2);                           // T3 = B22 - B12
+    strassen(c21, x, y, m2, k2, n2, crossover, ws);         // P7 = S3 * T3
+    add(x, a21, a22, 1, m2, k2);                            // S1 = A21 + A22
+    add(y, b12, b11, -1, k2, n2);                           // T1 = B12 - B11
+    strassen(c22, x, y, m2, k2, n2, crossover, ws);         // P5 = S1 * T1
+    add(x, x, a11, -1, m2, k2);                             // S2 = S1 - A11
+    add(y, b22, y, -1, k2, n2);                             // T2 = B22 - T1
+    strassen(c12, x, y, m2, k2, n2, crossover, ws);         // P6 = S2 * T2
+    add(x, a12, x, -1, m2, k2);                             // S4 = A12 - S2
+    strassen(c11, x, b22, m2, k2, n2, crossover, ws);       // P3 = S4 * B22
+    strassen(x, a11, b11, m2, k2, n2, crossover, ws);       // P1 = A11 * B11
+    add(c12, x, c12, 1, m2, n2);                            // U2 = P1 + P6
+    add(c21, c12, c21, 1, m2, n2);                          // U3 = U2 + P7
+    add(c12, c12, c22, 1, m2, n2);                          // U4 = U2 + P5
+    add(c22, c21, c22, 1, m2, n2);                          // C22 = U3 + P5
+    add(c12, c12, c11, 1, m2, n2);                          // C12 = U4 + P3
+    add(y, y, b21, -1, k2, n2);                             // T4 = T2 - B21
+    strassen(c11, a22, y, m2, k2, n2, crossover, ws);       // P4 = A22 * T4
+    add(c21, c21, c11, -1, m2, n2);                         // C21 = U3 - P4
+    strassen(c11, a12, b21, m2, k2, n2, crossover, ws);     // P2 = A12 * B21
+    add(c11, x, c11, 1, m2, n2);                            // C11 = P1 + P2
+
+    // Peeled last column of `a` (and row of `b`), column of `c`, and row of `c`
+    if (k % 2) mul(c, sub(a, 0, k - 1), sub(b, k - 1, 0), 2 * m2, 1, 2 * n2, true);
+    if (n % 2) mul(sub(c, 0, n - 1), a, sub(b, 0, n - 1), 2 * m2, k, 1, false);
+    if (m % 2) mul(sub(c, m - 1, 0), sub(a, m - 1, 0), b, 1, k, n, false);
+}
+
+
+size_t mat47__mul_square_size(unsigned int n, unsigned int crossover)
+{
+    size_t n_elems, n_rows;
+
+    workspace_size(n, n, n, crossover, &n_elems, &n_rows);
+
+    return sizeof(double) * n_elems + sizeof(double *) * n_rows;
+}
+
+void mat47__mul_square(
+    mat47_t *c, const mat47_t *a, const mat47_t *b, unsigned int crossover, void *buf
+) {
+    unsigned int n = a->n_rows;
+    view cv = {c->data, 0}, av = {a->data, 0}, bv = {b->data, 0};
+    size_t n_elems, n_rows;
+
+    if (n <= crossover) {
+        mul(cv, av, bv, n, n, n, false);
+        return;
+    }
+
+    // Row pointers first, as they're at least as aligned as elements
+    workspace_size(n, n, n, crossover, &n_elems, &n_rows);
+    strassen(
+        cv, av, bv, n, n, n, crossover,
+        (struct workspace){(double *)((double **)buf + n_rows), buf}
+    );
+}
+
+/* `c = a * b`, with Strassen-Winograd multiplication if enabled and worthwhile; Its
+ * workspace is taken from `ws` or, if null, allocated for this product only.
+ */
+static void
+mat_mul(mat47_t *c, const mat47_t *a, const mat47_t *b, mat47_workspace_t *ws)
+{
+    unsigned int m = a->n_rows, k = a->n_cols, n = b->n_cols;
+    unsigned int crossover = mat47_get_strassen_crossover();
+    size_t size = 0;
+    void *buf;
+
+    if (!(m == k && k == n && n > crossover)) {
+        mul((view){c->data, 0}, (view){a->data, 0}, (view){b->data, 0}, m, k, n, false);
+        return;
+    }
+
+    if (ws) buf = mat47__workspace_mul(ws, crossover);
+    else if ((buf = malloc(size = mat47__mul_square_size(n, crossover))))
+        stats_alloc(1, size);
+    if (!buf) {
+        debug("Failed to allocate the workspace; Falling back to classical");
+        crossover = MAT47_STRASSEN_OFF;
+    }
+    mat47__mul_square(c, a, b, crossover, buf);
+
+    if (!ws && buf) {
+        stats_free(size);
+        free(buf);
+    }
+}
+
+static bool check_mul(const mat47_t *a, const mat47_t *b)
+{
+    return check_ptr(a) || check_ptr(b) || check_eq(a->n_cols, b->n_rows);
+}
+
+
+mat47_t *mat47_mul(const mat47_t *a, const mat47_t *b)
+{
+    stats(MUL);
+    mat47_t *c;
+
+    if (check_mul(a, b)) return NULL;
+    if (!(c = mat47__new(a->n_rows, b->n_cols, false))) return NULL;
+    mat_mul(c, a, b, NULL);
+
+    return c;
+}
+
+
+void mat47_mul_into(
+    mat47_t *c, const mat47_t *a, const mat47_t *b, mat47_workspace_t *ws
+) {
+    stats(MUL_INTO);
+
+    if (check_ptr(c) || check_mul(a, b)) return;
+    if (
+        check(
+            c != a && c != b, MAT47_ERR_INVALID_ARG,
+            ": c @ %p is also an operand", (void *)c
+        )
+        || check_eq(c->n_rows, a->n_rows) || check_eq(c->n_cols, b->n_cols)
+    ) return;
+    // Rectangular products never need the workspace, hence ignore it
+    if (
+        ws && a->n_rows == a->n_cols && b->n_cols == a->n_cols
+        && check_eq(mat47__workspace_n(ws), a->n_rows)
+    ) return;
+
+    bump_version(c);
+    mat_mul(c, a, b, ws);
+}
@@ -0,0 +1,214 @@
+/* Matrix-vector and matrix-matrix products
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_BLAS_H
+#define MAT47_BLAS_H
+
+#include <limits.h>
+
+#include "linalg.h"
+#include "matrix.h"
+
+/**
+ * Minimum number of vectors from which :c:func:`mat47_gemv_batch` uses the
+ * matrix-multiply path instead of one matrix-vector product per vector
+ */
+#define MAT47_GEMV_BATCH_GEMM 4
+
+/**
+ * Computes a matrix-vector product, ``y = alpha * a * x + beta * y``, in place.
+ *
+ * Args:
+ *     y: A vector of ``a->n_rows`` elements, either a column vector
+ *       (``n x 1`` matrix) or a row vector (``1 x n`` matrix)
+ *     alpha: The scale factor of the product
+ *     a: The matrix
+ *     x: A vector of ``a->n_cols`` elements, either a column or a row vector
+ *     beta: The scale factor of *y*; If zero, the initial values of *y* are ignored
+ *       (i.e NaNs and infinities in it are not propagated).
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the matrices is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *x* or *y* is not a
+ *       vector of the required number of elements
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *y* is the same matrix
+ *       as *a* or *x*
+ *
+ * Four rows of *a* are processed per pass, such that every (SIMD) load of *x* is
+ * reused four times, in chunks of columns such that the part of *x* in use stays in
+ * the L1 cache. Large matrices are processed in parallel, by blocks of rows.
+ *
+ * Doesn't allocate memory; Row vectors are slightly faster, being contiguous. *y*
+ * must not share storage with *a* or *x*. If any error occurs, *y* is left unchanged.
+ */
+void mat47_gemv(
+    mat47_t *y, double alpha, const mat47_t *a, const mat47_t *x, double beta
+);
+
+/**
+ * Computes multiple matrix-vector products with the same matrix,
+ * ``y[k] = alpha * a * x[k] + beta * y[k]`` for every row *k*, in place.
+ *
+ * Args:
+ *     y: The results, one per row (``n_vecs x a->n_rows`` matrix)
+ *     alpha: The scale factor of the products
+ *     a: The matrix
+ *     x: The vectors, one per row (``n_vecs x a->n_cols`` matrix)
+ *     beta: The scale factor of *y*; If zero, the initial values of *y* are ignored.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the matrices is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *x* doesn't have as
+ *       many columns as *a*, or *y* doesn't have as many rows as *x* and columns as
+ *       *a* has rows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *y* is the same matrix
+ *       as *a* or *x*
+ *
+ * i.e ``y = alpha * x * transpose(a) + beta * y``. With fewer than
+ * :c:macro:`MAT47_GEMV_BATCH_GEMM` vectors, this is the same as calling
+ * :c:func:`mat47_gemv` for every vector. Otherwise, a matrix-multiply kernel is used,
+ * which computes the products with two rows of *a* and four vectors at a time, over
+ * blocks of *a* that stay in cache while all the vectors go through them; Hence, *a*
+ * is read from memory only once instead of once per vector.
+ *
+ * Doesn't allocate memory. *y* must not share storage with *a* or *x*. If any error
+ * occurs, *y* is left unchanged.
+ */
+void mat47_gemv_batch(
+    mat47_t *y, double alpha, const mat47_t *a, const mat47_t *x, double beta
+);
+
+/**
+ * Computes a transposed matrix-vector product, ``y = alpha * transpose(a) * x +
+ * beta * y``, in place.
+ *
+ * Args:
+ *     y: A vector of ``a->n_cols`` elements, either a column or a row vector
+ *     alpha: The scale factor of the product
+ *     a: The matrix
+ *     x: A vector of ``a->n_rows`` elements, either a column or a row vector
+ *     beta: The scale factor of *y*; If zero, the initial values of *y* are ignored.
+ *
+ * ERRORS:
+ *     Same as :c:func:`mat47_gemv`.
+ *
+ * *a* is traversed row by row (i.e in memory order), with four scaled rows added per
+ * pass into a chunk of accumulators, such that every load and store of the
+ * accumulators is reused four times. Large matrices are processed in parallel, by
+ * blocks of columns.
+ *
+ * Doesn't allocate memory. *y* must not share storage with *a* or *x*. If any error
+ * occurs, *y* is left unchanged.
+ */
+void mat47_gemv_t(
+    mat47_t *y, double alpha, const mat47_t *a, const mat47_t *x, double beta
+);
+
+/**
+ * The default Strassen-Winograd crossover: Square products of matrices with more
+ * rows are computed with Strassen-Winograd multiplication, by
+ * :c:func:`mat47_mul` and :c:func:`mat47_mul_into`.
+ *
+ * Chosen with the ``mul_x*`` benchmarks, which run each product size with candidate
+ * crossovers on both sides: ``256`` was the fastest for ``1024 x 1024`` and
+ * ``4096 x 4096`` products, whereas one level of recursion made ``256 x 256``
+ * products slower than the classical algorithm.
+ */
+#define MAT47_STRASSEN_DEFAULT_CROSSOVER 256
+
+/**
+ * Disables Strassen-Winograd multiplication, when set as the crossover (see
+ * :c:func:`mat47_set_strassen_crossover`)
+ */
+#define MAT47_STRASSEN_OFF UINT_MAX
+
+/**
+ * Returns the Strassen-Winograd crossover.
+ *
+ * Returns:
+ *     The value last set with :c:func:`mat47_set_strassen_crossover` or, if unset,
+ *     :c:macro:`MAT47_STRASSEN_DEFAULT_CROSSOVER`.
+ */
+unsigned int mat47_get_strassen_crossover(void);
+
+/**
+ * Sets the Strassen-Winograd crossover.
+ *
+ * Args:
+ *     n: Size (number of rows) of square operands above which Strassen-Winograd
+ *       multiplication is used, and at which its recursion stops;
+ *       :c:macro:`MAT47_STRASSEN_OFF` disables it and ``0`` restores the default.
+ *
+ * Strassen-Winograd multiplication does about ``(7/8)^L`` of the floating-point
+ * operations of the classical algorithm, for ``L`` levels of recursion (e.g about
+ * half, for an ``8192 x 8192`` product with the default crossover), but rounds
+ * differently, with a larger (normwise) error bound, growing with the number of
+ * levels. Disable it if results must be bit-identical to those of the classical
+ * algorithm (e.g across sizes).
+ *
+ * The setting applies to products computed afterwards, by any thread.
+ */
+void mat47_set_strassen_crossover(unsigned int n);
+
+/**
+ * Multiplies two matrices.
+ *
+ * Args:
+ *     a: The left operand
+ *     b: The right operand
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix equal to ``a * b``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Either operand is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* doesn't have as
+ *       many columns as *b* has rows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Scaled rows of *b* are added into two rows of the product at a time, over panels
+ * of *b* that stay in the L2 cache while all the rows of the product go through them.
+ * Large products are computed in parallel, by blocks of rows.
+ *
+ * Square products of matrices with more rows than the Strassen-Winograd crossover
+ * (see :c:func:`mat47_set_strassen_crossover`) are computed by Strassen-Winograd
+ * recursion down to the crossover, with the above as the base case. Its temporaries
+ * are taken from a workspace allocated once per product, about two thirds the size
+ * of an operand; If it can't be allocated, the classical algorithm is used instead.
+ */
+mat47_t *mat47_mul(const mat47_t *a, const mat47_t *b);
+
+/**
+ * Multiplies two matrices, into an existing matrix.
+ *
+ * Args:
+ *     c: The product, with as many rows as *a* and columns as *b*
+ *     a: The left operand
+ *     b: The right operand
+ *     ws: A workspace for square matrices the size of *a* and *b*, or null;
+ *       Ignored if either operand isn't square.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the matrices is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* doesn't have as
+ *       many columns as *b* has rows, *c* has the wrong dimensions, or *ws* is given
+ *       for a different size than that of square operands
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *c* is the same matrix
+ *       as *a* or *b*
+ *
+ * Same as :c:func:`mat47_mul`. The Strassen-Winograd workspace is kept in *ws* (see
+ * :c:func:`mat47_workspace_new`), such that repeated products of the same size
+ * allocate nothing once it's allocated, shared with :c:func:`mat47_pow_into` and
+ * :c:func:`mat47_expm_into`; If *ws* is null, it's allocated (and deallocated) by
+ * every product that needs it. *c* must not share storage with *a* or *b*. If any
+ * error occurs, *c* is left unchanged.
+ */
+void mat47_mul_into(
+    mat47_t *c, const mat47_t *a, const mat47_t *b, mat47_workspace_t *ws
+);
+
+#endif  // MAT47_BLAS_H
@@ -0,0 +1,181 @@
+/* Broadcast operations
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "broadcast.h"
+#include "error.h"
+#include "matrix.h"
+#include "reduce.h"
+#include "utils.h"
+
+struct bcast_args {
+    double **x;
+    unsigned int n_cols;
+    enum mat47_bcast_op op;
+    const double *row;  // Of the row vector, if a row broadcast
+    double **col;  // Of the column vector, if a column broadcast
+};
+
+/* Applies `op` between `x` and `v` (or `v[0]`, if `stride` is 0), element-wise;
+ * `v` must not overlap `x`.
+ *
+ * Every case is a separate loop, vectorized by the compiler.
+ */
+static inline void apply(
+    double *restrict x, enum mat47_bcast_op op, const double *restrict v,
+    size_t stride, unsigned int n
+) {
+    unsigned int j;
+
+    switch (op) {
+    case MAT47_BCAST_ADD: for (j = 0; j < n; j++) x[j] += v[j * stride]; break;
+    case MAT47_BCAST_SUB: for (j = 0; j < n; j++) x[j] -= v[j * stride]; break;
+    case MAT47_BCAST_MUL: for (j = 0; j < n; j++) x[j] *= v[j * stride]; break;
+    case MAT47_BCAST_DIV: for (j = 0; j < n; j++) x[j] /= v[j * stride]; break;
+    }
+}
+
+static void bcast_range(void *args, size_t begin, size_t end)
+{
+    struct bcast_args *a = args;
+    double v;
+
+    // An element of the column vector is read before its row is written, which it
+    // may be part of (e.g if `m` is the column vector)
+    for (; begin < end; begin++)
+        if (a->row) {
+            apply(a->x[begin], a->op, a->row, 1, a->n_cols);
+        } else {
+            v = a->col[begin][0];
+            apply(a->x[begin], a->op, &v, 0, a->n_cols);
+        }
+}
+
+static bool check_op(enum mat47_bcast_op op)
+{
+    return check(
+        op >= MAT47_BCAST_ADD && op <= MAT47_BCAST_DIV, MAT47_ERR_INVALID_ARG,
+        ": op=%d", op
+    );
+}
+
+static void bcast(mat47_t *m, enum mat47_bcast_op op, const double *row, double **col)
+{
+    bump_version(m);
+    mat47__parallel_for(
+        m->n_rows, PARALLEL_GRAIN / m->n_cols + 1, bcast_range,
+        &(struct bcast_args){m->data, m->n_cols, op, row, col}
+    );
+}
+
+
+// Whether the `m->n_cols` elements at `v` overlap any row of `m`
+static bool overlaps(const mat47_t *m, const double *v)
+{
+    size_t size = sizeof(double) * m->n_cols;
+    uintptr_t begin = (uintptr_t)v, end = begin + size, r;
+
+    for (unsigned int i = 0; i < m->n_rows; i++) {
+        r = (uintptr_t)m->data[i];
+        if (r < end && begin < r + size) return true;
+    }
+
+    return false;
+}
+
+void mat47_bcast_row(mat47_t *m, enum mat47_bcast_op op, const mat47_t *row)
+{
+    stats(BCAST_ROW);
+    double *copy = NULL;
+
+    if (check_ptr(m) || check_ptr(row) || check_op(op)) return;
+    if (check_eq(row->n_rows, 1) || check_eq(row->n_cols, m->n_cols)) return;
+
+    // e.g `mat47_bcast_row(m, op, m)`, for a single-row `m`
+    if (overlaps(m, row->data[0])) {
+        if (!(copy = malloc(sizeof(double) * m->n_cols))) {
+            mat47_errno = MAT47_ERR_ALLOC;
+            error(" for a copy of the row vector");
+            return;
+        }
+        memcpy(copy, row->data[0], sizeof(double) * m->n_cols);
+    }
+    bcast(m, op, copy ? copy : row->data[0], NULL);
+    free(copy);
+}
+
+
+void mat47_bcast_col(mat47_t *m, enum mat47_bcast_op op, const mat47_t *col)
+{
+    stats(BCAST_COL);
+
+    if (check_ptr(m) || check_ptr(col) || check_op(op)) return;
+    if (check_eq(col->n_rows, m->n_rows) || check_eq(col->n_cols, 1)) return;
+
+    bcast(m, op, NULL, col->data);
+}
+
+
+struct standardize_args {
+    double **x;
+    unsigned int n_cols;
+    const double *means;
+    const double *scales;  // Reciprocals of the standard deviations
+};
+
+static void standardize_range(void *args, size_t begin, size_t end)
+{
+    struct standardize_args *a = args;
+    const double *restrict means = a->means, *restrict scales = a->scales;
+    double *restrict row;
+    unsigned int j;
+
+    for (; begin < end; begin++)
+        for (row = a->x[begin], j = 0; j < a->n_cols; j++)
+            row[j] = (row[j] - means[j]) * scales[j];
+}
+
+void mat47_standardize(mat47_t *m, unsigned int ddof, mat47_t **means, mat47_t **stds)
+{
+    stats(STANDARDIZE);
+    mat47_t *mean, *std;
+    double *restrict s;
+
+    if (means) *means = NULL;
+    if (stds) *stds = NULL;
+    if (check_ptr(m)) return;
+    if (!(std = mat47_col_var(m, ddof, &mean))) return;
+
+    // Variances -> standard deviations, then scale factors
+    s = std->data[0];
+    for (unsigned int j = 0; j < m->n_cols; j++) s[j] = sqrt(s[j]);
+    if (stds) {
+        if (!(*stds = mat47_copy(std))) {
+            mat47_del(mean);
+            mat47_del(std);
+            return;
+        }
+    }
+    for (unsigned int j = 0; j < m->n_cols; j++) s[j] = (s[j] == 0 ? 1 : 1 / s[j]);
+
+    bump_version(m);
+    mat47__parallel_for(
+        m->n_rows, PARALLEL_GRAIN / m->n_cols + 1, standardize_range,
+        &(struct standardize_args){m->data, m->n_cols, mean->data[0], s}
+    );
+
+    mat47_del(std);
+    if (means)
+        *means = mean;
+    else
+        mat47_del(mean);
+}
@@ -0,0 +1,97 @@
+/* Broadcast operations
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_BROADCAST_H
+#define MAT47_BROADCAST_H
+
+#include "matrix.h"
+
+/** Element-wise operations applied by broadcast operations */
+enum mat47_bcast_op {
+    /** ``m[i][j] += v`` */
+    MAT47_BCAST_ADD = 1,
+
+    /** ``m[i][j] -= v`` */
+    MAT47_BCAST_SUB,
+
+    /** ``m[i][j] *= v`` */
+    MAT47_BCAST_MUL,
+
+    /** ``m[i][j] /= v`` */
+    MAT47_BCAST_DIV
+};
+
+/**
+ * Applies an operation between every column of a matrix and a column vector, in
+ * place.
+ *
+ * Args:
+ *     m: The matrix
+ *     op: The operation
+ *     col: A column vector (``n_rows x 1`` matrix); Every element of the *i*-th row
+ *       of *m* is operated on with the *i*-th element of *col*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* or *col* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *col* is not an
+ *       ``n_rows x 1`` matrix
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *op* is invalid
+ *
+ * For example, ``mat47_bcast_col(m, MAT47_BCAST_DIV, sums)`` (where *sums* holds the
+ * row sums of *m*) normalizes every row of *m* to sum up to one. *col* may be *m*
+ * itself.
+ */
+void mat47_bcast_col(mat47_t *m, enum mat47_bcast_op op, const mat47_t *col);
+
+/**
+ * Applies an operation between every row of a matrix and a row vector, in place.
+ *
+ * Args:
+ *     m: The matrix
+ *     op: The operation
+ *     row: A row vector (``1 x n_cols`` matrix); Every element of the *j*-th column
+ *       of *m* is operated on with the *j*-th element of *row*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* or *row* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *row* is not a
+ *       ``1 x n_cols`` matrix
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *op* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * For example, ``mat47_bcast_row(m, MAT47_BCAST_SUB, means)`` (where *means* holds
+ * the column means of *m*) centers every column of *m*. *row* may be *m* itself, or
+ * otherwise share storage with it, in which case it's copied first; That's the only
+ * memory allocated.
+ */
+void mat47_bcast_row(mat47_t *m, enum mat47_bcast_op op, const mat47_t *row);
+
+/**
+ * Centers every column of a matrix on zero and scales it to unit variance, in place.
+ *
+ * Args:
+ *     m: The matrix
+ *     ddof: "Delta degrees of freedom" of the variances (see :c:func:`mat47_col_var`)
+ *     means: If not null, the location to store a new row vector holding the
+ *       original column means in (or ``NULL``, on failure).
+ *     stds: If not null, the location to store a new row vector holding the
+ *       original column standard deviations in (or ``NULL``, on failure).
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *ddof* is not less than
+ *       the number of rows of *m*
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The matrix is traversed only twice: once to compute both the means and the
+ * variances, then once to both center and scale it. Columns with a standard
+ * deviation of zero are only centered.
+ *
+ * If any error occurs, *m* is left unchanged.
+ */
+void mat47_standardize(mat47_t *m, unsigned int ddof, mat47_t **means, mat47_t **stds);
+
+#endif  // MAT47_BROADCAST_H
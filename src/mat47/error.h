@@ -46,7 +46,19 @@ enum mat47_errors {
     MAT47_ERR_INDEX_OUT_OF_RANGE,
 
     /** Raised when certain arguments have mismatching dimensions */
-    MAT47_ERR_DIM_MISMATCH
+    MAT47_ERR_DIM_MISMATCH,
+
+    /** Raised when a matrix is (numerically) singular */
+    MAT47_ERR_SINGULAR,
+
+    /** Raised when an argument has an invalid value not covered by any other error */
+    MAT47_ERR_INVALID_ARG,
+
+    /** Raised when a matrix is not (numerically) positive definite */
+    MAT47_ERR_NOT_POSDEF,
+
+    /** Raised when an iterative method doesn't converge within its iteration limit */
+    MAT47_ERR_NO_CONVERGENCE
 };
 
 /**
@@ -0,0 +1,2667 @@
+/* Linear algebra routines
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blas.h"
+#include "error.h"
+#include "linalg.h"
+#include "matrix.h"
+#include "utils.h"
+
+
+/* LU factorization with partial pivoting, in-place, of a contiguous row-major n x n
+ * array. `piv[k]` is set to the row interchanged with row `k` at step `k`.
+ *
+ * Returns zero on success or, if a zero (or NaN) pivot is encountered, the 1-based
+ * step at which it occurred.
+ */
+#define lu_factor(T) \
+static unsigned int \
+lu_factor_##T(unsigned int n, T *restrict a, unsigned int *restrict piv) \
+{ \
+    unsigned int i, j, k, p; \
+    T *restrict row_k, *restrict row_i, pivot_max, l, tmp; \
+\
+    for (k = 0; k < n; k++) { \
+        pivot_max = fabs(a[(size_t)k * n + k]); \
+        for (p = k, i = k + 1; i < n; i++) \
+            if (fabs(a[(size_t)i * n + k]) > pivot_max) \
+                pivot_max = fabs(a[(size_t)(p = i) * n + k]); \
+\
+        piv[k] = p; \
+        if (!(pivot_max > 0)) return k + 1; \
+\
+        row_k = a + (size_t)k * n; \
+        if (p != k) { \
+            row_i = a + (size_t)p * n; \
+            for (j = 0; j < n; j++) \
+                tmp = row_k[j], row_k[j] = row_i[j], row_i[j] = tmp; \
+        } \
+\
+        for (i = k + 1; i < n; i++) { \
+            row_i = a + (size_t)i * n; \
+            if ((l = row_i[k] /= row_k[k]) == 0) continue; \
+            for (j = k + 1; j < n; j++) row_i[j] -= l * row_k[j]; \
+        } \
+    } \
+\
+    return 0; \
+}
+
+/* Solves `LU x = P b` for `n_rhs` right-hand sides, given the output of
+ * `lu_factor_T()`. `x` is a contiguous row-major n x n_rhs array holding `b` on entry
+ * and the solution on exit.
+ */
+#define lu_solve(T) \
+static void lu_solve_##T( \
+    unsigned int n, unsigned int n_rhs, \
+    const T *restrict lu, const unsigned int *restrict piv, T *restrict x \
+) { \
+    unsigned int i, j, r; \
+    T *restrict x_i, *restrict x_j, l, tmp; \
+\
+    for (i = 0; i < n; i++) \
+        if (piv[i] != i) { \
+            x_i = x + (size_t)i * n_rhs; \
+            x_j = x + (size_t)piv[i] * n_rhs; \
+            for (r = 0; r < n_rhs; r++) \
+                tmp = x_i[r], x_i[r] = x_j[r], x_j[r] = tmp; \
+        } \
+\
+    /* Forward substitution, with the unit lower triangle */ \
+    for (i = 1; i < n; i++) { \
+        x_i = x + (size_t)i * n_rhs; \
+        for (j = 0; j < i; j++) { \
+            if ((l = lu[(size_t)i * n + j]) == 0) continue; \
+            x_j = x + (size_t)j * n_rhs; \
+            for (r = 0; r < n_rhs; r++) x_i[r] -= l * x_j[r]; \
+        } \
+    } \
+\
+    /* Back substitution, with the upper triangle */ \
+    for (i = n; i--;) { \
+        x_i = x + (size_t)i * n_rhs; \
+        for (j = i + 1; j < n; j++) { \
+            if ((l = lu[(size_t)i * n + j]) == 0) continue; \
+            x_j = x + (size_t)j * n_rhs; \
+            for (r = 0; r < n_rhs; r++) x_i[r] -= l * x_j[r]; \
+        } \
+        for (l = lu[(size_t)i * n + i], r = 0; r < n_rhs; r++) x_i[r] /= l; \
+    } \
+}
+
+lu_factor(double)
+lu_solve(float)
+lu_solve(double)
+
+#undef lu_factor
+#undef lu_solve
+
+
+/* Copies the rows of a matrix into a contiguous single-precision array.
+ *
+ * Returns false if any element is out of the range of `float`.
+ */
+static bool demote(const mat47_t *restrict m, float *restrict dst)
+{
+    unsigned int i, j, n_cols = m->n_cols;
+    double *restrict row;
+
+    for (i = 0; i < m->n_rows; i++, dst += n_cols)
+        for (row = m->data[i], j = 0; j < n_cols; j++) {
+            if (fabs(row[j]) > FLT_MAX) return false;
+            dst[j] = row[j];
+        }
+
+    return true;
+}
+
+/* Computes `r = b - a * x`, where `x` and `r` are contiguous row-major arrays */
+static void residual(
+    const mat47_t *a, const mat47_t *b, const double *restrict x, double *restrict r
+) {
+    unsigned int i, j, k, n = a->n_cols, n_rhs = b->n_cols;
+    double *restrict a_row, *restrict r_row, a_ij;
+    const double *restrict x_row;
+
+    for (i = 0; i < a->n_rows; i++) {
+        r_row = r + (size_t)i * n_rhs;
+        memcpy(r_row, b->data[i], sizeof(double) * n_rhs);
+        for (a_row = a->data[i], j = 0; j < n; j++) {
+            if ((a_ij = a_row[j]) == 0) continue;
+            x_row = x + (size_t)j * n_rhs;
+            for (k = 0; k < n_rhs; k++) r_row[k] -= a_ij * x_row[k];
+        }
+    }
+}
+
+/* Checks the stopping criterion of iterative refinement, per column:
+ * `max(|r|) <= max(|x|) * tolerance`.
+ *
+ * `col_max` must point to `2 * n_rhs` elements of scratch space.
+ */
+static bool converged(
+    unsigned int n, unsigned int n_rhs,
+    const double *restrict x, const double *restrict r, double tolerance,
+    double *restrict col_max
+) {
+    unsigned int i, k;
+    double *restrict x_max = col_max, *restrict r_max = col_max + n_rhs;
+
+    memset(col_max, 0, sizeof(double) * 2 * n_rhs);
+    for (i = 0; i < n; i++, x += n_rhs, r += n_rhs)
+        for (k = 0; k < n_rhs; k++) {
+            imax(x_max[k], fabs(x[k]));
+            imax(r_max[k], fabs(r[k]));
+        }
+
+    for (k = 0; k < n_rhs; k++)
+        if (!(r_max[k] <= x_max[k] * tolerance)) return false;
+
+    return true;
+}
+
+
+/* Tiled factorizations.
+ *
+ * The matrix is split into square tiles of `TILE_SIZE` (except the last row and
+ * column of tiles), and every step of a factorization is a task over a few tiles
+ * (e.g factorizing a diagonal tile, or updating a trailing tile with the tiles of a
+ * factorized panel), which runs as soon as the tasks producing those tiles complete
+ * (see `mat47__dag_run()`). Hence, the factorization of a panel overlaps with the
+ * updates of the trailing matrix by the previous ones, instead of idling all but one
+ * thread.
+ */
+
+#define TILE_SIZE 128
+
+// Number of tiles covering `n` rows or columns
+#define n_tiles(n) (((n) + TILE_SIZE - 1) / TILE_SIZE)
+
+// Number of rows or columns in the `t`-th tile covering `n`
+#define tile_dim(n, t) min(TILE_SIZE, (n) - (t) * TILE_SIZE)
+
+typedef struct mat47__view view;
+
+// The `(i, j)`-th tile of `m`
+static inline view tile(const mat47_t *m, unsigned int i, unsigned int j)
+{
+    return (view){m->data + (size_t)i * TILE_SIZE, (size_t)j * TILE_SIZE};
+}
+
+#define row(v, i) mat47__row(v, i)
+
+
+/* Cholesky factorization: Lower triangle, `a = l * transpose(l)` */
+
+struct cholesky {
+    mat47_t *a;
+    unsigned int n;
+    atomic_bool failed;
+};
+
+// Factorizes the diagonal tile `(k, k)`
+static void potrf(void *ctx, unsigned int i, unsigned int j, unsigned int k)
+{
+    struct cholesky *c = ctx;
+    unsigned int n = tile_dim(c->n, k), r;
+    view t = tile(c->a, k, k);
+    double d;
+
+    (void)i; (void)j;
+    if (atomic_load(&c->failed)) return;
+
+    for (j = 0; j < n; j++) {
+        d = row(t, j)[j] - mat47__dot(row(t, j), row(t, j), j);
+        if (!(d > 0)) {
+            debug("Non-positive pivot at row %u", k * TILE_SIZE + j);
+            atomic_store(&c->failed, true);
+            return;
+        }
+        row(t, j)[j] = d = sqrt(d);
+        for (r = j + 1; r < n; r++)
+            row(t, r)[j] = (row(t, r)[j] - mat47__dot(row(t, r), row(t, j), j)) / d;
+    }
+}
+
+// `A[i][k] = A[i][k] * inverse(transpose(L[k][k]))`
+static void trsm_lt(void *ctx, unsigned int i, unsigned int j, unsigned int k)
+{
+    struct cholesky *c = ctx;
+    unsigned int m = tile_dim(c->n, i), n = tile_dim(c->n, k), r, p;
+    view l = tile(c->a, k, k), b = tile(c->a, i, k);
+    double *x;
+
+    (void)j;
+    if (atomic_load(&c->failed)) return;
+
+    for (r = 0; r < m; r++)
+        for (x = row(b, r), p = 0; p < n; p++)
+            x[p] = (x[p] - mat47__dot(row(l, p), x, p)) / row(l, p)[p];
+}
+
+// `A[i][j] -= A[i][k] * transpose(A[j][k])`; Also the symmetric update of `A[i][i]`
+static void gemm_nt(void *ctx, unsigned int i, unsigned int j, unsigned int k)
+{
+    struct cholesky *c = ctx;
+
+    if (atomic_load(&c->failed)) return;
+    mat47__gemm_nt(
+        tile(c->a, i, j), tile(c->a, i, k), tile(c->a, j, k), tile_dim(c->n, i),
+        tile_dim(c->n, k), tile_dim(c->n, j), -1
+    );
+}
+
+static bool cholesky_tasks(struct mat47__dag *dag, struct cholesky *c)
+{
+    unsigned int i, j, k, nt = n_tiles(c->n);
+
+#define id(i, j) ((size_t)(i) * nt + (j))
+    for (k = 0; k < nt; k++) {
+        if (!mat47__dag_add(dag, potrf, c, k, k, k, 1, &TILE_RW(id(k, k))))
+            return false;
+        for (i = k + 1; i < nt; i++)
+            if (
+                !mat47__dag_add(
+                    dag, trsm_lt, c, i, k, k, 2,
+                    (struct mat47__access[]){TILE_R(id(k, k)), TILE_RW(id(i, k))}
+                )
+            ) return false;
+        for (i = k + 1; i < nt; i++)
+            for (j = k + 1; j <= i; j++)
+                if (
+                    !mat47__dag_add(
+                        dag, gemm_nt, c, i, j, k, 3,
+                        (struct mat47__access[]){
+                            TILE_R(id(i, k)), TILE_R(id(j, k)), TILE_RW(id(i, j))
+                        }
+                    )
+                ) return false;
+    }
+#undef id
+
+    return true;
+}
+
+
+mat47_t *mat47_cholesky(const mat47_t *a)
+{
+    stats(CHOLESKY);
+    struct mat47__dag *dag = NULL;
+    struct cholesky c;
+    mat47_t *l;
+
+    if (check_ptr(a) || check_eq(a->n_rows, a->n_cols)) return NULL;
+    if (!(l = mat47_copy(a))) return NULL;
+
+    c = (struct cholesky){l, a->n_rows, false};
+    if (!(dag = mat47__dag_new((size_t)n_tiles(c.n) * n_tiles(c.n)))
+        || !cholesky_tasks(dag, &c)) {
+        mat47__dag_del(dag);
+        mat47_del(l);
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the task graph");
+        return NULL;
+    }
+    mat47__dag_run(dag);
+
+    if (atomic_load(&c.failed)) {
+        mat47_del(l);
+        mat47_errno = MAT47_ERR_NOT_POSDEF;
+        error(": non-positive pivot");
+        return NULL;
+    }
+    for (unsigned int i = 0; i < c.n; i++)
+        memset(l->data[i] + i + 1, 0, sizeof(double) * (c.n - i - 1));
+
+    return l;
+}
+
+
+/* Rank-1 updates and downdates of Cholesky factors, one row of `l` at a time, with
+ * the cosines and sines of the rotations in `c` and `s`.
+ */
+
+// Element `i` of the vector `x`
+static inline double vec_elem(const mat47_t *x, unsigned int i)
+{
+    return x->n_rows == 1 ? x->data[0][i] : x->data[i][0];
+}
+
+// Allocates `c` and `s` (contiguous), `n` elements each
+static bool check_rank1_args(const mat47_t *l, const mat47_t *x, double **c)
+{
+    unsigned int n, i;
+
+    if (check_ptr(l) || check_ptr(x) || check_eq(l->n_rows, l->n_cols)) return true;
+    n = l->n_rows;
+    if (
+        check(
+            (x->n_rows == 1 && x->n_cols == n) || (x->n_cols == 1 && x->n_rows == n),
+            MAT47_ERR_DIM_MISMATCH, ": %u x %u matrix is not a vector of %u elements",
+            x->n_rows, x->n_cols, n
+        )
+    ) return true;
+    for (i = 0; i < n; i++)
+        if (check(l->data[i][i] > 0, MAT47_ERR_NOT_POSDEF, ": l[%u][%u] <= 0", i, i))
+            return true;
+
+    if (!(*c = malloc(sizeof(double) * 2 * n))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for rotations");
+        return true;
+    }
+
+    return false;
+}
+
+void mat47_cholesky_update(mat47_t *l, const mat47_t *x)
+{
+    stats(CHOLESKY_UPDATE);
+    unsigned int n, i, k;
+    double *c, *s, *restrict row, x_i, t, r;
+
+    if (check_rank1_args(l, x, &c)) return;
+    n = l->n_rows;
+    s = c + n;
+    bump_version(l);
+
+    // Row `i` is rotated by the rotations of the rows above, each of which rotates
+    // `x_i` too, then its own rotation annihilates `x_i` against the diagonal.
+    for (i = 0; i < n; i++) {
+        row = l->data[i];
+        x_i = vec_elem(x, i);
+        for (k = 0; k < i; k++) {
+            t = (row[k] + s[k] * x_i) / c[k];
+            x_i = c[k] * x_i - s[k] * t;
+            row[k] = t;
+        }
+        r = hypot(row[i], x_i);
+        c[i] = r / row[i];
+        s[i] = x_i / row[i];
+        row[i] = r;
+    }
+    free(c);
+}
+
+void mat47_cholesky_downdate(mat47_t *l, const mat47_t *x)
+{
+    stats(CHOLESKY_DOWNDATE);
+    unsigned int n, i, j;
+    double *c, *s, *restrict row, norm, alpha, scale, a, b, t, xx;
+
+    if (check_rank1_args(l, x, &c)) return;
+    n = l->n_rows;
+    s = c + n;
+
+    // `p = inverse(l) * x`, in `s`
+    for (norm = 0, i = 0; i < n; i++) {
+        s[i] = (vec_elem(x, i) - mat47__dot(l->data[i], s, i)) / l->data[i][i];
+        norm += s[i] * s[i];
+    }
+    if (!(norm < 1)) {
+        free(c);
+        mat47_errno = MAT47_ERR_NOT_POSDEF;
+        error(": norm(inverse(l) * x)^2 = %g", norm);
+        return;
+    }
+    bump_version(l);
+
+    // The rotations annihilating `p`, from the bottom, against `alpha`
+    for (alpha = sqrt(1 - norm), i = n; i--;) {
+        scale = alpha + fabs(s[i]);
+        a = alpha / scale;
+        b = s[i] / scale;
+        norm = sqrt(a * a + b * b);
+        c[i] = a / norm;
+        s[i] = b / norm;
+        alpha = scale * norm;
+    }
+
+    // Applied to every row, from the diagonal leftwards
+    for (j = 0; j < n; j++)
+        for (row = l->data[j], xx = 0, i = j + 1; i--;) {
+            t = c[i] * xx + s[i] * row[i];
+            row[i] = c[i] * row[i] - s[i] * xx;
+            xx = t;
+        }
+    free(c);
+}
+
+
+/* LU factorization with partial pivoting: `p * a = l * u`.
+ *
+ * Every panel (column of tiles) is factorized by a single task; Its row interchanges
+ * are then applied to every other column of tiles by a task, which also computes the
+ * tile of `u` for columns right of the panel.
+ *
+ * Instantiated for the rows `a` of `double` (`mat47_lu()`) and `float`
+ * (`mat47_solve_mixed()`) matrices, with `GEMM(a, n, i, j, k)` computing
+ * `A[i][j] -= A[i][k] * A[k][j]`.
+ */
+
+static inline void
+axpy_float(float *restrict x, float a, const float *restrict y, unsigned int n)
+{
+    for (unsigned int j = 0; j < n; j++) x[j] += a * y[j];
+}
+
+static void gemm_tiles_double(
+    double **a, unsigned int n, unsigned int i, unsigned int j, unsigned int k
+) {
+    mat47__gemm(
+        (view){a + (size_t)i * TILE_SIZE, (size_t)j * TILE_SIZE},
+        (view){a + (size_t)i * TILE_SIZE, (size_t)k * TILE_SIZE},
+        (view){a + (size_t)k * TILE_SIZE, (size_t)j * TILE_SIZE}, tile_dim(n, i),
+        tile_dim(n, k), tile_dim(n, j), -1, true
+    );
+}
+
+// Scaled rows of `A[k][j]` are subtracted from two rows at once, four at a time
+static void gemm_tiles_float(
+    float **a, unsigned int n, unsigned int i, unsigned int j, unsigned int k
+) {
+    unsigned int m = tile_dim(n, i), d = tile_dim(n, k), w = tile_dim(n, j), r, p, c;
+    size_t r0 = (size_t)i * TILE_SIZE, p0 = (size_t)k * TILE_SIZE;
+    size_t c0 = (size_t)j * TILE_SIZE;
+    const float *restrict b0, *restrict b1, *restrict b2, *restrict b3, *x, *z;
+    float *restrict y, *restrict t, x0, x1, x2, x3, z0, z1, z2, z3;
+
+    for (r = 0; r + 2 <= m; r += 2) {
+        y = a[r0 + r] + c0, x = a[r0 + r] + p0;
+        t = a[r0 + r + 1] + c0, z = a[r0 + r + 1] + p0;
+        for (p = 0; p + 4 <= d; p += 4) {
+            x0 = x[p], x1 = x[p + 1], x2 = x[p + 2], x3 = x[p + 3];
+            z0 = z[p], z1 = z[p + 1], z2 = z[p + 2], z3 = z[p + 3];
+            b0 = a[p0 + p] + c0; b1 = a[p0 + p + 1] + c0;
+            b2 = a[p0 + p + 2] + c0; b3 = a[p0 + p + 3] + c0;
+            for (c = 0; c < w; c++) {
+                y[c] -= x0 * b0[c] + x1 * b1[c] + x2 * b2[c] + x3 * b3[c];
+                t[c] -= z0 * b0[c] + z1 * b1[c] + z2 * b2[c] + z3 * b3[c];
+            }
+        }
+        for (; p < d; p++) {
+            axpy_float(y, -x[p], a[p0 + p] + c0, w);
+            axpy_float(t, -z[p], a[p0 + p] + c0, w);
+        }
+    }
+    for (; r < m; r++)
+        for (p = 0; p < d; p++)
+            axpy_float(a[r0 + r] + c0, -a[r0 + r][p0 + p], a[p0 + p] + c0, w);
+}
+
+#define getrf(T, AXPY, GEMM) \
+struct lu_##T { \
+    T **a; \
+    unsigned int n; \
+    unsigned int *piv; \
+    atomic_bool singular; \
+}; \
+\
+static void swap_rows_##T(T *restrict x, T *restrict y, unsigned int n) \
+{ \
+    T tmp; \
+\
+    for (unsigned int j = 0; j < n; j++) tmp = x[j], x[j] = y[j], y[j] = tmp; \
+} \
+\
+/* Factorizes the panel `k`, from its diagonal tile down */ \
+static void \
+getrf_panel_##T(void *ctx, unsigned int i, unsigned int j, unsigned int k) \
+{ \
+    struct lu_##T *lu = ctx; \
+    unsigned int n = lu->n, c0 = k * TILE_SIZE, w = tile_dim(n, k), c, col, r, p; \
+    T **a = lu->a, pivot_max, l; \
+\
+    (void)i; (void)j; \
+    for (c = 0; c < w; c++) { \
+        col = c0 + c; \
+        pivot_max = fabs(a[col][col]); \
+        for (p = col, r = col + 1; r < n; r++) \
+            if (fabs(a[r][col]) > pivot_max) pivot_max = fabs(a[p = r][col]); \
+\
+        lu->piv[col] = p; \
+        if (!(pivot_max > 0)) { \
+            debug("Zero pivot at step %u", col); \
+            atomic_store(&lu->singular, true); \
+            continue; \
+        } \
+        if (p != col) swap_rows_##T(a[col] + c0, a[p] + c0, w); \
+\
+        for (r = col + 1; r < n; r++) { \
+            if ((l = a[r][col] /= a[col][col]) == 0) continue; \
+            AXPY(a[r] + col + 1, -l, a[col] + col + 1, w - c - 1); \
+        } \
+    } \
+} \
+\
+/* Applies the row interchanges of panel `k` to the column of tiles `j`, then, if \
+ * right of the panel, `A[k][j] = inverse(L[k][k]) * A[k][j]` \
+ */ \
+static void \
+getrf_swap_trsm_##T(void *ctx, unsigned int i, unsigned int j, unsigned int k) \
+{ \
+    struct lu_##T *lu = ctx; \
+    unsigned int r0 = k * TILE_SIZE, c0 = j * TILE_SIZE; \
+    unsigned int h = tile_dim(lu->n, k), w = tile_dim(lu->n, j), r, p; \
+    T **a = lu->a; \
+\
+    (void)i; \
+    for (r = r0; r < r0 + h; r++) \
+        if (lu->piv[r] != r) swap_rows_##T(a[r] + c0, a[lu->piv[r]] + c0, w); \
+\
+    if (j < k) return; \
+    /* Forward substitution, with the unit lower triangle */ \
+    for (r = 1; r < h; r++) \
+        for (p = 0; p < r; p++) \
+            AXPY(a[r0 + r] + c0, -a[r0 + r][r0 + p], a[r0 + p] + c0, w); \
+} \
+\
+/* `A[i][j] -= A[i][k] * A[k][j]` */ \
+static void getrf_gemm_##T(void *ctx, unsigned int i, unsigned int j, unsigned int k) \
+{ \
+    struct lu_##T *lu = ctx; \
+\
+    GEMM(lu->a, lu->n, i, j, k); \
+} \
+\
+static bool lu_tasks_##T(struct mat47__dag *dag, struct lu_##T *lu) \
+{ \
+    unsigned int i, j, k, nt = n_tiles(lu->n); \
+    struct mat47__access acc[nt + 1]; \
+\
+    for (k = 0; k < nt; k++) { \
+        for (i = k; i < nt; i++) acc[i - k] = TILE_RW(id(i, k)); \
+        if (!mat47__dag_add(dag, getrf_panel_##T, lu, k, k, k, nt - k, acc)) \
+            return false; \
+\
+        /* Right of the panel first, such that the next panel is ready soonest */ \
+        for (j = k + 1; j < nt; j++) { \
+            acc[0] = TILE_R(id(k, k)); \
+            for (i = k; i < nt; i++) acc[i - k + 1] = TILE_RW(id(i, j)); \
+            if ( \
+                !mat47__dag_add( \
+                    dag, getrf_swap_trsm_##T, lu, k, j, k, nt - k + 1, acc \
+                ) \
+            ) return false; \
+            for (i = k + 1; i < nt; i++) \
+                if ( \
+                    !mat47__dag_add( \
+                        dag, getrf_gemm_##T, lu, i, j, k, 3, \
+                        (struct mat47__access[]){ \
+                            TILE_R(id(i, k)), TILE_R(id(k, j)), TILE_RW(id(i, j)) \
+                        } \
+                    ) \
+                ) return false; \
+        } \
+        for (j = 0; j < k; j++) { \
+            acc[0] = TILE_R(id(k, k)); \
+            for (i = k; i < nt; i++) acc[i - k + 1] = TILE_RW(id(i, j)); \
+            if ( \
+                !mat47__dag_add( \
+                    dag, getrf_swap_trsm_##T, lu, k, j, k, nt - k + 1, acc \
+                ) \
+            ) return false; \
+        } \
+    } \
+\
+    return true; \
+} \
+\
+/* Runs the tasks of `lu_tasks_T()`, in parallel. \
+ * \
+ * Returns false if the task graph can't be allocated. \
+ */ \
+static bool getrf_##T(struct lu_##T *lu) \
+{ \
+    struct mat47__dag *dag = mat47__dag_new((size_t)n_tiles(lu->n) * n_tiles(lu->n)); \
+\
+    if (!dag || !lu_tasks_##T(dag, lu)) { \
+        mat47__dag_del(dag); \
+        return false; \
+    } \
+    mat47__dag_run(dag); \
+\
+    return true; \
+}
+
+#define id(i, j) ((size_t)(i) * nt + (j))
+getrf(double, mat47__axpy, gemm_tiles_double)
+getrf(float, axpy_float, gemm_tiles_float)
+#undef id
+
+#undef getrf
+
+
+mat47_t *mat47_lu(const mat47_t *a, unsigned int *piv)
+{
+    stats(LU);
+    struct lu_double lu;
+    mat47_t *f;
+
+    if (check_ptr(a) || check_ptr(piv) || check_eq(a->n_rows, a->n_cols)) return NULL;
+    if (!(f = mat47_copy(a))) return NULL;
+
+    lu = (struct lu_double){f->data, a->n_rows, piv, false};
+    if (!getrf_double(&lu)) {
+        mat47_del(f);
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the task graph");
+        return NULL;
+    }
+
+    if (atomic_load(&lu.singular)) {
+        mat47_del(f);
+        mat47_errno = MAT47_ERR_SINGULAR;
+        error(": zero pivot");
+        return NULL;
+    }
+
+    return f;
+}
+
+
+mat47_t *mat47_solve_mixed(const mat47_t *a, const mat47_t *b, int *iter)
+{
+    stats(SOLVE_MIXED);
+    if (check_ptr(a) || check_ptr(b)) return NULL;
+    if (check_eq(a->n_rows, a->n_cols) || check_eq(a->n_rows, b->n_rows)) return NULL;
+
+    unsigned int i, k, n = a->n_rows, n_rhs = b->n_cols;
+    size_t e, nn = (size_t)n * n, nk = (size_t)n * n_rhs;
+    int n_iter = -1;
+    double a_norm = 0, row_norm, tolerance;
+    double *restrict x, *restrict r, *restrict ad = NULL;
+    float *restrict af, *restrict xf, **rows;
+    unsigned int *restrict piv;
+    struct lu_float lu;
+    mat47_t *result = NULL;
+
+    af = malloc(sizeof(float) * nn);
+    xf = malloc(sizeof(float) * nk);
+    x = malloc(sizeof(double) * nk);
+    r = malloc(sizeof(double) * (nk + 2 * n_rhs));
+    piv = malloc(sizeof(unsigned int) * n);
+    rows = malloc(sizeof(float *) * n);
+    if (!(af && xf && x && r && piv && rows)) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for workspace");
+        goto cleanup;
+    }
+
+    for (i = 0; i < n; i++) {
+        for (row_norm = 0, k = 0; k < n; k++) row_norm += fabs(a->data[i][k]);
+        imax(a_norm, row_norm);
+    }
+    // Same as LAPACK's `DSGESV`
+    tolerance = a_norm * (DBL_EPSILON / 2) * sqrt(n);
+
+    for (i = 0; i < n; i++) rows[i] = af + (size_t)i * n;
+    lu = (struct lu_float){rows, n, piv, false};
+    if (!demote(a, af) || !demote(b, xf)) {
+        debug("Out of the range of single precision");
+        goto fallback;
+    }
+    if (!getrf_float(&lu)) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the task graph");
+        goto cleanup;
+    }
+    if (atomic_load(&lu.singular)) {
+        debug("Single-precision factorization failed");
+        goto fallback;
+    }
+
+    lu_solve_float(n, n_rhs, af, piv, xf);
+    for (e = 0; e < nk; e++) x[e] = xf[e];
+
+    for (n_iter = 0;; n_iter++) {
+        residual(a, b, x, r);
+        if (converged(n, n_rhs, x, r, tolerance, r + nk)) {
+            debug("Converged after %d refinement iterations", n_iter);
+            goto solved;
+        }
+        if (n_iter == MAT47_REFINE_MAX_ITER) break;
+
+        for (e = 0; e < nk; e++) {
+            if (fabs(r[e]) > FLT_MAX) goto not_converged;
+            xf[e] = r[e];
+        }
+        lu_solve_float(n, n_rhs, af, piv, xf);
+        for (e = 0; e < nk; e++) x[e] += xf[e];
+    }
+
+not_converged:
+    debug("Refinement failed to converge after %d iterations", n_iter);
+    n_iter = -MAT47_REFINE_MAX_ITER - 1;
+
+fallback:
+    free(af);
+    af = NULL;
+    if (!(ad = malloc(sizeof(double) * nn))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for double-precision factorization");
+        goto cleanup;
+    }
+
+    for (i = 0; i < n; i++) {
+        memcpy(ad + (size_t)i * n, a->data[i], sizeof(double) * n);
+        memcpy(x + (size_t)i * n_rhs, b->data[i], sizeof(double) * n_rhs);
+    }
+    if ((k = lu_factor_double(n, ad, piv))) {
+        mat47_errno = MAT47_ERR_SINGULAR;
+        error(": zero pivot at step %u", k);
+        goto cleanup;
+    }
+    lu_solve_double(n, n_rhs, ad, piv, x);
+
+solved:
+    if (!(result = mat47__new(n, n_rhs, false))) goto cleanup;
+    for (i = 0; i < n; i++)
+        memcpy(result->data[i], x + (size_t)i * n_rhs, sizeof(double) * n_rhs);
+    if (iter) *iter = n_iter;
+
+cleanup:
+    free(af); free(ad); free(xf); free(x); free(r); free(piv); free(rows);
+    return result;
+}
+
+
+/* QR factorization: `a = q * r`, with Householder reflectors.
+ *
+ * The diagonal tile of every column of tiles is factorized, then every tile below it
+ * is annihilated against its upper triangle (i.e "flat tree" tiled QR), every
+ * factorization being applied to the tiles right of it. Every reflector is
+ * `I - tau * v * transpose(v)`, with `v` stored below the diagonal of a diagonal tile
+ * (with an implicit unit head), or in a whole tile below it (with an implicit unit
+ * head in the upper triangle above). `q` is then generated by applying the
+ * reflectors, in reverse order, to the first columns of the identity.
+ */
+
+struct qr {
+    mat47_t *a;
+    mat47_t *q;
+    unsigned int m, n;
+    double *tau;  // `TILE_SIZE` scale factors per tile of `a`
+};
+
+#define tau(qr, i, k) ((qr)->tau + ((size_t)(i) * n_tiles((qr)->n) + (k)) * TILE_SIZE)
+
+/* Computes the reflector mapping `(alpha, x)` to `(beta, 0)`, where `x` is the
+ * elements `rows[r][col]` (`r < n`); `alpha` is replaced with `beta`, and `x` with the
+ * tail of `v`. Returns `tau`.
+ */
+static double householder(double *alpha, double **rows, size_t col, unsigned int n)
+{
+    double norm = 0, beta, scale;
+    unsigned int r;
+
+    for (r = 0; r < n; r++) norm += rows[r][col] * rows[r][col];
+    if (norm == 0) return 0;
+
+    beta = -copysign(sqrt(*alpha * *alpha + norm), *alpha);
+    scale = 1 / (*alpha - beta);
+    for (r = 0; r < n; r++) rows[r][col] *= scale;
+    scale = (beta - *alpha) / beta;
+    *alpha = beta;
+
+    return scale;
+}
+
+/* Applies the reflector `p` of tile `v` (with its head in row `p` of `top`) to `top`
+ * and `bottom`, from row `b0` of `v` and `bottom`, over `n` columns
+ */
+static void reflect(
+    double tau, view v, unsigned int p, view top, view bottom, unsigned int b0,
+    unsigned int m, unsigned int n
+) {
+    double w[TILE_SIZE], *t = row(top, p);
+    unsigned int r;
+
+    if (tau == 0) return;
+    memcpy(w, t, sizeof(double) * n);
+    for (r = b0; r < m; r++) mat47__axpy(w, row(v, r)[p], row(bottom, r), n);
+    mat47__axpy(t, -tau, w, n);
+    for (r = b0; r < m; r++) mat47__axpy(row(bottom, r), -tau * row(v, r)[p], w, n);
+}
+
+// Factorizes the diagonal tile `(k, k)`
+static void geqrt(void *ctx, unsigned int i, unsigned int j, unsigned int k)
+{
+    struct qr *qr = ctx;
+    unsigned int m = tile_dim(qr->m, k), n = tile_dim(qr->n, k), c;
+    view t = tile(qr->a, k, k), rest;
+    double *tau = tau(qr, k, k);
+
+    (void)i; (void)j;
+    for (c = 0; c < n; c++) {
+        tau[c] = householder(&row(t, c)[c], t.rows + c + 1, t.col + c, m - c - 1);
+        rest = (view){t.rows, t.col + c + 1};
+        reflect(tau[c], t, c, rest, rest, c + 1, m, n - c - 1);
+    }
+}
+
+/* Annihilates the tile `(i, k)` against the upper triangle of the diagonal tile
+ * `(k, k)`
+ */
+static void tsqrt(void *ctx, unsigned int i, unsigned int j, unsigned int k)
+{
+    struct qr *qr = ctx;
+    unsigned int m = tile_dim(qr->m, i), n = tile_dim(qr->n, k), c;
+    view r = tile(qr->a, k, k), b = tile(qr->a, i, k);
+    double *tau = tau(qr, i, k);
+
+    (void)j;
+    for (c = 0; c < n; c++) {
+        tau[c] = householder(&row(r, c)[c], b.rows, b.col + c, m);
+        reflect(
+            tau[c], b, c, (view){r.rows, r.col + c + 1}, (view){b.rows, b.col + c + 1},
+            0, m, n - c - 1
+        );
+    }
+}
+
+/* Applies the reflectors of the diagonal tile `(k, k)` to the tile `(k, j)` of the
+ * target: Of the factorization, `transpose(q_k) * A[k][j]`, or of the generation of
+ * `q`, `q_k * Q[k][j]`.
+ */
+static void unmqr(void *ctx, unsigned int i, unsigned int j, unsigned int k)
+{
+    struct qr *qr = ctx;
+    mat47_t *target = qr->q ? qr->q : qr->a;
+    unsigned int m = tile_dim(qr->m, k), n = tile_dim(qr->n, j), h = tile_dim(qr->n, k);
+    view v = tile(qr->a, k, k), t = tile(target, k, j);
+    double *tau = tau(qr, k, k);
+
+    (void)i;
+    if (!qr->q)
+        for (unsigned int p = 0; p < h; p++) reflect(tau[p], v, p, t, t, p + 1, m, n);
+    else
+        for (unsigned int p = h; p--;) reflect(tau[p], v, p, t, t, p + 1, m, n);
+}
+
+// Applies the reflectors of tile `(i, k)` to the tiles `(k, j)` and `(i, j)`
+static void tsmqr(void *ctx, unsigned int i, unsigned int j, unsigned int k)
+{
+    struct qr *qr = ctx;
+    mat47_t *target = qr->q ? qr->q : qr->a;
+    unsigned int m = tile_dim(qr->m, i), n = tile_dim(qr->n, j), h = tile_dim(qr->n, k);
+    view v = tile(qr->a, i, k), top = tile(target, k, j), bottom = tile(target, i, j);
+    double *tau = tau(qr, i, k);
+
+    if (!qr->q)
+        for (unsigned int p = 0; p < h; p++)
+            reflect(tau[p], v, p, top, bottom, 0, m, n);
+    else
+        for (unsigned int p = h; p--;) reflect(tau[p], v, p, top, bottom, 0, m, n);
+}
+
+/* Adds the tasks of the factorization (`qr->q` null) or of the generation of `q`;
+ * Tiles of `q` are numbered after those of `a`.
+ */
+static bool qr_tasks(struct mat47__dag *dag, struct qr *qr)
+{
+    unsigned int i, j, k, mt = n_tiles(qr->m), nt = n_tiles(qr->n);
+    size_t q0 = (size_t)mt * nt;
+
+#define id(i, j) ((size_t)(i) * nt + (j))
+#define add(fn, i, j, k, ...) \
+    mat47__dag_add( \
+        dag, fn, qr, i, j, k, sizeof_arr(((struct mat47__access[]){__VA_ARGS__})), \
+        (struct mat47__access[]){__VA_ARGS__} \
+    )
+    if (!qr->q) {
+        for (k = 0; k < nt; k++) {
+            if (!add(geqrt, k, k, k, TILE_RW(id(k, k)))) return false;
+            for (j = k + 1; j < nt; j++)
+                if (!add(unmqr, k, j, k, TILE_R(id(k, k)), TILE_RW(id(k, j))))
+                    return false;
+            for (i = k + 1; i < mt; i++) {
+                if (!add(tsqrt, i, k, k, TILE_RW(id(k, k)), TILE_RW(id(i, k))))
+                    return false;
+                for (j = k + 1; j < nt; j++)
+                    if (
+                        !add(
+                            tsmqr, i, j, k, TILE_R(id(i, k)), TILE_RW(id(k, j)),
+                            TILE_RW(id(i, j))
+                        )
+                    ) return false;
+            }
+        }
+        return true;
+    }
+
+    // Columns of `q` left of `k` are still those of the identity, below row `k`,
+    // hence unaffected by the reflectors of step `k`.
+    for (k = nt; k--;) {
+        for (i = mt; --i > k;)
+            for (j = k; j < nt; j++)
+                if (
+                    !add(
+                        tsmqr, i, j, k, TILE_R(id(i, k)), TILE_RW(q0 + id(k, j)),
+                        TILE_RW(q0 + id(i, j))
+                    )
+                ) return false;
+        for (j = k; j < nt; j++)
+            if (!add(unmqr, k, j, k, TILE_R(id(k, k)), TILE_RW(q0 + id(k, j))))
+                return false;
+    }
+#undef add
+#undef id
+
+    return true;
+}
+
+
+mat47_t *mat47_qr(const mat47_t *a, mat47_t **r)
+{
+    stats(QR);
+    struct mat47__dag *dag = NULL;
+    struct qr factor, generate;
+    mat47_t *q = NULL, *f = NULL;
+    unsigned int i, n;
+    size_t n_tiles;
+    double *tau = NULL;
+
+    if (check_ptr(a) || check_ptr(r)) return NULL;
+    *r = NULL;
+    if (
+        check(
+            a->n_rows >= a->n_cols, MAT47_ERR_DIM_MISMATCH,
+            ": %u x %u matrix has more columns than rows", a->n_rows, a->n_cols
+        )
+    ) return NULL;
+
+    n = a->n_cols;
+    n_tiles = (size_t)n_tiles(a->n_rows) * n_tiles(n);
+    if (
+        !((f = mat47_copy(a)) && (q = mat47_zero(a->n_rows, n))
+        && (*r = mat47_zero(n, n)))
+    ) goto fail;
+    if (!(tau = malloc(sizeof(double) * TILE_SIZE * n_tiles))) goto alloc_fail;
+    for (i = 0; i < n; i++) q->data[i][i] = 1;
+
+    factor = (struct qr){f, NULL, a->n_rows, n, tau};
+    generate = (struct qr){f, q, a->n_rows, n, tau};
+    if (
+        !(dag = mat47__dag_new(2 * n_tiles))
+        || !qr_tasks(dag, &factor) || !qr_tasks(dag, &generate)
+    ) goto alloc_fail;
+    mat47__dag_run(dag);
+
+    for (i = 0; i < n; i++)
+        memcpy((*r)->data[i] + i, f->data[i] + i, sizeof(double) * (n - i));
+    free(tau);
+    mat47_del(f);
+
+    return q;
+
+alloc_fail:
+    mat47__dag_del(dag);
+    mat47_errno = MAT47_ERR_ALLOC;
+    error(" for the factorization");
+fail:
+    free(tau);
+    mat47_del(f);
+    mat47_del(q);
+    mat47_del(*r);
+    *r = NULL;
+    return NULL;
+}
+
+
+/* Symmetric eigensolver: Implicitly restarted Lanczos.
+ *
+ * `a * transpose(v) = transpose(v) * t + beta * transpose(v[m]) * e_m`, with the `m`
+ * basis vectors in the rows of `v` and `t` tridiagonal. Every new vector is
+ * orthogonalized against the whole basis by classical Gram-Schmidt, twice (enough to
+ * reach working precision), such that no spurious copies of converged eigenvalues
+ * appear. A restart applies `m - k` implicit QR steps to `t`, shifted by the
+ * unwanted Ritz values, which leaves the first `k` vectors spanning the wanted
+ * directions and a residual with which the basis is extended again, as if that
+ * filter had been applied to the starting vector.
+ */
+
+// Minimum number of vectors in the basis
+#define EIGSH_MIN_BASIS 20
+
+// Maximum number of implicit QL iterations per eigenvalue of `t`
+#define TQL_MAX_ITER 60
+
+struct eigsh {
+    unsigned int n, k, m;
+    unsigned int k_max;  // Maximum number of vectors kept by restarts
+    enum mat47_eigsh_which which;
+    mat47_matvec_fn *fn;
+    void *arg;
+
+    double **v;  // `m + 1` basis vectors
+    double **tmp;  // `k_max + 1` vectors, for restarts
+    double *w;
+    double beta;
+
+    double *t, *q, *z;  // `m x m`, row-major
+    double *d, *e;  // Ritz values, off-diagonal of `t`
+    double *h, *proj;  // Projections on the basis
+    double **qt;  // `k_max + 1` rows of `m`
+    unsigned int *order;  // Ritz values, wanted first
+    uint64_t seed;
+};
+
+#define T(i, j) (s->t[(size_t)(i) * s->m + (j)])
+#define Q(i, j) (s->q[(size_t)(i) * s->m + (j)])
+#define Z(i, j) (s->z[(size_t)(i) * s->m + (j)])
+
+// Uniformly distributed in [-0.5, 0.5); xorshift64*
+static double random_elem(uint64_t *seed)
+{
+    *seed ^= *seed >> 12;
+    *seed ^= *seed << 25;
+    *seed ^= *seed >> 27;
+
+    return (*seed * UINT64_C(2685821657736338717) >> 11) * 0x1p-53 - 0.5;
+}
+
+/* Orthogonalizes `w` against the first `j` basis vectors, storing the projections
+ * removed in `h`; Returns its norm.
+ */
+static double orthogonalize(struct eigsh *s, unsigned int j, double *w, double *h)
+{
+    mat47_t basis = {.n_rows = j, .n_cols = s->n, .data = s->v};
+    mat47_t x = {.n_rows = 1, .n_cols = s->n, .data = &w};
+    mat47_t y = {.n_rows = 1, .n_cols = j, .data = &s->proj};
+
+    memset(h, 0, sizeof(double) * j);
+    for (int pass = 0; j && pass < 2; pass++) {
+        mat47_gemv(&y, 1, &basis, &x, 0);
+        mat47_gemv_t(&x, -1, &basis, &y, 1);
+        for (unsigned int i = 0; i < j; i++) h[i] += s->proj[i];
+    }
+
+    return sqrt(mat47__dot(w, w, s->n));
+}
+
+// Sets the `j`-th basis vector to a random unit vector orthogonal to the previous
+static void random_vector(struct eigsh *s, unsigned int j)
+{
+    double norm;
+
+    do {
+        for (unsigned int i = 0; i < s->n; i++) s->v[j][i] = random_elem(&s->seed);
+    } while (!((norm = orthogonalize(s, j, s->v[j], s->h)) > 0));
+    for (unsigned int i = 0; i < s->n; i++) s->v[j][i] /= norm;
+}
+
+// Extends the basis from `j0` to `m` vectors
+static void extend(struct eigsh *s, unsigned int j0)
+{
+    double w_norm, b;
+
+    for (unsigned int j = j0; j < s->m; j++) {
+        s->fn(s->w, s->v[j], s->arg);
+        w_norm = sqrt(mat47__dot(s->w, s->w, s->n));
+        b = orthogonalize(s, j + 1, s->w, s->h);
+        T(j, j) = s->h[j];
+
+        if (b <= 4 * DBL_EPSILON * w_norm) {
+            // Invariant subspace; `t` decouples.
+            b = 0;
+            if (j + 1 < s->m) random_vector(s, j + 1);
+            else memset(s->v[j + 1], 0, sizeof(double) * s->n);
+        } else {
+            for (unsigned int i = 0; i < s->n; i++) s->v[j + 1][i] = s->w[i] / b;
+        }
+
+        if (j + 1 < s->m) T(j, j + 1) = T(j + 1, j) = b;
+        else s->beta = b;
+    }
+}
+
+/* Computes the eigenvalues (in `d`) and eigenvectors (in the columns of `z`) of the
+ * symmetric tridiagonal matrix with diagonal `d` and off-diagonal `e` (`e[n - 1]` is
+ * ignored) by implicit QL iterations with Wilkinson shifts.
+ *
+ * Returns false if an eigenvalue doesn't converge.
+ */
+static bool tql(unsigned int n, double *d, double *e, double *z)
+{
+    unsigned int l, m, iter, k;
+    double g, r, s, c, p, f, b, dd;
+    int i;
+
+    for (l = 0; l < n * n; l++) z[l] = l % (n + 1) ? 0 : 1;
+    e[n - 1] = 0;
+    for (l = 0; l < n; l++) {
+        iter = 0;
+        do {
+            for (m = l; m + 1 < n; m++) {
+                dd = fabs(d[m]) + fabs(d[m + 1]);
+                if (fabs(e[m]) <= DBL_EPSILON * dd) break;
+            }
+            if (m == l) break;
+            if (iter++ == TQL_MAX_ITER) return false;
+
+            g = (d[l + 1] - d[l]) / (2 * e[l]);
+            r = hypot(g, 1);
+            g = d[m] - d[l] + e[l] / (g + copysign(r, g));
+            s = c = 1;
+            p = 0;
+            for (i = (int)m - 1; i >= (int)l; i--) {
+                f = s * e[i];
+                b = c * e[i];
+                e[i + 1] = r = hypot(f, g);
+                if (r == 0) {
+                    d[i + 1] -= p;
+                    e[m] = 0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2 * c * b;
+                d[i + 1] = g + (p = s * r);
+                g = c * r - b;
+                for (k = 0; k < n; k++) {
+                    f = z[(size_t)k * n + i + 1];
+                    z[(size_t)k * n + i + 1] = s * z[(size_t)k * n + i] + c * f;
+                    z[(size_t)k * n + i] = c * z[(size_t)k * n + i] - s * f;
+                }
+            }
+            if (r == 0 && i >= (int)l) continue;
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0;
+        } while (true);
+    }
+
+    return true;
+}
+
+static double wanted_key(enum mat47_eigsh_which which, double x)
+{
+    return (
+        which == MAT47_EIGSH_LARGEST ? -x
+        : which == MAT47_EIGSH_SMALLEST ? x
+        : -fabs(x)
+    );
+}
+
+// Computes the Ritz values and orders them, wanted first
+static bool ritz(struct eigsh *s)
+{
+    unsigned int i, j, tmp;
+
+    for (i = 0; i < s->m; i++) {
+        s->d[i] = T(i, i);
+        s->e[i] = i + 1 < s->m ? T(i, i + 1) : 0;
+    }
+    if (!tql(s->m, s->d, s->e, s->z)) return false;
+
+    for (i = 0; i < s->m; i++) s->order[i] = i;
+    for (i = 1; i < s->m; i++)
+        for (j = i; j && (
+                wanted_key(s->which, s->d[s->order[j]])
+                < wanted_key(s->which, s->d[s->order[j - 1]])
+            ); j--)
+            tmp = s->order[j], s->order[j] = s->order[j - 1], s->order[j - 1] = tmp;
+
+    return true;
+}
+
+// Returns the number of wanted Ritz pairs that have converged
+static unsigned int n_converged(struct eigsh *s)
+{
+    unsigned int n = 0;
+    double norm = 0;
+
+    for (unsigned int i = 0; i < s->m; i++) imax(norm, fabs(s->d[i]));
+    for (unsigned int i = 0; i < s->k; i++)
+        n += fabs(s->beta * Z(s->m - 1, s->order[i])) <= MAT47_EIGSH_TOL * norm;
+
+    return n;
+}
+
+/* An implicit QR step on `t`, shifted by `mu`: `t = transpose(g) * t * g`, with `g`
+ * (accumulated into `q`) a product of Givens rotations chasing the bulge down.
+ */
+static void qr_step(struct eigsh *s, double mu)
+{
+    unsigned int i, j, m = s->m, lo, hi;
+    double x = T(0, 0) - mu, y = T(1, 0), r, c, sn, a, b;
+
+    for (i = 0; i + 1 < m; i++) {
+        r = hypot(x, y);
+        c = r ? x / r : 1;
+        sn = r ? y / r : 0;
+        lo = i ? i - 1 : 0;
+        hi = min(i + 2, m - 1);
+        for (j = lo; j <= hi; j++) {
+            a = T(i, j), b = T(i + 1, j);
+            T(i, j) = c * a + sn * b;
+            T(i + 1, j) = c * b - sn * a;
+        }
+        for (j = lo; j <= hi; j++) {
+            a = T(j, i), b = T(j, i + 1);
+            T(j, i) = c * a + sn * b;
+            T(j, i + 1) = c * b - sn * a;
+        }
+        if (i) T(i + 1, i - 1) = T(i - 1, i + 1) = 0;
+        for (j = 0; j < m; j++) {
+            a = Q(j, i), b = Q(j, i + 1);
+            Q(j, i) = c * a + sn * b;
+            Q(j, i + 1) = c * b - sn * a;
+        }
+        if (i + 2 < m) x = T(i + 1, i), y = T(i + 2, i);
+    }
+}
+
+// Compresses the basis to the first `k` vectors, then sets the next one
+static void restart(struct eigsh *s, unsigned int k)
+{
+    unsigned int i, j, m = s->m, n = s->n;
+    double sigma, b, *tmp;
+
+    for (i = 0; i < m * m; i++) s->q[i] = i % (m + 1) ? 0 : 1;
+    for (i = k; i < m; i++) qr_step(s, s->d[s->order[i]]);
+
+    // Rows `0` to `k` of `transpose(q) * v`
+    for (i = 0; i <= k; i++)
+        for (j = 0; j < m; j++) s->qt[i][j] = Q(j, i);
+    mat47__gemm(
+        (view){s->tmp, 0}, (view){s->qt, 0}, (view){s->v, 0}, k + 1, m, n, 1, false
+    );
+
+    sigma = s->beta * Q(m - 1, k - 1);
+    for (i = 0; i < n; i++) s->w[i] = s->tmp[k][i] * T(k, k - 1) + s->v[m][i] * sigma;
+    for (i = 0; i < k; i++) tmp = s->v[i], s->v[i] = s->tmp[i], s->tmp[i] = tmp;
+
+    for (i = 0; i < m; i++)
+        for (j = 0; j < m; j++)
+            if (i >= k || j >= k) T(i, j) = 0;
+
+    if (!((b = orthogonalize(s, k, s->w, s->h)) > 0)) {
+        random_vector(s, k);
+    } else {
+        for (i = 0; i < n; i++) s->v[k][i] = s->w[i] / b;
+    }
+    T(k, k - 1) = T(k - 1, k) = b;
+}
+
+#undef T
+#undef Q
+
+static mat47_t *eigsh(struct eigsh *s, mat47_t **vecs)
+{
+    unsigned int i, j, n = s->n, k = s->k, m = s->m, p, n_conv, restarts = 0;
+    double *basis = NULL, *small = NULL;
+    mat47_t *values = NULL;
+
+    p = s->k_max = k + (m - k) / 2;
+    basis = malloc(sizeof(double) * n * (m + p + 3));
+    small = malloc(sizeof(double) * ((size_t)m * (3 * m + 5 + p)));
+    s->v = malloc(sizeof(double *) * (m + 2 * p + 3));
+    s->order = malloc(sizeof(unsigned int) * m);
+    if (!(basis && small && s->v && s->order)) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the Lanczos basis");
+        goto cleanup;
+    }
+
+    for (i = 0; i < m + p + 2; i++) s->v[i] = basis + (size_t)n * i;
+    s->tmp = s->v + m + 1;
+    s->qt = s->v + m + p + 2;
+    s->w = basis + (size_t)n * (m + p + 2);
+    s->t = small;
+    s->q = s->t + (size_t)m * m;
+    s->z = s->q + (size_t)m * m;
+    s->d = s->z + (size_t)m * m;
+    s->e = s->d + m;
+    s->h = s->e + m;
+    s->proj = s->h + m;
+    s->qt[0] = s->proj + m;
+    for (i = 1; i <= p; i++) s->qt[i] = s->qt[0] + (size_t)m * i;
+    memset(s->t, 0, sizeof(double) * m * m);
+
+    s->seed = UINT64_C(0x9E3779B97F4A7C15);
+    random_vector(s, 0);
+    extend(s, 0);
+    while (true) {
+        if (!ritz(s)) break;
+        // A basis of the whole space is exact
+        if (m == n || (n_conv = n_converged(s)) == k) {
+            if (!(values = mat47__new(k, 1, false))) goto cleanup;
+            for (i = 0; i < k; i++) values->data[i][0] = s->d[s->order[i]];
+            break;
+        }
+        if (restarts++ == MAT47_EIGSH_MAX_RESTARTS) break;
+        // Converged pairs are kept (with their share of the basis taken from the
+        // unwanted ones), such that they aren't filtered out along with those; A
+        // single wanted pair is kept with more (as by ARPACK).
+        p = k + min(n_conv, (m - k) / 2);
+        if (p == 1 && m > 2) p = m >= 6 ? m / 2 : 2;
+        restart(s, p);
+        extend(s, p);
+    }
+    if (!values) {
+        mat47_errno = MAT47_ERR_NO_CONVERGENCE;
+        error(": %u restarts", restarts);
+        goto cleanup;
+    }
+    debug("Converged after %u restart(s)", restarts);
+
+    if (vecs) {
+        if (!(*vecs = mat47__new(n, k, false))) {
+            mat47_del(values);
+            values = NULL;
+            goto cleanup;
+        }
+        // Rows of `transpose(z) * v`, for the wanted Ritz vectors
+        for (i = 0; i < k; i++)
+            for (j = 0; j < m; j++) s->qt[i][j] = Z(j, s->order[i]);
+        mat47__gemm(
+            (view){s->tmp, 0}, (view){s->qt, 0}, (view){s->v, 0}, k, m, n, 1, false
+        );
+        for (i = 0; i < n; i++)
+            for (j = 0; j < k; j++) (*vecs)->data[i][j] = s->tmp[j][i];
+    }
+
+cleanup:
+    free(basis);
+    free(small);
+    free(s->v);
+    free(s->order);
+    return values;
+}
+
+#undef Z
+
+static bool check_eigsh_args(
+    unsigned int n, unsigned int k, enum mat47_eigsh_which which
+) {
+    return (
+        check(k, MAT47_ERR_ZERO_SIZE, ": k=0")
+        || check(k <= n, MAT47_ERR_INVALID_ARG, ": k=%u > n=%u", k, n)
+        || check(
+            which == MAT47_EIGSH_LARGEST || which == MAT47_EIGSH_SMALLEST
+            || which == MAT47_EIGSH_LARGEST_MAGNITUDE,
+            MAT47_ERR_INVALID_ARG, ": which=%d", (int)which
+        )
+    );
+}
+
+static inline unsigned int basis_size(unsigned int n, unsigned int k)
+{
+    return min(n, max(2 * k + 1, EIGSH_MIN_BASIS));
+}
+
+static void dense_matvec(double *restrict y, const double *restrict x, void *arg)
+{
+    const mat47_t *a = arg;
+    mat47_t yv = {.n_rows = 1, .n_cols = a->n_rows, .data = &(double *){y}};
+    mat47_t xv = {.n_rows = 1, .n_cols = a->n_cols, .data = &(double *){(double *)x}};
+
+    mat47_gemv(&yv, 1, a, &xv, 0);
+}
+
+mat47_t *mat47_eigsh(
+    const mat47_t *m, unsigned int k, enum mat47_eigsh_which which, mat47_t **vecs
+) {
+    stats(EIGSH);
+    unsigned int n;
+
+    if (vecs) *vecs = NULL;
+    if (check_ptr(m) || check_eq(m->n_rows, m->n_cols)) return NULL;
+    if (check_eigsh_args(n = m->n_rows, k, which)) return NULL;
+
+    return eigsh(
+        &(struct eigsh){
+            .n = n, .k = k, .m = basis_size(n, k), .which = which,
+            .fn = dense_matvec, .arg = (void *)m
+        },
+        vecs
+    );
+}
+
+mat47_t *mat47_eigsh_fn(
+    unsigned int n, mat47_matvec_fn *fn, void *arg, unsigned int k,
+    enum mat47_eigsh_which which, mat47_t **vecs
+) {
+    stats(EIGSH_FN);
+
+    if (vecs) *vecs = NULL;
+    if (check_ptr(fn) || check(n, MAT47_ERR_ZERO_SIZE, ": n=0")) return NULL;
+    if (check_eigsh_args(n, k, which)) return NULL;
+
+    return eigsh(
+        &(struct eigsh){
+            .n = n, .k = k, .m = basis_size(n, k), .which = which, .fn = fn,
+            .arg = arg
+        },
+        vecs
+    );
+}
+
+
+/* Randomized SVD (Halko, Martinsson & Tropp): An orthonormal basis `q` of the range
+ * of `m * g`, for a random `g` of `l` columns, captures the `k` leading singular
+ * directions, such that the SVD of `transpose(q) * m` (`l` rows) gives those of `m`.
+ */
+
+// Maximum number of sweeps of one-sided Jacobi rotations
+#define JACOBI_MAX_SWEEPS 60
+
+// Rows of transposes are copied in blocks of this many, to reuse cache lines
+#define TRANSPOSE_BLOCK 32
+
+static void transpose_into(mat47_t *t, const mat47_t *m)
+{
+    unsigned int i0, j0, i, j;
+
+    for (i0 = 0; i0 < m->n_rows; i0 += TRANSPOSE_BLOCK)
+        for (j0 = 0; j0 < m->n_cols; j0 += TRANSPOSE_BLOCK)
+            for (i = i0; i < min(i0 + TRANSPOSE_BLOCK, m->n_rows); i++)
+                for (j = j0; j < min(j0 + TRANSPOSE_BLOCK, m->n_cols); j++)
+                    t->data[j][i] = m->data[i][j];
+}
+
+static mat47_t *transpose(const mat47_t *m)
+{
+    mat47_t *t;
+
+    if ((t = mat47__new(m->n_cols, m->n_rows, false))) transpose_into(t, m);
+
+    return t;
+}
+
+// Returns `transpose(transpose(a) * b)` i.e `transpose(b) * a`
+static mat47_t *mul_tn_t(const mat47_t *a, const mat47_t *b)
+{
+    mat47_t *at = transpose(a), *c = NULL, *ct = NULL;
+
+    if (at && (c = mat47__new(at->n_rows, b->n_cols, false))) {
+        mat47__gemm(
+            (view){c->data, 0}, (view){at->data, 0}, (view){b->data, 0}, at->n_rows,
+            at->n_cols, b->n_cols, 1, false
+        );
+        ct = transpose(c);
+    }
+    mat47_del(at);
+    mat47_del(c);
+
+    return ct;
+}
+
+/* CholeskyQR2 (Fukaya et al.): The `q` factor of a tall `n x l` matrix `a` is
+ * `a * inverse(r)`, where `transpose(r) * r` is the Cholesky factorization of the
+ * Gram matrix `transpose(a) * a`; Repeating it once makes `q` orthonormal to working
+ * precision. Both steps are independent over the rows of `a`, and `q` overwrites it.
+ *
+ * A pass fails if `a` is too ill-conditioned i.e a pivot is below `CHOLQR_MIN_PIVOT`
+ * times the diagonal element of the Gram matrix; `mat47_qr()` is then used instead.
+ */
+
+// Minimum relative pivot of the Cholesky factorization of Gram matrices
+#define CHOLQR_MIN_PIVOT 1e-12
+
+struct cholqr {
+    mat47_t *a;
+    unsigned int panel;  // Rows per panel
+    double *g;  // Gram matrix (then `r`), then one per panel
+};
+
+// Upper triangles of the Gram matrices of panels `begin` to `end` of `a`
+static void gram_range(void *arg, size_t begin, size_t end)
+{
+    struct cholqr *c = arg;
+    unsigned int l = c->a->n_cols, i, p, q;
+    double *restrict g, *x;
+
+    for (; begin < end; begin++) {
+        g = c->g + (begin + 1) * l * l;
+        memset(g, 0, sizeof(double) * l * l);
+        for (i = begin * c->panel; i < min((begin + 1) * c->panel, c->a->n_rows); i++)
+            for (x = c->a->data[i], p = 0; p < l; p++)
+                for (q = p; q < l; q++) g[p * l + q] += x[p] * x[q];
+    }
+}
+
+// `a[i] = a[i] * inverse(r)` for rows `begin` to `end`
+static void trsm_range(void *arg, size_t begin, size_t end)
+{
+    struct cholqr *c = arg;
+    unsigned int l = c->a->n_cols, j;
+    const double *restrict r = c->g;
+    double *x;
+
+    for (; begin < end; begin++)
+        for (x = c->a->data[begin], j = 0; j < l; j++) {
+            x[j] /= r[j * l + j];
+            mat47__axpy(x + j + 1, -x[j], r + j * l + j + 1, l - j - 1);
+        }
+}
+
+// One pass of CholeskyQR; Returns false, leaving `a` unchanged, if it fails
+static bool cholqr(struct cholqr *c, unsigned int n_panels)
+{
+    unsigned int l = c->a->n_cols, j, p, q;
+    double *restrict g = c->g, d;
+
+    mat47__parallel_for(n_panels, 1, gram_range, c);
+    memcpy(g, g + l * l, sizeof(double) * l * l);
+    for (p = 1; p < n_panels; p++)
+        for (j = 0; j < l * l; j++) g[j] += g[(p + 1) * l * l + j];
+
+    // `g = transpose(r) * r`, with `r` in the upper triangle
+    for (j = 0; j < l; j++) {
+        for (d = g[j * l + j], p = 0; p < j; p++) d -= g[p * l + j] * g[p * l + j];
+        if (!(d > CHOLQR_MIN_PIVOT * g[j * l + j])) {
+            debug("Pivot %g at column %u of %u, falling back to QR", d, j, l);
+            return false;
+        }
+        g[j * l + j] = d = sqrt(d);
+        for (q = j + 1; q < l; q++) {
+            for (p = 0; p < j; p++) g[j * l + q] -= g[p * l + j] * g[p * l + q];
+            g[j * l + q] /= d;
+        }
+    }
+
+    mat47__parallel_for(c->a->n_rows, PARALLEL_GRAIN / l + 1, trsm_range, c);
+    return true;
+}
+
+// `r = r2 * r`, for upper-triangular `l x l` matrices
+static void mul_upper(double **r, double **r2, unsigned int l)
+{
+    unsigned int i, j, p;
+    double s;
+
+    for (i = 0; i < l; i++)
+        for (j = i; j < l; j++) {
+            for (s = r2[i][i] * r[i][j], p = i + 1; p <= j; p++)
+                s += r2[i][p] * r[p][j];
+            r[i][j] = s;
+        }
+}
+
+/* Returns the thin `q` factor of `a`, or null on error, and stores `r` in `*r` unless
+ * `r` is null; Consumes `a`.
+ */
+static mat47_t *orthonormalize(mat47_t *a, mat47_t **r)
+{
+    unsigned int l = a->n_cols, n_panels, passes = 0, i;
+    struct cholqr c = {a, max(l, PARALLEL_GRAIN / l), NULL};
+    mat47_t *r1 = NULL, *r2 = NULL, *q;
+
+    n_panels = (a->n_rows + c.panel - 1) / c.panel;
+    if (
+        a->n_rows >= l
+        && (!r || ((r1 = mat47__new(l, l, true)) && (r2 = mat47__new(l, l, true))))
+        && (c.g = malloc(sizeof(double) * l * l * (n_panels + 1)))
+    )
+        for (; passes < 2 && cholqr(&c, n_panels); passes++)
+            for (i = 0; r && i < l; i++)
+                memcpy(
+                    (passes ? r2 : r1)->data[i] + i, c.g + i * l + i,
+                    sizeof(double) * (l - i)
+                );
+    free(c.g);
+
+    // Householder QR of `a`, or of the `q` factor of the first pass
+    if (passes < 2) {
+        mat47_del(r2);
+        q = mat47_qr(a, &r2);
+        mat47_del(a);
+        if (!(a = q)) {
+            mat47_del(r1);
+            return NULL;
+        }
+    }
+
+    if (r && passes) {
+        mul_upper(r1->data, r2->data, l);
+        *r = r1;
+    } else if (r) {
+        mat47_del(r1);
+        *r = r2;
+        r2 = NULL;
+    }
+    mat47_del(r2);
+
+    return a;
+}
+
+// Returns `a * b`, or null on error
+static void mul_nn_into(mat47_t *c, const mat47_t *a, const mat47_t *b)
+{
+    mat47__gemm(
+        (view){c->data, 0}, (view){a->data, 0}, (view){b->data, 0}, a->n_rows,
+        a->n_cols, b->n_cols, 1, false
+    );
+}
+
+static mat47_t *mul_nn(const mat47_t *a, const mat47_t *b)
+{
+    mat47_t *c;
+
+    if ((c = mat47__new(a->n_rows, b->n_cols, false))) mul_nn_into(c, a, b);
+
+    return c;
+}
+
+/* One-sided Jacobi SVD of the `n x n` matrix `a`: Rotates pairs of its columns until
+ * they're orthogonal, accumulating the rotations into `v`, such that `a` becomes
+ * `u * diag(s)` and `a = u * diag(s) * transpose(v)`.
+ */
+static void jacobi_svd(unsigned int n, double **a, double **v)
+{
+    unsigned int sweep, p, q, i;
+    double alpha, beta, gamma, zeta, t, c, s, x, y;
+    bool rotated = true;
+
+    for (i = 0; i < n; i++) {
+        memset(v[i], 0, sizeof(double) * n);
+        v[i][i] = 1;
+    }
+
+    for (sweep = 0; rotated && sweep < JACOBI_MAX_SWEEPS; sweep++) {
+        rotated = false;
+        for (p = 0; p + 1 < n; p++)
+            for (q = p + 1; q < n; q++) {
+                for (alpha = beta = gamma = 0, i = 0; i < n; i++) {
+                    alpha += a[i][p] * a[i][p];
+                    beta += a[i][q] * a[i][q];
+                    gamma += a[i][p] * a[i][q];
+                }
+                if (!(fabs(gamma) > DBL_EPSILON * sqrt(alpha * beta))) continue;
+
+                rotated = true;
+                zeta = (beta - alpha) / (2 * gamma);
+                t = copysign(1, zeta) / (fabs(zeta) + hypot(1, zeta));
+                c = 1 / hypot(1, t);
+                s = c * t;
+                for (i = 0; i < n; i++) {
+                    x = a[i][p], y = a[i][q];
+                    a[i][p] = c * x - s * y;
+                    a[i][q] = s * x + c * y;
+                    x = v[i][p], y = v[i][q];
+                    v[i][p] = c * x - s * y;
+                    v[i][q] = s * x + c * y;
+                }
+            }
+    }
+    debug("Jacobi SVD of %u x %u: %u sweep(s)", n, n, sweep);
+}
+
+mat47_t *mat47_rsvd(
+    const mat47_t *m, unsigned int k, unsigned int oversample, unsigned int power_iters,
+    mat47_t **u, mat47_t **vt
+) {
+    stats(RSVD);
+    unsigned int i, j, l, *order = NULL, tmp;
+    uint64_t seed = UINT64_C(0x9E3779B97F4A7C15);
+    mat47_t *y = NULL, *q = NULL, *r = NULL, *vr = NULL, *x = NULL, *s = NULL;
+    double *sigma = NULL;
+
+    if (u) *u = NULL;
+    if (vt) *vt = NULL;
+    if (check_ptr(m) || check(k, MAT47_ERR_ZERO_SIZE, ": k=0")) return NULL;
+    l = min(m->n_rows, m->n_cols);
+    if (check(k <= l, MAT47_ERR_INVALID_ARG, ": k=%u > %u", k, l)) return NULL;
+    l = min(l, k + min(oversample, l));
+
+    // Range of `m`
+    if (!(x = mat47__new(m->n_cols, l, false))) goto fail;
+    for (i = 0; i < m->n_cols; i++)
+        for (j = 0; j < l; j++) x->data[i][j] = random_elem(&seed);
+    y = mul_nn(m, x);
+    mat47_del(x);
+    x = NULL;
+    if (!y || !(q = orthonormalize(y, NULL))) goto fail;
+    for (unsigned int it = 0; it < power_iters; it++) {
+        x = mul_tn_t(q, m);
+        mat47_del(q);
+        q = NULL;
+        if (!x || !(x = orthonormalize(x, NULL))) goto fail;
+        y = mul_nn(m, x);
+        mat47_del(x);
+        x = NULL;
+        if (!y || !(q = orthonormalize(y, NULL))) goto fail;
+    }
+
+    // `transpose(transpose(q) * m) = x * r`, and `r = ur * diag(s) * transpose(vr)`
+    if (
+        !(x = mul_tn_t(q, m)) || !(x = orthonormalize(x, &r))
+        || !(vr = mat47__new(l, l, false))
+    ) goto fail;
+    jacobi_svd(l, r->data, vr->data);
+
+    sigma = malloc(sizeof(double) * l);
+    order = malloc(sizeof(unsigned int) * l);
+    if (!(sigma && order)) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the singular values");
+        goto fail;
+    }
+    for (j = 0; j < l; j++) {
+        for (sigma[j] = 0, i = 0; i < l; i++) sigma[j] += r->data[i][j] * r->data[i][j];
+        sigma[j] = sqrt(sigma[j]);
+        order[j] = j;
+    }
+    for (i = 1; i < l; i++)
+        for (j = i; j && sigma[order[j]] > sigma[order[j - 1]]; j--)
+            tmp = order[j], order[j] = order[j - 1], order[j - 1] = tmp;
+    // Rounding errors, rather than singular values
+    for (j = 0; j < l; j++)
+        if (sigma[order[j]] <= l * DBL_EPSILON * sigma[order[0]]) sigma[order[j]] = 0;
+
+    if (!(s = mat47__new(k, 1, false))) goto fail;
+    for (j = 0; j < k; j++) s->data[j][0] = sigma[order[j]];
+
+    // `u = q * vr` and `vt = transpose(x * ur)`, for the `k` leading columns
+    if (u) {
+        mat47_t *vk;
+
+        if (!(vk = mat47__new(l, k, false))) goto fail;
+        for (i = 0; i < l; i++)
+            for (j = 0; j < k; j++) vk->data[i][j] = vr->data[i][order[j]];
+        *u = mul_nn(q, vk);
+        mat47_del(vk);
+        if (!*u) goto fail;
+    }
+    if (vt) {
+        mat47_t *ukt;
+
+        if (!(ukt = mat47__new(k, l, false))) goto fail;
+        for (j = 0; j < k; j++)
+            for (i = 0; i < l; i++)
+                ukt->data[j][i] = sigma[order[j]] > 0
+                    ? r->data[i][order[j]] / sigma[order[j]] : 0;
+        if ((*vt = mat47_zero(k, m->n_cols)))
+            mat47__gemm_nt(
+                (view){(*vt)->data, 0}, (view){ukt->data, 0}, (view){x->data, 0}, k,
+                l, m->n_cols, 1
+            );
+        mat47_del(ukt);
+        if (!*vt) goto fail;
+    }
+
+    mat47_del(q); mat47_del(x); mat47_del(r); mat47_del(vr);
+    free(sigma);
+    free(order);
+    return s;
+
+fail:
+    mat47_del(q); mat47_del(x); mat47_del(r); mat47_del(vr);
+    mat47_del(s);
+    free(sigma);
+    free(order);
+    if (u) {
+        mat47_del(*u);
+        *u = NULL;
+    }
+    if (vt) {
+        mat47_del(*vt);
+        *vt = NULL;
+    }
+    return NULL;
+}
+
+
+/* Matrix power and exponential.
+ *
+ * Temporaries are kept in a workspace, such that repeated calls allocate nothing;
+ * Products are computed with `mat47__mul_square()` and the LU factorization by
+ * running the tasks of `lu_tasks_double()` in order.
+ */
+
+// Number of temporaries used by `mat47_expm_into()`; `mat47_pow_into()` uses one.
+#define EXPM_N_TMP 7
+
+// `p`, `vt`, `q` and `c` of `mat47_inv_update()`
+#define UPDATE_N_TMP 4
+
+struct mat47_workspace {
+    unsigned int n;
+    mat47_t *tmp[EXPM_N_TMP];  // Allocated as first needed
+    unsigned int *piv;
+    double *col_sums;  // `MAT47__NORM_1_SCRATCH(n)` elements
+
+    // The temporaries of `mat47_inv_update()`, for the rank it was last used with
+    mat47_t *update[UPDATE_N_TMP];
+    double *cap;  // `I + c`, packed for its factorization
+    unsigned int *cap_piv, rank;
+
+    // The Strassen-Winograd workspace, for the crossover it was last reserved for
+    void *mul;
+    size_t mul_size;
+    unsigned int crossover;
+};
+
+mat47_workspace_t *mat47_workspace_new(unsigned int n)
+{
+    mat47_workspace_t *ws;
+
+    if (check(n, MAT47_ERR_ZERO_SIZE, ": n=0")) return NULL;
+
+    if (
+        !(ws = calloc(1, sizeof(mat47_workspace_t)))
+        || !(ws->piv = malloc(sizeof(unsigned int) * n))
+        || !(ws->col_sums = malloc(sizeof(double) * MAT47__NORM_1_SCRATCH(n)))
+    ) {
+        if (ws) free(ws->piv);
+        free(ws);
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for workspace");
+        return NULL;
+    }
+    ws->n = n;
+
+    return ws;
+}
+
+static void del_update(mat47_workspace_t *ws)
+{
+    for (unsigned int i = 0; i < UPDATE_N_TMP; i++) {
+        mat47_del(ws->update[i]);
+        ws->update[i] = NULL;
+    }
+    free(ws->cap);
+    free(ws->cap_piv);
+    ws->cap = NULL;
+    ws->cap_piv = NULL;
+    ws->rank = 0;
+}
+
+void mat47_workspace_del(mat47_workspace_t *ws)
+{
+    if (!ws) return;
+
+    for (unsigned int i = 0; i < EXPM_N_TMP; i++) mat47_del(ws->tmp[i]);
+    del_update(ws);
+    if (ws->mul) stats_free(ws->mul_size);
+    free(ws->mul);
+    free(ws->piv);
+    free(ws->col_sums);
+    free(ws);
+}
+
+unsigned int mat47__workspace_n(const mat47_workspace_t *ws)
+{
+    return ws->n;
+}
+
+void *mat47__workspace_mul(mat47_workspace_t *ws, unsigned int crossover)
+{
+    unsigned int n = ws->n;
+    size_t size = n > crossover ? mat47__mul_square_size(n, crossover) : 0;
+
+    if (size > ws->mul_size) {
+        if (ws->mul) stats_free(ws->mul_size);
+        free(ws->mul);
+        ws->mul_size = 0;
+        if (!(ws->mul = malloc(size))) return NULL;
+        stats_alloc(1, size);
+        ws->mul_size = size;
+    }
+    ws->crossover = crossover;
+
+    return ws->mul;
+}
+
+// Allocates the first `n_tmp` temporaries and the Strassen-Winograd workspace, if
+// not yet allocated
+static bool reserve(mat47_workspace_t *ws, unsigned int n_tmp)
+{
+    unsigned int n = ws->n, crossover = mat47_get_strassen_crossover();
+
+    for (unsigned int i = 0; i < n_tmp; i++)
+        if (!ws->tmp[i] && !(ws->tmp[i] = mat47__new(n, n, false))) return false;
+
+    if (n > crossover && !mat47__workspace_mul(ws, crossover)) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the Strassen-Winograd workspace");
+        return false;
+    }
+    ws->crossover = crossover;
+
+    return true;
+}
+
+static inline void mul_ws(
+    mat47_workspace_t *ws, mat47_t *c, const mat47_t *a, const mat47_t *b
+) {
+    mat47__mul_square(c, a, b, ws->crossover, ws->mul);
+}
+
+static void set_identity(mat47_t *m)
+{
+    for (unsigned int i = 0; i < m->n_rows; i++) {
+        memset(m->data[i], 0, sizeof(double) * m->n_cols);
+        m->data[i][i] = 1;
+    }
+}
+
+static bool check_pow_args(
+    const mat47_t *dst, const mat47_t *m, const mat47_workspace_t *ws
+) {
+    return check_ptr(dst) || check_ptr(m) || check_eq(m->n_rows, m->n_cols)
+        || check_eq(dst->n_rows, m->n_rows) || check_eq(dst->n_cols, m->n_cols)
+        || (ws && check_eq(ws->n, m->n_rows))
+        || check(
+            dst != m, MAT47_ERR_INVALID_ARG, ": dst @ %p is also m", (void *)dst
+        );
+}
+
+// Returns false on failure
+static bool pow_into(
+    mat47_t *dst, const mat47_t *m, unsigned int k, mat47_workspace_t *ws
+) {
+    unsigned int bit, b, n_products;
+    mat47_t *p, *other;
+
+    if (!k) {
+        set_identity(dst);
+        return true;
+    }
+    if (!reserve(ws, 1)) return false;
+
+    // Starting such that the last product lands in `dst`
+    for (bit = UINT_MAX / 2 + 1; !(k & bit); bit >>= 1);
+    for (n_products = 0, b = bit >> 1; b; b >>= 1) n_products += 1 + !!(k & b);
+    p = n_products % 2 ? ws->tmp[0] : dst;
+    mat47_copy_into(p, m);
+
+    for (bit >>= 1; bit; bit >>= 1) {
+        other = p == dst ? ws->tmp[0] : dst;
+        mul_ws(ws, other, p, p);
+        p = other;
+        if (k & bit) {
+            other = p == dst ? ws->tmp[0] : dst;
+            mul_ws(ws, other, p, m);
+            p = other;
+        }
+    }
+    debug("Power %u with %u product(s)", k, n_products);
+
+    return true;
+}
+
+mat47_t *mat47_pow(const mat47_t *m, unsigned int k)
+{
+    stats(POW);
+    mat47_workspace_t *ws;
+    mat47_t *p;
+
+    if (check_ptr(m) || check_eq(m->n_rows, m->n_cols)) return NULL;
+    if (!(ws = mat47_workspace_new(m->n_rows))) return NULL;
+
+    if ((p = mat47__new(m->n_rows, m->n_cols, false)) && !pow_into(p, m, k, ws)) {
+        mat47_del(p);
+        p = NULL;
+    }
+    mat47_workspace_del(ws);
+
+    return p;
+}
+
+void mat47_pow_into(
+    mat47_t *dst, const mat47_t *m, unsigned int k, mat47_workspace_t *ws
+) {
+    stats(POW_INTO);
+    mat47_workspace_t *own = NULL;
+
+    if (check_pow_args(dst, m, ws)) return;
+    if (!ws && !(ws = own = mat47_workspace_new(m->n_rows))) return;
+
+    bump_version(dst);
+    pow_into(dst, m, k, ws);
+    mat47_workspace_del(own);
+}
+
+
+/* Exponential: Scaling and squaring, with the Padé approximants and bounds on the
+ * 1-norm (`theta`) of Higham (2005), "The scaling and squaring method for the matrix
+ * exponential revisited".
+ */
+
+static const struct pade {
+    unsigned int q;
+    double theta;
+    double b[14];
+} pade[] = {
+    {3, 1.495585217958292e-2, {120, 60, 12, 1}},
+    {5, 2.539398330063230e-1, {30240, 15120, 3360, 420, 30, 1}},
+    {7, 9.504178996162932e-1, {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1}},
+    {
+        9, 2.097847961257068,
+        {
+            17643225600., 8821612800., 2075673600., 302702400., 30270240., 2162160.,
+            110880., 3960., 90., 1.
+        }
+    },
+    {
+        13, 5.371920351148152,
+        {
+            64764752532480000., 32382376266240000., 7771770303897600.,
+            1187353796428800., 129060195264000., 10559470521600., 670442572800.,
+            33522128640., 1323241920., 40840800., 960960., 16380., 182., 1.
+        }
+    },
+};
+
+// `dst = id * I + coefs[0] * terms[0] + ...` (`+ dst`, if `accumulate`), by rows
+struct combine_args {
+    mat47_t *dst;
+    const mat47_t *const *terms;
+    const double *coefs;
+    unsigned int n_terms;
+    double id;
+    bool accumulate;
+};
+
+static void combine_range(void *args, size_t begin, size_t end)
+{
+    struct combine_args *g = args;
+    unsigned int n = g->dst->n_cols;
+    double *d;
+
+    for (size_t i = begin; i < end; i++) {
+        d = g->dst->data[i];
+        if (!g->accumulate) memset(d, 0, sizeof(double) * n);
+        for (unsigned int t = 0; t < g->n_terms; t++)
+            mat47__axpy(d, g->coefs[t], g->terms[t]->data[i], n);
+        d[i] += g->id;
+    }
+}
+
+static void combine(
+    mat47_t *dst, unsigned int n_terms, const mat47_t *const *terms,
+    const double *coefs, double id, bool accumulate
+) {
+    struct combine_args args = {dst, terms, coefs, n_terms, id, accumulate};
+
+    mat47__parallel_for(
+        dst->n_rows, PARALLEL_GRAIN / ((size_t)dst->n_cols * (n_terms + 1)) + 1,
+        combine_range, &args
+    );
+}
+
+// `b = inverse(a) * b`, given the LU factorization `a` (i.e `p * a = l * u`)
+static void lu_solve_in_place(const mat47_t *a, const unsigned int *piv, mat47_t *b)
+{
+    unsigned int n = a->n_rows, nt = n_tiles(n), i, k, r, p, h;
+    double **x = b->data;
+
+    for (r = 0; r < n; r++) if (piv[r] != r) swap_rows_double(x[r], x[piv[r]], n);
+
+    // Forward substitution, with the unit lower triangle, by rows of tiles
+    for (k = 0; k < nt; k++) {
+        h = tile_dim(n, k);
+        for (r = k * TILE_SIZE + 1; r < k * TILE_SIZE + h; r++)
+            for (p = k * TILE_SIZE; p < r; p++)
+                mat47__axpy(x[r], -a->data[r][p], x[p], n);
+        for (i = k + 1; i < nt; i++)
+            mat47__gemm(
+                (view){x + (size_t)i * TILE_SIZE, 0}, tile(a, i, k),
+                (view){x + (size_t)k * TILE_SIZE, 0}, tile_dim(n, i), h, n, -1, true
+            );
+    }
+
+    // Back substitution, with the upper triangle
+    for (k = nt; k--;) {
+        h = tile_dim(n, k);
+        for (r = k * TILE_SIZE + h; r-- > k * TILE_SIZE;) {
+            for (p = r + 1; p < k * TILE_SIZE + h; p++)
+                mat47__axpy(x[r], -a->data[r][p], x[p], n);
+            for (p = 0; p < n; p++) x[r][p] /= a->data[r][r];
+        }
+        for (i = 0; i < k; i++)
+            mat47__gemm(
+                (view){x + (size_t)i * TILE_SIZE, 0}, tile(a, i, k),
+                (view){x + (size_t)k * TILE_SIZE, 0}, TILE_SIZE, h, n, -1, true
+            );
+    }
+}
+
+// Runs the tasks of `lu_tasks_double()` in their order of submission, without
+// allocating
+static void lu_in_order(struct lu_double *lu)
+{
+    unsigned int i, j, k, nt = n_tiles(lu->n);
+
+    for (k = 0; k < nt; k++) {
+        getrf_panel_double(lu, k, k, k);
+        for (j = k + 1; j < nt; j++) {
+            getrf_swap_trsm_double(lu, k, j, k);
+            for (i = k + 1; i < nt; i++) getrf_gemm_double(lu, i, j, k);
+        }
+        for (j = 0; j < k; j++) getrf_swap_trsm_double(lu, k, j, k);
+    }
+}
+
+// Returns false on failure
+static bool expm_into(mat47_t *dst, const mat47_t *m, mat47_workspace_t *ws)
+{
+    const struct pade *pd;
+    double norm = mat47__norm_1(m, ws->col_sums), scale, odd[4], even[4];
+    unsigned int s = 0, i, n_powers;
+    mat47_t **t = ws->tmp, *a, *u, *v, *w, *p, *out;
+    const mat47_t *const *powers = (const mat47_t *const *)t + 1;
+    struct lu_double lu;
+
+    if (
+        check(
+            norm >= 0 && norm <= DBL_MAX, MAT47_ERR_INVALID_ARG,
+            ": m has non-finite elements or 1-norm"
+        )
+    ) return false;
+    for (pd = pade; pd->q < 13 && norm > pd->theta; pd++);
+    if (norm > pd->theta) s = ceil(log2(norm / pd->theta));
+    if (!reserve(ws, EXPM_N_TMP)) return false;
+    a = t[0], u = t[5], v = t[6], w = t[1];
+    debug("Exponential with the [%u/%u] approximant, scaled by 2^-%u", pd->q, pd->q, s);
+
+    // Even powers of `a = m * 2^-s`, in `t[1]`, ..., `t[n_powers]`
+    scale = ldexp(1, -(int)s);
+    combine(a, 1, &m, &scale, 0, false);
+    n_powers = pd->q < 13 ? pd->q / 2 : 3;
+    mul_ws(ws, t[1], a, a);
+    for (i = 1; i < n_powers; i++) mul_ws(ws, t[i + 1], t[i], t[1]);
+
+    // `u = a * (b[1] * I + b[3] * a^2 + ...)` and `v = b[0] * I + b[2] * a^2 + ...`
+    if (pd->q < 13) {
+        for (i = 0; i < n_powers; i++) odd[i] = pd->b[2 * i + 3];
+        for (i = 0; i < n_powers; i++) even[i] = pd->b[2 * i + 2];
+        combine(u, n_powers, powers, odd, pd->b[1], false);
+        combine(v, n_powers, powers, even, pd->b[0], false);
+    } else {
+        // With the highest terms factored as products with `a^6`, in `t[3]`
+        combine(v, 3, powers, (double[]){pd->b[9], pd->b[11], pd->b[13]}, 0, false);
+        mul_ws(ws, u, t[3], v);
+        combine(u, 3, powers, (double[]){pd->b[3], pd->b[5], pd->b[7]}, pd->b[1], true);
+        combine(t[4], 3, powers, (double[]){pd->b[8], pd->b[10], pd->b[12]}, 0, false);
+        mul_ws(ws, v, t[3], t[4]);
+        combine(v, 3, powers, (double[]){pd->b[2], pd->b[4], pd->b[6]}, pd->b[0], true);
+    }
+    mul_ws(ws, w, a, u);
+
+    // `inverse(v - w) * (v + w)`, in `v`
+    combine(u, 2, (const mat47_t *[]){v, w}, (double[]){1, -1}, 0, false);
+    combine(v, 1, (const mat47_t *[]){w}, (double[]){1}, 0, true);
+    lu = (struct lu_double){u->data, m->n_rows, ws->piv, false};
+    lu_in_order(&lu);
+    if (atomic_load(&lu.singular)) {
+        mat47_errno = MAT47_ERR_SINGULAR;
+        error(": zero pivot in the Pade approximant");
+        return false;
+    }
+    lu_solve_in_place(u, ws->piv, v);
+
+    // Squared `s` times, alternating such that the last product lands in `dst`
+    for (p = v, i = 0; i < s; i++, p = out) {
+        out = (s - i) % 2 ? dst : a;
+        mul_ws(ws, out, p, p);
+    }
+    if (p != dst) mat47_copy_into(dst, p);
+
+    return true;
+}
+
+mat47_t *mat47_expm(const mat47_t *m)
+{
+    stats(EXPM);
+    mat47_workspace_t *ws;
+    mat47_t *e;
+
+    if (check_ptr(m) || check_eq(m->n_rows, m->n_cols)) return NULL;
+    if (!(ws = mat47_workspace_new(m->n_rows))) return NULL;
+
+    if ((e = mat47__new(m->n_rows, m->n_cols, false)) && !expm_into(e, m, ws)) {
+        mat47_del(e);
+        e = NULL;
+    }
+    mat47_workspace_del(ws);
+
+    return e;
+}
+
+void mat47_expm_into(mat47_t *dst, const mat47_t *m, mat47_workspace_t *ws)
+{
+    stats(EXPM_INTO);
+    mat47_workspace_t *own = NULL;
+
+    if (check_pow_args(dst, m, ws)) return;
+    if (!ws && !(ws = own = mat47_workspace_new(m->n_rows))) return;
+
+    bump_version(dst);
+    expm_into(dst, m, ws);
+    mat47_workspace_del(own);
+}
+
+
+/* Sherman-Morrison-Woodbury update of an inverse */
+
+// Allocates the temporaries of a rank-`k` update, unless allocated for that rank
+static bool reserve_update(mat47_workspace_t *ws, unsigned int k)
+{
+    unsigned int i, n = ws->n, rows[] = {n, k, k, k}, cols[] = {k, n, n, k};
+
+    if (ws->rank == k) return true;
+
+    del_update(ws);
+    for (i = 0; i < UPDATE_N_TMP; i++)
+        if (!(ws->update[i] = mat47__new(rows[i], cols[i], false))) return false;
+    if (
+        !(ws->cap = malloc(sizeof(double) * (size_t)k * k))
+        || !(ws->cap_piv = malloc(sizeof(unsigned int) * k))
+    ) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the capacitance matrix");
+        return false;
+    }
+    ws->rank = k;
+
+    return true;
+}
+
+static void inv_update(
+    mat47_t *inv, const mat47_t *u, const mat47_t *v, mat47_workspace_t *ws
+) {
+    unsigned int i, j, n = inv->n_rows, k = u->n_cols, *piv;
+    mat47_t *p, *vt, *q, *c;
+    double *cc, t;
+
+    if (!reserve_update(ws, k)) return;
+    p = ws->update[0], vt = ws->update[1], q = ws->update[2], c = ws->update[3];
+    cc = ws->cap, piv = ws->cap_piv;
+
+    // `p = inv * u`, `q = transpose(v) * inv` and `c = I + transpose(v) * p`
+    mul_nn_into(p, inv, u);
+    transpose_into(vt, v);
+    mul_nn_into(q, vt, inv);
+    mul_nn_into(c, vt, p);
+    for (i = 0; i < k; i++) {
+        memcpy(cc + (size_t)i * k, c->data[i], sizeof(double) * k);
+        cc[(size_t)i * k + i] += 1;
+    }
+    if (lu_factor_double(k, cc, piv)) {
+        mat47_errno = MAT47_ERR_SINGULAR;
+        error(": the updated matrix is singular");
+        return;
+    }
+
+    // `q = inverse(c) * q`, in place
+    for (i = 0; i < k; i++)
+        if (piv[i] != i) swap_rows_double(q->data[i], q->data[piv[i]], n);
+    for (i = 1; i < k; i++)
+        for (j = 0; j < i; j++)
+            mat47__axpy(q->data[i], -cc[(size_t)i * k + j], q->data[j], n);
+    for (i = k; i--;) {
+        for (j = i + 1; j < k; j++)
+            mat47__axpy(q->data[i], -cc[(size_t)i * k + j], q->data[j], n);
+        for (t = 1 / cc[(size_t)i * k + i], j = 0; j < n; j++) q->data[i][j] *= t;
+    }
+
+    bump_version(inv);
+    mat47__gemm(
+        (view){inv->data, 0}, (view){p->data, 0}, (view){q->data, 0}, n, k, n, -1, true
+    );
+}
+
+void mat47_inv_update(
+    mat47_t *inv, const mat47_t *u, const mat47_t *v, mat47_workspace_t *ws
+) {
+    stats(INV_UPDATE);
+    mat47_workspace_t *own = NULL;
+
+    if (check_ptr(inv) || check_ptr(u) || check_ptr(v)) return;
+    if (
+        check_eq(inv->n_rows, inv->n_cols) || check_eq(u->n_rows, inv->n_rows)
+        || check_eq(v->n_rows, u->n_rows) || check_eq(v->n_cols, u->n_cols)
+        || (ws && check_eq(ws->n, inv->n_rows))
+    ) return;
+    if (!ws && !(ws = own = mat47_workspace_new(inv->n_rows))) return;
+
+    inv_update(inv, u, v, ws);
+    mat47_workspace_del(own);
+}
+
+
+/* Factorizations cached by `mat47_solve()`, if enabled.
+ *
+ * Keyed on the address and version of the coefficient matrix, at most one per matrix,
+ * in a list most recently used first and in a hash table of `CACHE_BUCKETS` chains
+ * (by address), such that lookups don't scan the list. An entry is referenced by the
+ * cache and by every solve using it, and deallocated with its last reference, such
+ * that it may be evicted during a solve. Deallocating a matrix drops its entry (see
+ * `mat47_del()`), hence a new matrix at the same address is never solved with it.
+ *
+ * Entries are deallocated without the lock held, since `mat47_del()` takes it.
+ */
+
+struct factor {
+    const mat47_t *a;
+    uint64_t version;
+    mat47_t *f;  // `l` of a Cholesky factorization, or `l` and `u` of an LU one
+    unsigned int *piv;  // Null for a Cholesky factorization
+    size_t size;  // In bytes
+    unsigned int refs;
+    struct factor *prev, *next;
+    struct factor *chain;  // Next in the same bucket
+};
+
+#define CACHE_BUCKET_BITS 6
+#define CACHE_BUCKETS (1 << CACHE_BUCKET_BITS)
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct factor *cache_head, *cache_tail, *buckets[CACHE_BUCKETS];
+static size_t cache_size;
+// Read without the lock, by `mat47_solve()` and `mat47__solve_forget()`
+static atomic_size_t cache_limit = MAT47_SOLVE_CACHE_DEFAULT_LIMIT;
+static atomic_uint n_cached;
+
+// The chain of the entry of `a`, if any (Fibonacci hashing)
+static struct factor **bucket(const mat47_t *a)
+{
+    uint64_t h = (uint64_t)(uintptr_t)a * UINT64_C(0x9E3779B97F4A7C15);
+
+    return &buckets[h >> (64 - CACHE_BUCKET_BITS)];
+}
+
+// Returns the entry of `a`, if any
+static struct factor *find(const mat47_t *a)
+{
+    struct factor *e;
+
+    for (e = *bucket(a); e && e->a != a; e = e->chain);
+    return e;
+}
+
+static void push_front(struct factor *e)
+{
+    e->prev = NULL;
+    if ((e->next = cache_head)) cache_head->prev = e;
+    else cache_tail = e;
+    cache_head = e;
+}
+
+static void unlink_factor(struct factor *e)
+{
+    *(e->prev ? &e->prev->next : &cache_head) = e->next;
+    *(e->next ? &e->next->prev : &cache_tail) = e->prev;
+}
+
+// Removes `e` from the cache, adding it to `dead` if no longer referenced
+static void drop(struct factor *e, struct factor **dead)
+{
+    struct factor **p;
+
+    for (p = bucket(e->a); *p != e; p = &(*p)->chain);
+    *p = e->chain;
+    unlink_factor(e);
+    cache_size -= e->size;
+    atomic_fetch_sub_explicit(&n_cached, 1, memory_order_relaxed);
+    e->prev = e->next = NULL;
+    if (!--e->refs) {
+        e->next = *dead;
+        *dead = e;
+    }
+}
+
+static void del_factors(struct factor *dead)
+{
+    struct factor *next;
+
+    for (; dead; dead = next) {
+        next = dead->next;
+        mat47_del(dead->f);
+        free(dead->piv);
+        free(dead);
+    }
+}
+
+// Evicts the least recently used entries, until the cache fits its limit
+static void evict(struct factor **dead)
+{
+    while (cache_size > cache_limit) drop(cache_tail, dead);
+}
+
+// Returns a reference to the entry of `a`, if any and up to date, as most recently used
+static struct factor *lookup(const mat47_t *a, struct factor **dead)
+{
+    struct factor *e;
+
+    if (!(e = find(a))) return NULL;
+    if (e->version != a->version) {
+        debug("Matrix @ %p modified since factorized", (void *)a);
+        drop(e, dead);
+        return NULL;
+    }
+
+    unlink_factor(e);
+    push_front(e);
+    e->refs++;
+
+    return e;
+}
+
+// Caches `e`, referenced by the caller, in place of any other entry of its matrix
+static void insert(struct factor *e, struct factor **dead)
+{
+    struct factor *old;
+
+    if ((old = find(e->a))) drop(old, dead);
+    if (e->size > cache_limit) return;
+
+    e->refs++;
+    push_front(e);
+    e->chain = *bucket(e->a);
+    *bucket(e->a) = e;
+    cache_size += e->size;
+    atomic_fetch_add_explicit(&n_cached, 1, memory_order_relaxed);
+    evict(dead);
+}
+
+static void release(struct factor *e)
+{
+    bool last;
+
+    pthread_mutex_lock(&cache_lock);
+    last = !--e->refs;
+    pthread_mutex_unlock(&cache_lock);
+    if (last) del_factors(e);
+}
+
+void mat47__solve_forget(const mat47_t *m)
+{
+    struct factor *e, *dead = NULL;
+
+    if (!atomic_load_explicit(&n_cached, memory_order_relaxed)) return;
+
+    pthread_mutex_lock(&cache_lock);
+    if ((e = find(m))) drop(e, &dead);
+    pthread_mutex_unlock(&cache_lock);
+    del_factors(dead);
+}
+
+
+size_t mat47_get_solve_cache_limit(void)
+{
+    return atomic_load(&cache_limit);
+}
+
+
+void mat47_set_solve_cache_limit(size_t bytes)
+{
+    struct factor *dead = NULL;
+
+    pthread_mutex_lock(&cache_lock);
+    cache_limit = bytes;
+    evict(&dead);
+    pthread_mutex_unlock(&cache_lock);
+    del_factors(dead);
+}
+
+
+// Symmetric, with a positive diagonal; i.e possibly positive definite
+static bool maybe_posdef(const mat47_t *a)
+{
+    for (unsigned int i = 0; i < a->n_rows; i++) {
+        if (!(a->data[i][i] > 0)) return false;
+        for (unsigned int j = 0; j < i; j++)
+            if (a->data[i][j] != a->data[j][i]) return false;
+    }
+
+    return true;
+}
+
+// Cholesky factorization if `a` is positive definite, otherwise LU factorization
+static struct factor *factorize(const mat47_t *a)
+{
+    unsigned int n = a->n_rows, errnum = mat47_errno;
+    struct factor *e;
+
+    if (!(e = malloc(sizeof(struct factor)))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the factorization");
+        return NULL;
+    }
+    *e = (struct factor){
+        .a = a, .version = a->version, .refs = 1,
+        .size = sizeof(struct factor) + (sizeof(double) * n + sizeof(double *)) * n
+    };
+
+    if (maybe_posdef(a)) {
+        if ((e->f = mat47_cholesky(a))) return e;
+        if (mat47_errno != MAT47_ERR_NOT_POSDEF) goto fail;
+        debug("Not positive definite; Using LU factorization");
+        mat47_errno = errnum;
+    }
+
+    if (!(e->piv = malloc(sizeof(unsigned int) * n))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for row interchanges");
+        goto fail;
+    }
+    if (!(e->f = mat47_lu(a, e->piv))) goto fail;
+    e->size += sizeof(unsigned int) * n;
+
+    return e;
+
+fail:
+    free(e->piv);
+    free(e);
+    return NULL;
+}
+
+struct solve_args {
+    const struct factor *e;
+    double *x;  // The right-hand sides, one after the other
+};
+
+// Solves for the right-hand sides [begin, end), in place
+static void solve_range(void *args, size_t begin, size_t end)
+{
+    struct solve_args *s = args;
+    const unsigned int *piv = s->e->piv;
+    unsigned int n = s->e->f->n_rows, i;
+    double **f = s->e->f->data, *restrict x, t;
+
+    for (; begin < end; begin++) {
+        x = s->x + begin * n;
+        if (piv)
+            for (i = 0; i < n; i++)
+                if (piv[i] != i) t = x[i], x[i] = x[piv[i]], x[piv[i]] = t;
+
+        // With `l`; Its diagonal is implicitly one, for LU
+        for (i = 0; i < n; i++) {
+            x[i] -= mat47__dot(f[i], x, i);
+            if (!piv) x[i] /= f[i][i];
+        }
+
+        // With `u`, by rows, or `transpose(l)`, by columns
+        for (i = n; i--;) {
+            if (piv) {
+                x[i] -= mat47__dot(f[i] + i + 1, x + i + 1, n - i - 1);
+                x[i] /= f[i][i];
+            } else {
+                x[i] /= f[i][i];
+                mat47__axpy(x, -x[i], f[i], i);
+            }
+        }
+    }
+}
+
+
+mat47_t *mat47_solve(const mat47_t *a, const mat47_t *b)
+{
+    stats(SOLVE);
+    struct factor *e = NULL, *dead = NULL;
+    struct solve_args s = {NULL, NULL};
+    unsigned int n, k, i, c;
+    bool use_cache;
+    mat47_t *x = NULL;
+
+    if (check_ptr(a) || check_ptr(b)) return NULL;
+    if (check_eq(a->n_rows, a->n_cols) || check_eq(a->n_rows, b->n_rows)) return NULL;
+    n = a->n_rows;
+    k = b->n_cols;
+
+    // The lock is never taken while the cache is disabled
+    if ((use_cache = atomic_load_explicit(&cache_limit, memory_order_relaxed))) {
+        pthread_mutex_lock(&cache_lock);
+        e = lookup(a, &dead);
+        pthread_mutex_unlock(&cache_lock);
+        del_factors(dead);
+    }
+    if (e) {
+        debug("Using the cached factorization of matrix @ %p", (void *)a);
+    } else {
+        if (!(e = factorize(a))) return NULL;
+        if (use_cache) {
+            dead = NULL;
+            pthread_mutex_lock(&cache_lock);
+            insert(e, &dead);
+            pthread_mutex_unlock(&cache_lock);
+            del_factors(dead);
+        }
+    }
+
+    // Every right-hand side is gathered into contiguous elements; A single one is
+    // solved for in place, in the storage of the solution
+    if (!(s.x = malloc(sizeof(double) * n * k))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for the right-hand sides");
+        goto cleanup;
+    }
+    if (k > 1 && !(x = mat47__new(n, k, false))) goto cleanup;
+    for (i = 0; i < n; i++)
+        for (c = 0; c < k; c++) s.x[(size_t)c * n + i] = b->data[i][c];
+
+    s.e = e;
+    mat47__parallel_for(k, PARALLEL_GRAIN / ((size_t)n * n) + 1, solve_range, &s);
+    if (k == 1) {
+        if ((x = mat47_adopt(n, 1, s.x, free))) s.x = NULL;
+    } else {
+        for (i = 0; i < n; i++)
+            for (c = 0; c < k; c++) x->data[i][c] = s.x[(size_t)c * n + i];
+    }
+
+cleanup:
+    free(s.x);
+    if (use_cache) release(e);
+    else del_factors(e);
+    return x;
+}
@@ -0,0 +1,596 @@
+/* Linear algebra routines
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_LINALG_H
+#define MAT47_LINALG_H
+
+#include "matrix.h"
+
+/**
+ * Solves a system of linear equations using mixed-precision iterative refinement.
+ *
+ * Args:
+ *     a: The (square) coefficient matrix
+ *     b: The right-hand side(s), one per column
+ *     iter: If not null, the location to store the refinement outcome in:
+ *
+ *       - ``>= 0``: The number of refinement iterations performed.
+ *       - ``< 0``: Refinement failed and the solution was computed entirely in double
+ *         precision. ``-1`` means the single-precision factorization could not be
+ *         used (e.g the matrix overflows or is singular in single precision) and any
+ *         other value means refinement did not converge.
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix *x* such that ``a * x = b``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *b* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* is not square or
+ *       the number of rows in *a* and *b* differ
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: *a* is singular
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * *a* is factorized (LU with partial pivoting) in single precision, by tiles in
+ * parallel as by :c:func:`mat47_lu`, then the solution is refined using residuals
+ * computed in double precision until it is accurate to double precision. If that
+ * does not happen within :c:macro:`MAT47_REFINE_MAX_ITER` iterations, the system is
+ * solved again using a double-precision factorization.
+ *
+ * Note:
+ *     This is usually about twice as fast as a double-precision solve for
+ *     well-conditioned systems. For ill-conditioned systems (condition number beyond
+ *     about ``1e8``), the fallback makes it slower.
+ */
+mat47_t *mat47_solve_mixed(const mat47_t *a, const mat47_t *b, int *iter);
+
+/** Maximum number of refinement iterations performed by :c:func:`mat47_solve_mixed` */
+#define MAT47_REFINE_MAX_ITER 30
+
+/**
+ * Computes the Cholesky factorization of a symmetric positive-definite matrix.
+ *
+ * Args:
+ *     a: The (square) matrix; Only its lower triangle is used.
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new lower-triangular matrix *l* such that
+ *       ``a = l * transpose(l)``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* is not square
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NOT_POSDEF`: *a* is not (numerically)
+ *       positive definite
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The factorization is tiled: Every step is a task over a few square tiles, which
+ * runs as soon as the tasks it depends on complete, on a pool of threads with
+ * work-stealing (see :c:func:`mat47_set_num_threads`). Hence, the factorization of
+ * a panel overlaps with the updates of the rest of the matrix by the previous ones.
+ */
+mat47_t *mat47_cholesky(const mat47_t *a);
+
+/**
+ * Downdates a Cholesky factorization by a rank-1 matrix, in place.
+ *
+ * Args:
+ *     l: The lower-triangular factor of ``a``, as by :c:func:`mat47_cholesky`,
+ *       replaced with that of ``a - x * transpose(x)``; Only its lower triangle is
+ *       used.
+ *     x: A vector of as many elements as *l* has rows, either a column vector
+ *       (``n x 1`` matrix) or a row vector (``1 x n`` matrix)
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *l* or *x* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *l* is not square or
+ *       *x* is not a vector of the required number of elements
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NOT_POSDEF`: *l* has a non-positive
+ *       diagonal element, or ``a - x * transpose(x)`` is not (numerically) positive
+ *       definite
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * e.g removes an observation from the factorization of a Gram matrix. As by
+ * LINPACK's ``DCHDD``: ``p = inverse(l) * x`` is computed first, which decides
+ * whether the downdate is possible (``norm(p) < 1``); The Givens rotations
+ * annihilating ``p`` against ``sqrt(1 - norm(p)^2)`` are then applied to *l*, one row
+ * at a time. Takes ``O(n^2)`` floating-point operations instead of ``O(n^3)`` for a
+ * new factorization. If any error occurs, *l* is left unchanged.
+ */
+void mat47_cholesky_downdate(mat47_t *l, const mat47_t *x);
+
+/**
+ * Updates a Cholesky factorization by a rank-1 matrix, in place.
+ *
+ * Args:
+ *     l: The lower-triangular factor of ``a``, as by :c:func:`mat47_cholesky`,
+ *       replaced with that of ``a + x * transpose(x)``; Only its lower triangle is
+ *       used.
+ *     x: A vector of as many elements as *l* has rows, either a column vector
+ *       (``n x 1`` matrix) or a row vector (``1 x n`` matrix)
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *l* or *x* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *l* is not square or
+ *       *x* is not a vector of the required number of elements
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NOT_POSDEF`: *l* has a non-positive
+ *       diagonal element
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * e.g adds an observation to the factorization of a Gram matrix. Every row of *l* is
+ * rotated (by Givens rotations) against *x*, as rotated by the rows above it, in
+ * ``O(n^2)`` floating-point operations instead of ``O(n^3)`` for a new factorization.
+ * If any error occurs, *l* is left unchanged.
+ */
+void mat47_cholesky_update(mat47_t *l, const mat47_t *x);
+
+/**
+ * Computes the LU factorization of a square matrix, with partial pivoting.
+ *
+ * Args:
+ *     a: The (square) matrix
+ *     piv: The location to store the row interchanges in, with room for as many
+ *       elements as *a* has rows; Row ``i`` was interchanged with row ``piv[i]``
+ *       (``>= i``), in order (as by LAPACK's ``DGETRF``, but zero-based).
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix holding *u* in its upper triangle and
+ *       *l*, without its unit diagonal, below it, such that ``p * a = l * u``, *p*
+ *       being the permutation given by *piv*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *piv* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* is not square
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: *a* is singular
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Tiled like :c:func:`mat47_cholesky`; Every panel (column of tiles) is factorized by
+ * a single task, such that pivots are searched for in whole columns.
+ */
+mat47_t *mat47_lu(const mat47_t *a, unsigned int *piv);
+
+/**
+ * Computes the (thin) QR factorization of a matrix.
+ *
+ * Args:
+ *     a: The matrix, with at least as many rows as columns
+ *     r: The location to store a pointer to a new upper-triangular matrix *r*
+ *       (``a->n_cols x a->n_cols``) in; Set to null if any error occurs.
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix *q*, of the same dimensions as *a* and
+ *       with orthonormal columns, such that ``a = q * r``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *r* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* has more columns
+ *       than rows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Tiled like :c:func:`mat47_cholesky`, with Householder reflectors; Every tile below
+ * the diagonal is annihilated against the diagonal tile above it, and *q* is
+ * generated by tasks of the same graph, overlapping with the end of the
+ * factorization.
+ */
+mat47_t *mat47_qr(const mat47_t *a, mat47_t **r);
+
+/** Which eigenvalues are computed by :c:func:`mat47_eigsh` */
+enum mat47_eigsh_which {
+    /** The largest (algebraically), in descending order */
+    MAT47_EIGSH_LARGEST,
+
+    /** The smallest (algebraically), in ascending order */
+    MAT47_EIGSH_SMALLEST,
+
+    /** Those of largest magnitude, in descending order of magnitude */
+    MAT47_EIGSH_LARGEST_MAGNITUDE
+};
+
+/**
+ * Tolerance of :c:func:`mat47_eigsh`: An eigenpair is converged when its residual
+ * norm is at most this times the largest magnitude of the approximate eigenvalues.
+ */
+#define MAT47_EIGSH_TOL 1e-12
+
+/** Maximum number of restarts performed by :c:func:`mat47_eigsh` */
+#define MAT47_EIGSH_MAX_RESTARTS 1000
+
+/**
+ * Computes a few eigenvalues and eigenvectors of a symmetric matrix.
+ *
+ * Args:
+ *     m: The (square) symmetric matrix
+ *     k: Number of eigenvalues to compute, at most as many as *m* has rows
+ *     which: Which eigenvalues to compute
+ *     vecs: If not null, the location to store a pointer to a new matrix
+ *       (``m->n_rows x k``) in, holding the (orthonormal) eigenvectors in its columns,
+ *       in the order of the eigenvalues; Set to null if any error occurs.
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new column vector of the *k* eigenvalues, in the
+ *       order given by *which*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *m* is not square
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: *k* is zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *k* exceeds the number of
+ *       rows of *m*, or *which* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NO_CONVERGENCE`: Not all the eigenpairs
+ *       converged within :c:macro:`MAT47_EIGSH_MAX_RESTARTS` restarts
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Uses the implicitly restarted Lanczos method, with full reorthogonalization: A
+ * Krylov basis of ``max(2 * k + 1, 20)`` vectors is built, one matrix-vector product
+ * (see :c:func:`mat47_gemv`) per vector, then compressed to *k* vectors by implicitly
+ * shifted QR steps on the projected tridiagonal matrix, using the unwanted Ritz values
+ * as shifts, until the wanted ones converge; Converged ones are kept in the basis
+ * over restarts, along with some of the others. Every restart takes at most
+ * ``max(k + 1, 20 - k)`` matrix-vector products and, beside *m*, memory for at most
+ * ``max(4 * k + 4, k + 33)`` vectors is used; Hence, this is much faster than a full
+ * eigendecomposition for small *k*.
+ *
+ * The starting vector is fixed, such that results are reproducible.
+ */
+mat47_t *mat47_eigsh(
+    const mat47_t *m, unsigned int k, enum mat47_eigsh_which which, mat47_t **vecs
+);
+
+/**
+ * A symmetric linear operator, computing ``y = a * x`` for some ``n x n`` matrix
+ * ``a``, used by :c:func:`mat47_eigsh_fn`.
+ *
+ * Args:
+ *     y: The product, ``n`` elements
+ *     x: The operand, ``n`` elements
+ *     arg: The argument given to :c:func:`mat47_eigsh_fn`
+ */
+typedef void mat47_matvec_fn(double *restrict y, const double *restrict x, void *arg);
+
+/**
+ * Computes a few eigenvalues and eigenvectors of a symmetric linear operator.
+ *
+ * Args:
+ *     n: The dimension of the operator
+ *     fn: The operator; Called once per matrix-vector product, from the calling
+ *       thread.
+ *     arg: The argument passed to *fn*
+ *     k: Number of eigenvalues to compute, at most *n*
+ *     which: Which eigenvalues to compute
+ *     vecs: Same as with :c:func:`mat47_eigsh`
+ *
+ * Returns:
+ *     Same as :c:func:`mat47_eigsh`.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *fn* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: *n* or *k* is zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *k* exceeds *n*, or
+ *       *which* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NO_CONVERGENCE`: Same as with
+ *       :c:func:`mat47_eigsh`
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Same as :c:func:`mat47_eigsh`, with the matrix-vector products computed by *fn*
+ * e.g for sparse or implicitly-defined matrices. Errors raised by *fn* are ignored.
+ */
+mat47_t *mat47_eigsh_fn(
+    unsigned int n, mat47_matvec_fn *fn, void *arg, unsigned int k,
+    enum mat47_eigsh_which which, mat47_t **vecs
+);
+
+/**
+ * Computes a truncated singular value decomposition of a matrix, by randomized
+ * projection.
+ *
+ * Args:
+ *     m: The matrix
+ *     k: The rank of the decomposition, at most the smaller dimension of *m*
+ *     oversample: Number of extra dimensions sampled beyond *k* (e.g ``10``), which
+ *       improves the accuracy; Limited, along with *k*, to the smaller dimension of
+ *       *m*.
+ *     power_iters: Number of power iterations (e.g ``2``), which improve the
+ *       accuracy if the singular values decay slowly, at the cost of two more passes
+ *       over *m* each
+ *     u: If not null, the location to store a pointer to a new matrix
+ *       (``m->n_rows x k``) in, holding the left singular vectors in its columns;
+ *       Set to null if any error occurs.
+ *     vt: If not null, the location to store a pointer to a new matrix
+ *       (``k x m->n_cols``) in, holding the right singular vectors in its rows; Set
+ *       to null if any error occurs.
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new column vector of the *k* largest (approximate)
+ *       singular values, in descending order, such that ``m`` is approximately
+ *       ``u * diag(s) * vt``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: *k* is zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *k* exceeds the smaller
+ *       dimension of *m*
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * With ``l = k + oversample``: The range of *m* is sampled by the product ``y = m *
+ * g`` with an ``m->n_cols x l`` random matrix ``g``, which is orthonormalized (see
+ * :c:func:`mat47_qr`) into ``q``, after the power iterations (each alternating
+ * between the ranges of ``transpose(m)`` and *m*, orthonormalizing after every
+ * product); Then, the ``l x l`` triangular factor of the QR factorization of
+ * ``transpose(transpose(q) * m)`` is decomposed by one-sided Jacobi rotations, and
+ * the singular vectors are mapped back through the orthonormal factors.
+ *
+ * The work is dominated by the ``2 + 2 * power_iters`` products with *m* (see
+ * :c:func:`mat47_mul`), each with a thin (``l``-column) matrix, and QR factorizations
+ * of thin matrices, all parallel; Only ``O(l * l * l)`` work is done serially. The
+ * random matrix is generated from a fixed seed, such that results are reproducible.
+ *
+ * Note:
+ *     The error of the approximation is close to the optimal (that of the exact
+ *     truncated decomposition), unless the singular values beyond the *k*-th decay
+ *     slowly. Singular values below ``l * DBL_EPSILON`` times the largest (e.g those
+ *     of a rank-deficient *m*, beyond its rank) are taken as zero, and the
+ *     corresponding rows of *vt* are zero.
+ */
+mat47_t *mat47_rsvd(
+    const mat47_t *m, unsigned int k, unsigned int oversample, unsigned int power_iters,
+    mat47_t **u, mat47_t **vt
+);
+
+/**
+ * Temporaries of :c:func:`mat47_pow_into`, :c:func:`mat47_expm_into`,
+ * :c:func:`mat47_mul_into` and :c:func:`mat47_inv_update`, for matrices of a given
+ * size, allocated as first needed and reused by later calls.
+ *
+ * A workspace must not be used by concurrent calls.
+ */
+typedef struct mat47_workspace mat47_workspace_t;
+
+/**
+ * Creates a workspace.
+ *
+ * Args:
+ *     n: The number of rows (and columns) of the matrices it's used with
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new workspace, which should be deallocated with
+ *       :c:func:`mat47_workspace_del`.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: *n* is zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Only vectors (of ``O(n)`` elements) are allocated here; Matrices are allocated by
+ * the first call that needs them.
+ */
+mat47_workspace_t *mat47_workspace_new(unsigned int n);
+
+/**
+ * Deallocates a workspace.
+ *
+ * Args:
+ *     ws: The workspace; If null, nothing is done.
+ */
+void mat47_workspace_del(mat47_workspace_t *ws);
+
+/**
+ * Raises a square matrix to a non-negative integer power.
+ *
+ * Args:
+ *     m: The matrix
+ *     k: The exponent
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix equal to ``m`` multiplied by itself *k*
+ *       times (the identity, if *k* is zero).
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *m* is not square
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * See :c:func:`mat47_pow_into`.
+ */
+mat47_t *mat47_pow(const mat47_t *m, unsigned int k);
+
+/**
+ * Raises a square matrix to a non-negative integer power, into an existing matrix.
+ *
+ * Args:
+ *     dst: The power, with the dimensions of *m*
+ *     m: The matrix
+ *     k: The exponent
+ *     ws: A workspace for matrices the size of *m* or, if null, one is created for
+ *       this call only
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *m* is not square, or
+ *       *dst* or *ws* is for a different size
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *dst* is the same
+ *       matrix as *m*
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Binary exponentiation, from the most significant bit of *k*: The power is squared
+ * for every bit and multiplied by *m* for every set bit, i.e less than ``2 *
+ * log2(k)`` products (see :c:func:`mat47_mul`), alternating between *dst* and a
+ * temporary such that the last lands in *dst*.
+ *
+ * Once *ws* holds the temporary (and the Strassen-Winograd workspace, for large
+ * matrices), no memory is allocated. *dst* must not share storage with *m*. If any
+ * error occurs, *dst* is left unchanged.
+ */
+void mat47_pow_into(
+    mat47_t *dst, const mat47_t *m, unsigned int k, mat47_workspace_t *ws
+);
+
+/**
+ * Computes the exponential of a square matrix.
+ *
+ * Args:
+ *     m: The matrix
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix equal to ``exp(m)``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *m* is not square
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *m* has non-finite
+ *       elements, or its 1-norm overflows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: The denominator of the
+ *       Padé approximant is singular
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * See :c:func:`mat47_expm_into`.
+ */
+mat47_t *mat47_expm(const mat47_t *m);
+
+/**
+ * Computes the exponential of a square matrix, into an existing matrix.
+ *
+ * Args:
+ *     dst: The exponential, with the dimensions of *m*
+ *     m: The matrix
+ *     ws: A workspace for matrices the size of *m* or, if null, one is created for
+ *       this call only
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *m* is not square, or
+ *       *dst* or *ws* is for a different size
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *dst* is the same
+ *       matrix as *m*, or *m* has non-finite elements, or its 1-norm overflows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: The denominator of the
+ *       Padé approximant is singular
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Scaling and squaring (Higham, 2005): ``m`` is scaled by ``2^-s``, such that its
+ * 1-norm (see :c:func:`mat47_norm_1`) is small enough for the ``[q/q]`` Padé
+ * approximant of the exponential, with the lowest ``q`` of 3, 5, 7, 9 and 13, to be
+ * accurate to double precision; The approximant ``inverse(v - u) * (v + u)`` is
+ * computed from even powers of the scaled matrix, with an LU factorization (see
+ * :c:func:`mat47_lu`), then squared ``s`` times.
+ *
+ * That's at most ``6 + s`` products (see :c:func:`mat47_mul`) and the equivalent of
+ * about three more, for the factorization and solution. Once *ws* holds the seven
+ * temporaries (and the Strassen-Winograd workspace, for large matrices), no memory is
+ * allocated. *dst* must not share storage with *m*. If any error occurs, *dst* is
+ * left unchanged.
+ */
+void mat47_expm_into(mat47_t *dst, const mat47_t *m, mat47_workspace_t *ws);
+
+/**
+ * Updates the inverse of a matrix after a low-rank change to the matrix, in place.
+ *
+ * Args:
+ *     inv: The (square) inverse of ``a``, replaced with that of
+ *       ``a + u * transpose(v)``
+ *     u: An ``n x k`` matrix, *inv* being ``n x n``
+ *     v: An ``n x k`` matrix
+ *     ws: A workspace for ``n x n`` matrices or, if null, one is created for this call
+ *       only
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *inv*, *u* or *v* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *inv* is not square, or
+ *       *u*, *v* or *ws* has the wrong dimensions
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: ``a + u * transpose(v)`` is
+ *       singular
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * With the Sherman-Morrison-Woodbury formula: ``inv - inv * u * inverse(c) *
+ * transpose(v) * inv``, where ``c = I + transpose(v) * inv * u`` is only ``k x k``;
+ * i.e ``O(n^2 * k)`` floating-point operations (about three products of ``n x n``
+ * and ``n x k`` matrices) instead of ``O(n^3)`` for a new inversion. With ``k = 1``,
+ * that's the Sherman-Morrison formula; e.g adding *r* to row ``i`` of ``a`` is
+ * ``u = e_i`` (column ``i`` of the identity) and ``v = transpose(r)``, and adding
+ * it to column ``i`` is ``u = r`` and ``v = e_i``.
+ *
+ * The temporaries (``3 * n * k + 2 * k^2`` elements) are held by *ws*, and
+ * reallocated only when *k* differs from that of the previous update with it; i.e a
+ * series of updates of the same rank allocates memory once. Rounding errors
+ * accumulate over many updates, which is why *inv* should be recomputed now and
+ * then. If any error occurs, *inv* is left unchanged.
+ */
+void mat47_inv_update(
+    mat47_t *inv, const mat47_t *u, const mat47_t *v, mat47_workspace_t *ws
+);
+
+/**
+ * Solves a system of linear equations, optionally reusing the factorization of the
+ * coefficient matrix across calls.
+ *
+ * Args:
+ *     a: The (square) coefficient matrix
+ *     b: The right-hand side(s), one per column
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix *x* such that ``a * x = b``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *b* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* is not square or
+ *       the number of rows in *a* and *b* differ
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_SINGULAR`: *a* is singular
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ *a* is factorized as by :c:func:`mat47_cholesky` if it's symmetric positive
+ * definite, otherwise as by :c:func:`mat47_lu`. Right-hand sides are solved for in
+ * parallel.
+ *
+ * The cache is disabled by default; it's enabled by setting a memory limit with
+ * :c:func:`mat47_set_solve_cache_limit`. The factorization is then cached along with
+ * the :c:member:`~mat47.version` of *a* and, until *a* is modified or deallocated,
+ * later calls with it skip the factorization, taking ``O(n^2 * k)`` floating-point
+ * operations for ``k`` right-hand sides instead of ``O(n^3)``.
+ *
+ * The cache holds at most one factorization per matrix, the least recently used ones
+ * being evicted beyond the limit. It's shared by all threads, and a cached
+ * factorization may be used by several at once.
+ *
+ * Attention:
+ *     While the cache is enabled, modifications of *a* through
+ *     :c:member:`~mat47.data` or :c:func:`mat47_row_ptr` must be followed by an
+ *     increment of its :c:member:`~mat47.version`, otherwise a stale factorization
+ *     is used.
+ */
+mat47_t *mat47_solve(const mat47_t *a, const mat47_t *b);
+
+/** The default memory limit of the cache of :c:func:`mat47_solve`: ``0`` (disabled) */
+#define MAT47_SOLVE_CACHE_DEFAULT_LIMIT ((size_t)0)
+
+/**
+ * Returns the memory limit of the cache of :c:func:`mat47_solve`.
+ *
+ * Returns:
+ *     The value last set with :c:func:`mat47_set_solve_cache_limit` or, if unset,
+ *     :c:macro:`MAT47_SOLVE_CACHE_DEFAULT_LIMIT`.
+ */
+size_t mat47_get_solve_cache_limit(void);
+
+/**
+ * Sets the memory limit of the cache of :c:func:`mat47_solve`.
+ *
+ * Args:
+ *     bytes: The memory the cached factorizations may use in total (e.g
+ *       ``(size_t)128 << 20`` for 128 MiB); ``0`` disables the cache.
+ *
+ * The least recently used factorizations are evicted until the cache fits the limit.
+ * A factorization larger than the limit isn't cached. Setting the limit to ``0`` then
+ * back to its previous value clears the cache.
+ */
+void mat47_set_solve_cache_limit(size_t bytes);
+
+#endif  // MAT47_LINALG_H
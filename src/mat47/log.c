@@ -0,0 +1,462 @@
+/* Logging
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "error.h"
+#include "matrix.h"
+#include "utils.h"
+
+// Number of records in a thread's log buffer
+#define RING_SIZE 256
+
+// Maximum size of a formatted log message, including the terminating null character
+#define MSG_SIZE 240
+
+// Maximum number of arguments of a record, including `*` widths and precisions
+#define MAX_ARGS 12
+
+// Size of the copies of a record's string arguments (or of its message, if formatted
+// by the logging thread), including their terminating null characters
+#define TEXT_SIZE 160
+
+FILE *MAT47_LOG_FILE;
+
+atomic_int mat47__log_level = MAT47_LOG_LEVEL_DEBUG;
+
+union arg {
+    intmax_t i;
+    uintmax_t u;
+    double d;
+    const void *p;
+    size_t offset;  // Of the copy of a string, in `text`
+};
+
+/* A log, formatted only when flushed.
+ *
+ * Formats are string literals, hence outlive records; Strings are copied, as they
+ * might not.
+ */
+struct record {
+    struct timespec time;
+    const char *format;  // Null if `text` holds the formatted message
+    union arg args[MAX_ARGS];
+    char text[TEXT_SIZE];
+};
+
+// A conversion specification: `%[flags][width][.precision][length]conv`
+struct spec {
+    const char *length;  // Start of the length modifier, or `conv` if none
+    char conv;
+    bool wide;  // `l` (for `c` and `s`), `L`, or unknown length modifier
+    unsigned int n_stars;  // `*` widths and precisions
+};
+
+/* A thread's log buffer.
+ *
+ * Single-producer (the owner thread), single-consumer (any thread flushing logs, while
+ * holding `rings_lock`). `head` and `tail` only ever increase; the buffer is full when
+ * they're `RING_SIZE` apart.
+ */
+struct ring {
+    atomic_size_t head;
+    atomic_size_t tail;
+    atomic_size_t n_dropped;
+    atomic_bool abandoned;  // The owner thread has exited
+    struct ring *next;
+    struct record records[RING_SIZE];
+};
+
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct ring *rings;
+static _Thread_local struct ring *thread_ring;
+
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+// Holds every thread's ring, only for the destructor to be called at thread exit
+static pthread_key_t ring_key;
+
+static struct {
+    pthread_mutex_t control_lock;  // Serializes starting and stopping
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_t thread;
+    bool running;
+    bool stop;
+    unsigned int interval_ms;
+} flusher = {
+    .control_lock = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER
+};
+
+
+static void abandon_ring(void *ring)
+{
+    thread_ring = NULL;
+    atomic_store_explicit(
+        &((struct ring *)ring)->abandoned, true, memory_order_release
+    );
+}
+
+static void init(void)
+{
+    pthread_key_create(&ring_key, abandon_ring);
+    atexit(mat47_log_flush);
+}
+
+static struct ring *new_ring(void)
+{
+    struct ring *ring;
+
+    pthread_once(&init_once, init);
+    if (!(ring = malloc(sizeof(struct ring)))) return NULL;
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->n_dropped, 0);
+    atomic_init(&ring->abandoned, false);
+    pthread_setspecific(ring_key, ring);
+
+    pthread_mutex_lock(&rings_lock);
+    ring->next = rings;
+    rings = ring;
+    pthread_mutex_unlock(&rings_lock);
+
+    return thread_ring = ring;
+}
+
+
+/* Parses the conversion specification starting at `p` (after the `%`).
+ *
+ * Returns a pointer past it.
+ */
+static const char *parse_spec(const char *p, struct spec *s)
+{
+    // Plain loops, as `strspn()` sets up a table per call
+    s->n_stars = 0;
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') p++;
+    if (*p == '*') p++, s->n_stars++;
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        if (*++p == '*') p++, s->n_stars++;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    s->length = p;
+    while (*p == 'h' || *p == 'l' || *p == 'j' || *p == 'z' || *p == 't') p++;
+    s->wide = p - s->length > 2 || (p > s->length && (*p == 'c' || *p == 's'));
+    s->conv = *p ? *p++ : '\0';
+
+    return p;
+}
+
+/* Reads an integer argument of conversion `s`, of the type implied by its length
+ * modifier; `h` and `hh` arguments are promoted to `int`, and converted when formatted.
+ */
+static uintmax_t int_arg(va_list *args, const struct spec *s)
+{
+    bool is_signed = s->conv == 'd' || s->conv == 'i';
+
+#define arg(T, UT) (is_signed ? (uintmax_t)va_arg(*args, T) : va_arg(*args, UT))
+    switch (s->length[0]) {
+    case 'l':
+        return (
+            s->length[1] == 'l'
+            ? arg(long long, unsigned long long) : arg(long, unsigned long)
+        );
+    case 'j': return arg(intmax_t, uintmax_t);
+    case 'z': case 't': return arg(ptrdiff_t, size_t);
+    default: return arg(int, unsigned int);
+    }
+#undef arg
+}
+
+/* Stores the arguments of a log, copying strings into `r->text`.
+ *
+ * Returns false if any can't be stored unformatted (e.g too many or `long double`).
+ */
+static bool store_args(struct record *r, const char *format, va_list *args)
+{
+    const char *p = format, *str;
+    size_t n = 0, used = 0, len;
+    struct spec s;
+
+    while ((p = strchr(p, '%'))) {
+        if (*++p == '%') {
+            p++;
+            continue;
+        }
+        p = parse_spec(p, &s);
+        if (s.wide || n + s.n_stars + 1 > MAX_ARGS) return false;
+
+        while (s.n_stars--) r->args[n++].i = va_arg(*args, int);
+        switch (s.conv) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+            r->args[n++].u = int_arg(args, &s);
+            break;
+        case 'c': r->args[n++].i = va_arg(*args, int); break;
+        case 'a': case 'A': case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+            r->args[n++].d = va_arg(*args, double);
+            break;
+        case 'p': r->args[n++].p = va_arg(*args, void *); break;
+        case 's':
+            // Truncated to the space left, if any; `used < TEXT_SIZE` always
+            if (!(str = va_arg(*args, const char *))) str = "(null)";
+            len = strnlen(str, TEXT_SIZE - 1 - used);
+            r->args[n++].offset = used;
+            memcpy(r->text + used, str, len);
+            r->text[used += len] = '\0';
+            used += used < TEXT_SIZE - 1;
+            break;
+        default: return false;
+        }
+    }
+
+    return true;
+}
+
+// Formats the message of a record into `msg`, of `MSG_SIZE`
+static void format_record(const struct record *r, char *msg)
+{
+    const char *p = r->format, *q;
+    char spec[32];
+    size_t len = 0, n = 0, k;
+    union arg a;
+    struct spec s;
+    int written, star;
+
+    if (!p) {
+        snprintf(msg, MSG_SIZE, "%s", r->text);
+        return;
+    }
+
+    while (*p && len < MSG_SIZE - 1) {
+        if (*p != '%' || p[1] == '%') {
+            msg[len++] = *p;
+            p += 1 + (*p == '%');
+            continue;
+        }
+
+        // The specification, with stars replaced, and integers formatted as
+        // `[u]intmax_t` (or `[unsigned] int`, for `h` and `hh`)
+        q = parse_spec(p + 1, &s);
+        for (k = 0; p < s.length; p++)
+            if (*p == '*') {
+                star = r->args[n++].i;
+                if (k < sizeof(spec) - 16) k += sprintf(spec + k, "%d", star);
+            } else if (k < sizeof(spec) - 16) {
+                spec[k++] = *p;
+            }
+        if (strchr("diouxX", s.conv)) {
+            if (*p == 'h') while (*p == 'h') spec[k++] = *p++;
+            else spec[k++] = 'j';
+        }
+        spec[k++] = s.conv;
+        spec[k] = '\0';
+        p = q;
+
+        a = r->args[n++];
+        switch (s.conv) {
+        case 'd': case 'i':
+            written = (
+                s.length[0] == 'h'
+                ? snprintf(msg + len, MSG_SIZE - len, spec, (int)a.i)
+                : snprintf(msg + len, MSG_SIZE - len, spec, a.i)
+            );
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            written = (
+                s.length[0] == 'h'
+                ? snprintf(msg + len, MSG_SIZE - len, spec, (unsigned int)a.u)
+                : snprintf(msg + len, MSG_SIZE - len, spec, a.u)
+            );
+            break;
+        case 'c': written = snprintf(msg + len, MSG_SIZE - len, spec, (int)a.i); break;
+        case 'p': written = snprintf(msg + len, MSG_SIZE - len, spec, a.p); break;
+        case 's':
+            written = snprintf(msg + len, MSG_SIZE - len, spec, r->text + a.offset);
+            break;
+        default: written = snprintf(msg + len, MSG_SIZE - len, spec, a.d);
+        }
+        if (written > 0) len = min(len + written, MSG_SIZE - 1);
+    }
+    msg[len] = '\0';
+}
+
+
+int mat47__log(const char *format, ...)
+{
+    struct ring *ring;
+    struct record *record;
+    size_t head;
+    va_list args, copy;
+
+    if (!(ring = thread_ring ? thread_ring : new_ring())) return 0;
+
+    head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) == RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->n_dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    // Formatted when flushed, unless the arguments can't be stored as such
+    record = &ring->records[head % RING_SIZE];
+    timespec_get(&record->time, TIME_UTC);
+    record->format = format;
+    va_start(args, format);
+    va_copy(copy, args);
+    if (!store_args(record, format, &args)) {
+        record->format = NULL;
+        vsnprintf(record->text, TEXT_SIZE, format, copy);
+    }
+    va_end(copy);
+    va_end(args);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return 0;
+}
+
+
+void mat47_log_flush(void)
+{
+    FILE *stream = MAT47_LOG_FILE ? MAT47_LOG_FILE : stderr;
+    struct ring *ring, **link;
+    struct record *record;
+    struct tm tm;
+    size_t head, tail, n_dropped;
+    char time_str[19];  // HH:MM:SS.NNNNNNNNN\0
+    char msg[MSG_SIZE];
+    bool abandoned;
+
+    pthread_mutex_lock(&rings_lock);
+
+    for (link = &rings; (ring = *link);) {
+        // Loaded before `head`, such that no record is lost when the ring is freed
+        abandoned = atomic_load_explicit(&ring->abandoned, memory_order_acquire);
+        head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+        for (
+            tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            tail != head;
+            tail++
+        ) {
+            record = &ring->records[tail % RING_SIZE];
+            strftime(
+                time_str, sizeof(time_str), "%T",
+                localtime_r(&record->time.tv_sec, &tm)
+            );
+            snprintf(
+                time_str + 8, sizeof(time_str) - 8, ".%09ld", record->time.tv_nsec
+            );
+            format_record(record, msg);
+            fprintf(stream, "(%s) %s\n", time_str, msg);
+        }
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+
+        n_dropped = atomic_exchange_explicit(&ring->n_dropped, 0, memory_order_relaxed);
+        if (n_dropped)
+            fprintf(stream, "(mat47) %zu log(s) dropped; Buffer full\n", n_dropped);
+
+        if (abandoned) {
+            *link = ring->next;
+            free(ring);
+        } else {
+            link = &ring->next;
+        }
+    }
+    fflush(stream);
+
+    pthread_mutex_unlock(&rings_lock);
+}
+
+
+enum mat47_log_level mat47_log_get_level(void)
+{
+    return atomic_load_explicit(&mat47__log_level, memory_order_relaxed);
+}
+
+
+void mat47_log_set_level(enum mat47_log_level level)
+{
+    atomic_store_explicit(&mat47__log_level, level, memory_order_relaxed);
+}
+
+
+static void *run_flusher(void *arg)
+{
+    struct timespec deadline;
+
+    (void)arg;
+    pthread_mutex_lock(&flusher.lock);
+    while (!flusher.stop) {
+        pthread_mutex_unlock(&flusher.lock);
+        mat47_log_flush();
+        pthread_mutex_lock(&flusher.lock);
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += flusher.interval_ms / 1000;
+        deadline.tv_nsec += flusher.interval_ms % 1000 * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        if (!flusher.stop)
+            pthread_cond_timedwait(&flusher.wake, &flusher.lock, &deadline);
+    }
+    pthread_mutex_unlock(&flusher.lock);
+
+    return NULL;
+}
+
+
+void mat47_log_start_flusher(unsigned int interval_ms)
+{
+    pthread_mutex_lock(&flusher.control_lock);
+
+    pthread_mutex_lock(&flusher.lock);
+    flusher.interval_ms = interval_ms;
+    flusher.stop = false;
+    pthread_mutex_unlock(&flusher.lock);
+
+    if (!flusher.running) {
+        if (pthread_create(&flusher.thread, NULL, run_flusher, NULL)) {
+            mat47_errno = MAT47_ERR_ALLOC;
+            error(" for log flusher thread");
+        } else {
+            flusher.running = true;
+        }
+    }
+
+    pthread_mutex_unlock(&flusher.control_lock);
+}
+
+
+void mat47_log_stop_flusher(void)
+{
+    pthread_mutex_lock(&flusher.control_lock);
+
+    if (flusher.running) {
+        pthread_mutex_lock(&flusher.lock);
+        flusher.stop = true;
+        pthread_cond_signal(&flusher.wake);
+        pthread_mutex_unlock(&flusher.lock);
+
+        pthread_join(flusher.thread, NULL);
+        flusher.running = false;
+    }
+
+    pthread_mutex_unlock(&flusher.control_lock);
+
+    mat47_log_flush();
+}
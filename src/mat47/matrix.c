@@ -4,6 +4,7 @@
  * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
  */
 
+#include <limits.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -21,30 +22,24 @@ _Thread_local unsigned int mat47_errno;
 
 
 /**
- * Allocates memory for a new matrix.
+ * Allocates memory for a new matrix object and its row pointers only.
  *
  * Args:
  *     n_rows: Number of rows
  *     n_cols: Number of columns
- *     zero: If true, all the matrix' elements are initialized to 0.0.
- *       Otherwise, the elements are uninitialized.
  *
  * Returns:
  *     - A null pointer, if either dimension equals zero or a failure occurs during
  *       memory allocation.
- *     - Otherwise, a pointer to a newly allocated matrix.
+ *     - Otherwise, a pointer to a newly allocated matrix whose row pointers are all
+ *       null.
  *
  * Raises:
  *     MAT47_ERR_ZERO_SIZE: Either dimension equals zero.
  *     MAT47_ERR_ALLOC: Unable to allocate memory.
- *
- * Note:
- *     Allocation of zeroed memory takes longer (tested).
  */
-static mat47_t *mat47_new(unsigned int n_rows, unsigned int n_cols, bool zero)
+static mat47_t *mat47_new_shell(unsigned int n_rows, unsigned int n_cols)
 {
-    double **restrict data;
-
     if (!(n_rows && n_cols)) {
         mat47_errno = MAT47_ERR_ZERO_SIZE;
         error(": %u x %u", n_rows, n_cols);
@@ -62,26 +57,99 @@ static mat47_t *mat47_new(unsigned int n_rows, unsigned int n_cols, bool zero)
 
     m->n_rows = n_rows;
     m->n_cols = n_cols;
+    m->block = NULL;
+    m->free_block = NULL;
+    m->version = 0;
+    m->row_cap = n_rows;
+    m->cap = 0;
     // Using `calloc()` to ensure all pointer are NULL, in case row allocation fails
-    if (!(m->data = data = calloc(sizeof(double *), n_rows))) {
+    if (!(m->data = calloc(sizeof(double *), n_rows))) {
         free(m);
         mat47_errno = MAT47_ERR_ALLOC;
         error(" for row pointers");
         return NULL;
     }
+    stats_alloc(2, sizeof(mat47_t) + sizeof(double *) * n_rows);
 
     debug("Allocated row pointers");
 
+    return m;
+}
+
+
+/**
+ * Sets up a matrix object to use a contiguous row-major buffer as its storage.
+ *
+ * Args:
+ *     m: A matrix returned by `mat47_new_shell()`
+ *     block: The buffer
+ *     free_block: The function to deallocate *block* with, or null if it's not owned
+ */
+static void
+mat47_use_block(mat47_t *m, double *restrict block, void (*free_block)(void *))
+{
+    double **restrict data = m->data;
+    unsigned int n_cols = m->n_cols;
+
+    m->block = block;
+    m->free_block = free_block;
+    m->cap = (size_t)m->n_rows * n_cols;
+    for (unsigned int i = 0; i < m->n_rows; i++, block += n_cols) data[i] = block;
+}
+
+
+/**
+ * Allocates memory for a new matrix.
+ *
+ * Args:
+ *     n_rows: Number of rows
+ *     n_cols: Number of columns
+ *     zero: If true, all the matrix' elements are initialized to 0.0.
+ *       Otherwise, the elements are uninitialized.
+ *
+ * Returns:
+ *     - A null pointer, if either dimension equals zero or a failure occurs during
+ *       memory allocation.
+ *     - Otherwise, a pointer to a newly allocated matrix.
+ *
+ * Raises:
+ *     MAT47_ERR_ZERO_SIZE: Either dimension equals zero.
+ *     MAT47_ERR_ALLOC: Unable to allocate memory.
+ *
+ * Note:
+ *     - Allocation of zeroed memory takes longer (tested).
+ *     - Matrices at least as large as the allocation policy's threshold are
+ *       allocated contiguously, as a memory mapping (see `mat47_set_alloc_policy()`).
+ */
+mat47_t *mat47__new(unsigned int n_rows, unsigned int n_cols, bool zero)
+{
+    double **restrict data, *block;
+    mat47_t *m;
+
+    if (!(m = mat47_new_shell(n_rows, n_cols))) return NULL;
+
+    // Large matrices are allocated contiguously, according to the allocation policy;
+    // Mapped memory is zeroed anyway.
+    if ((block = mat47__map_elements(n_rows, n_cols))) {
+        mat47_use_block(m, block, mat47__unmap_elements);
+        stats_alloc(1, sizeof(double) * n_rows * n_cols);
+        debug("Mapped elements");
+        return m;
+    }
+
+    data = m->data;
     for (unsigned int i = 0; i < n_rows; i++)
         if (!(data[i] = (
             zero ? calloc(sizeof(double), n_cols) : malloc(sizeof(double) * n_cols)
         ))) {
+            stats_alloc(i, sizeof(double) * i * n_cols);  // Freed by `mat47_del()`
             mat47_del(m);
             mat47_errno = MAT47_ERR_ALLOC;
             error(" for rows");
             return NULL;
         }
 
+    stats_alloc(n_rows, sizeof(double) * n_rows * n_cols);
     debug("Allocated rows, zero=%u", zero);
     debug(
         "[1, 1] = %f, [%d, %d] = %f",
@@ -94,128 +162,627 @@ static mat47_t *mat47_new(unsigned int n_rows, unsigned int n_cols, bool zero)
 
 mat47_t *mat47_zero(unsigned int n_rows, unsigned int n_cols)
 {
-    return mat47_new(n_rows, n_cols, true);
+    stats(ZERO);
+    return mat47__new(n_rows, n_cols, true);
 }
 
 
-#define init \
-    mat47_t *m; \
-    double **restrict data, *restrict data_row; \
-    restrict typeof(*array) row; \
-\
-    if (check_ptr(array)) return NULL; \
-    if (!(m = mat47_new(n_rows, n_cols, false))) return NULL; \
+void mat47_zero_into(mat47_t *m)
+{
+    stats(ZERO_INTO);
+
+    if (check_ptr(m)) return;
+
+    bump_version(m);
+    if (m->block)
+        memset(m->block, 0, sizeof(double) * m->n_rows * m->n_cols);
+    else
+        for (unsigned int i = 0; i < m->n_rows; i++)
+            memset(m->data[i], 0, sizeof(double) * m->n_cols);
+}
+
+
+// Elements converted per vector operation in `convert_*()`
+#define CONVERT_WIDTH 8
+
+struct convert_args {
+    const void *const *array;
+    double **data;
+    unsigned int n_cols;
+};
+
+/* Element type conversion kernels.
+ *
+ * Converts whole vectors at a time using the compiler's generic vector extension,
+ * which is lowered to the widest conversion instructions available for the target
+ * (e.g `cvtdq2pd` for `int32_t`, `pmovzxbd` + `cvtdq2pd` for `uint8_t`).
+ */
+#define convert(T) \
+static void convert_##T(double *restrict dst, const T *restrict src, unsigned int n) \
+{ \
+    typedef T src_vec __attribute__((vector_size(CONVERT_WIDTH * sizeof(T)))); \
+    typedef double dst_vec \
+        __attribute__((vector_size(CONVERT_WIDTH * sizeof(double)))); \
+    unsigned int j; \
+    src_vec s; \
+    dst_vec d; \
 \
-    data = m->data; \
-    while (n_rows--) { \
-        if (!(row = array[n_rows])) { \
-            mat47_del(m); \
-            mat47_errno = MAT47_ERR_NULL_PTR; \
-            error(": `array[%u]`", n_rows); \
-            return NULL; \
-        } \
-        data_row = data[n_rows]; \
-        for (unsigned int j = 0; j < n_cols; j++) \
-            data_row[j] = row[j]; \
+    for (j = 0; j + CONVERT_WIDTH <= n; j += CONVERT_WIDTH) { \
+        memcpy(&s, src + j, sizeof(s)); \
+        d = __builtin_convertvector(s, dst_vec); \
+        memcpy(dst + j, &d, sizeof(d)); \
     } \
+    for (; j < n; j++) dst[j] = src[j]; \
+} \
 \
-    return m;
-
-mat47_t *mat47_init_int8(uint n_rows, uint n_cols, int8_t **restrict array)
-{
-    init
+static void convert_rows_##T(void *args, size_t begin, size_t end) \
+{ \
+    struct convert_args *a = args; \
+\
+    for (; begin < end; begin++) \
+        convert_##T(a->data[begin], a->array[begin], a->n_cols); \
 }
 
-mat47_t *mat47_init_int16(uint n_rows, uint n_cols, int16_t **restrict array)
+convert(int8_t)
+convert(int16_t)
+convert(int32_t)
+convert(int64_t)
+convert(uint8_t)
+convert(uint16_t)
+convert(uint32_t)
+convert(uint64_t)
+convert(float)
+
+#undef convert
+
+static void convert_rows_double(void *args, size_t begin, size_t end)
 {
-    init
+    struct convert_args *a = args;
+
+    for (; begin < end; begin++)
+        memcpy(a->data[begin], a->array[begin], sizeof(double) * a->n_cols);
 }
 
-mat47_t *mat47_init_int32(uint n_rows, uint n_cols, int32_t **restrict array)
+/* Null rows are checked for upfront, such that the conversion can be split across
+ * threads for large arrays.
+ */
+static bool check_array(const void *const *array, unsigned int n_rows)
 {
-    init
+    if (check_ptr(array)) return true;
+    for (unsigned int i = n_rows; i--;)
+        if (!array[i]) {
+            mat47_errno = MAT47_ERR_NULL_PTR;
+            error(": `array[%u]`", i);
+            return true;
+        }
+
+    return false;
 }
 
-mat47_t *mat47_init_int64(uint n_rows, uint n_cols, int64_t **restrict array)
+static void convert_into(mat47_t *m, const void *const *array, mat47__range_fn *fn)
 {
-    init
+    bump_version(m);
+    mat47__parallel_for(
+        m->n_rows, PARALLEL_GRAIN / m->n_cols + 1, fn,
+        &(struct convert_args){array, m->data, m->n_cols}
+    );
+    stats_copy(sizeof(double) * m->n_rows * m->n_cols);
 }
 
-mat47_t *mat47_init_uint8(uint n_rows, uint n_cols, uint8_t **restrict array)
-{
-    init
+#define init(T) \
+    stats(INIT); \
+    mat47_t *m; \
+\
+    if (check_array((const void *const *)array, n_rows)) return NULL; \
+    if (!(m = mat47__new(n_rows, n_cols, false))) return NULL; \
+    convert_into(m, (const void *const *)array, convert_rows_##T); \
+\
+    return m;
+
+#define init_into(T) \
+    stats(INIT_INTO); \
+\
+    if (check_ptr(dst)) return; \
+    if (check_array((const void *const *)array, dst->n_rows)) return; \
+    convert_into(dst, (const void *const *)array, convert_rows_##T);
+
+#define init_fns(NAME, T) \
+mat47_t *mat47_init_##NAME(uint n_rows, uint n_cols, T **restrict array) \
+{ \
+    init(T) \
+} \
+\
+void mat47_init_##NAME##_into(mat47_t *dst, T **restrict array) \
+{ \
+    init_into(T) \
 }
 
-mat47_t *mat47_init_uint16(uint n_rows, uint n_cols, uint16_t **restrict array)
+init_fns(int8, int8_t)
+init_fns(int16, int16_t)
+init_fns(int32, int32_t)
+init_fns(int64, int64_t)
+init_fns(uint8, uint8_t)
+init_fns(uint16, uint16_t)
+init_fns(uint32, uint32_t)
+init_fns(uint64, uint64_t)
+init_fns(float, float)
+init_fns(double, double)
+
+#undef init
+#undef init_into
+#undef init_fns
+
+
+static bool check_ld(size_t ld, unsigned int n_cols)
 {
-    init
+    return check(
+        ld >= n_cols, MAT47_ERR_INVALID_ARG, ": ld=%zu, n_cols=%u", ld, n_cols
+    );
 }
 
-mat47_t *mat47_init_uint32(uint n_rows, uint n_cols, uint32_t **restrict array)
+// `m` must not share storage with `buf`
+static void copy_flat(mat47_t *m, const double *buf, size_t ld)
 {
-    init
+    unsigned int n_rows = m->n_rows, n_cols = m->n_cols;
+
+    bump_version(m);
+    if (ld == n_cols && m->block)
+        memcpy(m->block, buf, sizeof(double) * n_rows * n_cols);
+    else
+        for (unsigned int i = 0; i < n_rows; i++)
+            memcpy(m->data[i], buf + i * ld, sizeof(double) * n_cols);
+    stats_copy(sizeof(double) * n_rows * n_cols);
 }
 
-mat47_t *mat47_init_uint64(uint n_rows, uint n_cols, uint64_t **restrict array)
+mat47_t *mat47_init_double_flat(uint n_rows, uint n_cols, const double *buf, size_t ld)
 {
-    init
+    stats(INIT_FLAT);
+    mat47_t *m;
+    double *restrict block;
+
+    if (check_ptr(buf) || check_ld(ld, n_cols)) return NULL;
+    if (!(m = mat47_new_shell(n_rows, n_cols))) return NULL;
+
+    if (!(block = malloc(sizeof(double) * n_rows * n_cols))) {
+        mat47_del(m);
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for elements");
+        return NULL;
+    }
+    mat47_use_block(m, block, free);
+    stats_alloc(1, sizeof(double) * n_rows * n_cols);
+    copy_flat(m, buf, ld);
+
+    return m;
 }
 
-mat47_t *mat47_init_float(uint n_rows, uint n_cols, float **restrict array)
+
+void mat47_init_double_flat_into(mat47_t *dst, const double *buf, size_t ld)
 {
-    init
+    stats(INIT_FLAT_INTO);
+
+    if (check_ptr(dst) || check_ptr(buf) || check_ld(ld, dst->n_cols)) return;
+
+    copy_flat(dst, buf, ld);
 }
 
-#undef init
 
-mat47_t *mat47_init_double(uint n_rows, uint n_cols, double **restrict array)
+mat47_t *mat47_adopt(uint n_rows, uint n_cols, double *buf, void (*free_fn)(void *))
 {
+    stats(ADOPT);
     mat47_t *m;
-    double **restrict data, *restrict row;
 
-    if (check_ptr(array)) return NULL;
-    if (!(m = mat47_new(n_rows, n_cols, false))) return NULL;
+    if (check_ptr(buf)) return NULL;
+    if (!(m = mat47_new_shell(n_rows, n_cols))) return NULL;
 
-    data = m->data;
-    while (n_rows--) {
-        if (!(row = array[n_rows])) {
-            mat47_del(m);
-            mat47_errno = MAT47_ERR_NULL_PTR;
-            error(": `array[%u]`", n_rows);
-            return NULL;
-        }
-        memcpy(data[n_rows], row, sizeof(double) * n_cols);
-    }
+    mat47_use_block(m, buf, free_fn);
+    if (free_fn) stats_alloc(1, sizeof(double) * n_rows * n_cols);
+    debug("Adopted buffer @ %p, owned=%u", (void *)buf, !!free_fn);
 
     return m;
 }
 
 
+double *mat47_release(mat47_t *m)
+{
+    stats(RELEASE);
+    double *block;
+
+    if (check_ptr(m)) return NULL;
+    if (
+        check(
+            block = m->block,
+            MAT47_ERR_INVALID_ARG, ": matrix @ %p has no contiguous storage", (void *)m
+        )
+    ) return NULL;
+    if (
+        check(
+            m->free_block != mat47__unmap_elements,
+            MAT47_ERR_INVALID_ARG, ": matrix @ %p has mapped storage", (void *)m
+        )
+    ) return NULL;
+
+    mat47__solve_forget(m);
+    stats_free(
+        sizeof(mat47_t) + sizeof(double *) * m->row_cap
+        + (m->free_block ? sizeof(double) * m->cap : 0)
+    );
+    free(m->data);
+    debug("Released buffer @ %p from matrix @ %p", (void *)block, (void *)m);
+    free(m);
+
+    return block;
+}
+
 mat47_t *mat47_copy(const mat47_t *m)
 {
+    stats(COPY);
     if (check_ptr(m)) return NULL;
     return mat47_init_double(m->n_rows, m->n_cols, m->data);
 }
 
 
+void mat47_copy_into(mat47_t *dst, const mat47_t *src)
+{
+    stats(COPY_INTO);
+
+    if (check_ptr(dst) || check_ptr(src)) return;
+    if (check_eq(dst->n_rows, src->n_rows) || check_eq(dst->n_cols, src->n_cols))
+        return;
+    if (dst == src) return;
+
+    convert_into(dst, (const void *const *)src->data, convert_rows_double);
+}
+
+
 void mat47_del(mat47_t *m)
 {
+    stats(DEL);
+
     if (m) {
+        mat47__solve_forget(m);
         if (m->data) {
             double **restrict data = m->data;
             unsigned int n_rows = m->n_rows;
 
-            for (unsigned int i = 0; i < n_rows; i++) free(data[i]);
+            if (m->block) {
+                if (m->free_block) {
+                    m->free_block(m->block);
+                    stats_free(sizeof(double) * m->cap);
+                }
+            } else {
+                for (unsigned int i = 0; i < n_rows; i++) {
+                    if (data[i]) stats_free(sizeof(double) * m->n_cols);
+                    free(data[i]);
+                }
+            }
             free(m->data);
+            stats_free(sizeof(double *) * m->row_cap);
         }
+        stats_free(sizeof(mat47_t));
         debug("Deallocated matrix @ %p", (void *)m);
         free(m);
     }
 }
 
 
+/* Growth and reshaping.
+ *
+ * The room for rows (`data`, and `block` for contiguous storage) grows geometrically,
+ * such that appending rows costs amortized constant time per row (besides copying the
+ * elements).
+ */
+
+// Returns the capacity to grow `cap` to, for at least `n`
+static unsigned int grown_cap(unsigned int cap, unsigned int n)
+{
+    return max(n, cap > UINT_MAX / 2 ? UINT_MAX : 2 * cap);
+}
+
+// Makes room for `n_rows` row pointers in `m`; Returns true on failure.
+static bool reserve_rows(mat47_t *m, unsigned int n_rows)
+{
+    unsigned int cap;
+    double **data;
+
+    if (n_rows <= m->row_cap) return false;
+
+    cap = grown_cap(m->row_cap, n_rows);
+    if (!(data = realloc(m->data, sizeof(double *) * cap))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for row pointers");
+        return true;
+    }
+    stats_alloc(1, sizeof(double *) * cap);
+    stats_free(sizeof(double *) * m->row_cap);
+    debug("Grown row pointers from %u to %u", m->row_cap, cap);
+    m->data = data;
+    m->row_cap = cap;
+
+    return false;
+}
+
+/* Allocates contiguous storage for `n_rows * n_cols` elements, the same way as
+ * `mat47__new()`, and stores its deallocator into `*free_fn`.
+ */
+static double *new_block(uint n_rows, uint n_cols, void (**free_fn)(void *))
+{
+    double *block;
+
+    if ((block = mat47__map_elements(n_rows, n_cols))) {
+        *free_fn = mat47__unmap_elements;
+    } else if ((block = malloc(sizeof(double) * n_rows * n_cols))) {
+        *free_fn = free;
+    } else {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for elements");
+        return NULL;
+    }
+    stats_alloc(1, sizeof(double) * n_rows * n_cols);
+
+    return block;
+}
+
+// Points the rows of `m` into its contiguous storage, with `n_cols` columns each
+static void point_rows(mat47_t *m, unsigned int n_cols)
+{
+    for (unsigned int i = 0; i < m->n_rows; i++)
+        m->data[i] = m->block + (size_t)i * n_cols;
+}
+
+/* Replaces the contiguous storage of `m` with `block` (of `cap` elements), then
+ * points its rows into it, with `n_cols` columns each.
+ */
+static void replace_block(
+    mat47_t *m, double *block, size_t cap, void (*free_fn)(void *), unsigned int n_cols
+) {
+    if (m->block && m->free_block) {
+        m->free_block(m->block);
+        stats_free(sizeof(double) * m->cap);
+    }
+    m->block = block;
+    m->free_block = free_fn;
+    m->cap = cap;
+    point_rows(m, n_cols);
+}
+
+// Makes room for `n_rows` rows in the contiguous storage of `m`; Returns true on
+// failure.
+static bool reserve_block(mat47_t *m, unsigned int n_rows)
+{
+    unsigned int n_cols = m->n_cols, cap;
+    void (*free_fn)(void *) = free;
+    double *block;
+
+    if ((size_t)n_rows * n_cols <= m->cap) return false;
+
+    cap = grown_cap(m->cap / n_cols, n_rows);
+    // Only storage from `malloc()` can be grown in place
+    if (m->free_block == free) {
+        if (!(block = realloc(m->block, sizeof(double) * cap * n_cols))) {
+            mat47_errno = MAT47_ERR_ALLOC;
+            error(" for elements");
+            return true;
+        }
+        stats_alloc(1, sizeof(double) * cap * n_cols);
+        stats_free(sizeof(double) * m->cap);
+        m->block = NULL;  // Already deallocated (or reused) by `realloc()`
+    } else {
+        if (!(block = new_block(cap, n_cols, &free_fn))) return true;
+        memcpy(block, m->block, sizeof(double) * m->n_rows * n_cols);
+        stats_copy(sizeof(double) * m->n_rows * n_cols);
+    }
+    debug("Grown contiguous storage from %zu to %u rows", m->cap / n_cols, cap);
+    replace_block(m, block, (size_t)cap * n_cols, free_fn, n_cols);
+
+    return false;
+}
+
+/* Adds `n_rows - m->n_rows` rows to `m`; Their elements are uninitialized.
+ *
+ * Returns true on failure, in which case `m` is left unchanged (though maybe with
+ * more room).
+ */
+static bool add_rows(mat47_t *m, unsigned int n_rows)
+{
+    double **restrict data;
+    unsigned int i, n_cols = m->n_cols;
+
+    if (reserve_rows(m, n_rows) || (m->block && reserve_block(m, n_rows))) return true;
+
+    data = m->data;
+    if (m->block) {
+        for (i = m->n_rows; i < n_rows; i++) data[i] = m->block + (size_t)i * n_cols;
+    } else {
+        for (i = m->n_rows; i < n_rows; i++)
+            if (!(data[i] = malloc(sizeof(double) * n_cols))) {
+                while (i-- > m->n_rows) free(data[i]);
+                mat47_errno = MAT47_ERR_ALLOC;
+                error(" for rows");
+                return true;
+            }
+        stats_alloc(n_rows - m->n_rows, sizeof(double) * (n_rows - m->n_rows) * n_cols);
+    }
+    m->n_rows = n_rows;
+
+    return false;
+}
+
+
+void mat47_append_rows(mat47_t *m, const mat47_t *src)
+{
+    stats(APPEND_ROWS);
+    unsigned int i, n_rows, n_src_rows;
+
+    if (check_ptr(m) || check_ptr(src)) return;
+    if (check_eq(m->n_cols, src->n_cols)) return;
+    if (
+        check(
+            src->n_rows <= UINT_MAX - m->n_rows, MAT47_ERR_INVALID_ARG,
+            ": %u + %u rows", m->n_rows, src->n_rows
+        )
+    ) return;
+
+    n_rows = m->n_rows;
+    n_src_rows = src->n_rows;  // `src` may be `m`
+    if (add_rows(m, n_rows + n_src_rows)) return;
+
+    bump_version(m);
+    for (i = 0; i < n_src_rows; i++)
+        memcpy(m->data[n_rows + i], src->data[i], sizeof(double) * m->n_cols);
+    stats_copy(sizeof(double) * n_src_rows * m->n_cols);
+}
+
+
+void mat47_reshape(mat47_t *m, unsigned int n_rows, unsigned int n_cols)
+{
+    stats(RESHAPE);
+    size_t size;
+    void (*free_fn)(void *);
+    double *block;
+
+    if (check_ptr(m)) return;
+    size = (size_t)m->n_rows * m->n_cols;
+    if (check_eq((size_t)n_rows * n_cols, size)) return;
+    if (reserve_rows(m, n_rows)) return;
+
+    // Only once nothing can fail anymore, such that failures leave `m` unchanged
+    if (m->block) {
+        bump_version(m);
+        m->n_rows = n_rows;
+        m->n_cols = n_cols;
+        point_rows(m, n_cols);
+        return;
+    }
+
+    // Gather the rows into contiguous storage
+    if (!(block = new_block(n_rows, n_cols, &free_fn))) return;
+    bump_version(m);
+    for (unsigned int i = 0; i < m->n_rows; i++) {
+        memcpy(block + (size_t)i * m->n_cols, m->data[i], sizeof(double) * m->n_cols);
+        free(m->data[i]);
+    }
+    stats_copy(sizeof(double) * size);
+    stats_free(sizeof(double) * size);
+    debug("Gathered rows into contiguous storage @ %p", (void *)block);
+    m->n_rows = n_rows;
+    m->n_cols = n_cols;
+    replace_block(m, block, size, free_fn, n_cols);
+}
+
+
+// Changes the number of columns of every row, for non-contiguous storage
+static bool resize_rows(mat47_t *m, unsigned int n_rows, unsigned int n_cols)
+{
+    double *row;
+
+    for (unsigned int i = 0; i < n_rows; i++) {
+        if (!(row = realloc(m->data[i], sizeof(double) * n_cols))) {
+            // Rows already resized still have room for the current columns
+            if (n_cols < m->n_cols) continue;
+            mat47_errno = MAT47_ERR_ALLOC;
+            error(" for rows");
+            return true;
+        }
+        m->data[i] = row;
+        if (n_cols > m->n_cols)
+            memset(row + m->n_cols, 0, sizeof(double) * (n_cols - m->n_cols));
+    }
+    stats_alloc(n_rows, sizeof(double) * n_rows * n_cols);
+    stats_free(sizeof(double) * n_rows * m->n_cols);
+
+    return false;
+}
+
+// Changes the number of columns of contiguous storage, for `n_rows` rows
+static bool resize_block(mat47_t *m, unsigned int n_rows, unsigned int n_cols)
+{
+    unsigned int i, n_kept = min(n_rows, m->n_rows), n_kept_cols;
+    void (*free_fn)(void *);
+    double *block, *row;
+
+    n_kept_cols = min(n_cols, m->n_cols);
+    if (reserve_rows(m, n_rows)) return true;
+    if (!(block = new_block(n_rows, n_cols, &free_fn))) return true;
+
+    for (i = 0; i < n_rows; i++) {
+        row = block + (size_t)i * n_cols;
+        if (i < n_kept) {
+            memcpy(row, m->data[i], sizeof(double) * n_kept_cols);
+            memset(row + n_kept_cols, 0, sizeof(double) * (n_cols - n_kept_cols));
+        } else {
+            memset(row, 0, sizeof(double) * n_cols);
+        }
+    }
+    stats_copy(sizeof(double) * n_kept * n_kept_cols);
+    m->n_rows = n_rows;
+    replace_block(m, block, (size_t)n_rows * n_cols, free_fn, n_cols);
+
+    return false;
+}
+
+void mat47_resize(mat47_t *m, unsigned int n_rows, unsigned int n_cols)
+{
+    stats(RESIZE);
+    unsigned int i, n_old_rows;
+    double **restrict data;
+
+    if (check_ptr(m)) return;
+    if (!(n_rows && n_cols)) {
+        mat47_errno = MAT47_ERR_ZERO_SIZE;
+        error(": %u x %u", n_rows, n_cols);
+        return;
+    }
+
+    // Bumped only once nothing can fail anymore, such that failures leave `m`
+    // unchanged
+    n_old_rows = m->n_rows;
+    if (m->block) {
+        if (n_cols != m->n_cols) {
+            if (resize_block(m, n_rows, n_cols)) return;
+            m->n_cols = n_cols;
+        } else if (n_rows > n_old_rows) {
+            if (add_rows(m, n_rows)) return;
+            memset(
+                m->data[n_old_rows], 0, sizeof(double) * (n_rows - n_old_rows) * n_cols
+            );
+        } else {
+            m->n_rows = n_rows;
+        }
+        bump_version(m);
+        return;
+    }
+
+    if (reserve_rows(m, n_rows)) return;
+    data = m->data;
+    for (i = n_old_rows; i < n_rows; i++)
+        if (!(data[i] = calloc(sizeof(double), n_cols))) {
+            while (i-- > n_old_rows) free(data[i]);
+            mat47_errno = MAT47_ERR_ALLOC;
+            error(" for rows");
+            return;
+        }
+    if (n_cols != m->n_cols && resize_rows(m, min(n_rows, n_old_rows), n_cols)) {
+        for (i = n_old_rows; i < n_rows; i++) free(data[i]);
+        return;
+    }
+    if (n_rows > n_old_rows)
+        stats_alloc(
+            n_rows - n_old_rows, sizeof(double) * (n_rows - n_old_rows) * n_cols
+        );
+    else
+        stats_free(sizeof(double) * (n_old_rows - n_rows) * m->n_cols);
+
+    for (i = n_rows; i < n_old_rows; i++) free(data[i]);
+    m->n_rows = n_rows;
+    m->n_cols = n_cols;
+    bump_version(m);
+}
+
+
 double mat47_get_elem(const mat47_t *m, unsigned int row, unsigned int col)
 {
+    stats(GET_ELEM);
     if (check_ptr(m)) return NAN;
     if (check_row(m, row) || check_col(m, col)) return NAN;
 
@@ -225,96 +792,178 @@ double mat47_get_elem(const mat47_t *m, unsigned int row, unsigned int col)
 
 void mat47_set_elem(mat47_t *m, unsigned int row, unsigned int col, double value)
 {
+    stats(SET_ELEM);
     if (check_ptr(m)) return;
     if (check_row(m, row) || check_col(m, col)) return;
 
     m->data[row - 1][col - 1] = value;
+    bump_version(m);
 }
 
 
-mat47_t *
-mat47_get_submat
-(const mat47_t *m, unsigned top, unsigned left, unsigned bottom, unsigned right)
+double *mat47__row_ptr(const mat47_t *m, unsigned int row)
 {
-    long n_rows, n_cols;
-    double **restrict data, **restrict sub_data;
-    mat47_t *sub;
+    if (check_ptr(m) || check_row(m, row)) return NULL;
 
-    // Null pointer
-    if (check_ptr(m)) return NULL;
+    return m->data[row - 1];
+}
 
+
+void mat47_get_row(const mat47_t *m, unsigned int row, double *restrict buf)
+{
+    stats(GET_ROW);
+    if (check_ptr(m) || check_ptr(buf)) return;
+    if (check_row(m, row)) return;
+
+    memcpy(buf, m->data[row - 1], sizeof(double) * m->n_cols);
+    stats_copy(sizeof(double) * m->n_cols);
+}
+
+
+void mat47_set_row(mat47_t *m, unsigned int row, const double *restrict buf)
+{
+    stats(SET_ROW);
+    if (check_ptr(m) || check_ptr(buf)) return;
+    if (check_row(m, row)) return;
+
+    memcpy(m->data[row - 1], buf, sizeof(double) * m->n_cols);
+    bump_version(m);
+    stats_copy(sizeof(double) * m->n_cols);
+}
+
+
+void mat47_get_col(const mat47_t *m, unsigned int col, double *restrict buf)
+{
+    stats(GET_COL);
+    if (check_ptr(m) || check_ptr(buf)) return;
+    if (check_col(m, col)) return;
+
+    double **restrict data = m->data;
+    unsigned int n_rows = m->n_rows;
+
+    stats_copy(sizeof(double) * n_rows);
+    for (--col; n_rows--;) buf[n_rows] = data[n_rows][col];
+}
+
+
+void mat47_set_col(mat47_t *m, unsigned int col, const double *restrict buf)
+{
+    stats(SET_COL);
+    if (check_ptr(m) || check_ptr(buf)) return;
+    if (check_col(m, col)) return;
+
+    double **restrict data = m->data;
+    unsigned int n_rows = m->n_rows;
+
+    stats_copy(sizeof(double) * n_rows);
+    bump_version(m);
+    for (--col; n_rows--;) data[n_rows][col] = buf[n_rows];
+}
+
+
+/* Computes the dimensions of the sub-matrix `m[top:bottom, left:right]`.
+ *
+ * Returns true (with `mat47_errno` set) if the sub-matrix is invalid.
+ */
+static bool submat_dims(
+    const mat47_t *m, uint top, uint left, uint bottom, uint right,
+    long *n_rows, long *n_cols
+) {
     // Out-of-range indexes
     if (
         check_row(m, top)
         || check_col(m, left)
         || check_row(m, bottom)
         || check_col(m, right)
-    ) return NULL;
+    ) return true;
 
     // Empty sub-matrix
-    if ((n_rows = (long)bottom - top + 1) < 1) {
+    if ((*n_rows = (long)bottom - top + 1) < 1) {
         mat47_errno = MAT47_ERR_ZERO_SIZE;
         error(": top=%u, bottom=%u", top, bottom);
-        return NULL;
+        return true;
     }
-    if ((n_cols = (long)right - left + 1) < 1) {
+    if ((*n_cols = (long)right - left + 1) < 1) {
         mat47_errno = MAT47_ERR_ZERO_SIZE;
         error(": left=%u, right=%u", left, right);
-        return NULL;
+        return true;
     }
 
-    if (!(sub = mat47_new(n_rows, n_cols, false))) return NULL;
+    return false;
+}
+
+static void get_submat(const mat47_t *m, uint top, uint left, mat47_t *sub)
+{
+    double **restrict data = m->data, **restrict sub_data = sub->data;
+    unsigned int n_cols = sub->n_cols;
 
-    data = m->data;
-    sub_data = sub->data;
     --top; --left;  // Change to zero-based
-    for (unsigned int i = 0; i < n_rows; i++)
+    for (unsigned int i = 0; i < sub->n_rows; i++)
         memcpy(sub_data[i], data[top + i] + left, sizeof(double) * n_cols);
+    stats_copy(sizeof(double) * sub->n_rows * n_cols);
+}
+
+
+mat47_t *
+mat47_get_submat
+(const mat47_t *m, unsigned top, unsigned left, unsigned bottom, unsigned right)
+{
+    stats(GET_SUBMAT);
+    long n_rows, n_cols;
+    mat47_t *sub;
+
+    if (check_ptr(m)) return NULL;
+    if (submat_dims(m, top, left, bottom, right, &n_rows, &n_cols)) return NULL;
+
+    if (!(sub = mat47__new(n_rows, n_cols, false))) return NULL;
+    get_submat(m, top, left, sub);
 
     return sub;
 }
 
 
+void mat47_get_submat_into(
+    mat47_t *dst, const mat47_t *m, uint top, uint left, uint bottom, uint right
+) {
+    stats(GET_SUBMAT_INTO);
+    long n_rows, n_cols;
+
+    if (check_ptr(dst) || check_ptr(m)) return;
+    if (submat_dims(m, top, left, bottom, right, &n_rows, &n_cols)) return;
+    if (check_eq(n_rows, dst->n_rows) || check_eq(n_cols, dst->n_cols)) return;
+
+    if (dst == m) return;  // Same matrix
+
+    bump_version(dst);
+    get_submat(m, top, left, dst);
+}
+
+
 void
 mat47_set_submat
 (mat47_t *m, uint top, uint left, uint bottom, uint right, const mat47_t *sub)
 {
+    stats(SET_SUBMAT);
     long n_rows, n_cols;
     double **restrict data, **restrict sub_data;
 
     // Null pointers
     if (check_ptr(m) || check_ptr(sub)) return;
 
-    // Out-of-range indexes
-    if (
-        check_row(m, top)
-        || check_col(m, left)
-        || check_row(m, bottom)
-        || check_col(m, right)
-    ) return;
-
-    // Empty sub-matrix
-    if ((n_rows = (long)bottom - top + 1) < 1) {
-        mat47_errno = MAT47_ERR_ZERO_SIZE;
-        error(": top=%u, bottom=%u", top, bottom);
-        return;
-    }
-    if ((n_cols = (long)right - left + 1) < 1) {
-        mat47_errno = MAT47_ERR_ZERO_SIZE;
-        error(": left=%u, right=%u", left, right);
-        return;
-    }
+    if (submat_dims(m, top, left, bottom, right, &n_rows, &n_cols)) return;
 
     // Dimension mismatch
     if (check_eq(n_rows, sub->n_rows) || check_eq(n_cols, sub->n_cols)) return;
 
     if (m == sub) return;  // Same matrix
 
+    bump_version(m);
     data = m->data;
     sub_data = sub->data;
     --top; --left;  // Change to zero-based
     for (unsigned int i = 0; i < n_rows; i++)
         memcpy(data[top + i] + left, sub_data[i], sizeof(double) * n_cols);
+    stats_copy(sizeof(double) * n_rows * n_cols);
 }
 
 
@@ -324,6 +973,7 @@ mat47_set_submat
 intmax_t mat47_fprintf(
     const mat47_t *m, FILE *restrict stream, const char *restrict format
 ) {
+    stats(FPRINTF);
     if (check_ptr(m) || check_ptr(stream) || check_ptr(format)) return -1;
     if (!*format) {
         mat47_errno = MAT47_ERR_ZERO_SIZE;
@@ -437,7 +1087,11 @@ char *mat47_strerror(unsigned int errnum)
         "Invalid zero-sized/empty result",
         "Null pointer",
         "Index out of range",
-        "Mismatch in dimension"
+        "Mismatch in dimension",
+        "Singular matrix",
+        "Invalid argument",
+        "Matrix not positive definite",
+        "Iteration did not converge"
     };
 
     if (errnum >= sizeof_arr(error_str)) errnum = 0;
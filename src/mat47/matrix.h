@@ -34,6 +34,21 @@
 #undef MAT47_LOG_ERROR
 #endif
 
+// For documentation
+#ifndef MAT47_CHECK_ACCESS
+
+/**
+ * Makes the unchecked accessors (:c:func:`mat47_at`, :c:func:`mat47_set_at` and
+ * :c:func:`mat47_row_ptr`) check their arguments, if defined.
+ *
+ * Unlike the other ``MAT47_*`` macros, this is to be defined when compiling the code
+ * **using** the library (e.g in debug builds).
+ */
+#define MAT47_CHECK_ACCESS
+
+#undef MAT47_CHECK_ACCESS
+#endif
+
 /**
  * Stream to which library logs should be written.
  *
@@ -44,11 +59,83 @@
  *     :c:var:`MAT47_LOG_DEBUG` and/or :c:var:`MAT47_LOG_ERROR`.
  *
  * Attention:
- *     Logging may or may not be thread-safe, depending on the file I/O implementation
- *     being used.
+ *     This should not be changed while logs are being flushed (see
+ *     :c:func:`mat47_log_flush`).
  */
 extern FILE *MAT47_LOG_FILE;
 
+/**
+ * Defines the log levels, in increasing order of verbosity.
+ *
+ * Only logs enabled at compilation (see :c:var:`MAT47_LOG_DEBUG` and
+ * :c:var:`MAT47_LOG_ERROR`) can be emitted, whatever the level.
+ */
+enum mat47_log_level {
+    /** No logs */
+    MAT47_LOG_LEVEL_NONE,
+
+    /** Error logs only */
+    MAT47_LOG_LEVEL_ERROR,
+
+    /** Error and debug logs */
+    MAT47_LOG_LEVEL_DEBUG
+};
+
+/**
+ * Writes pending logs to :c:var:`MAT47_LOG_FILE`.
+ *
+ * Logs are not written to the stream by the functions emitting them. Instead, every
+ * thread records its logs (the raw arguments of the message, with copies of its
+ * strings, and a raw timestamp) in a fixed-size buffer, without locking or I/O;
+ * messages and timestamps are formatted and the logs are written only when flushed,
+ * either by this function, by the background flusher (see
+ * :c:func:`mat47_log_start_flusher`) or at normal program termination.
+ *
+ * Note:
+ *     - Logs are written in order per thread but not across threads.
+ *     - If a thread's buffer is full, further logs from the thread are dropped (and
+ *       counted) until the next flush.
+ *     - This can be called from any thread.
+ */
+void mat47_log_flush(void);
+
+/**
+ * Returns the current log level.
+ *
+ * Returns:
+ *     The log level (:c:enumerator:`~mat47_log_level.MAT47_LOG_LEVEL_DEBUG`, by
+ *     default).
+ */
+enum mat47_log_level mat47_log_get_level(void);
+
+/**
+ * Sets the log level.
+ *
+ * Args:
+ *     level: The new log level
+ *
+ * Logs above the level are discarded at the point of emission, without formatting.
+ */
+void mat47_log_set_level(enum mat47_log_level level);
+
+/**
+ * Starts a background thread which periodically flushes logs.
+ *
+ * Args:
+ *     interval_ms: The interval between flushes, in milliseconds
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to create the thread
+ *
+ * If the thread is already running, only its interval is changed.
+ */
+void mat47_log_start_flusher(unsigned int interval_ms);
+
+/**
+ * Stops the background log flusher, if running, then flushes any pending logs.
+ */
+void mat47_log_stop_flusher(void);
+
 /** The matrix type definition */
 struct mat47 {
 
@@ -58,12 +145,107 @@ struct mat47 {
     /** Number of columns */
     unsigned int n_cols;
 
+    /** Pointers to the rows; The elements of a row are contiguous */
     double **data;
+
+    /**
+     * Modification counter: Incremented by every function modifying the elements or
+     * dimensions of the matrix, such that a factorization of the matrix cached by
+     * :c:func:`mat47_solve` is used only while it's unchanged.
+     *
+     * Modifications through :c:member:`data` or :c:func:`mat47_row_ptr` aren't
+     * counted; The caller should then increment it.
+     */
+    uint64_t version;
+
+    /**
+     * Contiguous row-major buffer holding all the rows, if any; Otherwise, null and
+     * every row is allocated separately.
+     *
+     * Private; Should not be accessed directly.
+     */
+    double *block;
+
+    /**
+     * Deallocates :c:member:`block`; Null if the buffer is not owned by the matrix.
+     *
+     * Private; Should not be accessed directly.
+     */
+    void (*free_block)(void *);
+
+    /**
+     * Number of row pointers :c:member:`data` has room for.
+     *
+     * Private; Should not be accessed directly.
+     */
+    unsigned int row_cap;
+
+    /**
+     * Number of elements :c:member:`block` has room for, if not null.
+     *
+     * Private; Should not be accessed directly.
+     */
+    size_t cap;
 };
 
 /** The matrix type (Alias of :c:struct:`struct mat47<mat47>`) */
 typedef struct mat47 mat47_t;
 
+/**
+ * Creates a new matrix using an existing buffer as its storage, without copying.
+ *
+ * Args:
+ *     n_rows: Number of rows
+ *     n_cols: Number of columns
+ *     buf: A contiguous buffer of at least ``n_rows * n_cols`` elements, in
+ *       row-major order
+ *     free_fn: The function with which *buf* should be deallocated when the matrix is
+ *       deallocated (e.g ``free``), or null if the matrix should not take ownership of
+ *       *buf*
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix whose elements are those in *buf*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *buf* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: Either dimension equals zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Note:
+ *     - Modifying the matrix modifies *buf* and vice-versa.
+ *     - If null is returned, ownership of *buf* is not taken.
+ *     - If *free_fn* is null, *buf* must outlive the matrix.
+ */
+mat47_t *mat47_adopt(uint n_rows, uint n_cols, double *buf, void (*free_fn)(void *));
+
+/**
+ * Appends the rows of a matrix to another, in place.
+ *
+ * Args:
+ *     m: The matrix to be extended
+ *     src: The matrix whose rows are appended; May be *m* itself.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* or *src* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *m* and *src* have
+ *       different numbers of columns
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: The number of rows
+ *       would overflow
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The room for rows (and, for contiguous storage, elements) grows geometrically,
+ * hence appending a row costs amortized ``O(n_cols)`` time, like a dynamic array;
+ * Row pointers obtained earlier may be invalidated.
+ *
+ * Contiguous storage not allocated by the library (or by the allocator ``free``
+ * belongs to) is moved to a new buffer when it runs out of room. In particular, a
+ * borrowed buffer (see :c:func:`mat47_adopt`) stops being used.
+ *
+ * If any error occurs, *m* is left unchanged.
+ */
+void mat47_append_rows(mat47_t *m, const mat47_t *src);
+
 /**
  * Copies a matrix.
  *
@@ -80,6 +262,25 @@ typedef struct mat47 mat47_t;
  */
 mat47_t *mat47_copy(const mat47_t *m);
 
+/**
+ * Copies a matrix into another.
+ *
+ * Args:
+ *     dst: The destination matrix
+ *     src: The source matrix
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *src* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *dst* and *src* have
+ *       different dimensions
+ *
+ * Like every ``*_into`` function, this writes into an existing matrix of the same
+ * dimensions as the result, instead of allocating a new one, and doesn't allocate
+ * memory (unless documented otherwise); Hence, it's suitable for hot loops. If any
+ * error occurs, *dst* is left unchanged.
+ */
+void mat47_copy_into(mat47_t *dst, const mat47_t *src);
+
 /**
  * Deallocates memory used by a matrix.
  *
@@ -127,6 +328,22 @@ intmax_t mat47_fprintf(
 /** Like :c:func:`mat47_fprintf` but with *format* set to :c:macro:`MAT47_ELEM_FMT` */
 #define mat47_fprint(m, stream) mat47_fprintf(m, stream, MAT47_ELEM_FMT)
 
+/**
+ * Retrieves a matrix column.
+ *
+ * Args:
+ *     m: The matrix from which to retrieve a column
+ *     col: The **1-based** index of the column
+ *     buf: An array of at least ``m->n_rows`` elements, into which the column should
+ *       be copied
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* or *buf* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INDEX_OUT_OF_RANGE`: *col* is out of
+ *       range
+ */
+void mat47_get_col(const mat47_t *m, unsigned int col, double *restrict buf);
+
 /**
  * Retrieves a matrix element.
  *
@@ -146,6 +363,22 @@ intmax_t mat47_fprintf(
  */
 double mat47_get_elem(const mat47_t *m, unsigned int row, unsigned int col);
 
+/**
+ * Retrieves a matrix row.
+ *
+ * Args:
+ *     m: The matrix from which to retrieve a row
+ *     row: The **1-based** index of the row
+ *     buf: An array of at least ``m->n_cols`` elements, into which the row should be
+ *       copied
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* or *buf* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INDEX_OUT_OF_RANGE`: *row* is out of
+ *       range
+ */
+void mat47_get_row(const mat47_t *m, unsigned int row, double *restrict buf);
+
 /**
  * Retrieves a sub-matrix.
  *
@@ -172,6 +405,24 @@ mat47_t *
 mat47_get_submat
 (const mat47_t *m, unsigned top, unsigned left, unsigned bottom, unsigned right);
 
+/**
+ * Retrieves a sub-matrix into an existing matrix.
+ *
+ * Args:
+ *     dst: The matrix into which to store the sub-matrix
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *dst* and the
+ *       specified sub-matrix are not equally sized
+ *
+ * The other arguments and errors are the same as for :c:func:`mat47_get_submat`,
+ * except for allocation failures. See :c:func:`mat47_copy_into`.
+ */
+void mat47_get_submat_into(
+    mat47_t *dst, const mat47_t *m, uint top, uint left, uint bottom, uint right
+);
+
 /**
  * Creates a new matrix and initializes it from the given array.
  *
@@ -226,12 +477,187 @@ mat47_t *mat47_init_uint64(uint n_rows, uint n_cols, uint64_t **restrict array);
 mat47_t *mat47_init_float(uint n_rows, uint n_cols, float **restrict array);
 mat47_t *mat47_init_double(uint n_rows, uint n_cols, double **restrict array);
 
+/**
+ * Initializes an existing matrix from a 2D array.
+ *
+ * Args:
+ *     dst (:c:type:`mat47_t *<mat47_t>`): The matrix to initialize
+ *     array (``T **restrict``): 2D array of at least as many rows and columns as
+ *       *dst*, from which the matrix should be initialized
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *array*, or any of
+ *       the pointers *array* points to, is null
+ *
+ * ``T`` is the same as for :c:macro:`mat47_init`. See :c:func:`mat47_copy_into`.
+ */
+#define mat47_init_into(dst, array) \
+    _Generic( \
+        (array), \
+        int8_t **: mat47_init_int8_into, int16_t **: mat47_init_int16_into, \
+        int32_t **: mat47_init_int32_into, int64_t **: mat47_init_int64_into, \
+        uint8_t **: mat47_init_uint8_into, uint16_t **: mat47_init_uint16_into, \
+        uint32_t **: mat47_init_uint32_into, uint64_t **: mat47_init_uint64_into, \
+        float **: mat47_init_float_into, double **: mat47_init_double_into \
+    )(dst, array)
+
+// See ``mat47_init_into``
+void mat47_init_int8_into(mat47_t *dst, int8_t **restrict array);
+void mat47_init_int16_into(mat47_t *dst, int16_t **restrict array);
+void mat47_init_int32_into(mat47_t *dst, int32_t **restrict array);
+void mat47_init_int64_into(mat47_t *dst, int64_t **restrict array);
+void mat47_init_uint8_into(mat47_t *dst, uint8_t **restrict array);
+void mat47_init_uint16_into(mat47_t *dst, uint16_t **restrict array);
+void mat47_init_uint32_into(mat47_t *dst, uint32_t **restrict array);
+void mat47_init_uint64_into(mat47_t *dst, uint64_t **restrict array);
+void mat47_init_float_into(mat47_t *dst, float **restrict array);
+void mat47_init_double_into(mat47_t *dst, double **restrict array);
+
+/**
+ * Creates a new matrix and initializes it from a contiguous row-major array.
+ *
+ * Args:
+ *     n_rows: Number of rows in the array
+ *     n_cols: Number of columns in the array
+ *     buf: The array
+ *     ld: Leading dimension of the array i.e the distance (in elements) between the
+ *       starts of consecutive rows
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new initialized matrix.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *buf* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *ld* is less than
+ *       *n_cols*
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: Either dimension equals zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Note:
+ *     - The elements are copied into a single contiguous buffer, which can be taken
+ *       over with :c:func:`mat47_release`.
+ *     - The behaviour is undefined if *buf* has less than
+ *       ``(n_rows - 1) * ld + n_cols`` elements.
+ */
+mat47_t *mat47_init_double_flat(uint n_rows, uint n_cols, const double *buf, size_t ld);
+
+/**
+ * Initializes an existing matrix from a contiguous row-major array.
+ *
+ * Args:
+ *     dst: The matrix to initialize
+ *     buf: The array
+ *     ld: Leading dimension of the array
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *buf* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *ld* is less than the
+ *       number of columns of *dst*
+ *
+ * See :c:func:`mat47_init_double_flat` and :c:func:`mat47_copy_into`.
+ *
+ * Note:
+ *     The behaviour is undefined if *buf* overlaps the storage of *dst*.
+ */
+void mat47_init_double_flat_into(mat47_t *dst, const double *buf, size_t ld);
+
 /** Like :c:func:`mat47_fprintf` but with *stream* set to ``stdout`` */
 #define mat47_printf(m, format) mat47_fprintf(m, stdout, format)
 
 /** Like :c:func:`mat47_printf` but with *format* set to :c:macro:`MAT47_ELEM_FMT` */
 #define mat47_print(m) mat47_printf(m, MAT47_ELEM_FMT)
 
+/**
+ * Deallocates a matrix but not its storage, which is handed over to the caller.
+ *
+ * Args:
+ *     m: The matrix
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, the contiguous row-major buffer holding the elements of *m*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: The elements of *m* are
+ *       not stored in a single contiguous buffer
+ *
+ * Only matrices created by :c:func:`mat47_adopt` or :c:func:`mat47_init_double_flat`
+ * use a contiguous buffer that can be released. For the former, the buffer is the one
+ * originally given; for the latter, it should be deallocated with ``free()``. The
+ * storage of large matrices allocated as memory mappings (see
+ * :c:func:`mat47_set_alloc_policy`) can't be released.
+ *
+ * Note:
+ *     *m* must not be used after a successful call. If null is returned, *m* is
+ *     left unchanged.
+ */
+double *mat47_release(mat47_t *m);
+
+/**
+ * Changes the dimensions of a matrix, in place, without changing the number or order
+ * of its elements.
+ *
+ * Args:
+ *     m: The matrix
+ *     n_rows: The new number of rows
+ *     n_cols: The new number of columns
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: ``n_rows * n_cols``
+ *       differs from the number of elements of *m*
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The elements are taken in row-major order. Contiguous storage is reinterpreted
+ * without copying any element; Otherwise, the rows are gathered into contiguous
+ * storage (hence, further reshapes don't copy).
+ *
+ * If any error occurs, *m* is left unchanged.
+ */
+void mat47_reshape(mat47_t *m, unsigned int n_rows, unsigned int n_cols);
+
+/**
+ * Changes the dimensions of a matrix, in place, keeping the elements at the same
+ * positions.
+ *
+ * Args:
+ *     m: The matrix
+ *     n_rows: The new number of rows
+ *     n_cols: The new number of columns
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: Either dimension equals
+ *       zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Elements outside the new dimensions are dropped, while new ones are zeroed.
+ * Changing only the number of rows grows the room for rows geometrically, as
+ * :c:func:`mat47_append_rows` does, and never shrinks it; Changing the number of
+ * columns of contiguous storage moves it to a new buffer.
+ *
+ * If any error occurs, *m* is left unchanged.
+ */
+void mat47_resize(mat47_t *m, unsigned int n_rows, unsigned int n_cols);
+
+/**
+ * Modifies a matrix column.
+ *
+ * Args:
+ *     m: The matrix whose column is to be modified
+ *     col: The **1-based** index of the column
+ *     buf: An array of at least ``m->n_rows`` elements, from which the column should
+ *       be copied
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* or *buf* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INDEX_OUT_OF_RANGE`: *col* is out of
+ *       range
+ */
+void mat47_set_col(mat47_t *m, unsigned int col, const double *restrict buf);
+
 /**
  * Modifies a matrix element.
  *
@@ -248,6 +674,22 @@ mat47_t *mat47_init_double(uint n_rows, uint n_cols, double **restrict array);
  */
 void mat47_set_elem(mat47_t *m, unsigned int row, unsigned int col, double value);
 
+/**
+ * Modifies a matrix row.
+ *
+ * Args:
+ *     m: The matrix whose row is to be modified
+ *     row: The **1-based** index of the row
+ *     buf: An array of at least ``m->n_cols`` elements, from which the row should be
+ *       copied
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* or *buf* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INDEX_OUT_OF_RANGE`: *row* is out of
+ *       range
+ */
+void mat47_set_row(mat47_t *m, unsigned int row, const double *restrict buf);
+
 /**
  * Modifies a sub-matrix.
  *
@@ -289,6 +731,102 @@ mat47_set_submat
  */
 mat47_t *mat47_zero(unsigned int n_rows, unsigned int n_cols);
 
+/**
+ * Sets all elements of a matrix to zero.
+ *
+ * Args:
+ *     m: The matrix
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *
+ * See :c:func:`mat47_copy_into`.
+ */
+void mat47_zero_into(mat47_t *m);
+
+// Checked implementation of `mat47_row_ptr()`; Not part of the API
+double *mat47__row_ptr(const mat47_t *m, unsigned int row);
+
+/**
+ * Retrieves a matrix element, without checking the arguments.
+ *
+ * Args:
+ *     m: The matrix from which to retrieve an element
+ *     row: The **1-based** index of the element's row
+ *     col: The **1-based** index of the element's column
+ *
+ * Returns:
+ *     The element at ``m[row, col]``.
+ *
+ * This is inlined and, unless :c:macro:`MAT47_CHECK_ACCESS` is defined, the behaviour
+ * is undefined if *m* is null or either index is out of range. Otherwise, it's the
+ * same as :c:func:`mat47_get_elem`.
+ */
+static inline double mat47_at(const mat47_t *m, unsigned int row, unsigned int col)
+{
+#ifdef MAT47_CHECK_ACCESS
+    return mat47_get_elem(m, row, col);
+#else
+    return m->data[row - 1][col - 1];
+#endif
+}
+
+/**
+ * Retrieves a pointer to the elements of a matrix row, without checking the
+ * arguments.
+ *
+ * Args:
+ *     m: The matrix
+ *     row: The **1-based** index of the row
+ *
+ * Returns:
+ *     A pointer to the first of the ``m->n_cols`` contiguous elements of the row, or
+ *     a null pointer if :c:macro:`MAT47_CHECK_ACCESS` is defined and either argument
+ *     is invalid.
+ *
+ * This is inlined and, unless :c:macro:`MAT47_CHECK_ACCESS` is defined, the behaviour
+ * is undefined if *m* is null or *row* is out of range. Otherwise,
+ * :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR` or
+ * :c:enumerator:`~mat47_errors.MAT47_ERR_INDEX_OUT_OF_RANGE` is raised accordingly.
+ *
+ * Note:
+ *     The pointer is valid only until the matrix is deallocated, or its storage is
+ *     moved by :c:func:`mat47_append_rows`, :c:func:`mat47_reshape` or
+ *     :c:func:`mat47_resize`.
+ */
+static inline double *mat47_row_ptr(const mat47_t *m, unsigned int row)
+{
+#ifdef MAT47_CHECK_ACCESS
+    return mat47__row_ptr(m, row);
+#else
+    return m->data[row - 1];
+#endif
+}
+
+/**
+ * Modifies a matrix element, without checking the arguments.
+ *
+ * Args:
+ *     m: The matrix whose element is to be modified
+ *     row: The **1-based** index of the element's row
+ *     col: The **1-based** index of the element's column
+ *     value: The new value of the element
+ *
+ * This is inlined and, unless :c:macro:`MAT47_CHECK_ACCESS` is defined, the behaviour
+ * is undefined if *m* is null or either index is out of range. Otherwise, it's the
+ * same as :c:func:`mat47_set_elem`.
+ */
+static inline void
+mat47_set_at(mat47_t *m, unsigned int row, unsigned int col, double value)
+{
+#ifdef MAT47_CHECK_ACCESS
+    mat47_set_elem(m, row, col, value);
+#else
+    m->data[row - 1][col - 1] = value;
+    m->version++;
+#endif
+}
+
 #undef uint
 
 #endif  // MAT47_MATRIX_H
@@ -0,0 +1,441 @@
+/* Packed symmetric and triangular matrix definitions
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "matrix.h"
+#include "packed.h"
+#include "utils.h"
+
+#define n_elems(n) ((size_t)(n) * ((n) + 1) / 2)
+
+typedef struct mat47__view view;
+
+// The stored elements of row `i`: `len(p, i)` elements, from column `first(p, i)`
+static inline double *row(const mat47p_t *p, unsigned int i)
+{
+    if (p->kind == MAT47P_UPPER)
+        return p->data + (size_t)i * (2 * (size_t)p->n - i + 1) / 2;
+
+    return p->data + n_elems(i);
+}
+
+static inline unsigned int first(const mat47p_t *p, unsigned int i)
+{
+    return p->kind == MAT47P_UPPER ? i : 0;
+}
+
+static inline unsigned int len(const mat47p_t *p, unsigned int i)
+{
+    return p->kind == MAT47P_UPPER ? p->n - i : i + 1;
+}
+
+static bool check_kind(enum mat47p_kind kind)
+{
+    return check(
+        kind == MAT47P_SYMMETRIC || kind == MAT47P_LOWER || kind == MAT47P_UPPER,
+        MAT47_ERR_INVALID_ARG, ": kind=%d", kind
+    );
+}
+
+
+/**
+ * Allocates memory for a new packed matrix.
+ *
+ * Args:
+ *     n: Number of rows (and columns)
+ *     kind: The structure of the matrix
+ *     zero: Whether the elements should be initialized to zero
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a newly allocated packed matrix.
+ *
+ * Raises:
+ *     MAT47_ERR_ZERO_SIZE: *n* is zero.
+ *     MAT47_ERR_INVALID_ARG: *kind* is invalid.
+ *     MAT47_ERR_ALLOC: Unable to allocate memory.
+ */
+static mat47p_t *mat47p_new(unsigned int n, enum mat47p_kind kind, bool zero)
+{
+    mat47p_t *p;
+
+    if (check(n, MAT47_ERR_ZERO_SIZE, ": n=0") || check_kind(kind)) return NULL;
+
+    if (!(p = malloc(sizeof(mat47p_t)))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for packed matrix object");
+        return NULL;
+    }
+    p->n = n;
+    p->kind = kind;
+    p->data = zero
+        ? calloc(n_elems(n), sizeof(double)) : malloc(sizeof(double) * n_elems(n));
+    if (!p->data) {
+        free(p);
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for packed elements");
+        return NULL;
+    }
+    stats_alloc(2, sizeof(mat47p_t) + sizeof(double) * n_elems(n));
+
+    debug("Allocated %u x %u packed matrix @ %p, kind=%d", n, n, (void *)p, kind);
+
+    return p;
+}
+
+
+void mat47p_del(mat47p_t *p)
+{
+    stats(P_DEL);
+
+    if (p) {
+        stats_free(sizeof(mat47p_t) + sizeof(double) * n_elems(p->n));
+        free(p->data);
+        debug("Deallocated packed matrix @ %p", (void *)p);
+        free(p);
+    }
+}
+
+
+mat47p_t *mat47p_zero(unsigned int n, enum mat47p_kind kind)
+{
+    stats(P_ZERO);
+
+    return mat47p_new(n, kind, true);
+}
+
+
+// `m` must have `p->n` rows and columns
+static void pack(const mat47_t *m, mat47p_t *p)
+{
+    for (unsigned int i = 0; i < p->n; i++)
+        memcpy(row(p, i), m->data[i] + first(p, i), sizeof(double) * len(p, i));
+    stats_copy(sizeof(double) * n_elems(p->n));
+}
+
+mat47p_t *mat47p_pack(const mat47_t *m, enum mat47p_kind kind)
+{
+    stats(P_PACK);
+    mat47p_t *p;
+
+    if (check_ptr(m) || check_eq(m->n_rows, m->n_cols)) return NULL;
+    if (!(p = mat47p_new(m->n_rows, kind, false))) return NULL;
+    pack(m, p);
+
+    return p;
+}
+
+
+void mat47p_pack_into(mat47p_t *dst, const mat47_t *m)
+{
+    stats(P_PACK_INTO);
+
+    if (check_ptr(dst) || check_ptr(m)) return;
+    if (check_eq(m->n_rows, dst->n) || check_eq(m->n_cols, dst->n)) return;
+
+    pack(m, dst);
+}
+
+
+// `m` must have `p->n` rows and columns
+static void unpack(const mat47p_t *p, mat47_t *m)
+{
+    unsigned int i, j, n = p->n;
+    double *restrict r;
+
+    for (i = 0; i < n; i++) {
+        memset(m->data[i], 0, sizeof(double) * n);
+        memcpy(m->data[i] + first(p, i), row(p, i), sizeof(double) * len(p, i));
+    }
+    if (p->kind == MAT47P_SYMMETRIC)
+        for (i = 1; i < n; i++)
+            for (r = row(p, i), j = 0; j < i; j++) m->data[j][i] = r[j];
+    stats_copy(sizeof(double) * n_elems(n));
+}
+
+mat47_t *mat47p_unpack(const mat47p_t *p)
+{
+    stats(P_UNPACK);
+    mat47_t *m;
+
+    if (check_ptr(p)) return NULL;
+    if (!(m = mat47__new(p->n, p->n, false))) return NULL;
+    unpack(p, m);
+
+    return m;
+}
+
+
+void mat47p_unpack_into(mat47_t *dst, const mat47p_t *p)
+{
+    stats(P_UNPACK_INTO);
+
+    if (check_ptr(dst) || check_ptr(p)) return;
+    if (check_eq(dst->n_rows, p->n) || check_eq(dst->n_cols, p->n)) return;
+
+    bump_version(dst);
+    unpack(p, dst);
+}
+
+
+/* Matrix-vector products, by chunks of `GEMV_CHUNK` elements of the vectors */
+
+#define GEMV_CHUNK 512
+
+struct gemv_args {
+    const mat47p_t *a;
+    double alpha;
+    const mat47_t *x;
+    double beta;
+    mat47_t *y;
+};
+
+static inline double dot(const double *restrict a, const double *restrict x, size_t n)
+{
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t j = 0;
+
+    for (; j + 4 <= n; j += 4) {
+        s0 += a[j] * x[j];
+        s1 += a[j + 1] * x[j + 1];
+        s2 += a[j + 2] * x[j + 2];
+        s3 += a[j + 3] * x[j + 3];
+    }
+    for (; j < n; j++) s0 += a[j] * x[j];
+
+    return (s0 + s1) + (s2 + s3);
+}
+
+// Element `i` of a row or column vector
+static inline double *at(const mat47_t *v, unsigned int i)
+{
+    return v->n_rows > 1 ? v->data[i] : v->data[0] + i;
+}
+
+// Elements `k0` to `k0 + n - 1` of `v`, gathered into `buf` if it's a column vector
+static const double *gather(
+    const mat47_t *v, unsigned int k0, unsigned int n, double *buf
+) {
+    if (v->n_rows == 1) return v->data[0] + k0;
+    for (unsigned int k = 0; k < n; k++) buf[k] = v->data[k0 + k][0];
+
+    return buf;
+}
+
+static void scale(mat47_t *y, double beta, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) *at(y, i) = beta == 0 ? 0 : beta * *at(y, i);
+}
+
+static void trmv_range(void *args, size_t begin, size_t end)
+{
+    struct gemv_args *g = args;
+    const mat47p_t *a = g->a;
+    const double *x;
+    double buf[GEMV_CHUNK];
+    unsigned int k0, w, s, e, n = a->n;
+
+    scale(g->y, g->beta, begin, end);
+    for (k0 = 0; k0 < n; k0 += w) {
+        x = gather(g->x, k0, w = min(GEMV_CHUNK, n - k0), buf);
+        for (size_t i = begin; i < end; i++) {
+            s = max(first(a, i), k0);
+            e = min(first(a, i) + len(a, i), k0 + w);
+            if (s < e)
+                *at(g->y, i) += g->alpha
+                    * dot(row(a, i) + (s - first(a, i)), x + (s - k0), e - s);
+        }
+    }
+}
+
+/* Row `i` of the lower triangle is dotted with `x` and, scaled by `x[i]`, added into
+ * `y` as column `i` of the upper triangle; a chunk of columns at a time, the one of
+ * `y` accumulated in `acc`
+ */
+static void symv(struct gemv_args *g)
+{
+    const double *restrict x, *restrict r;
+    double buf[GEMV_CHUNK], acc[GEMV_CHUNK], s, x_i;
+    unsigned int i, j, k0, w, l, n = g->a->n;
+
+    scale(g->y, g->beta, 0, n);
+    for (k0 = 0; k0 < n; k0 += w) {
+        x = gather(g->x, k0, w = min(GEMV_CHUNK, n - k0), buf);
+        memset(acc, 0, sizeof(double) * w);
+        for (i = k0; i < n; i++) {
+            r = row(g->a, i) + k0;
+            x_i = g->alpha * *at(g->x, i);
+            for (l = min(i, k0 + w) - k0, s = 0, j = 0; j < l; j++) {
+                s += r[j] * x[j];
+                acc[j] += x_i * r[j];
+            }
+            *at(g->y, i) += g->alpha * s + (i < k0 + w ? x_i * r[i - k0] : 0);
+        }
+        for (j = 0; j < w; j++) *at(g->y, k0 + j) += acc[j];
+    }
+}
+
+static bool check_vector(const mat47_t *v, unsigned int n)
+{
+    return check(
+        (v->n_rows == 1 && v->n_cols == n) || (v->n_cols == 1 && v->n_rows == n),
+        MAT47_ERR_DIM_MISMATCH, ": %u x %u matrix is not a vector of %u elements",
+        v->n_rows, v->n_cols, n
+    );
+}
+
+void mat47p_gemv(
+    mat47_t *y, double alpha, const mat47p_t *a, const mat47_t *x, double beta
+) {
+    stats(P_GEMV);
+    unsigned int n;
+    struct gemv_args g;
+
+    if (check_ptr(y) || check_ptr(a) || check_ptr(x)) return;
+    if (
+        check(y != x, MAT47_ERR_INVALID_ARG, ": y @ %p is also x", (void *)y)
+        || check_vector(x, n = a->n) || check_vector(y, n)
+    ) return;
+
+    bump_version(y);
+    g = (struct gemv_args){a, alpha, x, beta, y};
+    if (a->kind == MAT47P_SYMMETRIC) symv(&g);
+    else mat47__parallel_for(n, PARALLEL_GRAIN / n + 1, trmv_range, &g);
+}
+
+
+/* Products with regular matrices, by blocks of `MAT47P_BLOCK` rows and `MAT47P_PANEL`
+ * columns expanded into (or computed in) a buffer on the stack
+ */
+
+struct block {
+    double elems[MAT47P_BLOCK][MAT47P_PANEL];
+    double *rows[MAT47P_BLOCK];
+};
+
+static void init_block(struct block *b)
+{
+    for (unsigned int i = 0; i < MAT47P_BLOCK; i++) b->rows[i] = b->elems[i];
+}
+
+/* Expands rows `r0` to `r0 + h - 1` of `a`, columns `k0` to `k0 + w - 1`, into `b`;
+ * Elements outside the stored triangle are zero, or mirrored for symmetric matrices
+ */
+static void expand(
+    const mat47p_t *a, unsigned int r0, unsigned int h, unsigned int k0,
+    unsigned int w, struct block *b
+) {
+    unsigned int i, j, s, e, k1 = k0 + w;
+    double *restrict d, *restrict r;
+
+    for (i = r0; i < r0 + h; i++) {
+        d = b->rows[i - r0];
+        s = max(first(a, i), k0);
+        e = min(first(a, i) + len(a, i), k1);
+        if (s >= e) {
+            memset(d, 0, sizeof(double) * w);
+            continue;
+        }
+        memset(d, 0, sizeof(double) * (s - k0));
+        memcpy(d + (s - k0), row(a, i) + (s - first(a, i)), sizeof(double) * (e - s));
+        memset(d + (e - k0), 0, sizeof(double) * (k1 - e));
+    }
+
+    // The mirrored upper triangle, from the rows below, each read contiguously
+    if (a->kind == MAT47P_SYMMETRIC)
+        for (j = max(r0 + 1, k0); j < k1; j++)
+            for (r = row(a, j), i = r0; i < min(j, r0 + h); i++)
+                b->rows[i - r0][j - k0] = r[i];
+}
+
+// `c` has `a->n` rows and as many columns as `b`
+static void mul(const mat47p_t *a, const mat47_t *b, mat47_t *c)
+{
+    unsigned int r0, h, c0, c1, k0, w, n = a->n;
+    struct block blk;
+
+    init_block(&blk);
+    for (r0 = 0; r0 < n; r0 += h) {
+        h = min(MAT47P_BLOCK, n - r0);
+        c0 = first(a, r0);
+        c1 = a->kind == MAT47P_LOWER ? r0 + h : n;
+        for (k0 = c0; k0 < c1; k0 += w) {
+            expand(a, r0, h, k0, w = min(MAT47P_PANEL, c1 - k0), &blk);
+            mat47__gemm(
+                (view){c->data + r0, 0}, (view){blk.rows, 0}, (view){b->data + k0, 0},
+                h, w, b->n_cols, 1, k0 > c0
+            );
+        }
+    }
+}
+
+mat47_t *mat47p_mul(const mat47p_t *a, const mat47_t *b)
+{
+    stats(P_MUL);
+    mat47_t *c;
+
+    if (check_ptr(a) || check_ptr(b) || check_eq(b->n_rows, a->n)) return NULL;
+    if ((c = mat47__new(a->n, b->n_cols, false))) mul(a, b, c);
+
+    return c;
+}
+
+
+void mat47p_mul_into(mat47_t *c, const mat47p_t *a, const mat47_t *b)
+{
+    stats(P_MUL_INTO);
+
+    if (check_ptr(c) || check_ptr(a) || check_ptr(b)) return;
+    if (
+        check_eq(b->n_rows, a->n)
+        || check(c != b, MAT47_ERR_INVALID_ARG, ": c @ %p is also b", (void *)c)
+        || check_eq(c->n_rows, a->n) || check_eq(c->n_cols, b->n_cols)
+    ) return;
+
+    bump_version(c);
+    mul(a, b, c);
+}
+
+
+void mat47p_syrk(mat47p_t *c, double alpha, const mat47_t *a, double beta)
+{
+    stats(P_SYRK);
+    unsigned int r0, h, k0, w, i, j, n;
+    double *restrict d, *restrict r;
+    struct block blk;
+
+    if (check_ptr(c) || check_ptr(a)) return;
+    if (
+        check(
+            c->kind == MAT47P_SYMMETRIC, MAT47_ERR_INVALID_ARG, ": kind=%d", c->kind
+        )
+        || check_eq(a->n_rows, c->n)
+    ) return;
+
+    // `blk = alpha * a[r0:r0 + h] * transpose(a[k0:k0 + w])`, up to the diagonal
+    init_block(&blk);
+    for (n = c->n, r0 = 0; r0 < n; r0 += h) {
+        h = min(MAT47P_BLOCK, n - r0);
+        for (k0 = 0; k0 < r0 + h; k0 += w) {
+            w = min(MAT47P_PANEL, r0 + h - k0);
+            for (i = 0; i < h; i++) memset(blk.rows[i], 0, sizeof(double) * w);
+            mat47__gemm_nt(
+                (view){blk.rows, 0}, (view){a->data + r0, 0}, (view){a->data + k0, 0},
+                h, a->n_cols, w, alpha
+            );
+            for (i = max(r0, k0); i < r0 + h; i++) {
+                d = blk.rows[i - r0], r = row(c, i);
+                for (j = k0; j < min(i + 1, k0 + w); j++)
+                    r[j] = d[j - k0] + (beta == 0 ? 0 : beta * r[j]);
+            }
+        }
+    }
+}
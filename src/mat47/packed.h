@@ -0,0 +1,261 @@
+/* Packed symmetric and triangular matrix definitions
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_PACKED_H
+#define MAT47_PACKED_H
+
+#include "matrix.h"
+
+/** Structures of packed matrices, determining the stored triangle */
+enum mat47p_kind {
+    /** Symmetric; The lower triangle is stored. */
+    MAT47P_SYMMETRIC = 1,
+
+    /** Lower triangular */
+    MAT47P_LOWER,
+
+    /** Upper triangular */
+    MAT47P_UPPER
+};
+
+/**
+ * The packed matrix type definition: A square matrix of which only one triangle
+ * (including the diagonal) is stored, i.e ``n * (n + 1) / 2`` elements instead of
+ * ``n * n``.
+ *
+ * The stored elements of every row are contiguous, rows following one another: For
+ * :c:enumerator:`MAT47P_SYMMETRIC` and :c:enumerator:`MAT47P_LOWER`, row ``i`` holds
+ * columns ``0`` to ``i``, from ``data + i * (i + 1) / 2``; For
+ * :c:enumerator:`MAT47P_UPPER`, it holds columns ``i`` to ``n - 1``, from ``data + i *
+ * (2 * n - i + 1) / 2``. The other elements of triangular matrices are zero and those
+ * of symmetric matrices mirror the stored ones.
+ */
+struct mat47p {
+
+    /** Number of rows (and columns) */
+    unsigned int n;
+
+    /** Structure of the matrix */
+    enum mat47p_kind kind;
+
+    /** Stored elements, contiguous */
+    double *data;
+};
+
+/** The packed matrix type (Alias of :c:struct:`struct mat47p<mat47p>`) */
+typedef struct mat47p mat47p_t;
+
+/**
+ * Rows of a packed matrix expanded (or computed) at a time by :c:func:`mat47p_mul`
+ * and :c:func:`mat47p_syrk`
+ */
+#define MAT47P_BLOCK 64
+
+/**
+ * Columns of a block of :c:macro:`MAT47P_BLOCK` rows expanded (or computed) at a time,
+ * in a buffer on the stack
+ */
+#define MAT47P_PANEL 64
+
+/**
+ * Deallocates memory used by a packed matrix.
+ *
+ * Args:
+ *     p: The packed matrix to be deallocated
+ */
+void mat47p_del(mat47p_t *p);
+
+/**
+ * Computes a matrix-vector product with a packed matrix, ``y = alpha * a * x + beta *
+ * y``, in place.
+ *
+ * Args:
+ *     y: A vector of ``a->n`` elements, either a column vector (``n x 1`` matrix) or
+ *       a row vector (``1 x n`` matrix)
+ *     alpha: The scale factor of the product
+ *     a: The packed matrix
+ *     x: A vector of ``a->n`` elements, either a column or a row vector
+ *     beta: The scale factor of *y*; If zero, the initial values of *y* are ignored.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the arguments is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *x* or *y* is not a
+ *       vector of the required number of elements
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *y* is the same matrix
+ *       as *x*
+ *
+ * Every stored element is read once: For symmetric matrices, each stored row is used
+ * both as a row (dot product with *x*) and as a column (scaled and added into the
+ * result) in the same pass, which is done by a single thread; Triangular matrices are
+ * processed in parallel, by blocks of rows.
+ *
+ * Column vectors are gathered a chunk at a time into a buffer on the stack; Doesn't
+ * allocate memory. *y* must not share storage with *x*. If any error occurs, *y* is
+ * left unchanged.
+ */
+void mat47p_gemv(
+    mat47_t *y, double alpha, const mat47p_t *a, const mat47_t *x, double beta
+);
+
+/**
+ * Multiplies a packed matrix by a regular matrix.
+ *
+ * Args:
+ *     a: The left operand
+ *     b: The right operand
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new (regular) matrix equal to ``a * b``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *b* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *b* doesn't have
+ *       ``a->n`` rows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * *a* is expanded a block of :c:macro:`MAT47P_BLOCK` rows by :c:macro:`MAT47P_PANEL`
+ * columns at a time into a buffer on the stack, which is multiplied by *b* with the
+ * kernel of :c:func:`mat47_mul`, in parallel; For triangular matrices, only the
+ * columns of the block within the stored triangle (and the matching rows of *b*) take
+ * part, i.e about half of the floating-point operations of a regular product.
+ */
+mat47_t *mat47p_mul(const mat47p_t *a, const mat47_t *b);
+
+/**
+ * Multiplies a packed matrix by a regular matrix, into an existing matrix.
+ *
+ * Args:
+ *     c: The product, with as many rows as *a* and columns as *b*
+ *     a: The left operand
+ *     b: The right operand
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the arguments is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *b* doesn't have
+ *       ``a->n`` rows, or *c* has the wrong dimensions
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *c* is the same matrix
+ *       as *b*
+ *
+ * See :c:func:`mat47p_mul`; Doesn't allocate memory. *c* must not share storage with
+ * *b*. If any error occurs, *c* is left unchanged.
+ */
+void mat47p_mul_into(mat47_t *c, const mat47p_t *a, const mat47_t *b);
+
+/**
+ * Packs one triangle of a square matrix.
+ *
+ * Args:
+ *     m: The matrix
+ *     kind: The structure of the packed matrix
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new packed matrix holding the lower (for
+ *       :c:enumerator:`MAT47P_SYMMETRIC` and :c:enumerator:`MAT47P_LOWER`) or upper
+ *       (for :c:enumerator:`MAT47P_UPPER`) triangle of *m*; The other elements are
+ *       ignored.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *m* is not square
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *kind* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ */
+mat47p_t *mat47p_pack(const mat47_t *m, enum mat47p_kind kind);
+
+/**
+ * Packs one triangle of a square matrix, into an existing packed matrix.
+ *
+ * Args:
+ *     dst: The packed matrix; Its structure determines the triangle packed.
+ *     m: The matrix
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *m* doesn't have
+ *       ``dst->n`` rows and columns
+ *
+ * See :c:func:`mat47p_pack`.
+ */
+void mat47p_pack_into(mat47p_t *dst, const mat47_t *m);
+
+/**
+ * Computes a symmetric rank-k update of a packed symmetric matrix,
+ * ``c = alpha * a * transpose(a) + beta * c``, in place.
+ *
+ * Args:
+ *     c: The symmetric packed matrix
+ *     alpha: The scale factor of the product
+ *     a: A matrix with ``c->n`` rows and any number of columns (``k``)
+ *     beta: The scale factor of *c*; If zero, the initial values of *c* are ignored.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *c* or *a* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* doesn't have
+ *       ``c->n`` rows
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *c* is not symmetric
+ *
+ * e.g the (unnormalized) covariance of centered observations, one per column. Blocks
+ * of :c:macro:`MAT47P_BLOCK` rows by :c:macro:`MAT47P_PANEL` columns of the product
+ * are computed on the stack, up to the diagonal, with the kernel of
+ * :c:func:`mat47_gemv_batch`, in parallel; i.e about half of the floating-point
+ * operations of the full product. If any error occurs, *c* is left unchanged.
+ */
+void mat47p_syrk(mat47p_t *c, double alpha, const mat47_t *a, double beta);
+
+/**
+ * Converts a packed matrix to a regular matrix.
+ *
+ * Args:
+ *     p: The packed matrix
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix with all the elements of *p*, including
+ *       the zero or mirrored ones.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *p* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ */
+mat47_t *mat47p_unpack(const mat47p_t *p);
+
+/**
+ * Converts a packed matrix to a regular matrix, into an existing matrix.
+ *
+ * Args:
+ *     dst: The matrix, with ``p->n`` rows and columns
+ *     p: The packed matrix
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *p* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *dst* has the wrong
+ *       dimensions
+ *
+ * See :c:func:`mat47p_unpack`.
+ */
+void mat47p_unpack_into(mat47_t *dst, const mat47p_t *p);
+
+/**
+ * Creates a new packed matrix with all elements initialized to zero.
+ *
+ * Args:
+ *     n: Number of rows (and columns)
+ *     kind: The structure of the matrix
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new packed matrix.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: *n* is zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *kind* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ */
+mat47p_t *mat47p_zero(unsigned int n, enum mat47p_kind kind);
+
+#endif  // MAT47_PACKED_H
@@ -0,0 +1,396 @@
+/* Parallelism settings
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "parallel.h"
+#include "utils.h"
+
+struct range {
+    mat47__range_fn *fn;
+    void *arg;
+    size_t begin;
+    size_t end;
+};
+
+static atomic_uint n_threads;
+
+// Set in threads running a range, so that nested calls run serially
+static _Thread_local bool in_parallel;
+
+
+unsigned int mat47_get_num_threads(void)
+{
+    unsigned int n;
+    long n_cpus;
+
+    if (!(n = atomic_load_explicit(&n_threads, memory_order_relaxed))) {
+        n = (n_cpus = sysconf(_SC_NPROCESSORS_ONLN)) > 0 ? n_cpus : 1;
+        atomic_store_explicit(&n_threads, n, memory_order_relaxed);
+    }
+
+    return n;
+}
+
+
+void mat47_set_num_threads(unsigned int n)
+{
+    atomic_store_explicit(&n_threads, n, memory_order_relaxed);
+}
+
+
+static void *run_range(void *range)
+{
+    struct range *r = range;
+
+    in_parallel = true;
+    r->fn(r->arg, r->begin, r->end);
+
+    return NULL;
+}
+
+void mat47__parallel_for(size_t n, size_t grain, mat47__range_fn *fn, void *arg)
+{
+    size_t n_ranges = 1, i, begin, step;
+
+    if (!in_parallel && grain)
+        n_ranges = min(mat47_get_num_threads(), n / grain);
+    if (n_ranges <= 1) {
+        fn(arg, 0, n);
+        return;
+    }
+
+    struct range ranges[n_ranges];
+    pthread_t threads[n_ranges];
+    bool started[n_ranges];
+
+    debug("Splitting %zu items into %zu ranges", n, n_ranges);
+
+    step = n / n_ranges;
+    for (begin = i = 0; i < n_ranges; i++, begin += step)
+        ranges[i] = (struct range){
+            fn, arg, begin, (i == n_ranges - 1 ? n : begin + step)
+        };
+
+    // The first range is run by the calling thread; If a thread can't be created,
+    // its range is run by the calling thread too.
+    for (i = 1; i < n_ranges; i++)
+        started[i] = !pthread_create(&threads[i], NULL, run_range, &ranges[i]);
+
+    in_parallel = true;
+    fn(arg, ranges[0].begin, ranges[0].end);
+    for (i = 1; i < n_ranges; i++)
+        if (!started[i]) fn(arg, ranges[i].begin, ranges[i].end);
+    in_parallel = false;
+
+    for (i = 1; i < n_ranges; i++)
+        if (started[i]) pthread_join(threads[i], NULL);
+}
+
+
+/* Task graphs.
+ *
+ * Dependencies are inferred, as tasks are added, from the last writer and the
+ * readers since of every tile, and recorded as lists of successors. Every worker has
+ * a deque of ready tasks: It pushes the successors it makes ready at the bottom and
+ * pops from the bottom (i.e depth-first, for locality, and such that a task on the
+ * critical path, e.g the next panel of a factorization, runs as soon as it's ready),
+ * while idle workers steal from the top of the others' deques. Workers that find
+ * every deque empty sleep on a condition variable, until a task is made ready or
+ * all have completed.
+ */
+
+struct task {
+    mat47__task_fn *fn;
+    void *ctx;
+    unsigned int i, j, k;
+    atomic_size_t n_deps;  // Number of uncompleted tasks it depends on
+    size_t *succ, n_succ, succ_cap;
+};
+
+struct tile {
+    size_t writer;  // Index of the last task to write it, or `NONE`
+    size_t *readers, n_readers, readers_cap;
+};
+
+struct deque {
+    pthread_mutex_t lock;
+    size_t *items, top, bottom;
+};
+
+struct mat47__dag {
+    struct task *tasks;
+    size_t n_tasks, tasks_cap;
+    struct tile *tiles;
+    size_t n_tiles;
+
+    // Used while running
+    struct deque *deques;
+    size_t n_workers;
+    atomic_size_t n_left;
+    atomic_size_t n_queued;  // Number of tasks in the deques
+    atomic_size_t n_idle;  // Number of workers sleeping, or about to
+    pthread_mutex_t idle_lock;
+    pthread_cond_t wake;
+};
+
+struct worker {
+    struct mat47__dag *dag;
+    size_t id;
+};
+
+#define NONE SIZE_MAX
+
+// Appends `item` to a growable array
+static bool push_item(size_t **items, size_t *n, size_t *cap, size_t item)
+{
+    size_t *grown;
+
+    if (*n == *cap) {
+        if (!(grown = realloc(*items, sizeof(size_t) * (*cap ? 2 * *cap : 4))))
+            return false;
+        *items = grown;
+        *cap = *cap ? 2 * *cap : 4;
+    }
+    (*items)[(*n)++] = item;
+
+    return true;
+}
+
+static bool add_edge(struct mat47__dag *dag, size_t from, size_t to)
+{
+    struct task *t;
+
+    if (from == NONE || from == to) return true;
+    t = &dag->tasks[from];
+    if (!push_item(&t->succ, &t->n_succ, &t->succ_cap, to)) return false;
+    dag->tasks[to].n_deps++;
+
+    return true;
+}
+
+
+struct mat47__dag *mat47__dag_new(size_t n_tiles)
+{
+    struct mat47__dag *dag;
+
+    if (!(dag = calloc(1, sizeof(*dag)))) return NULL;
+    if (!(dag->tiles = malloc(sizeof(*dag->tiles) * n_tiles))) {
+        free(dag);
+        return NULL;
+    }
+    for (size_t t = 0; t < n_tiles; t++)
+        dag->tiles[t] = (struct tile){NONE, NULL, 0, 0};
+    dag->n_tiles = n_tiles;
+
+    return dag;
+}
+
+
+bool mat47__dag_add(
+    struct mat47__dag *dag, mat47__task_fn *fn, void *ctx, unsigned int i,
+    unsigned int j, unsigned int k, size_t n_accesses,
+    const struct mat47__access *accesses
+) {
+    size_t id = dag->n_tasks, r;
+    struct task *grown;
+    struct tile *tile;
+
+    if (dag->n_tasks == dag->tasks_cap) {
+        r = dag->tasks_cap ? 2 * dag->tasks_cap : 64;
+        if (!(grown = realloc(dag->tasks, sizeof(*grown) * r))) return false;
+        dag->tasks = grown;
+        dag->tasks_cap = r;
+    }
+    dag->tasks[id] = (struct task){fn, ctx, i, j, k, 0, NULL, 0, 0};
+    dag->n_tasks++;
+
+    for (; n_accesses; n_accesses--, accesses++) {
+        tile = &dag->tiles[accesses->tile];
+        if (!add_edge(dag, tile->writer, id)) return false;
+        if (!accesses->write) {
+            if (!push_item(&tile->readers, &tile->n_readers, &tile->readers_cap, id))
+                return false;
+            continue;
+        }
+        for (r = 0; r < tile->n_readers; r++)
+            if (!add_edge(dag, tile->readers[r], id)) return false;
+        tile->n_readers = 0;
+        tile->writer = id;
+    }
+
+    return true;
+}
+
+
+void mat47__dag_del(struct mat47__dag *dag)
+{
+    size_t t;
+
+    if (!dag) return;
+    for (t = 0; t < dag->n_tasks; t++) free(dag->tasks[t].succ);
+    for (t = 0; t < dag->n_tiles; t++) free(dag->tiles[t].readers);
+    free(dag->tasks);
+    free(dag->tiles);
+    free(dag);
+}
+
+
+static void push_bottom(struct deque *d, size_t task)
+{
+    pthread_mutex_lock(&d->lock);
+    d->items[d->bottom++] = task;
+    pthread_mutex_unlock(&d->lock);
+}
+
+// Pops from the bottom if `own`, else from the top; Returns `NONE` if empty
+static size_t pop(struct deque *d, bool own)
+{
+    size_t task = NONE;
+
+    pthread_mutex_lock(&d->lock);
+    if (d->top < d->bottom) task = own ? d->items[--d->bottom] : d->items[d->top++];
+    // Every task is pushed once, hence the items never need to wrap around
+    if (d->top == d->bottom) d->top = d->bottom = 0;
+    pthread_mutex_unlock(&d->lock);
+
+    return task;
+}
+
+/* Pushes a ready task onto the deque of worker `w`, waking a sleeping worker if any.
+ *
+ * A worker counts itself idle before checking `n_queued` under `idle_lock`, hence it
+ * either sees the task or is counted (and woken) here.
+ */
+static void push_ready(struct mat47__dag *dag, size_t w, size_t task)
+{
+    push_bottom(&dag->deques[w], task);
+    atomic_fetch_add(&dag->n_queued, 1);
+    if (atomic_load(&dag->n_idle)) {
+        pthread_mutex_lock(&dag->idle_lock);
+        pthread_cond_signal(&dag->wake);
+        pthread_mutex_unlock(&dag->idle_lock);
+    }
+}
+
+// Sleeps until a task is queued or all have completed
+static void wait_ready(struct mat47__dag *dag)
+{
+    pthread_mutex_lock(&dag->idle_lock);
+    atomic_fetch_add(&dag->n_idle, 1);
+    while (!atomic_load(&dag->n_queued) && atomic_load(&dag->n_left))
+        pthread_cond_wait(&dag->wake, &dag->idle_lock);
+    atomic_fetch_sub(&dag->n_idle, 1);
+    pthread_mutex_unlock(&dag->idle_lock);
+}
+
+static void *work(void *arg)
+{
+    struct worker *w = arg;
+    struct mat47__dag *dag = w->dag;
+    size_t id, s, victim, n = dag->n_workers;
+    struct task *t;
+
+    in_parallel = true;
+    while (atomic_load(&dag->n_left)) {
+        id = pop(&dag->deques[w->id], true);
+        for (s = 1; id == NONE && s < n; s++) {
+            victim = (w->id + s) % n;
+            id = pop(&dag->deques[victim], false);
+        }
+        if (id == NONE) {
+            wait_ready(dag);
+            continue;
+        }
+        atomic_fetch_sub(&dag->n_queued, 1);
+
+        t = &dag->tasks[id];
+        t->fn(t->ctx, t->i, t->j, t->k);
+        // In reverse, such that the earliest added successor is popped first
+        for (s = t->n_succ; s--;)
+            if (atomic_fetch_sub(&dag->tasks[t->succ[s]].n_deps, 1) == 1)
+                push_ready(dag, w->id, t->succ[s]);
+        if (atomic_fetch_sub(&dag->n_left, 1) == 1) {
+            // The last task: Every sleeping worker can exit
+            pthread_mutex_lock(&dag->idle_lock);
+            pthread_cond_broadcast(&dag->wake);
+            pthread_mutex_unlock(&dag->idle_lock);
+        }
+    }
+
+    return NULL;
+}
+
+void mat47__dag_run(struct mat47__dag *dag)
+{
+    size_t n = in_parallel ? 1 : min(mat47_get_num_threads(), dag->n_tasks), i, w;
+    struct deque deques[n ? n : 1];
+    struct worker workers[n ? n : 1];
+    pthread_t threads[n ? n : 1];
+    bool started[n ? n : 1];
+    bool was_parallel = in_parallel;
+
+    if (!n) goto done;
+    // Every deque can hold all the tasks
+    for (w = 0; w < n; w++) {
+        if (!(deques[w].items = malloc(sizeof(size_t) * dag->n_tasks))) {
+            debug("Failed to allocate a deque; Using %zu workers", w);
+            n = w;
+            break;
+        }
+        deques[w].top = deques[w].bottom = 0;
+        pthread_mutex_init(&deques[w].lock, NULL);
+    }
+    if (!n) {
+        // Runs the tasks in the order they were added, which is a topological order
+        in_parallel = true;
+        for (i = 0; i < dag->n_tasks; i++)
+            dag->tasks[i].fn(
+                dag->tasks[i].ctx, dag->tasks[i].i, dag->tasks[i].j, dag->tasks[i].k
+            );
+        in_parallel = was_parallel;
+        goto done;
+    }
+
+    dag->deques = deques;
+    dag->n_workers = n;
+    atomic_store(&dag->n_left, dag->n_tasks);
+    atomic_store(&dag->n_queued, 0);
+    atomic_store(&dag->n_idle, 0);
+    pthread_mutex_init(&dag->idle_lock, NULL);
+    pthread_cond_init(&dag->wake, NULL);
+    for (w = i = 0; i < dag->n_tasks; i++)
+        if (!dag->tasks[i].n_deps) {
+            push_ready(dag, w, i);
+            w = (w + 1) % n;
+        }
+    debug("Running %zu tasks on %zu workers", dag->n_tasks, n);
+
+    // The calling thread is the first worker; If a thread can't be created, the
+    // others do its share.
+    for (w = 0; w < n; w++) workers[w] = (struct worker){dag, w};
+    for (w = 1; w < n; w++)
+        started[w] = !pthread_create(&threads[w], NULL, work, &workers[w]);
+    work(&workers[0]);
+    in_parallel = was_parallel;
+    for (w = 1; w < n; w++)
+        if (started[w]) pthread_join(threads[w], NULL);
+    pthread_cond_destroy(&dag->wake);
+    pthread_mutex_destroy(&dag->idle_lock);
+
+done:
+    for (w = 0; w < n; w++) {
+        free(deques[w].items);
+        pthread_mutex_destroy(&deques[w].lock);
+    }
+    mat47__dag_del(dag);
+}
@@ -0,0 +1,31 @@
+/* Parallelism settings
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_PARALLEL_H
+#define MAT47_PARALLEL_H
+
+/**
+ * Returns the maximum number of threads used by a single library function.
+ *
+ * Returns:
+ *     The value last set with :c:func:`mat47_set_num_threads` or, if unset, the number
+ *     of online processors.
+ */
+unsigned int mat47_get_num_threads(void);
+
+/**
+ * Sets the maximum number of threads used by a single library function.
+ *
+ * Args:
+ *     n: Number of threads; ``1`` disables parallelism and ``0`` restores the default
+ *       (the number of online processors)
+ *
+ * Only operations on large enough matrices are split across threads, such that every
+ * thread gets a substantial amount of work.
+ */
+void mat47_set_num_threads(unsigned int n);
+
+#endif  // MAT47_PARALLEL_H
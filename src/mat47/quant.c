@@ -0,0 +1,496 @@
+/* Quantized matrix definitions
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "matrix.h"
+#include "quant.h"
+#include "utils.h"
+
+#define uint unsigned int  // Used only where necessary, to avoid long lines
+
+// Number of `int8_t` products that can be summed in 32 bits without overflow,
+// with some headroom: 2^16 * (-128)^2 = 2^30
+#define INT8_CHUNK 65536
+
+// Approximate size (in bytes) of the block of right-operand rows reused across all
+// the rows of the left operand in `mat47q_mul_t()`; Should fit in the L2 cache.
+#define MUL_T_BLOCK_SIZE (256 * 1024)
+
+#define elem_size(type) ((type) == MAT47Q_INT8 ? sizeof(int8_t) : sizeof(int16_t))
+#define scale(q, row) ((q)->scales[(q)->scaling == MAT47Q_PER_ROW ? (row) : 0])
+
+
+/**
+ * Allocates memory for a new quantized matrix.
+ *
+ * Args:
+ *     n_rows: Number of rows
+ *     n_cols: Number of columns
+ *     type: Type of the elements
+ *     scaling: Granularity of the scale factors
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a newly allocated quantized matrix; The elements
+ *       and scale factors are uninitialized.
+ *
+ * Raises:
+ *     MAT47_ERR_ZERO_SIZE: Either dimension equals zero.
+ *     MAT47_ERR_INVALID_ARG: *type* or *scaling* is invalid.
+ *     MAT47_ERR_ALLOC: Unable to allocate memory.
+ */
+static mat47q_t *
+mat47q_new(uint n_rows, uint n_cols, enum mat47q_type type, enum mat47q_scaling scaling)
+{
+    mat47q_t *q;
+
+    if (!(n_rows && n_cols)) {
+        mat47_errno = MAT47_ERR_ZERO_SIZE;
+        error(": %u x %u", n_rows, n_cols);
+        return NULL;
+    }
+    if (
+        check(
+            type == MAT47Q_INT8 || type == MAT47Q_INT16,
+            MAT47_ERR_INVALID_ARG, ": type=%d", type
+        )
+        || check(
+            scaling == MAT47Q_PER_TENSOR || scaling == MAT47Q_PER_ROW,
+            MAT47_ERR_INVALID_ARG, ": scaling=%d", scaling
+        )
+    ) return NULL;
+
+    if (!(q = malloc(sizeof(mat47q_t)))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for quantized matrix object");
+        return NULL;
+    }
+
+    q->n_rows = n_rows;
+    q->n_cols = n_cols;
+    q->type = type;
+    q->scaling = scaling;
+    q->scales = malloc(sizeof(double) * (scaling == MAT47Q_PER_ROW ? n_rows : 1));
+    q->data = malloc(elem_size(type) * n_rows * (size_t)n_cols);
+    if (!(q->scales && q->data)) {
+        mat47q_del(q);
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for quantized elements");
+        return NULL;
+    }
+    stats_alloc(
+        3,
+        sizeof(mat47q_t) + sizeof(double) * (scaling == MAT47Q_PER_ROW ? n_rows : 1)
+        + elem_size(type) * n_rows * (size_t)n_cols
+    );
+
+    debug("Allocated quantized matrix @ %p, type=%d", (void *)q, type);
+
+    return q;
+}
+
+
+void mat47q_del(mat47q_t *q)
+{
+    stats(Q_DEL);
+
+    if (q) {
+        // Partially allocated ones (deallocated by `mat47q_new()`) aren't counted
+        if (q->scales && q->data)
+            stats_free(
+                sizeof(mat47q_t) + sizeof(double) * (
+                    q->scaling == MAT47Q_PER_ROW ? q->n_rows : 1
+                )
+                + elem_size(q->type) * q->n_rows * (size_t)q->n_cols
+            );
+        free(q->scales);
+        free(q->data);
+        debug("Deallocated quantized matrix @ %p", (void *)q);
+        free(q);
+    }
+}
+
+
+#define init(T, TYPE) \
+    stats(Q_INIT); \
+    mat47q_t *q; \
+    T *restrict data, *restrict row; \
+\
+    if (check_ptr(array) || check_ptr(scales)) return NULL; \
+    if (!(q = mat47q_new(n_rows, n_cols, TYPE, scaling))) return NULL; \
+\
+    memcpy( \
+        q->scales, scales, \
+        sizeof(double) * (scaling == MAT47Q_PER_ROW ? n_rows : 1) \
+    ); \
+    data = q->data; \
+    while (n_rows--) { \
+        if (!(row = array[n_rows])) { \
+            mat47q_del(q); \
+            mat47_errno = MAT47_ERR_NULL_PTR; \
+            error(": `array[%u]`", n_rows); \
+            return NULL; \
+        } \
+        memcpy(data + (size_t)n_rows * n_cols, row, sizeof(T) * n_cols); \
+        stats_copy(sizeof(T) * n_cols); \
+    } \
+\
+    return q;
+
+mat47q_t *mat47q_init_int8(
+    uint n_rows, uint n_cols, int8_t **restrict array,
+    enum mat47q_scaling scaling, const double *scales
+) {
+    init(int8_t, MAT47Q_INT8)
+}
+
+mat47q_t *mat47q_init_int16(
+    uint n_rows, uint n_cols, int16_t **restrict array,
+    enum mat47q_scaling scaling, const double *scales
+) {
+    init(int16_t, MAT47Q_INT16)
+}
+
+#undef init
+
+
+// Returns true (with `mat47_errno` set) if any element of `m` is infinite or NaN
+static bool check_finite(const mat47_t *m)
+{
+    unsigned int i, j;
+    const double *restrict row;
+
+    for (i = 0; i < m->n_rows; i++)
+        for (row = m->data[i], j = 0; j < m->n_cols; j++)
+            if (check(
+                isfinite(row[j]),
+                MAT47_ERR_INVALID_ARG, ": m[%u][%u]=%g is not finite", i, j, row[j]
+            ))
+                return true;
+
+    return false;
+}
+
+// `q` must have the same dimensions as `m`, and the elements of `m` must be finite
+static void quantize(const mat47_t *m, mat47q_t *q)
+{
+    unsigned int i, j, n_rows = m->n_rows, n_cols = m->n_cols;
+    double *restrict row, max_abs = 0, max_int, inv_scale;
+
+    max_int = q->type == MAT47Q_INT8 ? INT8_MAX : INT16_MAX;
+
+    if (q->scaling == MAT47Q_PER_TENSOR) {
+        for (i = 0; i < n_rows; i++)
+            for (row = m->data[i], j = 0; j < n_cols; j++) imax(max_abs, fabs(row[j]));
+        q->scales[0] = max_abs ? max_abs / max_int : 1;
+    }
+
+    for (i = 0; i < n_rows; i++) {
+        row = m->data[i];
+        if (q->scaling == MAT47Q_PER_ROW) {
+            for (max_abs = 0, j = 0; j < n_cols; j++) imax(max_abs, fabs(row[j]));
+            q->scales[i] = max_abs ? max_abs / max_int : 1;
+        }
+        inv_scale = 1 / scale(q, i);
+
+        // Values can't exceed `max_int` in magnitude after scaling, as the scale is
+        // computed from the largest one.
+        if (q->type == MAT47Q_INT8) {
+            int8_t *restrict q_row = (int8_t *)q->data + (size_t)i * n_cols;
+            for (j = 0; j < n_cols; j++) q_row[j] = lrint(row[j] * inv_scale);
+        } else {
+            int16_t *restrict q_row = (int16_t *)q->data + (size_t)i * n_cols;
+            for (j = 0; j < n_cols; j++) q_row[j] = lrint(row[j] * inv_scale);
+        }
+    }
+}
+
+mat47q_t *
+mat47q_quantize(const mat47_t *m, enum mat47q_type type, enum mat47q_scaling scaling)
+{
+    stats(Q_QUANTIZE);
+    mat47q_t *q;
+
+    if (check_ptr(m) || check_finite(m)) return NULL;
+    if (!(q = mat47q_new(m->n_rows, m->n_cols, type, scaling))) return NULL;
+    quantize(m, q);
+
+    return q;
+}
+
+
+void mat47q_quantize_into(mat47q_t *dst, const mat47_t *m)
+{
+    stats(Q_QUANTIZE_INTO);
+
+    if (check_ptr(dst) || check_ptr(m)) return;
+    if (check_eq(dst->n_rows, m->n_rows) || check_eq(dst->n_cols, m->n_cols)) return;
+    if (check_finite(m)) return;
+
+    quantize(m, dst);
+}
+
+
+// `m` must have the same dimensions as `q`
+static void dequantize(const mat47q_t *q, mat47_t *m)
+{
+    unsigned int i, j, n_cols = q->n_cols;
+    double *restrict row, s;
+
+    for (i = 0; i < q->n_rows; i++) {
+        row = m->data[i];
+        s = scale(q, i);
+        if (q->type == MAT47Q_INT8) {
+            int8_t *restrict q_row = (int8_t *)q->data + (size_t)i * n_cols;
+            for (j = 0; j < n_cols; j++) row[j] = s * q_row[j];
+        } else {
+            int16_t *restrict q_row = (int16_t *)q->data + (size_t)i * n_cols;
+            for (j = 0; j < n_cols; j++) row[j] = s * q_row[j];
+        }
+    }
+}
+
+mat47_t *mat47q_dequantize(const mat47q_t *q)
+{
+    stats(Q_DEQUANTIZE);
+    mat47_t *m;
+
+    if (check_ptr(q)) return NULL;
+    if (!(m = mat47__new(q->n_rows, q->n_cols, false))) return NULL;
+    dequantize(q, m);
+
+    return m;
+}
+
+
+void mat47q_dequantize_into(mat47_t *dst, const mat47q_t *q)
+{
+    stats(Q_DEQUANTIZE_INTO);
+
+    if (check_ptr(dst) || check_ptr(q)) return;
+    if (check_eq(dst->n_rows, q->n_rows) || check_eq(dst->n_cols, q->n_cols)) return;
+
+    bump_version(dst);
+    dequantize(q, dst);
+}
+
+
+/* Integer dot products.
+ *
+ * The inner loops are in the plain widening multiply-accumulate form, which compilers
+ * vectorize. `dot4_*()` computes the dot products of one row with four others, such
+ * that each element of the first row is loaded once for all four.
+ *
+ * `int8_t` elements are widened to `int16_t`, `WIDEN_CHUNK` at a time, and their
+ * products summed in 32 bits: That's the form compiled into `pmaddwd` (or the VNNI
+ * `vpdpwssd`), which multiplies pairs of `int16_t` and sums each pair in 32 bits;
+ * Products of `int8_t` (at most 2^14 in magnitude) can't overflow it. The sums spill
+ * into 64 bits every `INT8_CHUNK` elements. `int16_t` products can overflow 32 bits
+ * after only two additions, hence they're summed in 64 bits throughout.
+ */
+
+/* The products are compiled for several instruction sets, with the dot products
+ * forcibly inlined into each, the best one supported by the CPU being selected when
+ * the library is loaded; e.g `vpdpwssd` with AVX-512 VNNI or AVX-VNNI, `vpmaddwd`
+ * with AVX2. Only where the compiler and C library support it (GCC-compatible
+ * compilers, on x86-64 with glibc); Otherwise, for the target the library is
+ * compiled for.
+ */
+#if defined(__x86_64__) && defined(__GLIBC__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define KERNEL_CLONES __attribute__((target_clones( \
+    "arch=icelake-server", "arch=alderlake", "arch=haswell", "default" \
+)))
+#define KERNEL_INLINE __attribute__((always_inline)) inline
+#endif
+#endif
+#ifndef KERNEL_CLONES
+#define KERNEL_CLONES
+#define KERNEL_INLINE inline
+#endif
+
+// Number of `int8_t` elements widened at a time, per row
+#define WIDEN_CHUNK 64
+
+// `int16_t` dot product of `WIDEN_CHUNK` widened `int8_t` elements
+static KERNEL_INLINE int32_t
+dot_widened(const int16_t *restrict a, const int16_t *restrict b)
+{
+    int32_t acc = 0;
+
+    for (unsigned int j = 0; j < WIDEN_CHUNK; j++) acc += a[j] * b[j];
+    return acc;
+}
+
+// Widens `n` (at most `WIDEN_CHUNK`) elements into `dst`, zero-padded
+static KERNEL_INLINE void
+widen(int16_t *restrict dst, const int8_t *restrict src, unsigned int n)
+{
+    unsigned int j;
+
+    for (j = 0; j < n; j++) dst[j] = src[j];
+    for (; j < WIDEN_CHUNK; j++) dst[j] = 0;
+}
+
+static KERNEL_INLINE int64_t
+dot_int8_t(const int8_t *restrict a, const int8_t *restrict b, unsigned int n)
+{
+    int16_t wa[WIDEN_CHUNK], wb[WIDEN_CHUNK];
+    unsigned int j, end, w;
+    int64_t sum = 0;
+
+    for (j = 0; j < n;) {
+        int32_t acc = 0;
+
+        for (end = j + min(n - j, INT8_CHUNK); j < end; j += w) {
+            w = min(end - j, WIDEN_CHUNK);
+            widen(wa, a + j, w);
+            widen(wb, b + j, w);
+            acc += dot_widened(wa, wb);
+        }
+        sum += acc;
+    }
+
+    return sum;
+}
+
+static KERNEL_INLINE void dot4_int8_t(
+    const int8_t *restrict a, const int8_t *const b[4], unsigned int n, int64_t sum[4]
+) {
+    int16_t wa[WIDEN_CHUNK], wb[4][WIDEN_CHUNK];
+    unsigned int j, end, w, k;
+
+    sum[0] = sum[1] = sum[2] = sum[3] = 0;
+    for (j = 0; j < n;) {
+        int32_t acc[4] = {0};
+
+        for (end = j + min(n - j, INT8_CHUNK); j < end; j += w) {
+            w = min(end - j, WIDEN_CHUNK);
+            widen(wa, a + j, w);
+            for (k = 0; k < 4; k++) widen(wb[k], b[k] + j, w);
+            for (k = 0; k < 4; k++) acc[k] += dot_widened(wa, wb[k]);
+        }
+        for (k = 0; k < 4; k++) sum[k] += acc[k];
+    }
+}
+
+static KERNEL_INLINE int64_t
+dot_int16_t(const int16_t *restrict a, const int16_t *restrict b, unsigned int n)
+{
+    int64_t sum = 0;
+
+    for (unsigned int j = 0; j < n; j++) sum += (int64_t)a[j] * b[j];
+    return sum;
+}
+
+static KERNEL_INLINE void dot4_int16_t(
+    const int16_t *restrict a, const int16_t *const b[4], unsigned int n,
+    int64_t sum[4]
+) {
+    const int16_t *restrict b0 = b[0], *restrict b1 = b[1], *restrict b2 = b[2],
+        *restrict b3 = b[3];
+    int64_t acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+
+    for (unsigned int j = 0; j < n; j++) {
+        acc0 += (int64_t)a[j] * b0[j];
+        acc1 += (int64_t)a[j] * b1[j];
+        acc2 += (int64_t)a[j] * b2[j];
+        acc3 += (int64_t)a[j] * b3[j];
+    }
+    sum[0] = acc0; sum[1] = acc1; sum[2] = acc2; sum[3] = acc3;
+}
+
+/* `c = a * transpose(b)`, blocked over the rows of `b` so that a block stays in cache
+ * while every row of `a` is multiplied with it.
+ */
+#define mul_t(T) \
+KERNEL_CLONES \
+static void mul_t_##T(const mat47q_t *a, const mat47q_t *b, mat47_t *c) \
+{ \
+    unsigned int i, j, j_start, j_end, k, n = a->n_cols, n_b = b->n_rows; \
+    unsigned int block = max(4, MUL_T_BLOCK_SIZE / (sizeof(T) * n) / 4 * 4); \
+    const T *restrict a_row, *restrict b_data = b->data, *b_rows[4]; \
+    double *restrict c_row, s; \
+    int64_t sums[4]; \
+\
+    for (j_start = 0; j_start < n_b; j_start = j_end) { \
+        j_end = j_start + min(n_b - j_start, block); \
+        for (i = 0; i < a->n_rows; i++) { \
+            a_row = (T *)a->data + (size_t)i * n; \
+            c_row = c->data[i]; \
+            s = scale(a, i); \
+            for (j = j_start; j + 4 <= j_end; j += 4) { \
+                for (k = 0; k < 4; k++) b_rows[k] = b_data + (size_t)(j + k) * n; \
+                dot4_##T(a_row, b_rows, n, sums); \
+                for (k = 0; k < 4; k++) c_row[j + k] = s * scale(b, j + k) * sums[k]; \
+            } \
+            for (; j < j_end; j++) \
+                c_row[j] = \
+                    s * scale(b, j) * dot_##T(a_row, b_data + (size_t)j * n, n); \
+        } \
+    } \
+}
+
+mul_t(int8_t)
+mul_t(int16_t)
+
+#undef mul_t
+
+// Returns true (with `mat47_errno` set) if `a` and `b` can't be multiplied
+static bool check_mul_t(const mat47q_t *a, const mat47q_t *b)
+{
+    return (
+        check_eq(a->n_cols, b->n_cols)
+        || check(
+            a->type == b->type,
+            MAT47_ERR_INVALID_ARG, ": a->type=%d, b->type=%d", a->type, b->type
+        )
+    );
+}
+
+static void mul_t(const mat47q_t *a, const mat47q_t *b, mat47_t *c)
+{
+    debug(
+        "Multiplying %u x %u by transpose of %u x %u, type=%d",
+        a->n_rows, a->n_cols, b->n_rows, b->n_cols, a->type
+    );
+
+    if (a->type == MAT47Q_INT8)
+        mul_t_int8_t(a, b, c);
+    else
+        mul_t_int16_t(a, b, c);
+}
+
+mat47_t *mat47q_mul_t(const mat47q_t *a, const mat47q_t *b)
+{
+    stats(Q_MUL_T);
+    mat47_t *c;
+
+    if (check_ptr(a) || check_ptr(b) || check_mul_t(a, b)) return NULL;
+    if (!(c = mat47__new(a->n_rows, b->n_rows, false))) return NULL;
+    mul_t(a, b, c);
+
+    return c;
+}
+
+
+void mat47q_mul_t_into(mat47_t *c, const mat47q_t *a, const mat47q_t *b)
+{
+    stats(Q_MUL_T_INTO);
+
+    if (check_ptr(c) || check_ptr(a) || check_ptr(b) || check_mul_t(a, b)) return;
+    if (check_eq(c->n_rows, a->n_rows) || check_eq(c->n_cols, b->n_rows)) return;
+
+    bump_version(c);
+    mul_t(a, b, c);
+}
@@ -0,0 +1,241 @@
+/* Quantized matrix definitions
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_QUANT_H
+#define MAT47_QUANT_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+
+// Used only where necessary, to avoid long lines; Undefined later in this header
+#define uint unsigned int
+
+/** Integer types in which the elements of quantized matrices can be stored */
+enum mat47q_type {
+    /** ``int8_t`` elements */
+    MAT47Q_INT8 = 1,
+
+    /** ``int16_t`` elements */
+    MAT47Q_INT16
+};
+
+/** Granularity of the scale factors of quantized matrices */
+enum mat47q_scaling {
+    /** A single scale factor for the entire matrix */
+    MAT47Q_PER_TENSOR = 1,
+
+    /** One scale factor per row */
+    MAT47Q_PER_ROW
+};
+
+/**
+ * The quantized matrix type definition.
+ *
+ * The value represented by an element is the stored integer multiplied by the scale
+ * factor of the matrix or of the element's row.
+ */
+struct mat47q {
+
+    /** Number of rows */
+    unsigned int n_rows;
+
+    /** Number of columns */
+    unsigned int n_cols;
+
+    /** Type of the stored elements */
+    enum mat47q_type type;
+
+    /** Granularity of the scale factors */
+    enum mat47q_scaling scaling;
+
+    /** Scale factors; One, or one per row, depending on :c:member:`scaling` */
+    double *scales;
+
+    /** Elements, contiguous and in row-major order */
+    void *data;
+};
+
+/** The quantized matrix type (Alias of :c:struct:`struct mat47q<mat47q>`) */
+typedef struct mat47q mat47q_t;
+
+/**
+ * Deallocates memory used by a quantized matrix.
+ *
+ * Args:
+ *     q: The quantized matrix to be deallocated
+ */
+void mat47q_del(mat47q_t *q);
+
+/**
+ * Converts a quantized matrix to a regular matrix.
+ *
+ * Args:
+ *     q: The quantized matrix
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new matrix holding the values represented by *q*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *q* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ */
+mat47_t *mat47q_dequantize(const mat47q_t *q);
+
+/**
+ * Converts a quantized matrix to a regular matrix, into an existing matrix.
+ *
+ * Args:
+ *     dst: The matrix into which to store the values represented by *q*
+ *     q: The quantized matrix
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *q* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *dst* and *q* have
+ *       different dimensions
+ *
+ * See :c:func:`mat47_copy_into`.
+ */
+void mat47q_dequantize_into(mat47_t *dst, const mat47q_t *q);
+
+/**
+ * Creates a new quantized matrix and initializes it from the given array.
+ *
+ * Args:
+ *     n_rows (``unsigned int``): Number of rows in the array
+ *     n_cols (``unsigned int``): Number of columns in the array
+ *     array (``T **restrict``): 2D array from which the matrix should be initialized
+ *     scaling (:c:enum:`mat47q_scaling`): Granularity of *scales*
+ *     scales (``const double *``): Scale factor(s); One, or *n_rows*, depending on
+ *       *scaling*
+ *
+ * Returns:
+ *     :c:type:`mat47q_t *<mat47q_t>`:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new quantized matrix.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *array* (or any of the
+ *       pointers it points to) or *scales* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ZERO_SIZE`: Either dimension equals zero
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *scaling* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * ``T`` can be ``int8_t`` or ``int16_t`` and the elements are stored with the same
+ * type, without widening.
+ *
+ * Note:
+ *     The behaviour is undefined if either dimension is greater than the respective
+ *     dimension of the given array or *scales* has less elements than required.
+ */
+#define mat47q_init(n_rows, n_cols, array, scaling, scales) \
+    _Generic( \
+        (array), int8_t **: mat47q_init_int8, int16_t **: mat47q_init_int16 \
+    )(n_rows, n_cols, array, scaling, scales)
+
+// See ``mat47q_init``
+mat47q_t *mat47q_init_int8(
+    uint n_rows, uint n_cols, int8_t **restrict array,
+    enum mat47q_scaling scaling, const double *scales
+);
+mat47q_t *mat47q_init_int16(
+    uint n_rows, uint n_cols, int16_t **restrict array,
+    enum mat47q_scaling scaling, const double *scales
+);
+
+/**
+ * Multiplies a quantized matrix by the transpose of another.
+ *
+ * Args:
+ *     a: The left operand
+ *     b: The right operand, whose transpose is used
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new (regular) matrix equal to ``a * transpose(b)``.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *b* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* and *b* have
+ *       different numbers of columns
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *a* and *b* have
+ *       different element types
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Every element of the result is the dot product of a row of *a* and a row of *b*
+ * (e.g for similarity scores between two sets of embeddings). The products are
+ * accumulated exactly, in integers (32-bit for ``int8_t`` elements, 64-bit for
+ * ``int16_t`` elements), and scaled only once per result element.
+ */
+mat47_t *mat47q_mul_t(const mat47q_t *a, const mat47q_t *b);
+
+/**
+ * Multiplies a quantized matrix by the transpose of another, into an existing matrix.
+ *
+ * Args:
+ *     c: The matrix into which to store the product; Must have as many rows as *a*
+ *       and as many columns as *b* has rows.
+ *     a: The left operand
+ *     b: The right operand, whose transpose is used
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: Any of the arguments is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* and *b* have
+ *       different numbers of columns, or *c* has the wrong dimensions
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *a* and *b* have
+ *       different element types
+ *
+ * See :c:func:`mat47q_mul_t` and :c:func:`mat47_copy_into`.
+ */
+void mat47q_mul_t_into(mat47_t *c, const mat47q_t *a, const mat47q_t *b);
+
+/**
+ * Quantizes a matrix.
+ *
+ * Args:
+ *     m: The matrix to be quantized
+ *     type: Type of the quantized elements
+ *     scaling: Granularity of the scale factors
+ *
+ * Returns:
+ *     - A null pointer, if any of the error conditions below occur.
+ *     - Otherwise, a pointer to a new quantized matrix approximating *m*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *type* or *scaling* is
+ *       invalid, or an element of *m* is infinite or NaN
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Quantization is symmetric i.e the largest absolute value (in the matrix or row)
+ * maps to the largest value of *type* (``127`` or ``32767``) and zero maps to zero.
+ */
+mat47q_t *
+mat47q_quantize(const mat47_t *m, enum mat47q_type type, enum mat47q_scaling scaling);
+
+/**
+ * Quantizes a matrix into an existing quantized matrix.
+ *
+ * Args:
+ *     dst: The quantized matrix into which to store the result; Its element type
+ *       and scaling granularity are used.
+ *     m: The matrix to be quantized
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *dst* and *m* have
+ *       different dimensions
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: An element of *m* is
+ *       infinite or NaN
+ *
+ * See :c:func:`mat47q_quantize` and :c:func:`mat47_copy_into`.
+ */
+void mat47q_quantize_into(mat47q_t *dst, const mat47_t *m);
+
+#undef uint
+
+#endif  // MAT47_QUANT_H
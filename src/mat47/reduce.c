@@ -0,0 +1,948 @@
+/* Reductions
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include "error.h"
+#include "matrix.h"
+#include "reduce.h"
+#include "utils.h"
+
+// Elements per vector; Vectors wider than the target's registers would only be split
+#ifdef __AVX__
+#define W 4
+#else
+#define W 2
+#endif
+
+// Number of elements summed with the plain kernel at the leaves of pairwise summation
+#define PAIRWISE_BLOCK 128
+
+// Maximum number of rows (or blocks of rows) whose partial results are stored on the
+// stack
+#define STACK_ROWS 256
+
+// Maximum number of elements of scratch space for column-wise reductions stored on
+// the stack
+#define STACK_SCRATCH 1024
+
+// Number of elements reduced to their extremum before its index is looked up, small
+// enough for the lookup to hit L1 cache
+#define EXTREMUM_CHUNK 512
+
+typedef double vec __attribute__((vector_size(W * sizeof(double))));
+typedef int64_t ivec __attribute__((vector_size(W * sizeof(int64_t))));
+
+typedef double kernel_fn(const double *restrict x, const double *restrict y, size_t n);
+
+// The kernels of a reduction, one per summation mode
+struct kernels {
+    kernel_fn *fast;
+    kernel_fn *pairwise;
+    kernel_fn *kahan;
+};
+
+// Extremum of a range of elements
+struct extremum {
+    double value;
+    int64_t index;  // Negative if none was found
+};
+
+
+static inline vec load(const double *p)
+{
+    vec v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline vec vabs(vec v)
+{
+    return (vec)((ivec)v & INT64_MAX);
+}
+
+/* Per-lane `a > b ? a : b` and `a < b ? a : b`, hence `b` where `a` is NaN.
+ *
+ * Compilers don't derive `maxpd`/`minpd` from the generic comparisons and blends.
+ */
+#if defined(__AVX__)
+#define vec_max _mm256_max_pd
+#define vec_min _mm256_min_pd
+#elif defined(__SSE2__)
+#define vec_max _mm_max_pd
+#define vec_min _mm_min_pd
+#else
+static inline vec vec_max(vec a, vec b)
+{
+    ivec mask = a > b;
+
+    return (vec)(((ivec)a & mask) | ((ivec)b & ~mask));
+}
+
+static inline vec vec_min(vec a, vec b)
+{
+    ivec mask = a < b;
+
+    return (vec)(((ivec)a & mask) | ((ivec)b & ~mask));
+}
+#endif
+
+static inline void kahan_add(double *sum, double *comp, double x)
+{
+    double y = x - *comp, t = *sum + y;
+
+    *comp = (t - *sum) - y;
+    *sum = t;
+}
+
+
+/* Reduction kernels, summing `ELEM_<OP>(x, y, j)` over `0 <= j < n`.
+ *
+ * Floating-point addition isn't associative, hence compilers don't vectorize these
+ * loops by themselves (without `-ffast-math`, which would also break the
+ * compensation); Hence the explicit vectors, in multiple independent accumulators to
+ * hide the latency of additions.
+ */
+#define ELEM_sum(x, y, j) (x)[j]
+#define VELEM_sum(x, y, j) load((x) + (j))
+#define ELEM_sum_sq(x, y, j) ((x)[j] * (x)[j])
+#define VELEM_sum_sq(x, y, j) (load((x) + (j)) * load((x) + (j)))
+#define ELEM_sum_abs(x, y, j) fabs((x)[j])
+#define VELEM_sum_abs(x, y, j) vabs(load((x) + (j)))
+#define ELEM_dot(x, y, j) ((x)[j] * (y)[j])
+#define VELEM_dot(x, y, j) (load((x) + (j)) * load((y) + (j)))
+
+#define fast_kernel(OP) \
+static double fast_##OP(const double *restrict x, const double *restrict y, size_t n) \
+{ \
+    vec acc0 = {0}, acc1 = {0}, acc2 = {0}, acc3 = {0}; \
+    double s = 0; \
+    size_t j; \
+\
+    (void)y; \
+    for (j = 0; j + 4 * W <= n; j += 4 * W) { \
+        acc0 += VELEM_##OP(x, y, j); \
+        acc1 += VELEM_##OP(x, y, j + W); \
+        acc2 += VELEM_##OP(x, y, j + 2 * W); \
+        acc3 += VELEM_##OP(x, y, j + 3 * W); \
+    } \
+    for (; j + W <= n; j += W) acc0 += VELEM_##OP(x, y, j); \
+    acc0 = (acc0 + acc1) + (acc2 + acc3); \
+    for (int k = 0; k < W; k++) s += acc0[k]; \
+    for (; j < n; j++) s += ELEM_##OP(x, y, j); \
+\
+    return s; \
+}
+
+#define kernels(OP) \
+fast_kernel(OP) \
+\
+static double \
+pairwise_##OP(const double *restrict x, const double *restrict y, size_t n) \
+{ \
+    size_t half; \
+\
+    if (n <= PAIRWISE_BLOCK) return fast_##OP(x, y, n); \
+\
+    half = n / 2 / (4 * W) * (4 * W); \
+    return ( \
+        pairwise_##OP(x, y, half) \
+        + pairwise_##OP(x + half, (y ? y + half : y), n - half) \
+    ); \
+} \
+\
+static double kahan_##OP(const double *restrict x, const double *restrict y, size_t n) \
+{ \
+    vec s0 = {0}, s1 = {0}, c0 = {0}, c1 = {0}, v, t; \
+    double s = 0, c = 0; \
+    size_t j; \
+\
+    (void)y; \
+    for (j = 0; j + 2 * W <= n; j += 2 * W) { \
+        v = VELEM_##OP(x, y, j) - c0; \
+        t = s0 + v; \
+        c0 = (t - s0) - v; \
+        s0 = t; \
+        v = VELEM_##OP(x, y, j + W) - c1; \
+        t = s1 + v; \
+        c1 = (t - s1) - v; \
+        s1 = t; \
+    } \
+    for (int k = 0; k < W; k++) { \
+        kahan_add(&s, &c, s0[k]); \
+        kahan_add(&s, &c, s1[k]); \
+        kahan_add(&s, &c, -c0[k]); \
+        kahan_add(&s, &c, -c1[k]); \
+    } \
+    for (; j < n; j++) kahan_add(&s, &c, ELEM_##OP(x, y, j)); \
+\
+    return s - c; \
+} \
+\
+static const struct kernels OP##_kernels = {fast_##OP, pairwise_##OP, kahan_##OP};
+
+kernels(sum)
+kernels(sum_sq)
+kernels(dot)
+// Sums of absolute values involve no cancellation
+fast_kernel(sum_abs)
+
+#undef fast_kernel
+#undef kernels
+
+static kernel_fn *get_kernel(const struct kernels *k, enum mat47_sum_mode mode)
+{
+    switch (mode) {
+    case MAT47_SUM_FAST: return k->fast;
+    case MAT47_SUM_PAIRWISE: return k->pairwise;
+    case MAT47_SUM_KAHAN: return k->kahan;
+    }
+
+    mat47_errno = MAT47_ERR_INVALID_ARG;
+    error(": mode=%d", mode);
+    return NULL;
+}
+
+
+/* Whole-matrix reductions.
+ *
+ * The rows are split into at most `STACK_ROWS` blocks, of a number of rows that
+ * depends only on the size of the matrix (for reproducibility), whose results are
+ * computed separately (in parallel, for large matrices) and then combined in order.
+ *
+ * The rows of a block are contiguous if the matrix is stored in a single buffer,
+ * and are then reduced as a single vector; Otherwise, they are reduced one by one,
+ * with their results summed in chunks of `CHUNK_ROWS`.
+ */
+
+// Number of rows whose results are summed at once, in blocks of non-contiguous rows
+#define CHUNK_ROWS 64
+
+struct blocks_args {
+    kernel_fn *kernel;
+    kernel_fn *sum_kernel;  // Of the results of the rows of a block
+    const mat47_t *a;
+    const mat47_t *b;
+    unsigned int block_rows;
+    double *results;  // Per block of rows
+};
+
+static void reduce_blocks_range(void *args, size_t begin, size_t end)
+{
+    struct blocks_args *a = args;
+    double chunk[CHUNK_ROWS], total, comp;
+    unsigned int i, i0, i1, k, n_cols = a->a->n_cols;
+    double **x = a->a->data, **y = (a->b ? a->b->data : NULL);
+    bool flat = a->a->block && (!a->b || a->b->block);
+
+    for (; begin < end; begin++) {
+        i0 = begin * a->block_rows;
+        i1 = min(i0 + a->block_rows, a->a->n_rows);
+
+        if (flat || i1 - i0 == 1) {
+            a->results[begin] = a->kernel(
+                x[i0], (y ? y[i0] : NULL), (size_t)(i1 - i0) * n_cols
+            );
+            continue;
+        }
+
+        for (total = comp = 0, i = i0; i < i1; i += k) {
+            for (k = 0; k < CHUNK_ROWS && i + k < i1; k++)
+                chunk[k] = a->kernel(x[i + k], (y ? y[i + k] : NULL), n_cols);
+            kahan_add(&total, &comp, a->sum_kernel(chunk, NULL, k));
+        }
+        a->results[begin] = total - comp;
+    }
+}
+
+/* Returns the number of blocks of rows (of `*block_rows` rows each, except maybe the
+ * last) the rows of `m` should be split into, for whole-matrix reductions; At most
+ * `STACK_ROWS`.
+ */
+static unsigned int reduce_blocks(const mat47_t *m, unsigned int *block_rows)
+{
+    *block_rows = (m->n_rows + STACK_ROWS - 1) / STACK_ROWS;
+    return (m->n_rows + *block_rows - 1) / *block_rows;
+}
+
+/* Sums the reduction of every row, such that the result is the same regardless of
+ * how many threads the rows are split across.
+ */
+static double reduce(
+    const struct kernels *k, const mat47_t *a, const mat47_t *b,
+    enum mat47_sum_mode mode
+) {
+    double results[STACK_ROWS];
+    unsigned int n_blocks, block_rows;
+    kernel_fn *kernel, *sum_kernel;
+
+    if (!(kernel = get_kernel(k, mode))) return NAN;
+    sum_kernel = get_kernel(&sum_kernels, mode);
+
+    n_blocks = reduce_blocks(a, &block_rows);
+    mat47__parallel_for(
+        n_blocks, PARALLEL_GRAIN / ((size_t)block_rows * a->n_cols) + 1,
+        reduce_blocks_range,
+        &(struct blocks_args){kernel, sum_kernel, a, b, block_rows, results}
+    );
+
+    return sum_kernel(results, NULL, n_blocks);
+}
+
+
+double mat47_sum(const mat47_t *m, enum mat47_sum_mode mode)
+{
+    stats(SUM);
+
+    if (check_ptr(m)) return NAN;
+
+    return reduce(&sum_kernels, m, NULL, mode);
+}
+
+
+double mat47_dot(const mat47_t *a, const mat47_t *b, enum mat47_sum_mode mode)
+{
+    stats(DOT);
+
+    if (check_ptr(a) || check_ptr(b)) return NAN;
+    if (check_eq(a->n_rows, b->n_rows) || check_eq(a->n_cols, b->n_cols)) return NAN;
+
+    return reduce(&dot_kernels, a, b, mode);
+}
+
+
+double mat47_norm_fro(const mat47_t *m, enum mat47_sum_mode mode)
+{
+    stats(NORM_FRO);
+
+    if (check_ptr(m)) return NAN;
+
+    return sqrt(reduce(&sum_sq_kernels, m, NULL, mode));
+}
+
+
+struct rows_args {
+    kernel_fn *kernel;
+    double **x;
+    size_t n_cols;
+    unsigned int n_rows;
+    unsigned int block_rows;
+    double *results;  // Per block of rows, if not null
+    double **out;  // Otherwise, per row, into the first column
+};
+
+// Largest of `x` and `y`, or NaN if either is NaN
+static inline double max_nan(double x, double y)
+{
+    return isnan(x) || y <= x ? x : y;
+}
+
+static void row_sums_range(void *args, size_t begin, size_t end)
+{
+    struct rows_args *a = args;
+    unsigned int i, i1;
+    double norm;
+
+    if (a->out) {
+        for (; begin < end; begin++)
+            a->out[begin][0] = a->kernel(a->x[begin], NULL, a->n_cols);
+        return;
+    }
+
+    // Largest row sum per block; NaNs are propagated
+    for (; begin < end; begin++) {
+        i1 = min((begin + 1) * a->block_rows, a->n_rows);
+        for (norm = 0, i = begin * a->block_rows; i < i1; i++)
+            norm = max_nan(norm, a->kernel(a->x[i], NULL, a->n_cols));
+        a->results[begin] = norm;
+    }
+}
+
+
+double mat47_norm_inf(const mat47_t *m)
+{
+    stats(NORM_INF);
+    double results[STACK_ROWS], norm = 0;
+    unsigned int n_blocks, block_rows;
+
+    if (check_ptr(m)) return NAN;
+
+    n_blocks = reduce_blocks(m, &block_rows);
+    mat47__parallel_for(
+        n_blocks, PARALLEL_GRAIN / ((size_t)block_rows * m->n_cols) + 1,
+        row_sums_range,
+        &(struct rows_args){
+            fast_sum_abs, m->data, m->n_cols, m->n_rows, block_rows, results, NULL
+        }
+    );
+
+    for (unsigned int b = 0; b < n_blocks; b++) norm = max_nan(norm, results[b]);
+
+    return norm;
+}
+
+
+/* Column-wise sums.
+ *
+ * Computed in a single row-major sweep, by adding whole rows into a row of
+ * accumulators (which is vectorized by the compiler, as every column is independent),
+ * instead of walking down every column with a stride.
+ *
+ * The rows are split into a number of blocks that depends only on the size of the
+ * matrix (for reproducibility), whose sums are computed separately (in parallel, for
+ * large matrices) and then combined in order.
+ */
+
+struct cols_args {
+    double **x;
+    unsigned int n_rows;
+    unsigned int n_cols;
+    unsigned int block_rows;
+    enum mat47_sum_mode mode;
+    bool abs;
+    double *sums;  // Column sums, per block of rows
+    double *work;  // `depth` rows of scratch space, per block of rows
+    unsigned int depth;
+};
+
+static inline void
+add_row(double *restrict sums, const double *restrict row, unsigned int n, bool abs)
+{
+    if (abs)
+        for (unsigned int j = 0; j < n; j++) sums[j] += fabs(row[j]);
+    else
+        for (unsigned int j = 0; j < n; j++) sums[j] += row[j];
+}
+
+static void plain_cols(
+    double **x, unsigned int begin, unsigned int end, unsigned int n_cols, bool abs,
+    double *restrict sums
+) {
+    memset(sums, 0, sizeof(double) * n_cols);
+    for (; begin < end; begin++) add_row(sums, x[begin], n_cols, abs);
+}
+
+// `work` holds a row per level of recursion
+static void pairwise_cols(
+    double **x, unsigned int begin, unsigned int end, unsigned int n_cols, bool abs,
+    double *restrict sums, double *restrict work
+) {
+    unsigned int half;
+
+    if (end - begin <= PAIRWISE_BLOCK) {
+        plain_cols(x, begin, end, n_cols, abs, sums);
+        return;
+    }
+
+    half = begin + (end - begin) / 2;
+    pairwise_cols(x, begin, half, n_cols, abs, sums, work + n_cols);
+    pairwise_cols(x, half, end, n_cols, abs, work, work + n_cols);
+    add_row(sums, work, n_cols, false);
+}
+
+static void kahan_cols(
+    double **x, unsigned int begin, unsigned int end, unsigned int n_cols, bool abs,
+    double *restrict sums, double *restrict comps
+) {
+    double *restrict row, y, t;
+    unsigned int j;
+
+    memset(sums, 0, sizeof(double) * n_cols);
+    memset(comps, 0, sizeof(double) * n_cols);
+    for (; begin < end; begin++)
+        for (row = x[begin], j = 0; j < n_cols; j++) {
+            y = (abs ? fabs(row[j]) : row[j]) - comps[j];
+            t = sums[j] + y;
+            comps[j] = (t - sums[j]) - y;
+            sums[j] = t;
+        }
+    for (j = 0; j < n_cols; j++) sums[j] -= comps[j];
+}
+
+static void col_sums_range(void *args, size_t begin, size_t end)
+{
+    struct cols_args *a = args;
+    unsigned int i, i_end, n_cols = a->n_cols;
+    double *sums, *work;
+
+    for (; begin < end; begin++) {
+        sums = a->sums + begin * n_cols;
+        work = a->work + begin * a->depth * n_cols;
+        i = begin * a->block_rows;
+        i_end = min(a->n_rows, i + a->block_rows);
+
+        switch (a->mode) {
+        case MAT47_SUM_FAST:
+            plain_cols(a->x, i, i_end, n_cols, a->abs, sums);
+            break;
+        case MAT47_SUM_PAIRWISE:
+            pairwise_cols(a->x, i, i_end, n_cols, a->abs, sums, work);
+            break;
+        case MAT47_SUM_KAHAN:
+            kahan_cols(a->x, i, i_end, n_cols, a->abs, sums, work);
+            break;
+        }
+    }
+}
+
+/* Returns the number of blocks of rows (of `*block_rows` rows each, except maybe the
+ * last) the rows of `m` should be split into, for column-wise reductions.
+ */
+static unsigned int row_blocks(const mat47_t *m, unsigned int *block_rows)
+{
+    unsigned int n_blocks = min(
+        MAT47__MAX_COL_BLOCKS, (size_t)m->n_rows * m->n_cols / PARALLEL_GRAIN + 1
+    );
+
+    *block_rows = (m->n_rows + n_blocks - 1) / n_blocks;
+    return (m->n_rows + *block_rows - 1) / *block_rows;
+}
+
+/* Stores the column sums of `m` (of the absolute values, if `abs`) into `out`, with
+ * the partial sums in `scratch`, if not null, of `MAT47__MAX_COL_BLOCKS * m->n_cols`
+ * elements (for `MAT47_SUM_FAST`).
+ *
+ * Returns false on failure; `mode` must be valid.
+ */
+static bool col_sums(
+    const mat47_t *m, enum mat47_sum_mode mode, bool abs, double *restrict out,
+    double *scratch
+) {
+    unsigned int j, n_cols = m->n_cols, n_blocks, block_rows, rows, depth = 0;
+    double stack[STACK_SCRATCH], *sums = stack, *comps, y, t;
+    size_t size;
+
+    n_blocks = row_blocks(m, &block_rows);
+    if (mode == MAT47_SUM_PAIRWISE)
+        for (rows = block_rows; rows > PAIRWISE_BLOCK; rows = (rows + 1) / 2) depth++;
+    else if (mode == MAT47_SUM_KAHAN)
+        depth = 1;
+
+    size = (size_t)n_blocks * (1 + depth) * n_cols;
+    if (scratch) sums = scratch;
+    else if (size > STACK_SCRATCH && !(sums = malloc(sizeof(double) * size))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for column sums");
+        return false;
+    }
+
+    mat47__parallel_for(
+        n_blocks, 1, col_sums_range,
+        &(struct cols_args){
+            m->data, m->n_rows, n_cols, block_rows, mode, abs,
+            sums, sums + n_blocks * n_cols, depth
+        }
+    );
+
+    memcpy(out, sums, sizeof(double) * n_cols);
+    if (mode == MAT47_SUM_KAHAN) {
+        comps = sums + n_blocks * n_cols;  // Free after the blocks are summed
+        memset(comps, 0, sizeof(double) * n_cols);
+        for (unsigned int b = 1; b < n_blocks; b++)
+            for (j = 0; j < n_cols; j++) {
+                y = sums[b * n_cols + j] - comps[j];
+                t = out[j] + y;
+                comps[j] = (t - out[j]) - y;
+                out[j] = t;
+            }
+        for (j = 0; j < n_cols; j++) out[j] -= comps[j];
+    } else {
+        for (unsigned int b = 1; b < n_blocks; b++)
+            add_row(out, sums + b * n_cols, n_cols, false);
+    }
+    if (sums != stack && sums != scratch) free(sums);
+
+    return true;
+}
+
+double mat47__norm_1(const mat47_t *m, double *scratch)
+{
+    double *sums = scratch, norm = 0;
+
+    if (!sums && !(sums = malloc(sizeof(double) * m->n_cols))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for column sums");
+        return NAN;
+    }
+    if (!col_sums(m, MAT47_SUM_FAST, true, sums, scratch ? sums + m->n_cols : NULL))
+        norm = NAN;
+
+    // NaNs are propagated
+    for (unsigned int j = 0; j < m->n_cols && !isnan(norm); j++)
+        if (!(sums[j] <= norm)) norm = sums[j];
+    if (sums != scratch) free(sums);
+
+    return norm;
+}
+
+double mat47_norm_1(const mat47_t *m)
+{
+    stats(NORM_1);
+
+    if (check_ptr(m)) return NAN;
+
+    return mat47__norm_1(m, NULL);
+}
+
+
+mat47_t *mat47_row_sums(const mat47_t *m, enum mat47_sum_mode mode)
+{
+    stats(ROW_SUMS);
+    mat47_t *result;
+
+    if (check_ptr(m)) return NULL;
+    if (!get_kernel(&sum_kernels, mode)) return NULL;
+    if (!(result = mat47__new(m->n_rows, 1, false))) return NULL;
+    mat47_row_sums_into(result, m, mode);
+
+    return result;
+}
+
+
+void mat47_row_sums_into(mat47_t *dst, const mat47_t *m, enum mat47_sum_mode mode)
+{
+    stats(ROW_SUMS_INTO);
+    kernel_fn *kernel;
+
+    if (check_ptr(dst) || check_ptr(m)) return;
+    if (check_eq(dst->n_rows, m->n_rows) || check_eq(dst->n_cols, 1)) return;
+    if (!(kernel = get_kernel(&sum_kernels, mode))) return;
+
+    bump_version(dst);
+    mat47__parallel_for(
+        m->n_rows, PARALLEL_GRAIN / m->n_cols + 1, row_sums_range,
+        &(struct rows_args){kernel, m->data, m->n_cols, m->n_rows, 1, NULL, dst->data}
+    );
+}
+
+
+mat47_t *mat47_col_sums(const mat47_t *m, enum mat47_sum_mode mode)
+{
+    stats(COL_SUMS);
+    mat47_t *result;
+
+    if (check_ptr(m)) return NULL;
+    if (!get_kernel(&sum_kernels, mode)) return NULL;
+    if (!(result = mat47__new(1, m->n_cols, false))) return NULL;
+
+    if (!col_sums(m, mode, false, result->data[0], NULL)) {
+        mat47_del(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+
+// Returns true (with `mat47_errno` set) if `dst` can't hold the column-wise
+// reductions of `m` with `mode`
+static bool
+check_cols_into(const mat47_t *dst, const mat47_t *m, enum mat47_sum_mode mode)
+{
+    return (
+        check_ptr(dst) || check_ptr(m)
+        || check_eq(dst->n_rows, 1) || check_eq(dst->n_cols, m->n_cols)
+        || !get_kernel(&sum_kernels, mode)
+    );
+}
+
+void mat47_col_sums_into(mat47_t *dst, const mat47_t *m, enum mat47_sum_mode mode)
+{
+    stats(COL_SUMS_INTO);
+
+    if (check_cols_into(dst, m, mode)) return;
+
+    bump_version(dst);
+    col_sums(m, mode, false, dst->data[0], NULL);
+}
+
+
+mat47_t *mat47_col_means(const mat47_t *m, enum mat47_sum_mode mode)
+{
+    stats(COL_MEANS);
+    mat47_t *result;
+
+    if (!(result = mat47_col_sums(m, mode))) return NULL;
+    for (unsigned int j = 0; j < m->n_cols; j++) result->data[0][j] /= m->n_rows;
+
+    return result;
+}
+
+
+void mat47_col_means_into(mat47_t *dst, const mat47_t *m, enum mat47_sum_mode mode)
+{
+    stats(COL_MEANS_INTO);
+
+    if (check_cols_into(dst, m, mode)) return;
+
+    bump_version(dst);
+    if (!col_sums(m, mode, false, dst->data[0], NULL)) return;
+    for (unsigned int j = 0; j < m->n_cols; j++) dst->data[0][j] /= m->n_rows;
+}
+
+
+/* Column-wise variances.
+ *
+ * Computed in a single sweep from the sums of the deviations from the first row and
+ * of their squares; Shifting by an element of every column avoids most of the
+ * cancellation of the textbook one-pass formula, as long as the first row isn't far
+ * from the means.
+ */
+
+struct var_args {
+    double **x;
+    unsigned int n_rows;
+    unsigned int n_cols;
+    unsigned int block_rows;
+    double *sums;  // Sums of deviations then sums of their squares, per block of rows
+};
+
+static void col_moments_range(void *args, size_t begin, size_t end)
+{
+    struct var_args *a = args;
+    unsigned int i, i_end, j, n_cols = a->n_cols;
+    double *restrict s1, *restrict s2, *restrict shift = a->x[0], *restrict row, d;
+
+    for (; begin < end; begin++) {
+        s1 = a->sums + 2 * begin * n_cols;
+        s2 = s1 + n_cols;
+        memset(s1, 0, sizeof(double) * 2 * n_cols);
+        i = begin * a->block_rows;
+        for (i_end = min(a->n_rows, i + a->block_rows); i < i_end; i++)
+            for (row = a->x[i], j = 0; j < n_cols; j++) {
+                d = row[j] - shift[j];
+                s1[j] += d;
+                s2[j] += d * d;
+            }
+    }
+}
+
+mat47_t *mat47_col_var(const mat47_t *m, unsigned int ddof, mat47_t **means)
+{
+    stats(COL_VAR);
+    unsigned int j, n_cols, n_blocks, block_rows;
+    double *sums, *s1, *s2, n, dev;
+    mat47_t *var, *mean = NULL;
+
+    if (means) *means = NULL;
+    if (check_ptr(m)) return NULL;
+    if (
+        check(
+            ddof < m->n_rows, MAT47_ERR_INVALID_ARG,
+            ": ddof=%u, n_rows=%u", ddof, m->n_rows
+        )
+    ) return NULL;
+
+    n_cols = m->n_cols;
+    n_blocks = row_blocks(m, &block_rows);
+    if (!(sums = malloc(sizeof(double) * 2 * n_blocks * n_cols))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for column sums");
+        return NULL;
+    }
+    if (
+        !(var = mat47__new(1, n_cols, false))
+        || (means && !(mean = mat47__new(1, n_cols, false)))
+    ) {
+        mat47_del(var);
+        free(sums);
+        return NULL;
+    }
+
+    mat47__parallel_for(
+        n_blocks, 1, col_moments_range,
+        &(struct var_args){m->data, m->n_rows, n_cols, block_rows, sums}
+    );
+
+    s1 = sums;
+    s2 = sums + n_cols;
+    for (unsigned int b = 1; b < n_blocks; b++) {
+        add_row(s1, sums + 2 * b * n_cols, n_cols, false);
+        add_row(s2, sums + (2 * b + 1) * n_cols, n_cols, false);
+    }
+
+    n = m->n_rows;
+    for (j = 0; j < n_cols; j++) {
+        dev = s2[j] - s1[j] * s1[j] / n;
+        // Rounding could make it (slightly) negative; NaNs are propagated
+        var->data[0][j] = (dev < 0 ? 0 : dev) / (n - ddof);
+        if (mean) mean->data[0][j] = m->data[0][j] + s1[j] / n;
+    }
+    free(sums);
+
+    if (means) *means = mean;
+
+    return var;
+}
+
+
+// Returns the index of the first element equal to *value*, or *n* if none is
+static size_t find(const double *restrict x, size_t n, double value)
+{
+    vec v = (vec){0} + value;
+    ivec eq;
+    size_t j;
+
+    for (j = 0; j + 4 * W <= n; j += 4 * W) {
+        eq = (
+            (load(x + j) == v) | (load(x + j + W) == v)
+            | (load(x + j + 2 * W) == v) | (load(x + j + 3 * W) == v)
+        );
+        for (int k = 1; k < W; k++) eq[0] |= eq[k];
+        if (eq[0]) break;
+    }
+    for (; j < n; j++)
+        if (x[j] == value) break;
+
+    return j;
+}
+
+
+/* Extremum kernels.
+ *
+ * Return the first (smallest-index) extremum of a range, ignoring NaNs, if it's
+ * strictly beyond *bound* (or *bound* is NaN); Otherwise, the index is negative.
+ * Chunks of the range are first reduced to their extremum value, in multiple
+ * independent accumulators updated without branches (NaNs never compare true, hence
+ * are never picked); Only chunks beyond the extremum so far are then scanned again,
+ * from L1 cache, for its first index. Tracking indices per lane instead takes 64-bit
+ * integer comparisons, which SSE2 lacks.
+ */
+#define extremum(NAME, CMP, INIT) \
+static bool cmp_##NAME(double a, double b) \
+{ \
+    return a CMP b; \
+} \
+\
+static double chunk_##NAME(const double *restrict x, size_t n) \
+{ \
+    vec acc0 = (vec){0} + INIT, acc1 = acc0, acc2 = acc0, acc3 = acc0; \
+    double best = INIT; \
+    size_t j; \
+\
+    for (j = 0; j + 4 * W <= n; j += 4 * W) { \
+        acc0 = vec_##NAME(load(x + j), acc0); \
+        acc1 = vec_##NAME(load(x + j + W), acc1); \
+        acc2 = vec_##NAME(load(x + j + 2 * W), acc2); \
+        acc3 = vec_##NAME(load(x + j + 3 * W), acc3); \
+    } \
+    for (; j + W <= n; j += W) acc0 = vec_##NAME(load(x + j), acc0); \
+    acc0 = vec_##NAME(vec_##NAME(acc0, acc1), vec_##NAME(acc2, acc3)); \
+    for (int k = 0; k < W; k++) \
+        if (acc0[k] CMP best) best = acc0[k]; \
+    for (; j < n; j++) \
+        if (x[j] CMP best) best = x[j]; \
+\
+    return best; \
+} \
+\
+static struct extremum \
+row_##NAME(const double *restrict x, size_t n, double bound) \
+{ \
+    struct extremum e = {bound, -1}; \
+    size_t start, end, j; \
+    double best; \
+\
+    for (start = 0; start < n; start = end) { \
+        end = min(start + EXTREMUM_CHUNK, n); \
+        best = chunk_##NAME(x + start, end - start); \
+        /* Ties are won by earlier chunks; A chunk of NaNs has no element equal */ \
+        if ( \
+            (isnan(e.value) || best CMP e.value) \
+            && (j = start + find(x + start, end - start, best)) < end \
+        ) e = (struct extremum){x[j], j}; \
+    } \
+\
+    return e; \
+}
+
+extremum(min, <, INFINITY)
+extremum(max, >, -INFINITY)
+
+#undef extremum
+
+struct extrema_args {
+    struct extremum (*kernel)(const double *restrict x, size_t n, double bound);
+    double **x;
+    unsigned int n_cols;
+    struct extremum *results;
+};
+
+static void extrema_range(void *args, size_t begin, size_t end)
+{
+    struct extrema_args *a = args;
+    double bound = NAN;
+
+    // Rows not improving on earlier ones can't win, hence their index isn't looked up
+    for (; begin < end; begin++) {
+        a->results[begin] = a->kernel(a->x[begin], a->n_cols, bound);
+        if (a->results[begin].index >= 0) bound = a->results[begin].value;
+    }
+}
+
+static double extremum(
+    const mat47_t *m, unsigned int *row, unsigned int *col,
+    struct extremum (*kernel)(const double *restrict x, size_t n, double bound),
+    bool (*cmp)(double a, double b)
+) {
+    struct extremum buf[STACK_ROWS], *results = buf, e = {m->data[0][0], -1};
+    unsigned int i, e_row = 0;
+
+    if (m->n_rows > STACK_ROWS && !(results = malloc(sizeof(*results) * m->n_rows))) {
+        mat47_errno = MAT47_ERR_ALLOC;
+        error(" for row results");
+        return NAN;
+    }
+
+    mat47__parallel_for(
+        m->n_rows, PARALLEL_GRAIN / m->n_cols + 1, extrema_range,
+        &(struct extrema_args){kernel, m->data, m->n_cols, results}
+    );
+
+    // Ties are won by earlier rows
+    for (i = 0; i < m->n_rows; i++)
+        if (results[i].index >= 0 && (e.index < 0 || cmp(results[i].value, e.value))) {
+            e = results[i];
+            e_row = i;
+        }
+    if (results != buf) free(results);
+
+    // If all elements are NaN, the first is returned
+    if (row) *row = e_row + 1;
+    if (col) *col = max(e.index, 0) + 1;
+
+    return e.value;
+}
+
+
+double mat47_min(const mat47_t *m, unsigned int *row, unsigned int *col)
+{
+    stats(MIN);
+
+    if (check_ptr(m)) return NAN;
+
+    return extremum(m, row, col, row_min, cmp_min);
+}
+
+
+double mat47_max(const mat47_t *m, unsigned int *row, unsigned int *col)
+{
+    stats(MAX);
+
+    if (check_ptr(m)) return NAN;
+
+    return extremum(m, row, col, row_max, cmp_max);
+}
@@ -0,0 +1,312 @@
+/* Reductions
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_REDUCE_H
+#define MAT47_REDUCE_H
+
+#include "matrix.h"
+
+/**
+ * Defines the summation algorithms used by reductions.
+ *
+ * All are vectorized. In all modes, rows are reduced independently (in parallel, for
+ * large matrices) and the per-row results are then combined in a fixed order, such
+ * that results do not depend on the number of threads.
+ */
+enum mat47_sum_mode {
+    /**
+     * Plain summation into multiple independent accumulators; The fastest.
+     *
+     * The error bound grows linearly with the number of elements.
+     */
+    MAT47_SUM_FAST = 1,
+
+    /**
+     * Pairwise (cascade) summation; Nearly as fast as
+     * :c:enumerator:`MAT47_SUM_FAST`.
+     *
+     * The error bound grows logarithmically with the number of elements.
+     */
+    MAT47_SUM_PAIRWISE,
+
+    /**
+     * Kahan-compensated summation; About twice as slow as
+     * :c:enumerator:`MAT47_SUM_FAST`.
+     *
+     * The error bound is independent of the number of elements (barring catastrophic
+     * cancellation).
+     */
+    MAT47_SUM_KAHAN
+};
+
+/**
+ * Computes the mean of every column of a matrix.
+ *
+ * Args:
+ *     m: The matrix
+ *     mode: The summation algorithm
+ *
+ * Returns:
+ *     - ``NULL``, if any of the error conditions below occur.
+ *     - Otherwise, a new row vector (``1 x n_cols`` matrix) holding the column means.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *mode* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * See :c:func:`mat47_col_sums`.
+ */
+mat47_t *mat47_col_means(const mat47_t *m, enum mat47_sum_mode mode);
+
+/**
+ * Computes the mean of every column of a matrix, into an existing row vector.
+ *
+ * Args:
+ *     dst: The row vector (``1 x n_cols`` matrix) into which to store the results
+ *     m: The matrix
+ *     mode: The summation algorithm
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *dst* is not a
+ *       ``1 x n_cols`` matrix
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *mode* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate scratch
+ *       memory (only for matrices with a large number of columns or rows)
+ *
+ * See :c:func:`mat47_col_sums_into` and :c:func:`mat47_copy_into`.
+ */
+void mat47_col_means_into(mat47_t *dst, const mat47_t *m, enum mat47_sum_mode mode);
+
+/**
+ * Computes the sum of every column of a matrix.
+ *
+ * Args:
+ *     m: The matrix
+ *     mode: The summation algorithm
+ *
+ * Returns:
+ *     - ``NULL``, if any of the error conditions below occur.
+ *     - Otherwise, a new row vector (``1 x n_cols`` matrix) holding the column sums.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *mode* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * The matrix is traversed row by row (i.e in memory order) only once, with whole rows
+ * added to a row of accumulators.
+ */
+mat47_t *mat47_col_sums(const mat47_t *m, enum mat47_sum_mode mode);
+
+/**
+ * Computes the sum of every column of a matrix, into an existing row vector.
+ *
+ * Args:
+ *     dst: The row vector (``1 x n_cols`` matrix) into which to store the results
+ *     m: The matrix
+ *     mode: The summation algorithm
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *dst* is not a
+ *       ``1 x n_cols`` matrix
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *mode* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate scratch
+ *       memory (only for matrices with a large number of columns or rows)
+ *
+ * Scratch space is on the stack, unless the partial sums of all blocks of rows (and,
+ * for pairwise or Kahan summation, their intermediate results) don't fit in 1024
+ * elements.
+ *
+ * See :c:func:`mat47_col_sums` and :c:func:`mat47_copy_into`.
+ */
+void mat47_col_sums_into(mat47_t *dst, const mat47_t *m, enum mat47_sum_mode mode);
+
+/**
+ * Computes the variance of every column of a matrix and, optionally, their means.
+ *
+ * Args:
+ *     m: The matrix
+ *     ddof: "Delta degrees of freedom"; The divisor is ``n_rows - ddof`` e.g ``0``
+ *       for the population variance, ``1`` for the (unbiased) sample variance.
+ *     means: If not null, the location to store a new row vector holding the column
+ *       means in (or ``NULL``, on failure).
+ *
+ * Returns:
+ *     - ``NULL``, if any of the error conditions below occur.
+ *     - Otherwise, a new row vector (``1 x n_cols`` matrix) holding the column
+ *       variances.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *ddof* is not less than
+ *       the number of rows of *m*
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Both the variances and the means are computed in a single sweep over the matrix,
+ * from the deviations from the first row (which avoids most of the cancellation of
+ * the textbook one-pass formula), with plain summation.
+ */
+mat47_t *mat47_col_var(const mat47_t *m, unsigned int ddof, mat47_t **means);
+
+/**
+ * Computes the dot product of two matrices, as if they were vectors.
+ *
+ * Args:
+ *     a: The first matrix
+ *     b: The second matrix
+ *     mode: The summation algorithm
+ *
+ * Returns:
+ *     - ``NAN``, if any of the error conditions below occur.
+ *     - Otherwise, the sum of the products of the corresponding elements of *a* and
+ *       *b* (i.e the Frobenius inner product).
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *a* or *b* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *a* and *b* have
+ *       different dimensions
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *mode* is invalid
+ */
+double mat47_dot(const mat47_t *a, const mat47_t *b, enum mat47_sum_mode mode);
+
+/**
+ * Returns the largest element of a matrix and its position.
+ *
+ * Args:
+ *     m: The matrix
+ *     row: If not null, the location to store the (one-based) row of the element in
+ *     col: If not null, the location to store the (one-based) column of the element
+ *       in
+ *
+ * Returns:
+ *     - ``NAN``, if any of the error conditions below occur.
+ *     - Otherwise, the largest element.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * If there are multiple largest elements, the position of the first (in row-major
+ * order) is returned. NaN elements are ignored, unless all elements are NaN.
+ */
+double mat47_max(const mat47_t *m, unsigned int *row, unsigned int *col);
+
+/**
+ * Returns the smallest element of a matrix and its position.
+ *
+ * See :c:func:`mat47_max`.
+ */
+double mat47_min(const mat47_t *m, unsigned int *row, unsigned int *col);
+
+/**
+ * Computes the 1-norm (maximum absolute column sum) of a matrix.
+ *
+ * Args:
+ *     m: The matrix
+ *
+ * Returns:
+ *     - ``NAN``, if any of the error conditions below occur.
+ *     - Otherwise, the 1-norm of *m*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ *
+ * Note:
+ *     Sums of absolute values involve no cancellation, hence plain summation is
+ *     always used.
+ */
+double mat47_norm_1(const mat47_t *m);
+
+/**
+ * Computes the Frobenius norm (square root of the sum of squares of all elements) of
+ * a matrix.
+ *
+ * Args:
+ *     m: The matrix
+ *     mode: The summation algorithm
+ *
+ * Returns:
+ *     - ``NAN``, if any of the error conditions below occur.
+ *     - Otherwise, the Frobenius norm of *m*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *mode* is invalid
+ *
+ * Note:
+ *     The squares are not scaled, hence the result overflows if any element's
+ *     magnitude exceeds about ``1e154``.
+ */
+double mat47_norm_fro(const mat47_t *m, enum mat47_sum_mode mode);
+
+/**
+ * Computes the infinity-norm (maximum absolute row sum) of a matrix.
+ *
+ * See :c:func:`mat47_norm_1`.
+ */
+double mat47_norm_inf(const mat47_t *m);
+
+/**
+ * Computes the sum of every row of a matrix.
+ *
+ * Args:
+ *     m: The matrix
+ *     mode: The summation algorithm
+ *
+ * Returns:
+ *     - ``NULL``, if any of the error conditions below occur.
+ *     - Otherwise, a new column vector (``n_rows x 1`` matrix) holding the row sums.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *mode* is invalid
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_ALLOC`: Unable to allocate memory
+ */
+mat47_t *mat47_row_sums(const mat47_t *m, enum mat47_sum_mode mode);
+
+/**
+ * Computes the sum of every row of a matrix, into an existing column vector.
+ *
+ * Args:
+ *     dst: The column vector (``n_rows x 1`` matrix) into which to store the results
+ *     m: The matrix
+ *     mode: The summation algorithm
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *dst* or *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_DIM_MISMATCH`: *dst* is not an
+ *       ``n_rows x 1`` matrix
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *mode* is invalid
+ *
+ * See :c:func:`mat47_row_sums` and :c:func:`mat47_copy_into`.
+ */
+void mat47_row_sums_into(mat47_t *dst, const mat47_t *m, enum mat47_sum_mode mode);
+
+/**
+ * Computes the sum of all elements of a matrix.
+ *
+ * Args:
+ *     m: The matrix
+ *     mode: The summation algorithm
+ *
+ * Returns:
+ *     - ``NAN``, if any of the error conditions below occur.
+ *     - Otherwise, the sum of all elements of *m*.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *m* is null
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_INVALID_ARG`: *mode* is invalid
+ *
+ * The rows are reduced in up to 256 blocks, each summed as a single vector if *m* is
+ * stored in a single buffer, whose sums are then added.
+ */
+double mat47_sum(const mat47_t *m, enum mat47_sum_mode mode);
+
+#endif  // MAT47_REDUCE_H
@@ -0,0 +1,363 @@
+/* Performance counters
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "error.h"
+#include "stats.h"
+#include "utils.h"
+
+#define N_OPS MAT47_STATS_N_OPS
+#define N_COUNTERS MAT47__STATS_N_COUNTERS
+
+/* A thread's counters.
+ *
+ * Only ever modified by the owner thread, with plain (non-atomic) additions; Atomic
+ * types are used only so that they can be read while being modified.
+ */
+struct thread_stats {
+    atomic_uint_least64_t counters[N_OPS][N_COUNTERS];
+    struct thread_stats *next;
+};
+
+static const char *const op_names[N_OPS] = {
+    [MAT47_STATS_OP_ADOPT] = "mat47_adopt",
+    [MAT47_STATS_OP_APPEND_ROWS] = "mat47_append_rows",
+    [MAT47_STATS_OP_BCAST_COL] = "mat47_bcast_col",
+    [MAT47_STATS_OP_BCAST_ROW] = "mat47_bcast_row",
+    [MAT47_STATS_OP_CHOLESKY] = "mat47_cholesky",
+    [MAT47_STATS_OP_CHOLESKY_DOWNDATE] = "mat47_cholesky_downdate",
+    [MAT47_STATS_OP_CHOLESKY_UPDATE] = "mat47_cholesky_update",
+    [MAT47_STATS_OP_COL_MEANS] = "mat47_col_means",
+    [MAT47_STATS_OP_COL_MEANS_INTO] = "mat47_col_means_into",
+    [MAT47_STATS_OP_COL_SUMS] = "mat47_col_sums",
+    [MAT47_STATS_OP_COL_SUMS_INTO] = "mat47_col_sums_into",
+    [MAT47_STATS_OP_COL_VAR] = "mat47_col_var",
+    [MAT47_STATS_OP_COPY] = "mat47_copy",
+    [MAT47_STATS_OP_COPY_INTO] = "mat47_copy_into",
+    [MAT47_STATS_OP_DEL] = "mat47_del",
+    [MAT47_STATS_OP_DOT] = "mat47_dot",
+    [MAT47_STATS_OP_EIGSH] = "mat47_eigsh",
+    [MAT47_STATS_OP_EIGSH_FN] = "mat47_eigsh_fn",
+    [MAT47_STATS_OP_EXPM] = "mat47_expm",
+    [MAT47_STATS_OP_EXPM_INTO] = "mat47_expm_into",
+    [MAT47_STATS_OP_FPRINTF] = "mat47_fprintf",
+    [MAT47_STATS_OP_GEMV] = "mat47_gemv",
+    [MAT47_STATS_OP_GEMV_BATCH] = "mat47_gemv_batch",
+    [MAT47_STATS_OP_GEMV_T] = "mat47_gemv_t",
+    [MAT47_STATS_OP_GET_COL] = "mat47_get_col",
+    [MAT47_STATS_OP_GET_ELEM] = "mat47_get_elem",
+    [MAT47_STATS_OP_GET_ROW] = "mat47_get_row",
+    [MAT47_STATS_OP_GET_SUBMAT] = "mat47_get_submat",
+    [MAT47_STATS_OP_GET_SUBMAT_INTO] = "mat47_get_submat_into",
+    [MAT47_STATS_OP_INIT] = "mat47_init",
+    [MAT47_STATS_OP_INIT_INTO] = "mat47_init_into",
+    [MAT47_STATS_OP_INIT_FLAT] = "mat47_init_double_flat",
+    [MAT47_STATS_OP_INIT_FLAT_INTO] = "mat47_init_double_flat_into",
+    [MAT47_STATS_OP_INV_UPDATE] = "mat47_inv_update",
+    [MAT47_STATS_OP_LU] = "mat47_lu",
+    [MAT47_STATS_OP_MAX] = "mat47_max",
+    [MAT47_STATS_OP_MIN] = "mat47_min",
+    [MAT47_STATS_OP_MUL] = "mat47_mul",
+    [MAT47_STATS_OP_MUL_INTO] = "mat47_mul_into",
+    [MAT47_STATS_OP_NORM_1] = "mat47_norm_1",
+    [MAT47_STATS_OP_NORM_FRO] = "mat47_norm_fro",
+    [MAT47_STATS_OP_NORM_INF] = "mat47_norm_inf",
+    [MAT47_STATS_OP_POW] = "mat47_pow",
+    [MAT47_STATS_OP_POW_INTO] = "mat47_pow_into",
+    [MAT47_STATS_OP_QR] = "mat47_qr",
+    [MAT47_STATS_OP_RELEASE] = "mat47_release",
+    [MAT47_STATS_OP_RESHAPE] = "mat47_reshape",
+    [MAT47_STATS_OP_RESIZE] = "mat47_resize",
+    [MAT47_STATS_OP_ROW_SUMS] = "mat47_row_sums",
+    [MAT47_STATS_OP_ROW_SUMS_INTO] = "mat47_row_sums_into",
+    [MAT47_STATS_OP_RSVD] = "mat47_rsvd",
+    [MAT47_STATS_OP_SET_COL] = "mat47_set_col",
+    [MAT47_STATS_OP_SET_ELEM] = "mat47_set_elem",
+    [MAT47_STATS_OP_SET_ROW] = "mat47_set_row",
+    [MAT47_STATS_OP_SET_SUBMAT] = "mat47_set_submat",
+    [MAT47_STATS_OP_SOLVE] = "mat47_solve",
+    [MAT47_STATS_OP_SOLVE_MIXED] = "mat47_solve_mixed",
+    [MAT47_STATS_OP_STANDARDIZE] = "mat47_standardize",
+    [MAT47_STATS_OP_SUM] = "mat47_sum",
+    [MAT47_STATS_OP_ZERO] = "mat47_zero",
+    [MAT47_STATS_OP_ZERO_INTO] = "mat47_zero_into",
+    [MAT47_STATS_OP_B_DEL] = "mat47b_del",
+    [MAT47_STATS_OP_B_LU] = "mat47b_lu",
+    [MAT47_STATS_OP_B_LU_SOLVE] = "mat47b_lu_solve",
+    [MAT47_STATS_OP_B_LU_SOLVE_INTO] = "mat47b_lu_solve_into",
+    [MAT47_STATS_OP_B_PACK] = "mat47b_pack",
+    [MAT47_STATS_OP_B_SOLVE] = "mat47b_solve",
+    [MAT47_STATS_OP_B_SOLVE_INTO] = "mat47b_solve_into",
+    [MAT47_STATS_OP_B_TRIDIAG_SOLVE] = "mat47b_tridiag_solve",
+    [MAT47_STATS_OP_B_TRIDIAG_SOLVE_BATCH] = "mat47b_tridiag_solve_batch",
+    [MAT47_STATS_OP_B_TRIDIAG_SOLVE_INTO] = "mat47b_tridiag_solve_into",
+    [MAT47_STATS_OP_B_UNPACK] = "mat47b_unpack",
+    [MAT47_STATS_OP_B_ZERO] = "mat47b_zero",
+    [MAT47_STATS_OP_P_DEL] = "mat47p_del",
+    [MAT47_STATS_OP_P_GEMV] = "mat47p_gemv",
+    [MAT47_STATS_OP_P_MUL] = "mat47p_mul",
+    [MAT47_STATS_OP_P_MUL_INTO] = "mat47p_mul_into",
+    [MAT47_STATS_OP_P_PACK] = "mat47p_pack",
+    [MAT47_STATS_OP_P_PACK_INTO] = "mat47p_pack_into",
+    [MAT47_STATS_OP_P_SYRK] = "mat47p_syrk",
+    [MAT47_STATS_OP_P_UNPACK] = "mat47p_unpack",
+    [MAT47_STATS_OP_P_UNPACK_INTO] = "mat47p_unpack_into",
+    [MAT47_STATS_OP_P_ZERO] = "mat47p_zero",
+    [MAT47_STATS_OP_Q_DEL] = "mat47q_del",
+    [MAT47_STATS_OP_Q_DEQUANTIZE] = "mat47q_dequantize",
+    [MAT47_STATS_OP_Q_DEQUANTIZE_INTO] = "mat47q_dequantize_into",
+    [MAT47_STATS_OP_Q_INIT] = "mat47q_init",
+    [MAT47_STATS_OP_Q_MUL_T] = "mat47q_mul_t",
+    [MAT47_STATS_OP_Q_MUL_T_INTO] = "mat47q_mul_t_into",
+    [MAT47_STATS_OP_Q_QUANTIZE] = "mat47q_quantize",
+    [MAT47_STATS_OP_Q_QUANTIZE_INTO] = "mat47q_quantize_into",
+};
+
+static const struct {
+    size_t offset;  // Of the member of `struct mat47_op_stats`
+    const char *prometheus_name;
+    const char *prometheus_help;
+} counter_info[N_COUNTERS] = {
+    [MAT47__STATS_CALLS] = {
+        offsetof(struct mat47_op_stats, calls),
+        "mat47_calls_total", "Number of calls"
+    },
+    [MAT47__STATS_NS] = {
+        offsetof(struct mat47_op_stats, ns),
+        "mat47_seconds_total", "Cumulative time spent in calls"
+    },
+    [MAT47__STATS_N_ALLOCS] = {
+        offsetof(struct mat47_op_stats, n_allocs),
+        "mat47_allocations_total", "Number of blocks of memory allocated"
+    },
+    [MAT47__STATS_BYTES_ALLOCATED] = {
+        offsetof(struct mat47_op_stats, bytes_allocated),
+        "mat47_allocated_bytes_total", "Size of memory allocated"
+    },
+    [MAT47__STATS_BYTES_FREED] = {
+        offsetof(struct mat47_op_stats, bytes_freed),
+        "mat47_freed_bytes_total", "Size of memory deallocated"
+    },
+    [MAT47__STATS_BYTES_COPIED] = {
+        offsetof(struct mat47_op_stats, bytes_copied),
+        "mat47_copied_bytes_total", "Size of matrix elements copied"
+    },
+};
+
+#define counter(op_stats, counter) \
+    (*(uint64_t *)((char *)(op_stats) + counter_info[counter].offset))
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static struct thread_stats *threads;  // Of live threads
+static uint64_t retired[N_OPS][N_COUNTERS];  // Totals of exited threads
+static uint64_t baseline[N_OPS][N_COUNTERS];  // Totals at the last reset
+
+static _Thread_local struct thread_stats *thread_stats;
+static _Thread_local int current_op = -1;
+
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+// Holds every thread's counters, only for the destructor to be called at thread exit
+static pthread_key_t stats_key;
+
+
+static void retire_thread_stats(void *stats)
+{
+    struct thread_stats *t = stats, **link;
+
+    pthread_mutex_lock(&lock);
+    for (link = &threads; *link != t; link = &(*link)->next);
+    *link = t->next;
+    for (int op = 0; op < N_OPS; op++)
+        for (int c = 0; c < N_COUNTERS; c++)
+            retired[op][c] += atomic_load_explicit(
+                &t->counters[op][c], memory_order_relaxed
+            );
+    pthread_mutex_unlock(&lock);
+
+    free(t);
+    thread_stats = NULL;
+}
+
+static void init(void)
+{
+    pthread_key_create(&stats_key, retire_thread_stats);
+}
+
+static struct thread_stats *get_thread_stats(void)
+{
+    struct thread_stats *t;
+
+    if (thread_stats) return thread_stats;
+
+    pthread_once(&init_once, init);
+    if (!(t = malloc(sizeof(struct thread_stats)))) return NULL;
+
+    for (int op = 0; op < N_OPS; op++)
+        for (int c = 0; c < N_COUNTERS; c++) atomic_init(&t->counters[op][c], 0);
+    pthread_setspecific(stats_key, t);
+
+    pthread_mutex_lock(&lock);
+    t->next = threads;
+    threads = t;
+    pthread_mutex_unlock(&lock);
+
+    return thread_stats = t;
+}
+
+static inline void add(int op, enum mat47__stats_counter counter, uint64_t n)
+{
+    struct thread_stats *t;
+    atomic_uint_least64_t *value;
+
+    if (!(t = get_thread_stats())) return;
+
+    value = &t->counters[op][counter];
+    atomic_store_explicit(
+        value, atomic_load_explicit(value, memory_order_relaxed) + n,
+        memory_order_relaxed
+    );
+}
+
+
+struct mat47__stats_frame mat47__stats_enter(enum mat47_stats_op op)
+{
+    struct mat47__stats_frame frame = {.op = -1};
+
+    if (current_op < 0) {
+        current_op = frame.op = op;
+        clock_gettime(CLOCK_MONOTONIC, &frame.start);
+    }
+
+    return frame;
+}
+
+
+void mat47__stats_exit(struct mat47__stats_frame *frame)
+{
+    struct timespec end;
+
+    if (frame->op < 0) return;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    add(frame->op, MAT47__STATS_CALLS, 1);
+    add(
+        frame->op, MAT47__STATS_NS,
+        (end.tv_sec - frame->start.tv_sec) * 1000000000ULL
+        + end.tv_nsec - frame->start.tv_nsec
+    );
+    current_op = -1;
+}
+
+
+void mat47__stats_count(enum mat47__stats_counter counter, uint64_t n)
+{
+    if (current_op >= 0) add(current_op, counter, n);
+}
+
+
+// Must be called while holding `lock`
+static void get_totals(uint64_t totals[N_OPS][N_COUNTERS])
+{
+    memcpy(totals, retired, sizeof(retired));
+    for (struct thread_stats *t = threads; t; t = t->next)
+        for (int op = 0; op < N_OPS; op++)
+            for (int c = 0; c < N_COUNTERS; c++)
+                totals[op][c] += atomic_load_explicit(
+                    &t->counters[op][c], memory_order_relaxed
+                );
+}
+
+
+void mat47_stats_reset(void)
+{
+    pthread_mutex_lock(&lock);
+    get_totals(baseline);
+    pthread_mutex_unlock(&lock);
+}
+
+
+void mat47_stats_snapshot(mat47_stats_t *stats)
+{
+    uint64_t totals[N_OPS][N_COUNTERS];
+
+    if (check_ptr(stats)) return;
+
+    pthread_mutex_lock(&lock);
+    get_totals(totals);
+    for (int op = 0; op < N_OPS; op++) {
+        stats->ops[op].name = op_names[op];
+        for (int c = 0; c < N_COUNTERS; c++)
+            counter(&stats->ops[op], c) = totals[op][c] - baseline[op][c];
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+
+intmax_t mat47_stats_fprint_json(const mat47_stats_t *stats, FILE *stream)
+{
+    const struct mat47_op_stats *s;
+    intmax_t n_bytes = 0;
+
+    if (check_ptr(stats) || check_ptr(stream)) return -1;
+
+    n_bytes += fprintf(stream, "{");
+    for (int op = 0; op < N_OPS; op++) {
+        s = &stats->ops[op];
+        n_bytes += fprintf(
+            stream,
+            "%s\n  \"%s\": {\"calls\": %" PRIu64 ", \"ns\": %" PRIu64
+            ", \"n_allocs\": %" PRIu64 ", \"bytes_allocated\": %" PRIu64
+            ", \"bytes_freed\": %" PRIu64 ", \"bytes_copied\": %" PRIu64 "}",
+            (op ? "," : ""), s->name, s->calls, s->ns, s->n_allocs,
+            s->bytes_allocated, s->bytes_freed, s->bytes_copied
+        );
+    }
+    n_bytes += fprintf(stream, "\n}\n");
+
+    return n_bytes;
+}
+
+
+intmax_t mat47_stats_fprint_prometheus(const mat47_stats_t *stats, FILE *stream)
+{
+    const char *name;
+    intmax_t n_bytes = 0;
+    uint64_t value;
+
+    if (check_ptr(stats) || check_ptr(stream)) return -1;
+
+    for (int c = 0; c < N_COUNTERS; c++) {
+        name = counter_info[c].prometheus_name;
+        n_bytes += fprintf(
+            stream, "# HELP %s %s\n# TYPE %s counter\n",
+            name, counter_info[c].prometheus_help, name
+        );
+        for (int op = 0; op < N_OPS; op++) {
+            value = counter(&stats->ops[op], c);
+            n_bytes += (
+                c == MAT47__STATS_NS
+                ? fprintf(
+                    stream, "%s{op=\"%s\"} %" PRIu64 ".%09" PRIu64 "\n",
+                    name, stats->ops[op].name, value / 1000000000, value % 1000000000
+                )
+                : fprintf(
+                    stream, "%s{op=\"%s\"} %" PRIu64 "\n",
+                    name, stats->ops[op].name, value
+                )
+            );
+        }
+    }
+
+    return n_bytes;
+}
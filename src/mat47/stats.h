@@ -0,0 +1,430 @@
+/* Performance counters
+ *
+ * Copyright (c) 2022 AnonymouX47
+ * See https://github.com/AnonymouX47/mat47/LICENSE for license information.
+ */
+
+#ifndef MAT47_STATS_H
+#define MAT47_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// For documentation
+#ifndef MAT47_STATS
+
+/**
+ * Enables library-wide performance counters if defined (to be defined at
+ * **compilation**).
+ *
+ * If undefined, the functions declared in this header are still available but all
+ * counters remain zero.
+ */
+#define MAT47_STATS
+
+#undef MAT47_STATS
+#endif
+
+/** Defines the operations (API functions) for which performance counters are kept */
+enum mat47_stats_op {
+    /** :c:func:`mat47_adopt` */
+    MAT47_STATS_OP_ADOPT,
+
+    /** :c:func:`mat47_append_rows` */
+    MAT47_STATS_OP_APPEND_ROWS,
+
+    /** :c:func:`mat47_bcast_col` */
+    MAT47_STATS_OP_BCAST_COL,
+
+    /** :c:func:`mat47_bcast_row` */
+    MAT47_STATS_OP_BCAST_ROW,
+
+    /** :c:func:`mat47_cholesky` */
+    MAT47_STATS_OP_CHOLESKY,
+
+    /** :c:func:`mat47_cholesky_downdate` */
+    MAT47_STATS_OP_CHOLESKY_DOWNDATE,
+
+    /** :c:func:`mat47_cholesky_update` */
+    MAT47_STATS_OP_CHOLESKY_UPDATE,
+
+    /** :c:func:`mat47_col_means` */
+    MAT47_STATS_OP_COL_MEANS,
+
+    /** :c:func:`mat47_col_means_into` */
+    MAT47_STATS_OP_COL_MEANS_INTO,
+
+    /** :c:func:`mat47_col_sums` */
+    MAT47_STATS_OP_COL_SUMS,
+
+    /** :c:func:`mat47_col_sums_into` */
+    MAT47_STATS_OP_COL_SUMS_INTO,
+
+    /** :c:func:`mat47_col_var` */
+    MAT47_STATS_OP_COL_VAR,
+
+    /** :c:func:`mat47_copy` */
+    MAT47_STATS_OP_COPY,
+
+    /** :c:func:`mat47_copy_into` */
+    MAT47_STATS_OP_COPY_INTO,
+
+    /** :c:func:`mat47_del` */
+    MAT47_STATS_OP_DEL,
+
+    /** :c:func:`mat47_dot` */
+    MAT47_STATS_OP_DOT,
+
+    /** :c:func:`mat47_eigsh` */
+    MAT47_STATS_OP_EIGSH,
+
+    /** :c:func:`mat47_eigsh_fn` */
+    MAT47_STATS_OP_EIGSH_FN,
+
+    /** :c:func:`mat47_expm` */
+    MAT47_STATS_OP_EXPM,
+
+    /** :c:func:`mat47_expm_into` */
+    MAT47_STATS_OP_EXPM_INTO,
+
+    /** :c:func:`mat47_fprintf` (and :c:func:`mat47_printf`) */
+    MAT47_STATS_OP_FPRINTF,
+
+    /** :c:func:`mat47_gemv` */
+    MAT47_STATS_OP_GEMV,
+
+    /** :c:func:`mat47_gemv_batch` */
+    MAT47_STATS_OP_GEMV_BATCH,
+
+    /** :c:func:`mat47_gemv_t` */
+    MAT47_STATS_OP_GEMV_T,
+
+    /** :c:func:`mat47_get_col` */
+    MAT47_STATS_OP_GET_COL,
+
+    /** :c:func:`mat47_get_elem` */
+    MAT47_STATS_OP_GET_ELEM,
+
+    /** :c:func:`mat47_get_row` */
+    MAT47_STATS_OP_GET_ROW,
+
+    /** :c:func:`mat47_get_submat` */
+    MAT47_STATS_OP_GET_SUBMAT,
+
+    /** :c:func:`mat47_get_submat_into` */
+    MAT47_STATS_OP_GET_SUBMAT_INTO,
+
+    /** :c:func:`mat47_init`, for all element types */
+    MAT47_STATS_OP_INIT,
+
+    /** :c:func:`mat47_init_into`, for all element types */
+    MAT47_STATS_OP_INIT_INTO,
+
+    /** :c:func:`mat47_init_double_flat` */
+    MAT47_STATS_OP_INIT_FLAT,
+
+    /** :c:func:`mat47_init_double_flat_into` */
+    MAT47_STATS_OP_INIT_FLAT_INTO,
+
+    /** :c:func:`mat47_inv_update` */
+    MAT47_STATS_OP_INV_UPDATE,
+
+    /** :c:func:`mat47_lu` */
+    MAT47_STATS_OP_LU,
+
+    /** :c:func:`mat47_max` */
+    MAT47_STATS_OP_MAX,
+
+    /** :c:func:`mat47_min` */
+    MAT47_STATS_OP_MIN,
+
+    /** :c:func:`mat47_mul` */
+    MAT47_STATS_OP_MUL,
+
+    /** :c:func:`mat47_mul_into` */
+    MAT47_STATS_OP_MUL_INTO,
+
+    /** :c:func:`mat47_norm_1` */
+    MAT47_STATS_OP_NORM_1,
+
+    /** :c:func:`mat47_norm_fro` */
+    MAT47_STATS_OP_NORM_FRO,
+
+    /** :c:func:`mat47_norm_inf` */
+    MAT47_STATS_OP_NORM_INF,
+
+    /** :c:func:`mat47_pow` */
+    MAT47_STATS_OP_POW,
+
+    /** :c:func:`mat47_pow_into` */
+    MAT47_STATS_OP_POW_INTO,
+
+    /** :c:func:`mat47_qr` */
+    MAT47_STATS_OP_QR,
+
+    /** :c:func:`mat47_release` */
+    MAT47_STATS_OP_RELEASE,
+
+    /** :c:func:`mat47_reshape` */
+    MAT47_STATS_OP_RESHAPE,
+
+    /** :c:func:`mat47_resize` */
+    MAT47_STATS_OP_RESIZE,
+
+    /** :c:func:`mat47_row_sums` */
+    MAT47_STATS_OP_ROW_SUMS,
+
+    /** :c:func:`mat47_row_sums_into` */
+    MAT47_STATS_OP_ROW_SUMS_INTO,
+
+    /** :c:func:`mat47_rsvd` */
+    MAT47_STATS_OP_RSVD,
+
+    /** :c:func:`mat47_set_col` */
+    MAT47_STATS_OP_SET_COL,
+
+    /** :c:func:`mat47_set_elem` */
+    MAT47_STATS_OP_SET_ELEM,
+
+    /** :c:func:`mat47_set_row` */
+    MAT47_STATS_OP_SET_ROW,
+
+    /** :c:func:`mat47_set_submat` */
+    MAT47_STATS_OP_SET_SUBMAT,
+
+    /** :c:func:`mat47_solve` */
+    MAT47_STATS_OP_SOLVE,
+
+    /** :c:func:`mat47_solve_mixed` */
+    MAT47_STATS_OP_SOLVE_MIXED,
+
+    /** :c:func:`mat47_standardize` */
+    MAT47_STATS_OP_STANDARDIZE,
+
+    /** :c:func:`mat47_sum` */
+    MAT47_STATS_OP_SUM,
+
+    /** :c:func:`mat47_zero` */
+    MAT47_STATS_OP_ZERO,
+
+    /** :c:func:`mat47_zero_into` */
+    MAT47_STATS_OP_ZERO_INTO,
+
+    /** :c:func:`mat47b_del` */
+    MAT47_STATS_OP_B_DEL,
+
+    /** :c:func:`mat47b_lu` */
+    MAT47_STATS_OP_B_LU,
+
+    /** :c:func:`mat47b_lu_solve` */
+    MAT47_STATS_OP_B_LU_SOLVE,
+
+    /** :c:func:`mat47b_lu_solve_into` */
+    MAT47_STATS_OP_B_LU_SOLVE_INTO,
+
+    /** :c:func:`mat47b_pack` */
+    MAT47_STATS_OP_B_PACK,
+
+    /** :c:func:`mat47b_solve` */
+    MAT47_STATS_OP_B_SOLVE,
+
+    /** :c:func:`mat47b_solve_into` */
+    MAT47_STATS_OP_B_SOLVE_INTO,
+
+    /** :c:func:`mat47b_tridiag_solve` */
+    MAT47_STATS_OP_B_TRIDIAG_SOLVE,
+
+    /** :c:func:`mat47b_tridiag_solve_batch` */
+    MAT47_STATS_OP_B_TRIDIAG_SOLVE_BATCH,
+
+    /** :c:func:`mat47b_tridiag_solve_into` */
+    MAT47_STATS_OP_B_TRIDIAG_SOLVE_INTO,
+
+    /** :c:func:`mat47b_unpack` */
+    MAT47_STATS_OP_B_UNPACK,
+
+    /** :c:func:`mat47b_zero` */
+    MAT47_STATS_OP_B_ZERO,
+
+    /** :c:func:`mat47p_del` */
+    MAT47_STATS_OP_P_DEL,
+
+    /** :c:func:`mat47p_gemv` */
+    MAT47_STATS_OP_P_GEMV,
+
+    /** :c:func:`mat47p_mul` */
+    MAT47_STATS_OP_P_MUL,
+
+    /** :c:func:`mat47p_mul_into` */
+    MAT47_STATS_OP_P_MUL_INTO,
+
+    /** :c:func:`mat47p_pack` */
+    MAT47_STATS_OP_P_PACK,
+
+    /** :c:func:`mat47p_pack_into` */
+    MAT47_STATS_OP_P_PACK_INTO,
+
+    /** :c:func:`mat47p_syrk` */
+    MAT47_STATS_OP_P_SYRK,
+
+    /** :c:func:`mat47p_unpack` */
+    MAT47_STATS_OP_P_UNPACK,
+
+    /** :c:func:`mat47p_unpack_into` */
+    MAT47_STATS_OP_P_UNPACK_INTO,
+
+    /** :c:func:`mat47p_zero` */
+    MAT47_STATS_OP_P_ZERO,
+
+    /** :c:func:`mat47q_del` */
+    MAT47_STATS_OP_Q_DEL,
+
+    /** :c:func:`mat47q_dequantize` */
+    MAT47_STATS_OP_Q_DEQUANTIZE,
+
+    /** :c:func:`mat47q_dequantize_into` */
+    MAT47_STATS_OP_Q_DEQUANTIZE_INTO,
+
+    /** :c:func:`mat47q_init`, for all element types */
+    MAT47_STATS_OP_Q_INIT,
+
+    /** :c:func:`mat47q_mul_t` */
+    MAT47_STATS_OP_Q_MUL_T,
+
+    /** :c:func:`mat47q_mul_t_into` */
+    MAT47_STATS_OP_Q_MUL_T_INTO,
+
+    /** :c:func:`mat47q_quantize` */
+    MAT47_STATS_OP_Q_QUANTIZE,
+
+    /** :c:func:`mat47q_quantize_into` */
+    MAT47_STATS_OP_Q_QUANTIZE_INTO,
+
+    /** Number of operations; Not an operation */
+    MAT47_STATS_N_OPS
+};
+
+/**
+ * Performance counters of an operation.
+ *
+ * Only calls made from outside the library are counted. The time and resources used
+ * by library functions called internally are attributed to the outermost call e.g
+ * :c:func:`mat47_copy` calls :c:func:`mat47_init`, yet such calls are counted only
+ * for the former.
+ */
+struct mat47_op_stats {
+
+    /** Name of the function e.g ``"mat47_init"`` */
+    const char *name;
+
+    /** Number of calls */
+    uint64_t calls;
+
+    /** Cumulative (wall-clock) time spent in calls, in nanoseconds */
+    uint64_t ns;
+
+    /**
+     * Number of blocks of memory allocated, or whose ownership was transferred to
+     * the library (e.g by :c:func:`mat47_adopt`)
+     */
+    uint64_t n_allocs;
+
+    /** Size of the memory counted by :c:member:`n_allocs`, in bytes */
+    uint64_t bytes_allocated;
+
+    /**
+     * Size of the memory deallocated, or whose ownership was transferred out of the
+     * library (e.g by :c:func:`mat47_release`), in bytes
+     */
+    uint64_t bytes_freed;
+
+    /**
+     * Size of matrix elements copied (including those converted from other types),
+     * in bytes
+     */
+    uint64_t bytes_copied;
+};
+
+/** A snapshot of the performance counters of all operations */
+struct mat47_stats {
+
+    /** Counters, indexed by :c:enum:`mat47_stats_op` */
+    struct mat47_op_stats ops[MAT47_STATS_N_OPS];
+};
+
+/**
+ * The performance counters type (Alias of :c:struct:`struct mat47_stats<mat47_stats>`)
+ */
+typedef struct mat47_stats mat47_stats_t;
+
+/**
+ * Writes performance counters to a stream, as a JSON object.
+ *
+ * Args:
+ *     stats: The counters
+ *     stream: The stream to write to
+ *
+ * Returns:
+ *     - ``-1``, if any of the error conditions below occur.
+ *     - Otherwise, the number of bytes written.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *stats* or *stream* is null
+ *
+ * The object maps the name of each operation to an object of its counters, keyed by
+ * the names of the members of :c:struct:`mat47_op_stats`.
+ *
+ * Note:
+ *     *stream* is not explicitly flushed.
+ */
+intmax_t mat47_stats_fprint_json(const mat47_stats_t *stats, FILE *stream);
+
+/**
+ * Writes performance counters to a stream, in the Prometheus text exposition format.
+ *
+ * Args:
+ *     stats: The counters
+ *     stream: The stream to write to
+ *
+ * Returns:
+ *     - ``-1``, if any of the error conditions below occur.
+ *     - Otherwise, the number of bytes written.
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *stats* or *stream* is null
+ *
+ * Every counter is written as a ``mat47_*_total`` metric with an ``op`` label. Times
+ * are in seconds.
+ *
+ * Note:
+ *     *stream* is not explicitly flushed.
+ */
+intmax_t mat47_stats_fprint_prometheus(const mat47_stats_t *stats, FILE *stream);
+
+/**
+ * Resets all performance counters to zero, for all threads.
+ *
+ * This only affects subsequent snapshots; The counters of calls in progress are still
+ * updated when they return.
+ */
+void mat47_stats_reset(void);
+
+/**
+ * Takes a snapshot of the performance counters.
+ *
+ * Args:
+ *     stats: The location to store the snapshot in
+ *
+ * ERRORS:
+ *     - :c:enumerator:`~mat47_errors.MAT47_ERR_NULL_PTR`: *stats* is null
+ *
+ * Every thread updates its own counters, without synchronization. This aggregates
+ * the counters of all threads (including those that have exited) since the last
+ * reset (see :c:func:`mat47_stats_reset`).
+ *
+ * Note:
+ *     This can be called from any thread, while other threads use the library.
+ */
+void mat47_stats_snapshot(mat47_stats_t *stats);
+
+#endif  // MAT47_STATS_H
@@ -8,10 +8,15 @@
 #define MAT47_UTILS_H
 
 #include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <time.h>
 
 #include "error.h"
+#include "matrix.h"
+#include "stats.h"
 
 #define check(expr, errnum, msg, ...) ( \
     (expr) \
@@ -37,21 +42,24 @@
     ": (" #index ")=%" PRIdMAX ", n_rows=%u", (intmax_t)(index), (m)->n_rows \
 )
 
-#define log_(level, msg, ...) fprintf( \
-    (MAT47_LOG_FILE ? MAT47_LOG_FILE : stderr), \
-    "(%s) " __FILE__ ":%d: %s: [" level "] " msg "\n", \
-    mat47__get_timestamp(), __LINE__, __func__, ##__VA_ARGS__ \
+#define log_(level, msg, ...) ( \
+    atomic_load_explicit(&mat47__log_level, memory_order_relaxed) \
+        >= MAT47_LOG_LEVEL_##level \
+    ? mat47__log( \
+        __FILE__ ":%d: %s: [" #level "] " msg, __LINE__, __func__, ##__VA_ARGS__ \
+    ) \
+    : 0 \
 )
 
 #ifdef MAT47_LOG_DEBUG
-#define debug(msg, ...) log_("DEBUG", msg, ##__VA_ARGS__)
+#define debug(msg, ...) log_(DEBUG, msg, ##__VA_ARGS__)
 #else
 #define debug(...) mat47__return_zero()
 #endif
 
 #ifdef MAT47_LOG_ERROR
 #define error(extra_msg, ...) \
-    log_("ERROR", "%s" extra_msg, mat47_strerror(mat47_errno), ##__VA_ARGS__)
+    log_(ERROR, "%s" extra_msg, mat47_strerror(mat47_errno), ##__VA_ARGS__)
 #else
 #define error(...) mat47__return_zero()
 #endif
@@ -72,25 +80,225 @@
 
 extern FILE *MAT47_LOG_FILE;
 
+// Defined in `log.c`
+extern atomic_int mat47__log_level;
+
 int mat47__return_zero(void);
 
+/* Records a log in the calling thread's log buffer, to be formatted when flushed; See
+ * `mat47_log_flush()`. `format` must be a string literal.
+ *
+ * Always returns zero.
+ */
+int mat47__log(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
 #define _sum \
     intmax_t sum = 0; \
     while (n--) sum += arr[n]; \
     return sum;
 
-static intmax_t sum8(unsigned int n, int8_t arr[]) {_sum}
-static intmax_t sum16(unsigned int n, int16_t arr[]) {_sum}
-static intmax_t sum32(unsigned int n, int32_t arr[]) {_sum}
-static intmax_t sum64(unsigned int n, int64_t arr[]) {_sum}
+static inline intmax_t sum8(unsigned int n, int8_t arr[]) {_sum}
+static inline intmax_t sum16(unsigned int n, int16_t arr[]) {_sum}
+static inline intmax_t sum32(unsigned int n, int32_t arr[]) {_sum}
+static inline intmax_t sum64(unsigned int n, int64_t arr[]) {_sum}
 
-static uintmax_t usum8(unsigned int n, uint8_t arr[]) {_sum}
-static uintmax_t usum16(unsigned int n, uint16_t arr[]) {_sum}
-static uintmax_t usum32(unsigned int n, uint32_t arr[]) {_sum}
-static uintmax_t usum64(unsigned int n, uint64_t arr[]) {_sum}
+static inline uintmax_t usum8(unsigned int n, uint8_t arr[]) {_sum}
+static inline uintmax_t usum16(unsigned int n, uint16_t arr[]) {_sum}
+static inline uintmax_t usum32(unsigned int n, uint32_t arr[]) {_sum}
+static inline uintmax_t usum64(unsigned int n, uint64_t arr[]) {_sum}
 
 #undef _sum
 
-char *mat47__get_timestamp(void);
+// Performance counters of an operation, in the order of `struct mat47_op_stats`
+enum mat47__stats_counter {
+    MAT47__STATS_CALLS,
+    MAT47__STATS_NS,
+    MAT47__STATS_N_ALLOCS,
+    MAT47__STATS_BYTES_ALLOCATED,
+    MAT47__STATS_BYTES_FREED,
+    MAT47__STATS_BYTES_COPIED,
+    MAT47__STATS_N_COUNTERS
+};
+
+struct mat47__stats_frame {
+    int op;  // Negative for calls nested within another operation
+    struct timespec start;
+};
+
+/* `stats(OP)` must be the first statement of an API function's body. The counters of
+ * the operation are updated when the function returns.
+ *
+ * `stats_alloc()`, `stats_free()` and `stats_copy()` update the counters of the
+ * operation in progress on the calling thread, if any.
+ */
+#ifdef MAT47_STATS
+#define stats(op) \
+    __attribute__((cleanup(mat47__stats_exit))) \
+    struct mat47__stats_frame mat47__stats_frame = \
+        mat47__stats_enter(MAT47_STATS_OP_##op)
+#define stats_alloc(n, bytes) ( \
+    mat47__stats_count(MAT47__STATS_N_ALLOCS, n), \
+    mat47__stats_count(MAT47__STATS_BYTES_ALLOCATED, bytes) \
+)
+#define stats_free(bytes) mat47__stats_count(MAT47__STATS_BYTES_FREED, bytes)
+#define stats_copy(bytes) mat47__stats_count(MAT47__STATS_BYTES_COPIED, bytes)
+#else
+#define stats(op) (void)0
+#define stats_alloc(n, bytes) (void)0
+#define stats_free(bytes) (void)0
+#define stats_copy(bytes) (void)0
+#endif
+
+// Defined in `stats.c`
+struct mat47__stats_frame mat47__stats_enter(enum mat47_stats_op op);
+void mat47__stats_exit(struct mat47__stats_frame *frame);
+void mat47__stats_count(enum mat47__stats_counter counter, uint64_t n);
+
+// Defined in `matrix.c`; Shared by the other modules but not part of the API
+mat47_t *mat47__new(unsigned int n_rows, unsigned int n_cols, bool zero);
+
+/* Marks the elements (or dimensions) of `m` as modified, once the arguments of the
+ * modifying function are validated; See `struct mat47::version`.
+ */
+#define bump_version(m) ((void)(m)->version++)
+
+// Defined in `linalg.c`; Drops the factorizations of `m` cached by `mat47_solve()`
+void mat47__solve_forget(const mat47_t *m);
+
+/* Defined in `alloc.c`.
+ *
+ * `mat47__map_elements()` returns null if the elements are smaller than the
+ * allocation policy's threshold or on failure, without raising any error. The
+ * elements are zeroed. `mat47__unmap_elements()` deallocates them.
+ */
+double *mat47__map_elements(unsigned int n_rows, unsigned int n_cols);
+void mat47__unmap_elements(void *elements);
+
+// Minimum number of elements worth processing on a separate thread, for
+// memory-bound operations
+#define PARALLEL_GRAIN (1 << 18)
+
+typedef void mat47__range_fn(void *arg, size_t begin, size_t end);
+
+/* Calls `fn(arg, begin, end)` for consecutive subranges covering [0, n), in parallel
+ * if there are at least `2 * grain` items (and `grain` is non-zero).
+ *
+ * Calls made by a function running in parallel run serially.
+ */
+void mat47__parallel_for(size_t n, size_t grain, mat47__range_fn *fn, void *arg);
+
+/* Task graphs (defined in `parallel.c`).
+ *
+ * Tasks are added in sequential program order, each with the tiles it reads and
+ * writes (identified by indexes below the number given to `mat47__dag_new()`); A task
+ * depends on the last task to write any tile it accesses and, if it writes a tile, on
+ * the tasks that read it since. `mat47__dag_run()` runs all the tasks, each once all
+ * the tasks it depends on have completed, on up to `mat47_get_num_threads()` workers
+ * with work-stealing deques, then deallocates the graph.
+ *
+ * `mat47__dag_new()` and `mat47__dag_add()` return null and false, respectively, if
+ * unable to allocate memory, without raising any error; The graph should then be
+ * deallocated with `mat47__dag_del()`. Tasks run serially if `mat47__dag_run()` is
+ * called by a function running in parallel.
+ */
+typedef void mat47__task_fn(void *ctx, unsigned int i, unsigned int j, unsigned int k);
+
+struct mat47__access {
+    size_t tile;
+    bool write;
+};
+
+#define TILE_R(tile) ((struct mat47__access){(tile), false})
+#define TILE_RW(tile) ((struct mat47__access){(tile), true})
+
+struct mat47__dag *mat47__dag_new(size_t n_tiles);
+bool mat47__dag_add(
+    struct mat47__dag *dag, mat47__task_fn *fn, void *ctx, unsigned int i,
+    unsigned int j, unsigned int k, size_t n_accesses,
+    const struct mat47__access *accesses
+);
+void mat47__dag_run(struct mat47__dag *dag);
+void mat47__dag_del(struct mat47__dag *dag);
+
+/* A block of a matrix: Rows `rows[0]`, `rows[1]`, ..., from column `col` */
+struct mat47__view {
+    double **rows;
+    size_t col;
+};
+
+// Row `i` of the view `v`
+static inline double *mat47__row(struct mat47__view v, size_t i)
+{
+    return v.rows[i] + v.col;
+}
+
+// `x += a * y`, over `n` elements
+static inline void
+mat47__axpy(double *restrict x, double a, const double *restrict y, unsigned int n)
+{
+    for (unsigned int j = 0; j < n; j++) x[j] += a * y[j];
+}
+
+static inline double
+mat47__dot(const double *restrict x, const double *restrict y, unsigned int n)
+{
+    double s = 0;
+
+    for (unsigned int j = 0; j < n; j++) s += x[j] * y[j];
+    return s;
+}
+
+/* Defined in `blas.c`.
+ *
+ * `mat47__gemm()` computes `c = alpha * a * b + c` (or `alpha * a * b`, if not
+ * `accumulate`) and `mat47__gemm_nt()` computes `c = alpha * a * transpose(b) + c`,
+ * where `a` is `m x k` and `c` is `m x n`, in parallel.
+ */
+void mat47__gemm(
+    struct mat47__view c, struct mat47__view a, struct mat47__view b, unsigned int m,
+    unsigned int k, unsigned int n, double alpha, bool accumulate
+);
+void mat47__gemm_nt(
+    struct mat47__view c, struct mat47__view a, struct mat47__view b, unsigned int m,
+    unsigned int k, unsigned int n, double alpha
+);
+
+/* Defined in `blas.c`.
+ *
+ * `mat47__mul_square()` computes `c = a * b`, for `n x n` matrices, with
+ * Strassen-Winograd multiplication down to `crossover` if `n` exceeds it, taking its
+ * temporaries from `buf`, of at least `mat47__mul_square_size(n, crossover)` bytes.
+ * Doesn't allocate memory.
+ */
+size_t mat47__mul_square_size(unsigned int n, unsigned int crossover);
+void mat47__mul_square(
+    mat47_t *c, const mat47_t *a, const mat47_t *b, unsigned int crossover, void *buf
+);
+
+// Maximum number of row blocks whose column sums are computed separately (and
+// possibly in parallel) by the column-wise reductions of `reduce.c`
+#define MAT47__MAX_COL_BLOCKS 64
+
+/* Defined in `reduce.c`.
+ *
+ * `mat47__norm_1()` returns the 1-norm of `m`, as `mat47_norm_1()` does, computing
+ * the column sums in `scratch` if not null, of `MAT47__NORM_1_SCRATCH(m->n_cols)`
+ * elements; Doesn't allocate memory then.
+ */
+#define MAT47__NORM_1_SCRATCH(n_cols) ((size_t)(MAT47__MAX_COL_BLOCKS + 1) * (n_cols))
+
+double mat47__norm_1(const mat47_t *m, double *scratch);
+
+/* Defined in `linalg.c`.
+ *
+ * `mat47__workspace_n()` returns the size of the matrices `ws` is for.
+ * `mat47__workspace_mul()` returns the Strassen-Winograd workspace of `ws` for
+ * `crossover` (see `mat47__mul_square()`), reallocated if too small, or null if
+ * unable to allocate it, without raising any error.
+ */
+struct mat47_workspace;
+
+unsigned int mat47__workspace_n(const struct mat47_workspace *ws);
+void *mat47__workspace_mul(struct mat47_workspace *ws, unsigned int crossover);
 
 #endif  // MAT47_UTILS_H
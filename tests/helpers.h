@@ -0,0 +1,54 @@
+/* Helpers shared by the automated tests
+ *
+ * Included after the source file under test.
+ */
+
+#ifndef MAT47_TESTS_HELPERS_H
+#define MAT47_TESTS_HELPERS_H
+
+#include <math.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/error.h"
+#include "../src/mat47/matrix.h"
+
+#define create_matrix(m, mat47_f, ...) \
+    mat47_errno = 0; \
+    m = mat47_f(__VA_ARGS__); \
+\
+    cr_assert_eq( \
+        mat47_errno, 0, "Error creating matrix: (%s)", mat47_strerror(mat47_errno) \
+    ); \
+    cr_assert_not_null(m, "`" #m "` is null")
+
+#define assert_error(errnum, expr) \
+    mat47_errno = 0; \
+    cr_assert_null(expr, #expr " should fail"); \
+    cr_assert_eq( \
+        mat47_errno, errnum, \
+        "%u (%s) was raised", mat47_errno, mat47_strerror(mat47_errno) \
+    )
+
+#define assert_void_error(errnum, expr) \
+    mat47_errno = 0; \
+    expr; \
+    cr_assert_eq( \
+        mat47_errno, errnum, \
+        "%u (%s) was raised", mat47_errno, mat47_strerror(mat47_errno) \
+    )
+
+// A matrix of smoothly varying, distinct elements in [-1, 1]
+static inline mat47_t *new_wave(unsigned int n_rows, unsigned int n_cols)
+{
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, n_rows, n_cols);
+    for (unsigned int i = 0; i < n_rows; i++)
+        for (unsigned int j = 0; j < n_cols; j++)
+            m->data[i][j] = sin(i * 7.0 + j * 3.0 + 1);
+
+    return m;
+}
+
+#endif  // MAT47_TESTS_HELPERS_H
@@ -0,0 +1,134 @@
+#include <stdint.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/alloc.c"
+#include "../src/mat47/matrix.h"
+
+
+#define create_matrix(m, mat47_f, ...) \
+    mat47_errno = 0; \
+    m = mat47_f(__VA_ARGS__); \
+\
+    cr_assert_eq( \
+        mat47_errno, 0, "Error creating matrix: (%s)", mat47_strerror(mat47_errno) \
+    ); \
+    cr_assert_not_null(m, "`" #m "` is null")
+
+static void restore_policy(void)
+{
+    mat47_set_alloc_policy(MAT47_ALLOC_POLICY_DEFAULT);
+}
+
+// Asserts that `m` is zeroed and stored in a contiguous mapping
+static void assert_mapped(const mat47_t *m)
+{
+    cr_assert_not_null(m->block);
+    cr_assert_eq(m->free_block, mat47__unmap_elements);
+    cr_assert_eq((uintptr_t)m->block % HEADER_SIZE, 0, "Should be aligned");
+    for (unsigned int i = 0; i < m->n_rows; i++) {
+        cr_assert_eq(m->data[i], m->block + (size_t)i * m->n_cols);
+        for (unsigned int j = 0; j < m->n_cols; j++) cr_assert_eq(m->data[i][j], 0);
+    }
+}
+
+
+Test(alloc_policy, get_set)
+{
+    struct mat47_alloc_policy p = mat47_get_alloc_policy();
+
+    cr_assert_eq(p.threshold, MAT47_ALLOC_POLICY_DEFAULT.threshold);
+    cr_assert_eq(p.flags, MAT47_ALLOC_POLICY_DEFAULT.flags);
+
+    mat47_errno = 0;
+    mat47_set_alloc_policy((struct mat47_alloc_policy){1024, MAT47_ALLOC_HUGETLB});
+    cr_assert_eq(mat47_errno, 0);
+    p = mat47_get_alloc_policy();
+    cr_assert_eq(p.threshold, 1024);
+    cr_assert_eq(p.flags, MAT47_ALLOC_HUGETLB);
+
+    mat47_set_alloc_policy((struct mat47_alloc_policy){0, 1 << 5});
+    cr_assert_eq(mat47_errno, MAT47_ERR_INVALID_ARG);
+    p = mat47_get_alloc_policy();
+    cr_assert_eq(p.threshold, 1024, "Should be unchanged");
+    cr_assert_eq(p.flags, MAT47_ALLOC_HUGETLB, "Should be unchanged");
+    restore_policy();
+}
+
+Test(alloc_policy, threshold)
+{
+    mat47_t *m;
+
+    // 10 x 10 elements = 800 bytes
+    mat47_set_alloc_policy((struct mat47_alloc_policy){801, 0});
+    create_matrix(m, mat47_zero, 10, 10);
+    cr_assert_null(m->block, "Should be allocated row by row");
+    mat47_del(m);
+
+    mat47_set_alloc_policy((struct mat47_alloc_policy){800, 0});
+    create_matrix(m, mat47_zero, 10, 10);
+    assert_mapped(m);
+    mat47_del(m);
+
+    mat47_set_alloc_policy((struct mat47_alloc_policy){SIZE_MAX, ALL_FLAGS});
+    create_matrix(m, mat47_zero, 1000, 1000);
+    cr_assert_null(m->block, "Should be allocated row by row");
+    mat47_del(m);
+    restore_policy();
+}
+
+Test(alloc_policy, flags)
+{
+    unsigned int flags[] = {0, MAT47_ALLOC_HUGEPAGES, MAT47_ALLOC_HUGETLB, ALL_FLAGS};
+    mat47_t *m;
+
+    for (size_t k = 0; k < sizeof_arr(flags); k++) {
+        mat47_set_alloc_policy((struct mat47_alloc_policy){0, flags[k]});
+        create_matrix(m, mat47_zero, 1200, 1000);
+        assert_mapped(m);
+        // Rounded up to huge pages only for `MAP_HUGETLB`
+        if (!(flags[k] & MAT47_ALLOC_HUGETLB))
+            cr_assert_eq(
+                ((struct header *)((char *)m->block - HEADER_SIZE))->length,
+                HEADER_SIZE + sizeof(double) * 1200 * 1000
+            );
+        m->data[1199][999] = 1;
+        mat47_del(m);
+    }
+    restore_policy();
+}
+
+Test(alloc_policy, release)
+{
+    mat47_t *m;
+
+    mat47_set_alloc_policy((struct mat47_alloc_policy){0, 0});
+    create_matrix(m, mat47_zero, 3, 3);
+    mat47_errno = 0;
+    cr_assert_null(mat47_release(m));
+    cr_assert_eq(mat47_errno, MAT47_ERR_INVALID_ARG);
+    mat47_del(m);
+    restore_policy();
+}
+
+Test(alloc_policy, grow)
+{
+    mat47_t *m;
+
+    mat47_set_alloc_policy((struct mat47_alloc_policy){800, 0});
+    create_matrix(m, mat47_zero, 10, 10);
+    mat47_append_rows(m, m);
+    cr_assert_eq(mat47_errno, 0);
+    cr_assert_eq(m->n_rows, 20);
+    assert_mapped(m);
+
+    mat47_resize(m, 20, 30);
+    cr_assert_eq(mat47_errno, 0);
+    assert_mapped(m);
+
+    mat47_reshape(m, 30, 20);
+    cr_assert_eq(mat47_errno, 0);
+    assert_mapped(m);
+    mat47_del(m);
+    restore_policy();
+}
@@ -0,0 +1,229 @@
+#include <math.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/async.c"
+
+#include "helpers.h"
+
+
+static void assert_equal(const mat47_t *a, const mat47_t *b)
+{
+    cr_assert_eq(a->n_rows, b->n_rows);
+    cr_assert_eq(a->n_cols, b->n_cols);
+    for (unsigned int i = 0; i < a->n_rows; i++)
+        for (unsigned int j = 0; j < a->n_cols; j++)
+            cr_assert_eq(a->data[i][j], b->data[i][j], "[%u][%u]", i, j);
+}
+
+// Waits for a future that should complete successfully
+static mat47_t *wait_ok(mat47_future_t *f)
+{
+    mat47_t *m;
+
+    cr_assert_not_null(f);
+    create_matrix(m, mat47_future_wait, f);
+
+    return m;
+}
+
+static mat47_t *load(void *arg)
+{
+    return new_wave(*(unsigned int *)arg, *(unsigned int *)arg);
+}
+
+static mat47_t *fail(void *arg)
+{
+    mat47_errno = *(unsigned int *)arg;
+
+    return NULL;
+}
+
+static mat47_t *square(mat47_t *m, void *arg)
+{
+    mat47_t *p = mat47_mul(m, m);
+
+    (void)arg;
+    mat47_del(m);
+
+    return p;
+}
+
+static atomic_uint n_calls;
+
+static mat47_t *count_call(mat47_t *m, void *arg)
+{
+    (void)arg;
+    atomic_fetch_add(&n_calls, 1);
+
+    return m;
+}
+
+
+Test(async, errors)
+{
+    // Outlives the detached operation below
+    static unsigned int n = 2;
+    mat47_t *m;
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47_async_call(NULL, NULL));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_future_then(NULL, square, NULL));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_future_wait(NULL));
+
+    mat47_errno = 0;
+    cr_assert_not(mat47_future_done(NULL));
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+
+    // Consumes the future, deallocating its result
+    assert_error(
+        MAT47_ERR_NULL_PTR,
+        mat47_future_then(mat47_async_call(load, &n), NULL, NULL)
+    );
+
+    // Raised by the operations
+    create_matrix(m, mat47_zero, 2, 3);
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_future_wait(mat47_async_mul(m, m)));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_future_wait(mat47_async_cholesky(NULL)));
+    assert_error(
+        MAT47_ERR_DIM_MISMATCH,
+        mat47_future_wait(mat47_async_lu(m, (unsigned int[2]){0}))
+    );
+    assert_error(
+        MAT47_ERR_NULL_PTR, mat47_future_wait(mat47_async_qr(NULL, &(mat47_t *){NULL}))
+    );
+    mat47_del(m);
+}
+
+Test(async, operations)
+{
+    unsigned int n = 150, piv[150], piv_async[150];
+    mat47_t *a, *expected, *result, *r, *r_async;
+
+    a = new_wave(n, n);
+
+    create_matrix(expected, mat47_mul, a, a);
+    result = wait_ok(mat47_async_mul(a, a));
+    assert_equal(result, expected);
+    mat47_del(result);
+
+    // `a * transpose(a)` is positive-definite
+    for (unsigned int i = 0; i < n; i++) expected->data[i][i] += n;
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int j = 0; j < i; j++)
+            expected->data[i][j] = expected->data[j][i];
+    mat47_del(a);
+    a = expected;
+    create_matrix(expected, mat47_cholesky, a);
+    result = wait_ok(mat47_async_cholesky(a));
+    assert_equal(result, expected);
+    mat47_del(result); mat47_del(expected);
+
+    create_matrix(expected, mat47_lu, a, piv);
+    result = wait_ok(mat47_async_lu(a, piv_async));
+    assert_equal(result, expected);
+    for (unsigned int i = 0; i < n; i++) cr_assert_eq(piv_async[i], piv[i]);
+    mat47_del(result); mat47_del(expected);
+
+    create_matrix(expected, mat47_qr, a, &r);
+    result = wait_ok(mat47_async_qr(a, &r_async));
+    assert_equal(result, expected);
+    assert_equal(r_async, r);
+    mat47_del(result); mat47_del(expected); mat47_del(r); mat47_del(r_async);
+
+    mat47_del(a);
+}
+
+Test(async, then)
+{
+    unsigned int n = 3, errnum = MAT47_ERR_SINGULAR;
+    mat47_future_t *f;
+    mat47_t *expected, *result;
+
+    // Chained while pending or once complete
+    for (int done = 0; done < 2; done++) {
+        f = mat47_async_call(load, &n);
+        cr_assert_not_null(f);
+        while (done && !mat47_future_done(f)) sched_yield();
+
+        f = mat47_future_then(mat47_future_then(f, square, NULL), square, NULL);
+        result = wait_ok(f);
+        expected = square(square(new_wave(n, n), NULL), NULL);
+        assert_equal(result, expected);
+        mat47_del(result); mat47_del(expected);
+    }
+
+    // Errors skip the continuations
+    f = mat47_async_call(fail, &errnum);
+    f = mat47_future_then(mat47_future_then(f, count_call, NULL), count_call, NULL);
+    cr_assert_not_null(f);
+    assert_error(MAT47_ERR_SINGULAR, mat47_future_wait(f));
+    cr_assert_eq(atomic_load(&n_calls), 0);
+}
+
+
+static atomic_bool flag;
+
+// Raises an error if the flag isn't set within ten seconds
+static mat47_t *wait_flag(void *arg)
+{
+    time_t deadline = time(NULL) + 10;
+
+    (void)arg;
+    while (!atomic_load(&flag))
+        if (time(NULL) > deadline) {
+            mat47_errno = MAT47_ERR_INVALID_ARG;
+            break;
+        }
+        else sched_yield();
+
+    return NULL;
+}
+
+static mat47_t *set_flag(void *arg)
+{
+    (void)arg;
+    atomic_store(&flag, true);
+
+    return NULL;
+}
+
+Test(async, overlap)
+{
+    mat47_future_t *blocked, *f;
+
+    // Would never complete, if run after the operation it waits for
+    blocked = mat47_async_call(wait_flag, NULL);
+    f = mat47_async_call(set_flag, NULL);
+    mat47_errno = 0;
+    cr_assert_null(mat47_future_wait(blocked));
+    cr_assert_null(mat47_future_wait(f));
+    cr_assert_eq(mat47_errno, 0);
+}
+
+
+static mat47_t *nested(void *arg)
+{
+    unsigned int depth = *(unsigned int *)arg - 1;
+
+    if (!depth) return new_wave(1, 1);
+
+    return mat47_future_wait(mat47_async_call(nested, &depth));
+}
+
+Test(async, nested)
+{
+    mat47_future_t *f[8];
+    mat47_t *m;
+    unsigned int depth = 5;
+
+    // More operations waiting for others than threads in the pool
+    for (size_t i = 0; i < sizeof_arr(f); i++) f[i] = mat47_async_call(nested, &depth);
+    for (size_t i = 0; i < sizeof_arr(f); i++) {
+        m = wait_ok(f[i]);
+        cr_assert_eq(m->data[0][0], sin(1));
+        mat47_del(m);
+    }
+}
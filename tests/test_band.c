@@ -0,0 +1,282 @@
+#include <math.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/band.c"
+#include "../src/mat47/blas.h"
+
+#include "helpers.h"
+
+
+// A banded matrix of the elements of `new_wave()`, plus `diag` on the diagonal
+static mat47b_t *new_band(unsigned int n, unsigned int kl, unsigned int ku, double diag)
+{
+    mat47_t *m = new_wave(n, n);
+    mat47b_t *b;
+
+    for (unsigned int i = 0; i < n; i++) m->data[i][i] += diag;
+    create_matrix(b, mat47b_pack, m, kl, ku);
+    mat47_del(m);
+
+    return b;
+}
+
+// Asserts that `a * x` is close to `b`, relative to the magnitude of `x`
+static void assert_solution(const mat47b_t *a, const mat47_t *x, const mat47_t *b)
+{
+    mat47_t *dense, *ax;
+    double tol = 1;
+
+    for (unsigned int i = 0; i < x->n_rows; i++)
+        for (unsigned int j = 0; j < x->n_cols; j++)
+            tol = fmax(tol, fabs(x->data[i][j]));
+    tol *= 1e-12;
+
+    create_matrix(dense, mat47b_unpack, a);
+    create_matrix(ax, mat47_mul, dense, x);
+    for (unsigned int i = 0; i < b->n_rows; i++)
+        for (unsigned int j = 0; j < b->n_cols; j++)
+            cr_assert_float_eq(ax->data[i][j], b->data[i][j], tol, "[%u][%u]", i, j);
+    mat47_del(dense);
+    mat47_del(ax);
+}
+
+
+Test(band, errors)
+{
+    unsigned int piv[3];
+    mat47_t *m, *rect, *x;
+    mat47b_t *b, *wide;
+
+    assert_error(MAT47_ERR_ZERO_SIZE, mat47b_zero(0, 0, 0));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47b_zero(3, 3, 0));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47b_zero(3, 1, 3));
+    assert_error(MAT47_ERR_NULL_PTR, mat47b_pack(NULL, 0, 0));
+    assert_error(MAT47_ERR_NULL_PTR, mat47b_unpack(NULL));
+
+    create_matrix(m, mat47_zero, 3, 3);
+    create_matrix(rect, mat47_zero, 2, 3);
+    create_matrix(b, mat47b_zero, 3, 1, 1);
+    create_matrix(wide, mat47b_zero, 3, 2, 1);
+
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47b_pack(rect, 0, 0));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47b_pack(m, 1, 5));
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47b_lu(b, NULL));
+    assert_error(MAT47_ERR_SINGULAR, mat47b_lu(b, piv));
+    assert_error(MAT47_ERR_NULL_PTR, mat47b_lu_solve(b, NULL, m));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47b_lu_solve(b, piv, rect));
+    assert_error(MAT47_ERR_NULL_PTR, mat47b_solve(NULL, m));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47b_solve(b, rect));
+    assert_error(MAT47_ERR_SINGULAR, mat47b_solve(b, m));
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47b_tridiag_solve(b, NULL));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47b_tridiag_solve(wide, m));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47b_tridiag_solve(b, rect));
+    assert_error(MAT47_ERR_SINGULAR, mat47b_tridiag_solve(b, m));
+
+    // Leaves `x` unchanged
+    create_matrix(x, mat47_zero, 3, 3);
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47b_tridiag_solve_batch(x, m, NULL, m));
+    assert_void_error(MAT47_ERR_INVALID_ARG, mat47b_tridiag_solve_batch(x, m, x, m));
+    assert_void_error(
+        MAT47_ERR_DIM_MISMATCH, mat47b_tridiag_solve_batch(x, m, m, rect)
+    );
+    x->data[1][2] = 5;
+    assert_void_error(MAT47_ERR_SINGULAR, mat47b_tridiag_solve_batch(x, m, m, m));
+    cr_assert_eq(x->data[1][2], 5);
+
+    mat47_del(m); mat47_del(rect); mat47_del(x);
+    mat47b_del(b); mat47b_del(wide);
+    mat47b_del(NULL);
+}
+
+Test(band, round_trip)
+{
+    unsigned int n = 7, bands[][2] = {{0, 0}, {1, 1}, {2, 0}, {0, 3}, {6, 6}};
+    mat47_t *m = new_wave(n, n), *u;
+    mat47b_t *b;
+
+    for (size_t k = 0; k < sizeof_arr(bands); k++) {
+        unsigned int kl = bands[k][0], ku = bands[k][1];
+
+        create_matrix(b, mat47b_pack, m, kl, ku);
+        cr_assert_eq(b->n, n);
+        cr_assert_eq(b->kl, kl);
+        cr_assert_eq(b->ku, ku);
+        for (unsigned int i = 0; i < n; i++)
+            for (unsigned int t = 0; t <= kl + ku; t++) {
+                long j = (long)i - kl + t;
+                double expected = j >= 0 && j < n ? m->data[i][j] : 0;
+
+                cr_assert_eq(
+                    b->data[i * (kl + ku + 1) + t], expected, "[%u][%ld]", i, j
+                );
+            }
+
+        create_matrix(u, mat47b_unpack, b);
+        for (unsigned int i = 0; i < n; i++)
+            for (unsigned int j = 0; j < n; j++)
+                cr_assert_eq(
+                    u->data[i][j],
+                    j + kl >= i && j <= i + ku ? m->data[i][j] : 0, "[%u][%u]", i, j
+                );
+        mat47_del(u);
+        mat47b_del(b);
+    }
+    mat47_del(m);
+}
+
+Test(band, solve)
+{
+    unsigned int n = 200, bands[][2] = {{0, 0}, {3, 2}, {1, 4}, {5, 0}};
+    unsigned int *piv, i, n_swaps;
+    mat47_t *b = new_wave(n, 3), *x, *y;
+    mat47b_t *a, *lu;
+
+    cr_assert_not_null(piv = malloc(sizeof(unsigned int) * n));
+    for (size_t k = 0; k < sizeof_arr(bands); k++) {
+        // Not diagonally dominant, such that rows are interchanged
+        a = new_band(n, bands[k][0], bands[k][1], 1.5);
+
+        create_matrix(lu, mat47b_lu, a, piv);
+        cr_assert_eq(lu->kl, a->kl);
+        cr_assert_eq(lu->ku, a->kl + a->ku);
+        for (n_swaps = 0, i = 0; i < n; i++) {
+            cr_assert(piv[i] >= i && piv[i] <= i + a->kl);
+            n_swaps += piv[i] != i;
+        }
+        if (a->kl) cr_assert_gt(n_swaps, 0);
+        create_matrix(x, mat47b_lu_solve, lu, piv, b);
+        assert_solution(a, x, b);
+
+        create_matrix(y, mat47b_solve, a, b);
+        for (i = 0; i < n; i++)
+            for (unsigned int j = 0; j < b->n_cols; j++)
+                cr_assert_eq(y->data[i][j], x->data[i][j]);
+
+        mat47_del(x); mat47_del(y);
+        mat47b_del(a); mat47b_del(lu);
+    }
+    mat47_del(b);
+    free(piv);
+}
+
+Test(band, tridiag_solve)
+{
+    unsigned int n = 150, bands[][2] = {{1, 1}, {1, 0}, {0, 1}, {0, 0}};
+    mat47_t *b = new_wave(n, 4), *x;
+    mat47b_t *a;
+
+    for (size_t k = 0; k < sizeof_arr(bands); k++) {
+        // Diagonally dominant
+        a = new_band(n, bands[k][0], bands[k][1], 3);
+        create_matrix(x, mat47b_tridiag_solve, a, b);
+        assert_solution(a, x, b);
+        mat47_del(x);
+        mat47b_del(a);
+    }
+
+    // Single element
+    a = new_band(1, 0, 0, 3);
+    mat47_del(b);
+    b = new_wave(1, 1);
+    create_matrix(x, mat47b_tridiag_solve, a, b);
+    cr_assert_float_eq(x->data[0][0], sin(1) / (sin(1) + 3), 1e-15);
+    mat47_del(x); mat47_del(b);
+    mat47b_del(a);
+}
+
+Test(band, solve_into)
+{
+    unsigned int n = 40, piv[40], i, j;
+    mat47_t *b = new_wave(n, 3), *x, *dst, *rect;
+    mat47b_t *a = new_band(n, 2, 1, 1.5), *t = new_band(n, 1, 1, 3), *lu, *zero;
+
+    create_matrix(lu, mat47b_lu, a, piv);
+    create_matrix(zero, mat47b_zero, n, 1, 1);
+    create_matrix(dst, mat47_zero, n, 3);
+    create_matrix(rect, mat47_zero, n, 2);
+
+    // Errors leave `dst` unchanged
+    dst->data[1][2] = 5;
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47b_solve_into(NULL, a, b));
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47b_lu_solve_into(dst, lu, NULL, b));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47b_solve_into(rect, a, b));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47b_lu_solve_into(rect, lu, piv, b));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47b_tridiag_solve_into(rect, t, b));
+    assert_void_error(MAT47_ERR_INVALID_ARG, mat47b_tridiag_solve_into(dst, a, b));
+    assert_void_error(MAT47_ERR_SINGULAR, mat47b_solve_into(dst, zero, b));
+    assert_void_error(MAT47_ERR_SINGULAR, mat47b_tridiag_solve_into(dst, zero, b));
+    cr_assert_eq(dst->data[1][2], 5);
+    for (i = 0; i < n; i++)
+        for (j = 0; j < 3; j++)
+            if (i != 1 || j != 2) cr_assert_eq(dst->data[i][j], 0, "[%u][%u]", i, j);
+
+    create_matrix(x, mat47b_solve, a, b);
+    mat47b_solve_into(dst, a, b);
+    cr_assert_eq(mat47_errno, 0);
+    for (i = 0; i < n; i++)
+        for (j = 0; j < 3; j++) cr_assert_eq(dst->data[i][j], x->data[i][j]);
+    mat47_copy_into(dst, b);
+    mat47b_lu_solve_into(dst, lu, piv, dst);
+    cr_assert_eq(mat47_errno, 0);
+    for (i = 0; i < n; i++)
+        for (j = 0; j < 3; j++) cr_assert_eq(dst->data[i][j], x->data[i][j]);
+    mat47_del(x);
+
+    create_matrix(x, mat47b_tridiag_solve, t, b);
+    mat47b_tridiag_solve_into(dst, t, b);
+    cr_assert_eq(mat47_errno, 0);
+    for (i = 0; i < n; i++)
+        for (j = 0; j < 3; j++) cr_assert_eq(dst->data[i][j], x->data[i][j]);
+    mat47_copy_into(dst, b);
+    mat47b_tridiag_solve_into(dst, t, dst);
+    cr_assert_eq(mat47_errno, 0);
+    for (i = 0; i < n; i++)
+        for (j = 0; j < 3; j++) cr_assert_eq(dst->data[i][j], x->data[i][j]);
+
+    mat47_del(b); mat47_del(x); mat47_del(dst); mat47_del(rect);
+    mat47b_del(a); mat47b_del(t); mat47b_del(lu); mat47b_del(zero);
+}
+
+Test(band, tridiag_solve_batch)
+{
+    unsigned int n = 60, n_systems = 37;
+    mat47_t *dl = new_wave(n, n_systems), *d = new_wave(n, n_systems);
+    mat47_t *du = new_wave(n, n_systems), *b = new_wave(n, n_systems);
+    mat47_t *x, *col, *expected;
+    mat47b_t *a;
+
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int s = 0; s < n_systems; s++) {
+            d->data[i][s] += 3;
+            du->data[i][s] = cos(i + s);
+        }
+
+    create_matrix(x, mat47_copy, b);
+    mat47_errno = 0;
+    mat47b_tridiag_solve_batch(x, dl, d, du);
+    cr_assert_eq(mat47_errno, 0);
+
+    create_matrix(a, mat47b_zero, n, 1, 1);
+    create_matrix(col, mat47_zero, n, 1);
+    for (unsigned int s = 0; s < n_systems; s++) {
+        for (unsigned int i = 0; i < n; i++) {
+            if (i) *elem(a, i, i - 1) = dl->data[i][s];
+            *elem(a, i, i) = d->data[i][s];
+            if (i < n - 1) *elem(a, i, i + 1) = du->data[i][s];
+            col->data[i][0] = b->data[i][s];
+        }
+        create_matrix(expected, mat47b_tridiag_solve, a, col);
+        for (unsigned int i = 0; i < n; i++)
+            cr_assert_float_eq(
+                x->data[i][s], expected->data[i][0], 1e-13, "[%u][%u]", i, s
+            );
+        mat47_del(expected);
+    }
+
+    mat47_del(dl); mat47_del(d); mat47_del(du); mat47_del(b); mat47_del(x);
+    mat47_del(col);
+    mat47b_del(a);
+}
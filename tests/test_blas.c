@@ -0,0 +1,375 @@
+#include <math.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/blas.c"
+
+
+#define create_matrix(m, mat47_f, ...) \
+    mat47_errno = 0; \
+    m = mat47_f(__VA_ARGS__); \
+\
+    cr_assert_eq( \
+        mat47_errno, 0, "Error creating matrix: (%s)", mat47_strerror(mat47_errno) \
+    ); \
+    cr_assert_not_null(m, "`" #m "` is null")
+
+#define assert_error(errnum, expr) \
+    mat47_errno = 0; \
+    expr; \
+    cr_assert_eq( \
+        mat47_errno, errnum, \
+        #expr ": %u (%s) was raised", mat47_errno, mat47_strerror(mat47_errno) \
+    )
+
+/* Returns a new matrix with small integral elements (hence, products are summed
+ * exactly in any order), varying with `seed`.
+ */
+static mat47_t *new_filled(unsigned int n_rows, unsigned int n_cols, unsigned int seed)
+{
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, n_rows, n_cols);
+    for (unsigned int i = 0; i < n_rows; i++)
+        for (unsigned int j = 0; j < n_cols; j++)
+            m->data[i][j] = (double)((i * 3 + j * 5 + seed) % 7) - 3;
+
+    return m;
+}
+
+// `sum(a[i][j] * x[j] for j)`, or `sum(a[j][i] * x[j] for j)` if `trans`
+static double naive_dot(const mat47_t *a, const double *x, unsigned int i, bool trans)
+{
+    double s = 0;
+
+    if (trans)
+        for (unsigned int j = 0; j < a->n_rows; j++) s += a->data[j][i] * x[j];
+    else
+        for (unsigned int j = 0; j < a->n_cols; j++) s += a->data[i][j] * x[j];
+
+    return s;
+}
+
+// Copies the elements of vector `v` into `out`
+static void flatten(const mat47_t *v, double *out)
+{
+    for (unsigned int k = 0; k < v->n_rows * v->n_cols; k++)
+        out[k] = *vector_elem(v, k);
+}
+
+// Sizes exercising the scalar tails, partial groups of rows and multiple chunks
+static const unsigned int sizes[][2] = {
+    {1, 1}, {3, 5}, {4, 4}, {7, 9}, {33, 130}, {130, 33}, {9, 2500}, {2500, 9},
+    {600, 700}
+};
+
+
+/* Errors */
+
+Test(gemv, errors)
+{
+    mat47_t *a, *x, *y, *xs, *ys;
+
+    create_matrix(a, mat47_zero, 3, 4);
+    create_matrix(x, mat47_zero, 4, 1);
+    create_matrix(y, mat47_zero, 1, 3);
+    create_matrix(xs, mat47_zero, 2, 4);
+    create_matrix(ys, mat47_zero, 2, 3);
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47_gemv(NULL, 1, a, x, 0));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_gemv(y, 1, NULL, x, 0));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_gemv(y, 1, a, NULL, 0));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_gemv_t(NULL, 1, a, y, 0));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_gemv_batch(ys, 1, a, NULL, 0));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_gemv(x, 1, a, x, 0));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_gemv_t(a, 1, a, y, 0));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_gemv_batch(xs, 1, a, xs, 0));
+
+    // Not vectors, or of the wrong length
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_gemv(y, 1, a, xs, 0));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_gemv(x, 1, a, y, 0));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_gemv(ys, 1, a, x, 0));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_gemv_t(y, 1, a, x, 0));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_gemv_t(ys, 1, a, y, 0));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_gemv_batch(ys, 1, a, y, 0));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_gemv_batch(y, 1, a, xs, 0));
+
+    mat47_del(a); mat47_del(x); mat47_del(y); mat47_del(xs); mat47_del(ys);
+}
+
+
+/* Products */
+
+Test(gemv, gemv)
+{
+    // {alpha, beta}
+    static const double scales[][2] = {{1, 0}, {-2, 1}, {0.5, -3}};
+    double *x_flat, *y_flat;
+    mat47_t *a, *x, *y;
+
+    for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+        unsigned int n_rows = sizes[s][0], n_cols = sizes[s][1];
+
+        a = new_filled(n_rows, n_cols, 0);
+        x_flat = malloc(sizeof(double) * n_cols);
+        y_flat = malloc(sizeof(double) * n_rows);
+        // Row and column vectors
+        for (unsigned int shape = 0; shape < 4; shape++) {
+            x = shape & 1 ? new_filled(n_cols, 1, 1) : new_filled(1, n_cols, 1);
+            y = shape & 2 ? new_filled(n_rows, 1, 2) : new_filled(1, n_rows, 2);
+            flatten(x, x_flat);
+
+            for (size_t k = 0; k < sizeof_arr(scales); k++) {
+                flatten(y, y_flat);
+                mat47_errno = 0;
+                mat47_gemv(y, scales[k][0], a, x, scales[k][1]);
+                cr_assert_eq(mat47_errno, 0);
+
+                for (unsigned int i = 0; i < n_rows; i++)
+                    cr_assert_eq(
+                        *vector_elem(y, i),
+                        scales[k][0] * naive_dot(a, x_flat, i, false)
+                        + scales[k][1] * y_flat[i],
+                        "%ux%u, shape=%u, scales=%zu, row %u",
+                        n_rows, n_cols, shape, k, i
+                    );
+            }
+            mat47_del(x); mat47_del(y);
+        }
+        free(x_flat); free(y_flat);
+        mat47_del(a);
+    }
+}
+
+Test(gemv, gemv_t)
+{
+    static const double scales[][2] = {{1, 0}, {-2, 1}, {0.5, -3}};
+    double *x_flat, *y_flat;
+    mat47_t *a, *x, *y;
+
+    for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+        unsigned int n_rows = sizes[s][0], n_cols = sizes[s][1];
+
+        a = new_filled(n_rows, n_cols, 0);
+        x_flat = malloc(sizeof(double) * n_rows);
+        y_flat = malloc(sizeof(double) * n_cols);
+        for (unsigned int shape = 0; shape < 4; shape++) {
+            x = shape & 1 ? new_filled(n_rows, 1, 1) : new_filled(1, n_rows, 1);
+            y = shape & 2 ? new_filled(n_cols, 1, 2) : new_filled(1, n_cols, 2);
+            flatten(x, x_flat);
+
+            for (size_t k = 0; k < sizeof_arr(scales); k++) {
+                flatten(y, y_flat);
+                mat47_errno = 0;
+                mat47_gemv_t(y, scales[k][0], a, x, scales[k][1]);
+                cr_assert_eq(mat47_errno, 0);
+
+                for (unsigned int j = 0; j < n_cols; j++)
+                    cr_assert_eq(
+                        *vector_elem(y, j),
+                        scales[k][0] * naive_dot(a, x_flat, j, true)
+                        + scales[k][1] * y_flat[j],
+                        "%ux%u, shape=%u, scales=%zu, column %u",
+                        n_rows, n_cols, shape, k, j
+                    );
+            }
+            mat47_del(x); mat47_del(y);
+        }
+        free(x_flat); free(y_flat);
+        mat47_del(a);
+    }
+}
+
+Test(gemv, beta_zero)
+{
+    double x_flat[6];
+    mat47_t *a, *x, *y;
+
+    a = new_filled(5, 6, 0);
+    x = new_filled(6, 1, 1);
+    create_matrix(y, mat47_zero, 5, 1);
+    flatten(x, x_flat);
+
+    // Neither NaNs nor infinities are propagated
+    for (unsigned int i = 0; i < 5; i++) y->data[i][0] = i % 2 ? NAN : INFINITY;
+    mat47_gemv(y, 1, a, x, 0);
+    for (unsigned int i = 0; i < 5; i++)
+        cr_assert_eq(y->data[i][0], naive_dot(a, x_flat, i, false));
+
+    mat47_del(x);
+    x = new_filled(1, 5, 1);
+    mat47_del(y);
+    create_matrix(y, mat47_zero, 1, 6);
+    for (unsigned int j = 0; j < 6; j++) y->data[0][j] = NAN;
+    mat47_gemv_t(y, 1, a, x, 0);
+    for (unsigned int j = 0; j < 6; j++)
+        cr_assert_eq(y->data[0][j], naive_dot(a, x->data[0], j, true));
+
+    mat47_del(a); mat47_del(x); mat47_del(y);
+}
+
+Test(gemv, batch)
+{
+    static const double scales[][2] = {{1, 0}, {-2, 1}};
+    mat47_t *a, *x, *y, *y0;
+
+    for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+        unsigned int n_rows = sizes[s][0], n_cols = sizes[s][1];
+
+        a = new_filled(n_rows, n_cols, 0);
+        // Both paths, with partial groups of vectors
+        for (unsigned int n_vecs = 1; n_vecs <= 9; n_vecs++) {
+            x = new_filled(n_vecs, n_cols, 1);
+            y0 = new_filled(n_vecs, n_rows, 2);
+
+            for (size_t k = 0; k < sizeof_arr(scales); k++) {
+                create_matrix(y, mat47_copy, y0);
+                if (scales[k][1] == 0) y->data[n_vecs - 1][0] = NAN;
+                mat47_errno = 0;
+                mat47_gemv_batch(y, scales[k][0], a, x, scales[k][1]);
+                cr_assert_eq(mat47_errno, 0);
+
+                for (unsigned int v = 0; v < n_vecs; v++)
+                    for (unsigned int i = 0; i < n_rows; i++)
+                        cr_assert_eq(
+                            y->data[v][i],
+                            scales[k][0] * naive_dot(a, x->data[v], i, false)
+                            + scales[k][1] * y0->data[v][i],
+                            "%ux%u, n_vecs=%u, scales=%zu, y[%u][%u]",
+                            n_rows, n_cols, n_vecs, k, v, i
+                        );
+                mat47_del(y);
+            }
+            mat47_del(x); mat47_del(y0);
+        }
+        mat47_del(a);
+    }
+}
+
+
+/* Matrix multiplication */
+
+// Asserts that `c == a * b`, exactly
+static void assert_product(const mat47_t *c, const mat47_t *a, const mat47_t *b)
+{
+    double s;
+
+    cr_assert_eq(c->n_rows, a->n_rows);
+    cr_assert_eq(c->n_cols, b->n_cols);
+    for (unsigned int i = 0; i < a->n_rows; i++)
+        for (unsigned int j = 0; j < b->n_cols; j++) {
+            s = 0;
+            for (unsigned int p = 0; p < a->n_cols; p++)
+                s += a->data[i][p] * b->data[p][j];
+            cr_assert_eq(
+                c->data[i][j], s, "%ux%u * %ux%u: c[%u][%u]",
+                a->n_rows, a->n_cols, b->n_rows, b->n_cols, i, j
+            );
+        }
+}
+
+Test(mul, errors)
+{
+    mat47_t *a, *b, *c, *d, *e;
+    mat47_workspace_t *ws;
+
+    create_matrix(a, mat47_zero, 3, 4);
+    create_matrix(b, mat47_zero, 4, 2);
+    create_matrix(c, mat47_zero, 3, 2);
+    create_matrix(d, mat47_zero, 2, 2);
+
+    mat47_errno = 0;
+    cr_assert_null(mat47_mul(NULL, b));
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+    mat47_errno = 0;
+    cr_assert_null(mat47_mul(b, a));
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47_mul_into(NULL, a, b, NULL));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_mul_into(c, a, NULL, NULL));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_mul_into(c, b, a, NULL));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_mul_into(d, a, b, NULL));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_mul_into(d, d, d, NULL));
+
+    // A workspace is for square operands of its size, and ignored for others
+    cr_assert_not_null(ws = mat47_workspace_new(2));
+    mat47_errno = 0;
+    a->data[2][3] = b->data[3][1] = 2;
+    mat47_mul_into(c, a, b, ws);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    assert_product(c, a, b);
+    mat47_del(a);
+    create_matrix(a, mat47_zero, 3, 3);
+    create_matrix(e, mat47_zero, 3, 3);
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_mul_into(e, a, a, ws));
+    mat47_workspace_del(ws);
+
+    mat47_del(a); mat47_del(b); mat47_del(c); mat47_del(d); mat47_del(e);
+}
+
+Test(mul, classical)
+{
+    // Sizes exercising the scalar tails, odd rows and multiple panels
+    static const unsigned int dims[][3] = {
+        {1, 1, 1}, {1, 5, 3}, {3, 1, 4}, {7, 9, 2}, {33, 130, 17}, {5, 700, 600},
+        {300, 3, 1100}
+    };
+    mat47_t *a, *b, *c;
+
+    mat47_set_strassen_crossover(MAT47_STRASSEN_OFF);
+    for (size_t s = 0; s < sizeof_arr(dims); s++) {
+        a = new_filled(dims[s][0], dims[s][1], 0);
+        b = new_filled(dims[s][1], dims[s][2], 1);
+
+        create_matrix(c, mat47_mul, a, b);
+        assert_product(c, a, b);
+
+        // Overwritten
+        for (unsigned int i = 0; i < c->n_rows; i++) c->data[i][0] = NAN;
+        mat47_mul_into(c, a, b, NULL);
+        cr_assert_eq(mat47_errno, 0);
+        assert_product(c, a, b);
+
+        mat47_del(a); mat47_del(b); mat47_del(c);
+    }
+    mat47_set_strassen_crossover(0);
+}
+
+Test(mul, strassen)
+{
+    // With integral elements, the rounding of the Strassen-Winograd algorithm is
+    // the same as that of the classical one.
+    static const unsigned int crossovers[] = {1, 2, 5, 16};
+    static const unsigned int ns[] = {2, 3, 7, 16, 33, 64, 101};
+    mat47_t *a, *b, *c;
+    mat47_workspace_t *ws;
+
+    cr_assert_eq(mat47_get_strassen_crossover(), MAT47_STRASSEN_DEFAULT_CROSSOVER);
+    for (size_t x = 0; x < sizeof_arr(crossovers); x++) {
+        mat47_set_strassen_crossover(crossovers[x]);
+        cr_assert_eq(mat47_get_strassen_crossover(), crossovers[x]);
+
+        for (size_t s = 0; s < sizeof_arr(ns); s++) {
+            a = new_filled(ns[s], ns[s], 0);
+            b = new_filled(ns[s], ns[s], 1);
+
+            create_matrix(c, mat47_mul, a, b);
+            assert_product(c, a, b);
+            mat47_mul_into(c, b, a, NULL);
+            assert_product(c, b, a);
+            // Twice, reusing the workspace
+            cr_assert_not_null(ws = mat47_workspace_new(ns[s]));
+            mat47_mul_into(c, a, b, ws);
+            assert_product(c, a, b);
+            mat47_mul_into(c, b, a, ws);
+            cr_assert_eq(mat47_errno, 0);
+            assert_product(c, b, a);
+            mat47_workspace_del(ws);
+
+            mat47_del(a); mat47_del(b); mat47_del(c);
+        }
+    }
+
+    mat47_set_strassen_crossover(0);
+    cr_assert_eq(mat47_get_strassen_crossover(), MAT47_STRASSEN_DEFAULT_CROSSOVER);
+}
@@ -0,0 +1,208 @@
+#include <math.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/broadcast.c"
+
+
+#define create_matrix(m, mat47_f, ...) \
+    mat47_errno = 0; \
+    m = mat47_f(__VA_ARGS__); \
+\
+    cr_assert_eq( \
+        mat47_errno, 0, "Error creating matrix: (%s)", mat47_strerror(mat47_errno) \
+    ); \
+    cr_assert_not_null(m, "`" #m "` is null")
+
+#define assert_error(errnum, expr) \
+    mat47_errno = 0; \
+    expr; \
+    cr_assert_eq( \
+        mat47_errno, errnum, \
+        "%u (%s) was raised", mat47_errno, mat47_strerror(mat47_errno) \
+    )
+
+/* Returns a new matrix with the elements `i * n_cols + j + 1` */
+static mat47_t *new_seq(unsigned int n_rows, unsigned int n_cols)
+{
+    mat47_t *m;
+
+    create_matrix(m, mat47__new, n_rows, n_cols, false);
+    for (unsigned int i = 0; i < n_rows; i++)
+        for (unsigned int j = 0; j < n_cols; j++) m->data[i][j] = i * n_cols + j + 1;
+
+    return m;
+}
+
+
+/* bcast_row, bcast_col */
+
+Test(bcast, errors)
+{
+    mat47_t *m, *row, *col;
+
+    m = new_seq(3, 4);
+    row = new_seq(1, 4);
+    col = new_seq(3, 1);
+    assert_error(MAT47_ERR_NULL_PTR, mat47_bcast_row(NULL, MAT47_BCAST_ADD, row));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_bcast_row(m, MAT47_BCAST_ADD, NULL));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_bcast_col(NULL, MAT47_BCAST_ADD, col));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_bcast_col(m, MAT47_BCAST_ADD, NULL));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_bcast_row(m, 0, row));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_bcast_col(m, MAT47_BCAST_DIV + 1, col));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_bcast_row(m, MAT47_BCAST_ADD, col));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_bcast_col(m, MAT47_BCAST_ADD, row));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_bcast_row(m, MAT47_BCAST_ADD, m));
+
+    // Unchanged
+    for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int j = 0; j < 4; j++)
+            cr_assert_eq(m->data[i][j], i * 4 + j + 1);
+    mat47_del(m); mat47_del(row); mat47_del(col);
+}
+
+Test(bcast, ops)
+{
+    enum mat47_bcast_op ops[] = {
+        MAT47_BCAST_ADD, MAT47_BCAST_SUB, MAT47_BCAST_MUL, MAT47_BCAST_DIV
+    };
+    unsigned int n_rows = 7, n_cols = 13;
+    double x, v, expected;
+    mat47_t *m, *row, *col;
+
+    row = new_seq(1, n_cols);
+    col = new_seq(n_rows, 1);
+    for (size_t k = 0; k < sizeof_arr(ops); k++) {
+        for (int by_row = 0; by_row < 2; by_row++) {
+            m = new_seq(n_rows, n_cols);
+            if (by_row)
+                mat47_bcast_row(m, ops[k], row);
+            else
+                mat47_bcast_col(m, ops[k], col);
+            cr_assert_eq(mat47_errno, 0);
+
+            for (unsigned int i = 0; i < n_rows; i++)
+                for (unsigned int j = 0; j < n_cols; j++) {
+                    x = i * n_cols + j + 1;
+                    v = (by_row ? j : i) + 1;
+                    expected = (
+                        ops[k] == MAT47_BCAST_ADD ? x + v
+                        : ops[k] == MAT47_BCAST_SUB ? x - v
+                        : ops[k] == MAT47_BCAST_MUL ? x * v
+                        : x / v
+                    );
+                    cr_assert_eq(
+                        m->data[i][j], expected, "op=%d, by_row=%d, [%u][%u]",
+                        ops[k], by_row, i, j
+                    );
+                }
+            mat47_del(m);
+        }
+    }
+    mat47_del(row); mat47_del(col);
+}
+
+Test(bcast, large)
+{
+    // Large enough to be split across threads
+    unsigned int n_rows = 1200, n_cols = 1000;
+    mat47_t *m, *row;
+
+    m = new_seq(n_rows, n_cols);
+    create_matrix(row, mat47_zero, 1, n_cols);
+    for (unsigned int j = 0; j < n_cols; j++) row->data[0][j] = j + 1;
+
+    mat47_bcast_row(m, MAT47_BCAST_SUB, row);
+    for (unsigned int i = 0; i < n_rows; i++)
+        for (unsigned int j = 0; j < n_cols; j++)
+            cr_assert_eq(m->data[i][j], (double)i * n_cols);
+    mat47_del(m); mat47_del(row);
+}
+
+
+Test(bcast, aliased)
+{
+    double *saved;
+    mat47_t *m, *row;
+
+    // Self-broadcasts
+    m = new_seq(1, 13);
+    mat47_bcast_row(m, MAT47_BCAST_MUL, m);
+    for (unsigned int j = 0; j < 13; j++)
+        cr_assert_eq(m->data[0][j], (j + 1.0) * (j + 1));
+    mat47_del(m);
+    m = new_seq(11, 1);
+    mat47_bcast_col(m, MAT47_BCAST_MUL, m);
+    for (unsigned int i = 0; i < 11; i++)
+        cr_assert_eq(m->data[i][0], (i + 1.0) * (i + 1));
+    mat47_del(m);
+
+    // A row vector sharing storage with a row of `m`, which is updated before those
+    // after it
+    m = new_seq(3, 4);
+    row = new_seq(1, 4);
+    saved = row->data[0];
+    row->data[0] = m->data[1];
+    mat47_errno = 0;
+    mat47_bcast_row(m, MAT47_BCAST_SUB, row);
+    cr_assert_eq(mat47_errno, 0);
+    row->data[0] = saved;
+    for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int j = 0; j < 4; j++)
+            cr_assert_eq(m->data[i][j], (i * 4.0 + j + 1) - (4.0 + j + 1));
+    mat47_del(m); mat47_del(row);
+}
+
+/* standardize */
+
+Test(standardize, errors)
+{
+    mat47_t *m, *means = (mat47_t *)1, *stds = (mat47_t *)1;
+
+    m = new_seq(3, 2);
+    assert_error(MAT47_ERR_NULL_PTR, mat47_standardize(NULL, 0, &means, &stds));
+    cr_assert_null(means);
+    cr_assert_null(stds);
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_standardize(m, 3, NULL, NULL));
+    cr_assert_eq(m->data[2][1], 6, "Should be unchanged");
+    mat47_del(m);
+}
+
+Test(standardize, standardize)
+{
+    unsigned int n_rows = 1500, n_cols = 900;
+    double sum, sum_sq, x;
+    mat47_t *m, *orig, *means, *stds;
+
+    create_matrix(m, mat47__new, n_rows, n_cols, false);
+    for (unsigned int i = 0; i < n_rows; i++)
+        for (unsigned int j = 0; j < n_cols; j++)
+            m->data[i][j] = (j == 3 ? 42 : j + (j + 1) * sin(i * 7.0 + j * 3.0));
+    create_matrix(orig, mat47_copy, m);
+
+    mat47_standardize(m, 1, &means, &stds);
+    cr_assert_eq(mat47_errno, 0);
+    cr_assert_not_null(means);
+    cr_assert_not_null(stds);
+    cr_assert_eq(means->data[0][3], 42);
+    cr_assert_eq(stds->data[0][3], 0);
+
+    for (unsigned int j = 0; j < n_cols; j++) {
+        sum = sum_sq = 0;
+        for (unsigned int i = 0; i < n_rows; i++) {
+            sum += m->data[i][j];
+            sum_sq += m->data[i][j] * m->data[i][j];
+        }
+        cr_assert_float_eq(sum / n_rows, 0, 1e-9, "column %u", j);
+        cr_assert_float_eq(
+            sum_sq / (n_rows - 1), (j == 3 ? 0 : 1), 1e-9, "column %u", j
+        );
+
+        // Reversible
+        for (unsigned int i = 0; i < n_rows; i++) {
+            x = m->data[i][j] * stds->data[0][j] + means->data[0][j];
+            cr_assert_float_eq(x, orig->data[i][j], 1e-9 * (j + 1), "column %u", j);
+        }
+    }
+    mat47_del(m); mat47_del(orig); mat47_del(means); mat47_del(stds);
+}
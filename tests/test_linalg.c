@@ -0,0 +1,1189 @@
+#include <math.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/linalg.c"
+#include "../src/mat47/parallel.h"
+
+#include "helpers.h"
+
+
+/* Returns the largest absolute element of `a * x - b` */
+static double max_residual(const mat47_t *a, const mat47_t *x, const mat47_t *b)
+{
+    unsigned int i, j, k;
+    double sum, res = 0;
+
+    for (i = 0; i < a->n_rows; i++)
+        for (k = 0; k < b->n_cols; k++) {
+            for (sum = -b->data[i][k], j = 0; j < a->n_cols; j++)
+                sum += a->data[i][j] * x->data[j][k];
+            imax(res, fabs(sum));
+        }
+
+    return res;
+}
+
+
+/* solve_mixed */
+
+Test(solve_mixed, null_ptr)
+{
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 2, 2);
+    assert_error(MAT47_ERR_NULL_PTR, mat47_solve_mixed(NULL, m, NULL));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_solve_mixed(m, NULL, NULL));
+    mat47_del(m);
+}
+
+Test(solve_mixed, dim_mismatch)
+{
+    mat47_t *a, *b;
+
+    create_matrix(a, mat47_zero, 2, 3);
+    create_matrix(b, mat47_zero, 2, 1);
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_solve_mixed(a, b, NULL));
+    mat47_del(a); mat47_del(b);
+
+    create_matrix(a, mat47_zero, 3, 3);
+    create_matrix(b, mat47_zero, 2, 1);
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_solve_mixed(a, b, NULL));
+    mat47_del(a); mat47_del(b);
+}
+
+Test(solve_mixed, singular)
+{
+    double a[3][3] = {{1, 2, 3}, {2, 4, 6}, {0, 1, 1}}, b[3][1] = {{1}, {2}, {3}};
+    mat47_t *ma, *mb;
+
+    create_matrix(ma, mat47_init, 3, 3, ((double *[3]){a[0], a[1], a[2]}));
+    create_matrix(mb, mat47_init, 3, 1, ((double *[3]){b[0], b[1], b[2]}));
+    assert_error(MAT47_ERR_SINGULAR, mat47_solve_mixed(ma, mb, NULL));
+    mat47_del(ma); mat47_del(mb);
+}
+
+Test(solve_mixed, well_conditioned)
+{
+    unsigned int i, j, n, n_rhs = 3, shift;
+    int iter;
+    mat47_t *a, *b, *x;
+
+    // Single and multiple tiles (of 128), with dominant diagonals or cyclic
+    // superdiagonals, which need row interchanges across tiles
+    for (n = 50; n <= 300; n += 250)
+        for (shift = 0; shift <= 1; shift++) {
+            create_matrix(a, mat47_zero, n, n);
+            create_matrix(b, mat47_zero, n, n_rhs);
+            for (i = 0; i < n; i++) {
+                for (j = 0; j < n; j++) a->data[i][j] = sin(i * 7.0 + j * 3.0);
+                a->data[i][(i + shift) % n] += n;
+                for (j = 0; j < n_rhs; j++) b->data[i][j] = cos(i + j * 0.5) / 3;
+            }
+
+            iter = -100;
+            create_matrix(x, mat47_solve_mixed, a, b, &iter);
+            cr_assert_geq(iter, 0, "Should converge: n=%u, iter=%d", n, iter);
+            cr_assert_eq(x->n_rows, n);
+            cr_assert_eq(x->n_cols, n_rhs);
+            cr_assert_lt(
+                max_residual(a, x, b), 1e-12 * n / 50,
+                "Not accurate to double precision: n=%u", n
+            );
+
+            mat47_del(a); mat47_del(b); mat47_del(x);
+        }
+}
+
+Test(solve_mixed, fallback)
+{
+    unsigned int i, j, n = 10;
+    int iter = 0;
+    mat47_t *a, *b, *x;
+
+    // Hilbert matrix; Condition number ~1e13
+    create_matrix(a, mat47_zero, n, n);
+    create_matrix(b, mat47_zero, n, 1);
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) a->data[i][j] = 1.0 / (i + j + 1);
+        b->data[i][0] = 1;
+    }
+
+    create_matrix(x, mat47_solve_mixed, a, b, &iter);
+    cr_assert_lt(iter, 0, "Should fall back to double precision: iter=%d", iter);
+    cr_assert_lt(max_residual(a, x, b), 1e-6);
+
+    mat47_del(a); mat47_del(b); mat47_del(x);
+}
+
+
+/* Tiled factorizations */
+
+// Sizes exercising partial and multiple tiles (of 128)
+static const unsigned int sizes[] = {1, 2, 7, 128, 129, 300};
+
+// Thread counts exercising the serial and work-stealing schedules
+static const unsigned int threads[] = {1, 4};
+
+/* Returns the largest absolute element of `a - x * y` (or `x * transpose(y)`, if
+ * `trans`), relative to the largest of `a`
+ */
+static double max_error(
+    const mat47_t *a, const mat47_t *x, const mat47_t *y, bool trans
+) {
+    double sum, err = 0, a_max = 0;
+
+    for (unsigned int i = 0; i < a->n_rows; i++)
+        for (unsigned int j = 0; j < a->n_cols; j++) {
+            sum = a->data[i][j];
+            for (unsigned int k = 0; k < x->n_cols; k++)
+                sum -= x->data[i][k] * (trans ? y->data[j][k] : y->data[k][j]);
+            imax(err, fabs(sum));
+            imax(a_max, fabs(a->data[i][j]));
+        }
+
+    return err / a_max;
+}
+
+Test(cholesky, errors)
+{
+    double a[2][2] = {{1, 2}, {2, 1}};
+    mat47_t *m;
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47_cholesky(NULL));
+    create_matrix(m, mat47_zero, 2, 3);
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_cholesky(m));
+    mat47_del(m);
+
+    create_matrix(m, mat47_init, 2, 2, ((double *[2]){a[0], a[1]}));
+    assert_error(MAT47_ERR_NOT_POSDEF, mat47_cholesky(m));
+    mat47_del(m);
+}
+
+Test(cholesky, factorize)
+{
+    mat47_t *a, *b, *l;
+
+    for (size_t t = 0; t < sizeof_arr(threads); t++) {
+        mat47_set_num_threads(threads[t]);
+        for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+            unsigned int n = sizes[s];
+
+            // `b * transpose(b) + n * I`
+            b = new_wave(n, n);
+            create_matrix(a, mat47_zero, n, n);
+            for (unsigned int i = 0; i < n; i++) {
+                for (unsigned int j = 0; j < n; j++)
+                    for (unsigned int k = 0; k < n; k++)
+                        a->data[i][j] += b->data[i][k] * b->data[j][k];
+                a->data[i][i] += n;
+            }
+
+            create_matrix(l, mat47_cholesky, a);
+            for (unsigned int i = 0; i < n; i++)
+                for (unsigned int j = i + 1; j < n; j++) cr_assert_eq(l->data[i][j], 0);
+            cr_assert_lt(max_error(a, l, l, true), 1e-14 * n, "n=%u", n);
+
+            mat47_del(a); mat47_del(b); mat47_del(l);
+        }
+    }
+    mat47_set_num_threads(0);
+}
+
+Test(lu, errors)
+{
+    double a[3][3] = {{1, 2, 3}, {2, 4, 6}, {0, 1, 1}};
+    unsigned int piv[3];
+    mat47_t *m;
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47_lu(NULL, piv));
+    create_matrix(m, mat47_zero, 3, 2);
+    assert_error(MAT47_ERR_NULL_PTR, mat47_lu(m, NULL));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_lu(m, piv));
+    mat47_del(m);
+
+    create_matrix(m, mat47_init, 3, 3, ((double *[3]){a[0], a[1], a[2]}));
+    assert_error(MAT47_ERR_SINGULAR, mat47_lu(m, piv));
+    mat47_del(m);
+}
+
+Test(lu, factorize)
+{
+    mat47_t *a, *f, *l, *u;
+    unsigned int *piv;
+    double tmp;
+
+    for (size_t t = 0; t < sizeof_arr(threads); t++) {
+        mat47_set_num_threads(threads[t]);
+        for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+            unsigned int n = sizes[s];
+
+            a = new_wave(n, n);
+            piv = malloc(sizeof(unsigned int) * n);
+            create_matrix(f, mat47_lu, a, piv);
+
+            create_matrix(l, mat47_zero, n, n);
+            create_matrix(u, mat47_zero, n, n);
+            for (unsigned int i = 0; i < n; i++) {
+                for (unsigned int j = 0; j < n; j++)
+                    if (j < i) l->data[i][j] = f->data[i][j];
+                    else u->data[i][j] = f->data[i][j];
+                l->data[i][i] = 1;
+                // Partial pivoting bounds the multipliers
+                for (unsigned int j = 0; j < i; j++)
+                    cr_assert_leq(fabs(l->data[i][j]), 1);
+            }
+            // `p * a`
+            for (unsigned int i = 0; i < n; i++) {
+                cr_assert_geq(piv[i], i);
+                cr_assert_lt(piv[i], n);
+                for (unsigned int j = 0; j < n; j++) {
+                    tmp = a->data[i][j];
+                    a->data[i][j] = a->data[piv[i]][j];
+                    a->data[piv[i]][j] = tmp;
+                }
+            }
+            cr_assert_lt(max_error(a, l, u, false), 1e-14 * n, "n=%u", n);
+
+            free(piv);
+            mat47_del(a); mat47_del(f); mat47_del(l); mat47_del(u);
+        }
+    }
+    mat47_set_num_threads(0);
+}
+
+Test(qr, errors)
+{
+    mat47_t *m, *r = (mat47_t *)1;
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47_qr(NULL, &r));
+    create_matrix(m, mat47_zero, 2, 3);
+    assert_error(MAT47_ERR_NULL_PTR, mat47_qr(m, NULL));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_qr(m, &r));
+    cr_assert_null(r);
+    mat47_del(m);
+}
+
+Test(qr, factorize)
+{
+    // Including tall matrices, with more rows of tiles than columns
+    static const unsigned int shapes[][2] = {
+        {1, 1}, {5, 3}, {7, 7}, {128, 128}, {300, 129}, {260, 260}, {400, 100}
+    };
+    mat47_t *a, *q, *r, *qt_q, *id;
+
+    for (size_t t = 0; t < sizeof_arr(threads); t++) {
+        mat47_set_num_threads(threads[t]);
+        for (size_t s = 0; s < sizeof_arr(shapes); s++) {
+            unsigned int m = shapes[s][0], n = shapes[s][1];
+
+            a = new_wave(m, n);
+            create_matrix(q, mat47_qr, a, &r);
+            cr_assert_eq(q->n_rows, m);
+            cr_assert_eq(q->n_cols, n);
+            cr_assert_eq(r->n_rows, n);
+            cr_assert_eq(r->n_cols, n);
+            for (unsigned int i = 0; i < n; i++)
+                for (unsigned int j = 0; j < i; j++) cr_assert_eq(r->data[i][j], 0);
+            cr_assert_lt(max_error(a, q, r, false), 1e-14 * m, "%ux%u", m, n);
+
+            // Orthonormal columns
+            create_matrix(qt_q, mat47_zero, n, n);
+            create_matrix(id, mat47_zero, n, n);
+            for (unsigned int i = 0; i < n; i++) {
+                id->data[i][i] = 1;
+                for (unsigned int j = 0; j < n; j++)
+                    for (unsigned int k = 0; k < m; k++)
+                        qt_q->data[i][j] += q->data[k][i] * q->data[k][j];
+            }
+            for (unsigned int i = 0; i < n; i++)
+                for (unsigned int j = 0; j < n; j++)
+                    cr_assert_float_eq(qt_q->data[i][j], id->data[i][j], 1e-13 * m);
+
+            mat47_del(a); mat47_del(q); mat47_del(r); mat47_del(qt_q); mat47_del(id);
+        }
+    }
+    mat47_set_num_threads(0);
+}
+
+
+/* eigsh */
+
+/* Returns a new symmetric matrix with eigenvalues `values` and eigenvectors the
+ * columns of the Q factor of a wave
+ */
+static mat47_t *new_spectrum(unsigned int n, const double *values)
+{
+    mat47_t *wave = new_wave(n, n), *q, *r, *a;
+
+    create_matrix(q, mat47_qr, wave, &r);
+    create_matrix(a, mat47_zero, n, n);
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int j = 0; j < n; j++)
+            for (unsigned int k = 0; k < n; k++)
+                a->data[i][j] += q->data[i][k] * values[k] * q->data[j][k];
+    mat47_del(wave); mat47_del(q); mat47_del(r);
+
+    return a;
+}
+
+/* Asserts that the columns of `vecs` are orthonormal eigenvectors of `a`, with
+ * eigenvalues `values`
+ */
+static void assert_eigenpairs(
+    const mat47_t *a, const mat47_t *values, const mat47_t *vecs
+) {
+    unsigned int n = a->n_rows, k = values->n_rows;
+    unsigned int i;
+    double sum;
+
+    cr_assert_eq(values->n_cols, 1);
+    cr_assert_eq(vecs->n_rows, n);
+    cr_assert_eq(vecs->n_cols, k);
+    for (unsigned int c = 0; c < k; c++) {
+        for (i = 0; i < n; i++) {
+            sum = -values->data[c][0] * vecs->data[i][c];
+            for (unsigned int j = 0; j < n; j++)
+                sum += a->data[i][j] * vecs->data[j][c];
+            cr_assert_float_eq(sum, 0, 1e-9, "Residual of pair %u", c);
+        }
+        for (unsigned int d = 0; d < k; d++) {
+            for (sum = 0, i = 0; i < n; i++) sum += vecs->data[i][c] * vecs->data[i][d];
+            cr_assert_float_eq(sum, c == d, 1e-10, "Dot product of %u and %u", c, d);
+        }
+    }
+}
+
+Test(eigsh, errors)
+{
+    mat47_t *m, *vecs = (mat47_t *)1;
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47_eigsh(NULL, 1, MAT47_EIGSH_LARGEST, &vecs));
+    cr_assert_null(vecs);
+    create_matrix(m, mat47_zero, 2, 3);
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_eigsh(m, 1, MAT47_EIGSH_LARGEST, NULL));
+    mat47_del(m);
+
+    create_matrix(m, mat47_zero, 3, 3);
+    assert_error(MAT47_ERR_ZERO_SIZE, mat47_eigsh(m, 0, MAT47_EIGSH_LARGEST, NULL));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_eigsh(m, 4, MAT47_EIGSH_LARGEST, NULL));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_eigsh(m, 1, 3, NULL));
+    mat47_del(m);
+
+    assert_error(
+        MAT47_ERR_NULL_PTR, mat47_eigsh_fn(3, NULL, NULL, 1, MAT47_EIGSH_LARGEST, NULL)
+    );
+    assert_error(
+        MAT47_ERR_ZERO_SIZE,
+        mat47_eigsh_fn(0, (mat47_matvec_fn *)1, NULL, 1, MAT47_EIGSH_LARGEST, NULL)
+    );
+}
+
+Test(eigsh, dense)
+{
+    static const struct {
+        enum mat47_eigsh_which which;
+        double expected[6];
+    } cases[] = {
+        {MAT47_EIGSH_LARGEST, {149.75, 148.75, 147.75, 146.75, 145.75, 144.75}},
+        {MAT47_EIGSH_SMALLEST, {-149.25, -148.25, -147.25, -146.25, -145.25, -144.25}},
+        {
+            MAT47_EIGSH_LARGEST_MAGNITUDE,
+            {149.75, -149.25, 148.75, -148.25, 147.75, -147.25}
+        }
+    };
+    unsigned int n = 300, k = 6;
+    double spectrum[300];
+    mat47_t *a, *values, *vecs;
+
+    for (unsigned int i = 0; i < n; i++) spectrum[i] = i - 149.25;
+    a = new_spectrum(n, spectrum);
+    for (size_t c = 0; c < sizeof_arr(cases); c++) {
+        create_matrix(values, mat47_eigsh, a, k, cases[c].which, &vecs);
+        cr_assert_not_null(vecs);
+        for (unsigned int i = 0; i < k; i++)
+            cr_assert_float_eq(
+                values->data[i][0], cases[c].expected[i], 1e-9, "%zu: %u", c, i
+            );
+        assert_eigenpairs(a, values, vecs);
+        mat47_del(values); mat47_del(vecs);
+    }
+    mat47_del(a);
+}
+
+Test(eigsh, small)
+{
+    double spectrum[] = {3, -1, 2, 0, 5}, sorted[5], tmp;
+    mat47_t *a, *values, *vecs;
+
+    // The basis spans the whole space
+    for (unsigned int n = 1; n <= sizeof_arr(spectrum); n++) {
+        for (unsigned int i = 0; i < n; i++) sorted[i] = spectrum[i];
+        for (unsigned int i = 1; i < n; i++)
+            for (unsigned int j = i; j && sorted[j] > sorted[j - 1]; j--)
+                tmp = sorted[j], sorted[j] = sorted[j - 1], sorted[j - 1] = tmp;
+
+        a = new_spectrum(n, spectrum);
+        create_matrix(values, mat47_eigsh, a, n, MAT47_EIGSH_LARGEST, &vecs);
+        for (unsigned int i = 0; i < n; i++)
+            cr_assert_float_eq(values->data[i][0], sorted[i], 1e-12, "n=%u", n);
+        assert_eigenpairs(a, values, vecs);
+        mat47_del(a); mat47_del(values); mat47_del(vecs);
+    }
+
+    // Zero matrix: Every Krylov space is invariant
+    create_matrix(a, mat47_zero, 50, 50);
+    create_matrix(values, mat47_eigsh, a, 3, MAT47_EIGSH_SMALLEST, &vecs);
+    for (unsigned int i = 0; i < 3; i++) cr_assert_eq(values->data[i][0], 0);
+    assert_eigenpairs(a, values, vecs);
+    mat47_del(a); mat47_del(values); mat47_del(vecs);
+}
+
+// `y = l * x`, with `l` the second-difference matrix (`2` on the diagonal, `-1` on
+// the off-diagonals)
+static void laplacian(double *restrict y, const double *restrict x, void *arg)
+{
+    unsigned int n = *(unsigned int *)arg;
+
+    for (unsigned int i = 0; i < n; i++)
+        y[i] = 2 * x[i] - (i ? x[i - 1] : 0) - (i + 1 < n ? x[i + 1] : 0);
+}
+
+Test(eigsh, matrix_free)
+{
+    unsigned int n = 100;
+    double pi = acos(-1);
+    mat47_t *values, *vecs, *l;
+
+    create_matrix(l, mat47_zero, n, n);
+    for (unsigned int i = 0; i < n; i++) {
+        l->data[i][i] = 2;
+        if (i) l->data[i][i - 1] = l->data[i - 1][i] = -1;
+    }
+
+    // Including a single pair, kept with more vectors over restarts
+    for (unsigned int k = 1; k <= 4; k += 3) {
+        create_matrix(
+            values, mat47_eigsh_fn, n, laplacian, &n, k, MAT47_EIGSH_LARGEST, &vecs
+        );
+        for (unsigned int i = 0; i < k; i++)
+            cr_assert_float_eq(
+                values->data[i][0], 2 - 2 * cos(pi * (n - i) / (n + 1)), 1e-10
+            );
+        assert_eigenpairs(l, values, vecs);
+        mat47_del(values); mat47_del(vecs);
+    }
+    mat47_del(l);
+}
+
+
+// Asserts that the columns of `m` (or its rows, if `rows`) are orthonormal
+static void assert_orthonormal(const mat47_t *m, bool rows)
+{
+    unsigned int n = rows ? m->n_cols : m->n_rows, k = rows ? m->n_rows : m->n_cols;
+    double sum;
+
+    for (unsigned int c = 0; c < k; c++)
+        for (unsigned int d = 0; d < k; d++) {
+            sum = 0;
+            for (unsigned int i = 0; i < n; i++)
+                sum += rows
+                    ? m->data[c][i] * m->data[d][i] : m->data[i][c] * m->data[i][d];
+            cr_assert_float_eq(sum, c == d, 1e-10, "Dot product of %u and %u", c, d);
+        }
+}
+
+// Asserts that `a * transpose(vt) = u * diag(s)` i.e the singular triplets of `a`
+static void assert_triplets(
+    const mat47_t *a, const mat47_t *s, const mat47_t *u, const mat47_t *vt
+) {
+    double sum;
+
+    for (unsigned int c = 0; c < s->n_rows; c++)
+        for (unsigned int i = 0; i < a->n_rows; i++) {
+            sum = -s->data[c][0] * u->data[i][c];
+            for (unsigned int j = 0; j < a->n_cols; j++)
+                sum += a->data[i][j] * vt->data[c][j];
+            cr_assert_float_eq(sum, 0, 1e-9, "Residual of triplet %u", c);
+        }
+}
+
+Test(rsvd, errors)
+{
+    mat47_t *m, *u = (mat47_t *)1, *vt = (mat47_t *)1;
+
+    create_matrix(m, mat47_zero, 4, 3);
+    assert_error(MAT47_ERR_NULL_PTR, mat47_rsvd(NULL, 1, 0, 0, &u, &vt));
+    cr_assert_null(u);
+    cr_assert_null(vt);
+    assert_error(MAT47_ERR_ZERO_SIZE, mat47_rsvd(m, 0, 0, 0, NULL, NULL));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_rsvd(m, 4, 0, 0, NULL, NULL));
+    mat47_del(m);
+}
+
+Test(rsvd, low_rank)
+{
+    unsigned int n_rows = 120, n_cols = 80, rank = 6, k = 4;
+    double values[] = {10, 8, 5, 3, 2, 1};
+    mat47_t *wave, *left, *right, *r, *a, *s, *u, *vt;
+
+    // `left * diag(values) * transpose(right)`, with orthonormal columns
+    wave = new_wave(n_rows, rank);
+    create_matrix(left, mat47_qr, wave, &r);
+    mat47_del(wave); mat47_del(r);
+    wave = new_wave(n_cols, rank);
+    for (unsigned int i = 0; i < n_cols; i++) wave->data[i][0] += 1;
+    create_matrix(right, mat47_qr, wave, &r);
+    mat47_del(wave); mat47_del(r);
+    create_matrix(a, mat47_zero, n_rows, n_cols);
+    for (unsigned int i = 0; i < n_rows; i++)
+        for (unsigned int j = 0; j < n_cols; j++)
+            for (unsigned int c = 0; c < rank; c++)
+                a->data[i][j] += left->data[i][c] * values[c] * right->data[j][c];
+
+    // The range is captured exactly, with enough oversampling
+    for (unsigned int power_iters = 0; power_iters <= 2; power_iters += 2) {
+        create_matrix(s, mat47_rsvd, a, k, rank - k, power_iters, &u, &vt);
+        cr_assert_eq(s->n_rows, k);
+        cr_assert_eq(s->n_cols, 1);
+        cr_assert_eq(u->n_rows, n_rows);
+        cr_assert_eq(u->n_cols, k);
+        cr_assert_eq(vt->n_rows, k);
+        cr_assert_eq(vt->n_cols, n_cols);
+        for (unsigned int c = 0; c < k; c++)
+            cr_assert_float_eq(s->data[c][0], values[c], 1e-10);
+        assert_orthonormal(u, false);
+        assert_orthonormal(vt, true);
+        assert_triplets(a, s, u, vt);
+        mat47_del(s); mat47_del(u); mat47_del(vt);
+    }
+
+    // Optional factors; Zero singular values
+    create_matrix(s, mat47_rsvd, a, 8, 100, 1, NULL, &vt);
+    for (unsigned int c = 0; c < rank; c++)
+        cr_assert_float_eq(s->data[c][0], values[c], 1e-10);
+    for (unsigned int c = rank; c < 8; c++) {
+        cr_assert_float_eq(s->data[c][0], 0, 1e-10);
+        for (unsigned int j = 0; j < n_cols; j++) cr_assert_eq(vt->data[c][j], 0);
+    }
+    mat47_del(s); mat47_del(vt);
+
+    mat47_del(left); mat47_del(right); mat47_del(a);
+}
+
+Test(rsvd, full_rank)
+{
+    unsigned int n = 30;
+    mat47_t *a, *s, *u, *vt;
+
+    // All the singular triplets
+    a = new_wave(n + 10, n);
+    for (unsigned int i = 0; i < n; i++) a->data[i][i] += 2;
+    create_matrix(s, mat47_rsvd, a, n, 0, 0, &u, &vt);
+    for (unsigned int c = 1; c < n; c++)
+        cr_assert_geq(s->data[c - 1][0], s->data[c][0]);
+    assert_orthonormal(u, false);
+    assert_orthonormal(vt, true);
+    assert_triplets(a, s, u, vt);
+    mat47_del(a); mat47_del(s); mat47_del(u); mat47_del(vt);
+}
+
+
+// Asserts that `a` and `b` differ by at most `tol` times the largest element of `b`
+static void assert_close(const mat47_t *a, const mat47_t *b, double tol)
+{
+    double scale = 0;
+
+    cr_assert_eq(a->n_rows, b->n_rows);
+    cr_assert_eq(a->n_cols, b->n_cols);
+    for (unsigned int i = 0; i < b->n_rows; i++)
+        for (unsigned int j = 0; j < b->n_cols; j++)
+            scale = fmax(scale, fabs(b->data[i][j]));
+    for (unsigned int i = 0; i < a->n_rows; i++)
+        for (unsigned int j = 0; j < a->n_cols; j++)
+            cr_assert_float_eq(
+                a->data[i][j], b->data[i][j], tol * scale, "[%u][%u]", i, j
+            );
+}
+
+Test(pow, errors)
+{
+    mat47_t *a, *b, *c;
+    mat47_workspace_t *ws;
+
+    assert_error(MAT47_ERR_ZERO_SIZE, mat47_workspace_new(0));
+    create_matrix(a, mat47_zero, 3, 3);
+    create_matrix(b, mat47_zero, 3, 2);
+    create_matrix(c, mat47_zero, 2, 2);
+    ws = mat47_workspace_new(2);
+    cr_assert_not_null(ws);
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47_pow(NULL, 2));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_pow(b, 2));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_expm(NULL));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_expm(b));
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47_pow_into(NULL, a, 2, NULL));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47_pow_into(c, a, 2, NULL));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47_pow_into(a, a, 2, ws));
+    assert_void_error(MAT47_ERR_INVALID_ARG, mat47_pow_into(c, c, 2, ws));
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47_expm_into(a, NULL, NULL));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47_expm_into(b, b, NULL));
+    assert_void_error(MAT47_ERR_INVALID_ARG, mat47_expm_into(c, c, ws));
+
+    // Non-finite elements
+    a->data[1][2] = NAN;
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_expm(a));
+    a->data[1][2] = INFINITY;
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_expm(a));
+
+    // A success leaves an earlier error untouched
+    mat47_errno = MAT47_ERR_ALLOC;
+    mat47_del(mat47_pow(c, 3));
+    mat47_del(mat47_expm(c));
+    cr_assert_eq(mat47_errno, MAT47_ERR_ALLOC);
+
+    mat47_del(a); mat47_del(b); mat47_del(c);
+    mat47_workspace_del(ws);
+    mat47_workspace_del(NULL);
+}
+
+Test(pow, powers)
+{
+    unsigned int n = 150, crossovers[] = {0, 40};
+    mat47_t *a, *p, *expected, *next;
+    mat47_workspace_t *ws;
+
+    // Scaled for powers to stay around unity
+    a = new_wave(n, n);
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int j = 0; j < n; j++) a->data[i][j] /= 0.5 * n;
+    create_matrix(p, mat47_zero, n, n);
+    ws = mat47_workspace_new(n);
+    cr_assert_not_null(ws);
+
+    // Including Strassen-Winograd products, reusing the workspace across crossovers
+    for (size_t x = 0; x < sizeof_arr(crossovers); x++) {
+        mat47_set_strassen_crossover(crossovers[x]);
+        create_matrix(expected, mat47_zero, n, n);
+        for (unsigned int i = 0; i < n; i++) expected->data[i][i] = 1;
+        for (unsigned int k = 0; k <= 13; k++) {
+            mat47_errno = 0;
+            mat47_pow_into(p, a, k, ws);
+            cr_assert_eq(mat47_errno, 0);
+            assert_close(p, expected, 1e-12);
+
+            create_matrix(next, mat47_mul, expected, a);
+            mat47_del(expected);
+            expected = next;
+        }
+        mat47_del(expected);
+    }
+    mat47_set_strassen_crossover(0);
+
+    // Without a workspace
+    create_matrix(expected, mat47_pow, a, 37);
+    mat47_pow_into(p, a, 37, NULL);
+    assert_close(p, expected, 0);
+    mat47_del(expected);
+
+    mat47_del(a); mat47_del(p);
+    mat47_workspace_del(ws);
+}
+
+Test(expm, closed_form)
+{
+    double t, d[] = {-3, 0, 0.5, 2};
+    mat47_t *a, *e;
+
+    // Rotations, over all the approximants and with scaling
+    create_matrix(a, mat47_zero, 2, 2);
+    for (t = 1e-3; t < 100; t *= 3) {
+        a->data[0][1] = -t;
+        a->data[1][0] = t;
+        create_matrix(e, mat47_expm, a);
+        cr_assert_float_eq(e->data[0][0], cos(t), 1e-13, "t=%g", t);
+        cr_assert_float_eq(e->data[0][1], -sin(t), 1e-13, "t=%g", t);
+        cr_assert_float_eq(e->data[1][0], sin(t), 1e-13, "t=%g", t);
+        cr_assert_float_eq(e->data[1][1], cos(t), 1e-13, "t=%g", t);
+        mat47_del(e);
+    }
+    mat47_del(a);
+
+    // Diagonal matrices
+    create_matrix(a, mat47_zero, 4, 4);
+    for (unsigned int i = 0; i < 4; i++) a->data[i][i] = d[i];
+    create_matrix(e, mat47_expm, a);
+    for (unsigned int i = 0; i < 4; i++)
+        for (unsigned int j = 0; j < 4; j++)
+            cr_assert_float_eq(e->data[i][j], i == j ? exp(d[i]) : 0, 1e-14 * exp(2));
+    mat47_del(a); mat47_del(e);
+
+    // The zero matrix
+    create_matrix(a, mat47_zero, 3, 3);
+    create_matrix(e, mat47_expm, a);
+    for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int j = 0; j < 3; j++) cr_assert_eq(e->data[i][j], i == j);
+    mat47_del(a); mat47_del(e);
+}
+
+Test(expm, inverse)
+{
+    unsigned int n = 300;
+    double scales[] = {1e-4, 0.1, 1, 5};
+    mat47_t *a, *minus_a, *e, *e_minus, *id, *product;
+    mat47_workspace_t *ws;
+
+    // `exp(a) * exp(-a) = I`, with more rows than a tile, reusing the workspace
+    a = new_wave(n, n);
+    create_matrix(minus_a, mat47_zero, n, n);
+    create_matrix(e, mat47_zero, n, n);
+    create_matrix(e_minus, mat47_zero, n, n);
+    create_matrix(id, mat47_zero, n, n);
+    for (unsigned int i = 0; i < n; i++) id->data[i][i] = 1;
+    ws = mat47_workspace_new(n);
+    cr_assert_not_null(ws);
+    for (size_t x = 0; x < sizeof_arr(scales); x++) {
+        for (unsigned int i = 0; i < n; i++)
+            for (unsigned int j = 0; j < n; j++) {
+                a->data[i][j] = sin(i * 7.0 + j * 3.0 + 1) * scales[x] / n;
+                minus_a->data[i][j] = -a->data[i][j];
+            }
+        mat47_errno = 0;
+        mat47_expm_into(e, a, ws);
+        mat47_expm_into(e_minus, minus_a, ws);
+        cr_assert_eq(mat47_errno, 0);
+
+        create_matrix(product, mat47_mul, e, e_minus);
+        assert_close(product, id, 1e-12);
+        mat47_del(product);
+    }
+
+    mat47_del(a); mat47_del(minus_a); mat47_del(e); mat47_del(e_minus); mat47_del(id);
+    mat47_workspace_del(ws);
+}
+
+
+// `b * transpose(b) + n * I`, for `b = new_wave(n, n)`
+static mat47_t *new_posdef(unsigned int n)
+{
+    mat47_t *a, *b = new_wave(n, n);
+
+    create_matrix(a, mat47_zero, n, n);
+    for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = 0; j < n; j++)
+            for (unsigned int k = 0; k < n; k++)
+                a->data[i][j] += b->data[i][k] * b->data[j][k];
+        a->data[i][i] += n;
+    }
+    mat47_del(b);
+
+    return a;
+}
+
+Test(cholesky_update, errors)
+{
+    mat47_t *l, *x, *rect;
+
+    create_matrix(l, mat47_zero, 3, 3);
+    create_matrix(x, mat47_zero, 3, 1);
+    create_matrix(rect, mat47_zero, 3, 2);
+
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47_cholesky_update(NULL, x));
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47_cholesky_downdate(l, NULL));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47_cholesky_update(rect, x));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47_cholesky_downdate(l, rect));
+    assert_void_error(MAT47_ERR_NOT_POSDEF, mat47_cholesky_update(l, x));
+
+    // `I - x * transpose(x)` is singular; `l` is left unchanged
+    for (unsigned int i = 0; i < 3; i++) l->data[i][i] = 1;
+    x->data[1][0] = 1;
+    assert_void_error(MAT47_ERR_NOT_POSDEF, mat47_cholesky_downdate(l, x));
+    for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int j = 0; j < 3; j++) cr_assert_eq(l->data[i][j], i == j);
+
+    mat47_del(l); mat47_del(x); mat47_del(rect);
+}
+
+Test(cholesky_update, update_downdate)
+{
+    unsigned int sizes[] = {1, 2, 7, 129};
+    mat47_t *a, *l, *l0, *col, *row, *expected;
+
+    for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+        unsigned int n = sizes[s];
+
+        a = new_posdef(n);
+        create_matrix(l, mat47_cholesky, a);
+        create_matrix(l0, mat47_copy, l);
+        create_matrix(col, mat47_zero, n, 1);
+        create_matrix(row, mat47_zero, 1, n);
+        for (unsigned int i = 0; i < n; i++)
+            row->data[0][i] = col->data[i][0] = 3 * cos(i * 2.0);
+
+        mat47_errno = 0;
+        mat47_cholesky_update(l, col);
+        cr_assert_eq(mat47_errno, 0);
+        for (unsigned int i = 0; i < n; i++)
+            for (unsigned int j = 0; j < n; j++)
+                a->data[i][j] += col->data[i][0] * col->data[j][0];
+        create_matrix(expected, mat47_cholesky, a);
+        assert_close(l, expected, 1e-13);
+        for (unsigned int i = 0; i < n; i++)
+            for (unsigned int j = i + 1; j < n; j++) cr_assert_eq(l->data[i][j], 0);
+
+        // Back to the initial factor
+        mat47_cholesky_downdate(l, row);
+        cr_assert_eq(mat47_errno, 0);
+        assert_close(l, l0, 1e-12);
+
+        mat47_del(a); mat47_del(l); mat47_del(l0); mat47_del(col); mat47_del(row);
+        mat47_del(expected);
+    }
+}
+
+// The inverse of `a`, by solving for the columns of the identity
+static mat47_t *inverse(const mat47_t *a)
+{
+    mat47_t *id, *inv;
+
+    create_matrix(id, mat47_zero, a->n_rows, a->n_rows);
+    for (unsigned int i = 0; i < a->n_rows; i++) id->data[i][i] = 1;
+    create_matrix(inv, mat47_solve_mixed, a, id, NULL);
+    mat47_del(id);
+
+    return inv;
+}
+
+Test(inv_update, errors)
+{
+    mat47_t *inv, *u, *v, *rect;
+
+    create_matrix(inv, mat47_zero, 3, 3);
+    create_matrix(u, mat47_zero, 3, 1);
+    create_matrix(v, mat47_zero, 3, 1);
+    create_matrix(rect, mat47_zero, 3, 2);
+
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47_inv_update(inv, NULL, v, NULL));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47_inv_update(rect, u, v, NULL));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47_inv_update(inv, u, rect, NULL));
+
+    // `I - e_1 * transpose(e_1)` is singular; `inv` is left unchanged
+    for (unsigned int i = 0; i < 3; i++) inv->data[i][i] = 1;
+    u->data[1][0] = 1;
+    v->data[1][0] = -1;
+    assert_void_error(MAT47_ERR_SINGULAR, mat47_inv_update(inv, u, v, NULL));
+    for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int j = 0; j < 3; j++) cr_assert_eq(inv->data[i][j], i == j);
+
+    mat47_del(inv); mat47_del(u); mat47_del(v); mat47_del(rect);
+}
+
+Test(inv_update, woodbury)
+{
+    unsigned int n = 150, ranks[] = {1, 4, 4};
+    mat47_t *a, *inv, *u, *v, *expected;
+    mat47_workspace_t *ws, *wrong;
+
+    create_matrix(ws, mat47_workspace_new, n);
+    create_matrix(wrong, mat47_workspace_new, n + 1);
+    for (size_t r = 0; r < sizeof_arr(ranks); r++) {
+        unsigned int k = ranks[r];
+
+        a = new_wave(n, n);
+        for (unsigned int i = 0; i < n; i++) a->data[i][i] += n;
+        inv = inverse(a);
+        create_matrix(u, mat47_zero, n, k);
+        create_matrix(v, mat47_zero, n, k);
+        for (unsigned int i = 0; i < n; i++)
+            for (unsigned int j = 0; j < k; j++) {
+                u->data[i][j] = cos(i * 5.0 + j);
+                v->data[i][j] = sin(i + j * 2.0) * 3;
+            }
+
+        assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47_inv_update(inv, u, v, wrong));
+        // A workspace from the second update on, reused by the third
+        mat47_errno = 0;
+        mat47_inv_update(inv, u, v, r ? ws : NULL);
+        cr_assert_eq(mat47_errno, 0);
+
+        for (unsigned int i = 0; i < n; i++)
+            for (unsigned int j = 0; j < n; j++)
+                for (unsigned int l = 0; l < k; l++)
+                    a->data[i][j] += u->data[i][l] * v->data[j][l];
+        expected = inverse(a);
+        assert_close(inv, expected, 1e-12);
+
+        mat47_del(a); mat47_del(inv); mat47_del(u); mat47_del(v);
+        mat47_del(expected);
+    }
+    mat47_workspace_del(ws); mat47_workspace_del(wrong);
+}
+
+Test(inv_update, row_change)
+{
+    unsigned int n = 40, changed = 17;
+    mat47_t *a, *inv, *u, *v, *expected;
+
+    // Row `changed` of `a` replaced with `r`: `u = e_changed` and `v = r - a[changed]`
+    a = new_wave(n, n);
+    for (unsigned int i = 0; i < n; i++) a->data[i][i] += n;
+    inv = inverse(a);
+    create_matrix(u, mat47_zero, n, 1);
+    create_matrix(v, mat47_zero, n, 1);
+    u->data[changed][0] = 1;
+    for (unsigned int j = 0; j < n; j++) {
+        double r = (j == changed) * 2.0 * n + cos(j);
+
+        v->data[j][0] = r - a->data[changed][j];
+        a->data[changed][j] = r;
+    }
+
+    mat47_errno = 0;
+    mat47_inv_update(inv, u, v, NULL);
+    cr_assert_eq(mat47_errno, 0);
+    expected = inverse(a);
+    assert_close(inv, expected, 1e-12);
+
+    mat47_del(a); mat47_del(inv); mat47_del(u); mat47_del(v); mat47_del(expected);
+}
+
+
+/* solve */
+
+// Enough for every test
+static const size_t cache_limit_on = (size_t)128 << 20;
+
+// The cached factorization of `a`, if any
+static struct factor *cached(const mat47_t *a)
+{
+    struct factor *e;
+
+    for (e = cache_head; e && e->a != a; e = e->next);
+    cr_assert_eq(find(a), e);
+    return e;
+}
+
+Test(solve, errors)
+{
+    mat47_t *m, *rect, *b;
+
+    create_matrix(m, mat47_zero, 3, 3);
+    create_matrix(rect, mat47_zero, 2, 3);
+    create_matrix(b, mat47_zero, 3, 1);
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47_solve(NULL, b));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_solve(m, NULL));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_solve(rect, b));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_solve(m, rect));
+    assert_error(MAT47_ERR_SINGULAR, mat47_solve(m, b));
+    cr_assert_null(cached(m));
+
+    mat47_del(m); mat47_del(rect); mat47_del(b);
+}
+
+Test(solve, factorize)
+{
+    unsigned int sizes[] = {2, 7, 129}, k = 40;
+    mat47_t *a, *b, *x;
+
+    mat47_set_solve_cache_limit(cache_limit_on);
+    for (size_t t = 0; t < sizeof_arr(threads); t++) {
+        mat47_set_num_threads(threads[t]);
+        for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+            unsigned int n = sizes[s];
+
+            b = new_wave(n, k);
+            for (int kind = 0; kind < 3; kind++) {
+                if (kind == 0) {  // Positive definite
+                    a = new_posdef(n);
+                } else if (kind == 1) {  // Indefinite, with a positive diagonal
+                    a = new_posdef(n);
+                    a->data[0][1] = a->data[1][0] = 2 * (a->data[0][0] + a->data[1][1]);
+                } else {  // Not symmetric
+                    a = new_wave(n, n);
+                    for (unsigned int i = 0; i < n; i++) a->data[i][i] += n;
+                }
+
+                create_matrix(x, mat47_solve, a, b);
+                cr_assert_not_null(cached(a));
+                cr_assert_eq(!cached(a)->piv, kind == 0, "kind %d", kind);
+                cr_assert_lt(max_residual(a, x, b), 1e-10, "kind %d, n=%u", kind, n);
+                mat47_del(x);
+
+                // Cached
+                create_matrix(x, mat47_solve, a, b);
+                cr_assert_lt(max_residual(a, x, b), 1e-10, "kind %d, n=%u", kind, n);
+                mat47_del(x);
+                mat47_del(a);
+            }
+            mat47_del(b);
+        }
+    }
+    mat47_set_num_threads(0);
+    mat47_set_solve_cache_limit(MAT47_SOLVE_CACHE_DEFAULT_LIMIT);
+}
+
+Test(solve, versions)
+{
+    unsigned int n = 50;
+    mat47_t *a = new_wave(n, n), *b = new_wave(n, 2), *c = new_wave(3, 3), *x, *y;
+    uint64_t version;
+
+    mat47_set_solve_cache_limit(cache_limit_on);
+    for (unsigned int i = 0; i < n; i++) a->data[i][i] += n;
+    create_matrix(x, mat47_solve, a, b);
+    cr_assert_eq(cached(a)->version, a->version);
+
+    // Unrecorded modifications aren't seen
+    a->data[3][4] += 10;
+    create_matrix(y, mat47_solve, a, b);
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int j = 0; j < 2; j++) cr_assert_eq(y->data[i][j], x->data[i][j]);
+    mat47_del(y);
+    a->version++;
+    create_matrix(y, mat47_solve, a, b);
+    cr_assert_lt(max_residual(a, y, b), 1e-12);
+    mat47_del(y);
+
+    // Modifying functions
+    version = a->version;
+    mat47_set_elem(a, 5, 9, 20);
+    cr_assert_gt(a->version, version);
+    create_matrix(y, mat47_solve, a, b);
+    cr_assert_lt(max_residual(a, y, b), 1e-12);
+    mat47_del(y);
+
+    version = a->version;
+    mat47_set_submat(a, 10, 20, 12, 22, c);
+    cr_assert_gt(a->version, version);
+    create_matrix(y, mat47_solve, a, b);
+    cr_assert_lt(max_residual(a, y, b), 1e-12);
+    mat47_del(y);
+
+    version = a->version;
+    mat47_set_at(a, 1, 2, 3);
+    mat47_zero_into(c);
+    mat47_set_submat(a, 1, 1, 3, 3, c);
+    cr_assert_eq(a->version, version + 2);
+
+    // Failed modifications don't count
+    version = a->version;
+    mat47_set_elem(a, n + 1, 1, 0);
+    mat47_set_submat(a, 1, 1, 2, 2, c);
+    cr_assert_eq(a->version, version);
+
+    // Deallocated matrices are dropped
+    mat47_del(a);
+    cr_assert_null(cached(a));
+    mat47_del(b); mat47_del(c); mat47_del(x);
+    mat47_set_solve_cache_limit(MAT47_SOLVE_CACHE_DEFAULT_LIMIT);
+}
+
+Test(solve, eviction)
+{
+    unsigned int n = 20;
+    size_t size;
+    mat47_t *a[3], *b = new_wave(n, 1), *x;
+
+    for (int i = 0; i < 3; i++) {
+        a[i] = new_wave(n, n);
+        for (unsigned int j = 0; j < n; j++) a[i]->data[j][j] += n + i;
+    }
+
+    // Room for two factorizations
+    mat47_set_solve_cache_limit(cache_limit_on);
+    create_matrix(x, mat47_solve, a[0], b);
+    mat47_del(x);
+    size = cached(a[0])->size;
+    mat47_set_solve_cache_limit(2 * size);
+    cr_assert_eq(mat47_get_solve_cache_limit(), 2 * size);
+
+    create_matrix(x, mat47_solve, a[1], b);
+    mat47_del(x);
+    create_matrix(x, mat47_solve, a[2], b);
+    mat47_del(x);
+    cr_assert_null(cached(a[0]));
+    cr_assert_not_null(cached(a[1]));
+    cr_assert_not_null(cached(a[2]));
+
+    // The least recently used is evicted
+    create_matrix(x, mat47_solve, a[1], b);
+    mat47_del(x);
+    create_matrix(x, mat47_solve, a[0], b);
+    cr_assert_lt(max_residual(a[0], x, b), 1e-12);
+    mat47_del(x);
+    cr_assert_not_null(cached(a[0]));
+    cr_assert_not_null(cached(a[1]));
+    cr_assert_null(cached(a[2]));
+    cr_assert_eq(cache_head->a, a[0]);
+
+    // Too large to be cached
+    mat47_set_solve_cache_limit(size - 1);
+    cr_assert_null(cache_head);
+    create_matrix(x, mat47_solve, a[2], b);
+    cr_assert_lt(max_residual(a[2], x, b), 1e-12);
+    mat47_del(x);
+    cr_assert_null(cache_head);
+    cr_assert_eq(cache_size, 0);
+
+    mat47_set_solve_cache_limit(MAT47_SOLVE_CACHE_DEFAULT_LIMIT);
+    for (int i = 0; i < 3; i++) mat47_del(a[i]);
+    mat47_del(b);
+}
+
+Test(solve, disabled)
+{
+    unsigned int n = 30;
+    mat47_t *a = new_wave(n, n), *b = new_wave(n, 1), *x;
+
+    for (unsigned int i = 0; i < n; i++) a->data[i][i] += n;
+    cr_assert_eq(mat47_get_solve_cache_limit(), 0);
+
+    create_matrix(x, mat47_solve, a, b);
+    cr_assert_lt(max_residual(a, x, b), 1e-12);
+    cr_assert_null(cache_head);
+    // Solved for in place
+    cr_assert_not_null(x->block);
+    mat47_del(x);
+
+    // Modifications are seen without a new version
+    a->data[3][4] += 10;
+    create_matrix(x, mat47_solve, a, b);
+    cr_assert_lt(max_residual(a, x, b), 1e-12);
+    mat47_del(x);
+
+    mat47_del(a); mat47_del(b);
+}
+
+Test(solve, many)
+{
+    // More than one per bucket
+    unsigned int n = 3, count = 4 * CACHE_BUCKETS;
+    mat47_t *a[4 * CACHE_BUCKETS], *b = new_wave(n, 2), *x;
+
+    mat47_set_solve_cache_limit(cache_limit_on);
+    for (unsigned int i = 0; i < count; i++) {
+        a[i] = new_wave(n, n);
+        for (unsigned int j = 0; j < n; j++) a[i]->data[j][j] += n + i;
+        create_matrix(x, mat47_solve, a[i], b);
+        mat47_del(x);
+    }
+    cr_assert_eq(n_cached, count);
+    for (unsigned int i = 0; i < count; i++) {
+        cr_assert_not_null(cached(a[i]), "i=%u", i);
+        create_matrix(x, mat47_solve, a[i], b);
+        cr_assert_lt(max_residual(a[i], x, b), 1e-12, "i=%u", i);
+        mat47_del(x);
+    }
+
+    // Dropped from their bucket when deallocated, in any order
+    for (unsigned int i = 0; i < count; i += 2) mat47_del(a[i]);
+    for (unsigned int i = 1; i < count; i += 2) {
+        cr_assert_not_null(cached(a[i]), "i=%u", i);
+        mat47_del(a[i]);
+    }
+    cr_assert_eq(n_cached, 0);
+    for (unsigned int i = 0; i < CACHE_BUCKETS; i++) cr_assert_null(buckets[i]);
+    mat47_del(b);
+    mat47_set_solve_cache_limit(MAT47_SOLVE_CACHE_DEFAULT_LIMIT);
+}
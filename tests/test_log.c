@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <criterion/criterion.h>
+
+#define MAT47_LOG_DEBUG
+#define MAT47_LOG_ERROR
+#include "../src/mat47/log.c"
+
+
+static char output[1 << 16];
+
+// Flushes pending logs into `output`
+static void flush(void)
+{
+    size_t n;
+
+    MAT47_LOG_FILE = tmpfile();
+    cr_assert_not_null(MAT47_LOG_FILE);
+    mat47_log_flush();
+    rewind(MAT47_LOG_FILE);
+    n = fread(output, 1, sizeof(output) - 1, MAT47_LOG_FILE);
+    output[n] = '\0';
+    fclose(MAT47_LOG_FILE);
+    MAT47_LOG_FILE = NULL;
+}
+
+static unsigned int count(const char *str)
+{
+    unsigned int n = 0;
+    const char *p = output;
+
+    while ((p = strstr(p, str))) n++, p++;
+
+    return n;
+}
+
+
+Test(log, deferred)
+{
+    debug("first %d", 1);
+    mat47_errno = MAT47_ERR_ALLOC;
+    error(" second");
+    flush();
+
+    cr_assert_not_null(strstr(output, "[DEBUG] first 1\n"), "%s", output);
+    cr_assert_not_null(strstr(output, "[ERROR] "), "%s", output);
+    cr_assert_not_null(strstr(output, mat47_strerror(MAT47_ERR_ALLOC)), "%s", output);
+    cr_assert_lt(strstr(output, "first"), strstr(output, "second"));
+    cr_assert_eq(output[0], '(');
+
+    // Already written
+    flush();
+    cr_assert_eq(output[0], '\0', "%s", output);
+}
+
+Test(log, level)
+{
+    cr_assert_eq(mat47_log_get_level(), MAT47_LOG_LEVEL_DEBUG);
+
+    mat47_log_set_level(MAT47_LOG_LEVEL_ERROR);
+    cr_assert_eq(mat47_log_get_level(), MAT47_LOG_LEVEL_ERROR);
+    debug("hidden");
+    error("shown");
+
+    mat47_log_set_level(MAT47_LOG_LEVEL_NONE);
+    debug("hidden");
+    error("hidden");
+
+    mat47_log_set_level(MAT47_LOG_LEVEL_DEBUG);
+    flush();
+
+    cr_assert_eq(count("hidden"), 0, "%s", output);
+    cr_assert_eq(count("shown"), 1, "%s", output);
+}
+
+Test(log, dropped)
+{
+    unsigned int i;
+
+    for (i = 0; i < RING_SIZE + 10; i++) debug("%u", i);
+    flush();
+
+    cr_assert_eq(count("[DEBUG]"), RING_SIZE);
+    cr_assert_not_null(strstr(output, " 10 log(s) dropped"), "%s", output);
+
+    debug("after");
+    flush();
+    cr_assert_eq(count("[DEBUG]"), 1);
+}
+
+Test(log, truncated)
+{
+    char long_str[MSG_SIZE * 2];
+
+    memset(long_str, 'x', sizeof(long_str) - 1);
+    long_str[sizeof(long_str) - 1] = '\0';
+    debug("%s", long_str);
+    flush();
+
+    cr_assert_eq(count("\n"), 1);
+    cr_assert_lt(strlen(output), (size_t)MSG_SIZE + 32);
+}
+
+Test(log, formats)
+{
+    char str[8] = "kept", expected[MSG_SIZE];
+
+#define FORMAT "%d %u %zu %jd %hhd %5.2f %g %#x %-5s| %.*s %c %% %p"
+#define ARGS \
+    -3, 7U, (size_t)9, (intmax_t)-4, 300, 3.14159, 1e-3, 255, str, 2, "xyz", 'q', \
+    (void *)str
+    snprintf(expected, sizeof(expected), "[DEBUG] " FORMAT "\n", ARGS);
+    // Formatted when flushed, with the arguments as they were
+    debug(FORMAT, ARGS);
+#undef FORMAT
+#undef ARGS
+    strcpy(str, "gone");
+    // Formatted right away
+    debug("%Lf", 1.5L);
+    flush();
+
+    cr_assert_not_null(strstr(output, expected), "%s", output);
+    cr_assert_not_null(strstr(output, "[DEBUG] 1.500000\n"), "%s", output);
+}
+
+static void *log_from_thread(void *arg)
+{
+    debug("from thread %d", *(int *)arg);
+
+    return NULL;
+}
+
+Test(log, threads)
+{
+    pthread_t threads[4];
+    int ids[4] = {0, 1, 2, 3}, i;
+    struct ring *before;
+
+    // Rings of threads still running (e.g those of the async pool) remain
+    debug("before");
+    flush();
+    before = rings;
+    for (i = 0; i < 4; i++)
+        cr_assert_eq(pthread_create(&threads[i], NULL, log_from_thread, &ids[i]), 0);
+    for (i = 0; i < 4; i++) pthread_join(threads[i], NULL);
+    flush();
+
+    cr_assert_eq(count("from thread"), 4, "%s", output);
+    // The rings of exited threads are freed
+    cr_assert_eq(rings, before);
+}
+
+Test(log, flusher)
+{
+    MAT47_LOG_FILE = tmpfile();
+    cr_assert_not_null(MAT47_LOG_FILE);
+
+    mat47_log_start_flusher(1);
+    mat47_log_start_flusher(1);  // Already running
+    cr_assert(flusher.running);
+    debug("background");
+    mat47_log_stop_flusher();
+    cr_assert_not(flusher.running);
+
+    rewind(MAT47_LOG_FILE);
+    output[fread(output, 1, sizeof(output) - 1, MAT47_LOG_FILE)] = '\0';
+    fclose(MAT47_LOG_FILE);
+    MAT47_LOG_FILE = NULL;
+
+    cr_assert_eq(count("background"), 1, "%s", output);
+}
@@ -1,9 +1,12 @@
 #include <limits.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <unistd.h>
 
 #include <criterion/criterion.h>
 
 #include "../src/mat47/matrix.c"
-#include "../src/mat47/utils.c"
+#include "../src/mat47/parallel.h"
 
 
 #define create_matrix(m, mat47_f, ...) \
@@ -39,21 +42,21 @@
 Test(new, zero_size)
 {
     mat47_errno = 0;
-    cr_assert_null(mat47_new(0, 1, false), "Zero `n_rows` is invalid");
+    cr_assert_null(mat47__new(0, 1, false), "Zero `n_rows` is invalid");
     cr_assert_eq(
         mat47_errno, MAT47_ERR_ZERO_SIZE,
         "%u (%s) was raised", mat47_errno, mat47_strerror(mat47_errno)
     );
 
     mat47_errno = 0;
-    cr_assert_null(mat47_new(1, 0, false), "Zero `n_cols` is invalid");
+    cr_assert_null(mat47__new(1, 0, false), "Zero `n_cols` is invalid");
     cr_assert_eq(
         mat47_errno, MAT47_ERR_ZERO_SIZE,
         "%u (%s) was raised", mat47_errno, mat47_strerror(mat47_errno)
     );
 
     mat47_errno = 0;
-    cr_assert_null(mat47_new(1, 0, false), "Zero `n_cols` and `n_rows` is invalid");
+    cr_assert_null(mat47__new(1, 0, false), "Zero `n_cols` and `n_rows` is invalid");
     cr_assert_eq(
         mat47_errno, MAT47_ERR_ZERO_SIZE,
         "%u (%s) was raised", mat47_errno, mat47_strerror(mat47_errno)
@@ -68,7 +71,7 @@ Test(new, uninitialized)
     for (r = 1; r <= 10; r++)
         for (c = 1; c <= 10; c++) {
             mat47_errno = 0;
-            m = mat47_new(r, c, false);
+            m = mat47__new(r, c, false);
 
             cr_assert_eq(
                 mat47_errno, 0,
@@ -98,7 +101,7 @@ Test(new, zeroed)
     for (r = 1; r <= 10; r++)
         for (c = 1; c <= 10; c++) {
             mat47_errno = 0;
-            m = mat47_new(r, c, true);
+            m = mat47__new(r, c, true);
 
             cr_assert_eq(
                 mat47_errno, 0,
@@ -179,6 +182,174 @@ TestInit(double)
 
 #undef TestInit
 
+#define TestInitLarge(T) \
+Test(init, large_##T) \
+{ \
+    unsigned int i, j, n_rows = 300, n_cols = 2011; \
+    T **array = malloc(sizeof(T *) * n_rows); \
+    mat47_t *m; \
+\
+    for (i = 0; i < n_rows; i++) { \
+        array[i] = malloc(sizeof(T) * n_cols); \
+        for (j = 0; j < n_cols; j++) array[i][j] = (T)(i * 7 + j * 3); \
+    } \
+\
+    mat47_set_num_threads(4); \
+    create_matrix(m, mat47_init, n_rows, n_cols, array); \
+    mat47_set_num_threads(0); \
+\
+    for (i = 0; i < n_rows; i++) \
+        for (j = 0; j < n_cols; j++) \
+            cr_assert_eq( \
+                m->data[i][j], (double)array[i][j], \
+                "`m = %f`, `a = %f`; i=%u, j=%u", \
+                m->data[i][j], (double)array[i][j], i, j \
+            ); \
+\
+    for (i = 0; i < n_rows; i++) free(array[i]); \
+    free(array); \
+    mat47_del(m); \
+}
+
+TestInitLarge(int8_t)
+TestInitLarge(int32_t)
+TestInitLarge(uint8_t)
+TestInitLarge(uint64_t)
+TestInitLarge(float)
+TestInitLarge(double)
+
+#undef TestInitLarge
+
+/* init_flat */
+
+Test(init_flat, errors)
+{
+    double a[4] = {0};
+
+    mat47_errno = 0;
+    cr_assert_null(mat47_init_double_flat(2, 2, NULL, 2), "Null `buf` is invalid");
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+
+    mat47_errno = 0;
+    cr_assert_null(mat47_init_double_flat(2, 2, a, 1), "`ld` < `n_cols` is invalid");
+    cr_assert_eq(mat47_errno, MAT47_ERR_INVALID_ARG);
+
+    mat47_errno = 0;
+    cr_assert_null(mat47_init_double_flat(0, 2, a, 2), "Zero `n_rows` is invalid");
+    cr_assert_eq(mat47_errno, MAT47_ERR_ZERO_SIZE);
+}
+
+Test(init_flat, init_flat)
+{
+    unsigned int i, j, ld;
+    double a[12] = {-128, -1, 7, 8, 0, 1, 9, 10, 2, 127, 11, 12};
+    mat47_t *m;
+
+    for (ld = 2; ld <= 4; ld += 2) {
+        create_matrix(m, mat47_init_double_flat, 3, 2, a, ld);
+
+        cr_assert_not_null(m->block, "Elements should be contiguous");
+        for (i = 0; i < 3; i++)
+            for (j = 0; j < 2; j++)
+                cr_assert_eq(
+                    m->data[i][j], a[i * ld + j],
+                    "ld=%u: `m = %f`, `a = %f`; i=%u, j=%u",
+                    ld, m->data[i][j], a[i * ld + j], i, j
+                );
+
+        mat47_del(m);
+    }
+}
+
+/* adopt */
+
+static unsigned int n_freed;
+
+static void count_free(void *p)
+{
+    n_freed++;
+    free(p);
+}
+
+Test(adopt, errors)
+{
+    double a[4] = {0};
+
+    mat47_errno = 0;
+    cr_assert_null(mat47_adopt(2, 2, NULL, NULL), "Null `buf` is invalid");
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+
+    mat47_errno = 0;
+    cr_assert_null(mat47_adopt(2, 0, a, NULL), "Zero `n_cols` is invalid");
+    cr_assert_eq(mat47_errno, MAT47_ERR_ZERO_SIZE);
+}
+
+Test(adopt, owned)
+{
+    unsigned int i, j;
+    double *buf = malloc(sizeof(double) * 6);
+    mat47_t *m;
+
+    for (i = 0; i < 6; i++) buf[i] = i;
+    create_matrix(m, mat47_adopt, 2, 3, buf, count_free);
+
+    for (i = 0; i < 2; i++)
+        for (j = 0; j < 3; j++)
+            cr_assert_eq(
+                &m->data[i][j], &buf[i * 3 + j], "Elements should not be copied"
+            );
+
+    n_freed = 0;
+    mat47_del(m);
+    cr_assert_eq(n_freed, 1, "Buffer should be deallocated with the given function");
+}
+
+Test(adopt, borrowed)
+{
+    double buf[6] = {0};
+    mat47_t *m;
+
+    create_matrix(m, mat47_adopt, 3, 2, buf, NULL);
+    mat47_set_elem(m, 3, 2, 47);
+    cr_assert_eq(buf[5], 47);
+    mat47_del(m);
+}
+
+/* release */
+
+Test(release, errors)
+{
+    mat47_t *m;
+
+    mat47_errno = 0;
+    cr_assert_null(mat47_release(NULL));
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+
+    create_matrix(m, mat47_zero, 2, 2);
+    mat47_errno = 0;
+    cr_assert_null(mat47_release(m), "Separately allocated rows can't be released");
+    cr_assert_eq(mat47_errno, MAT47_ERR_INVALID_ARG);
+    mat47_del(m);
+}
+
+Test(release, release)
+{
+    double *buf = malloc(sizeof(double) * 4), flat[4] = {1, 2, 3, 4};
+    mat47_t *m;
+
+    create_matrix(m, mat47_adopt, 2, 2, buf, count_free);
+    n_freed = 0;
+    cr_assert_eq(mat47_release(m), buf);
+    cr_assert_eq(n_freed, 0, "Released buffer should not be deallocated");
+    free(buf);
+
+    create_matrix(m, mat47_init_double_flat, 2, 2, flat, 2);
+    buf = mat47_release(m);
+    cr_assert_not_null(buf);
+    cr_assert_eq(buf[3], 4);
+    free(buf);
+}
+
 /* copy */
 
 Test(copy, null_matrix_ptr)
@@ -325,6 +496,123 @@ Test(elem, set)
     mat47_del(m);
 }
 
+Test(elem, unchecked)
+{
+    unsigned int i, j;
+    double a[3][2] = {{-128, -1}, {0, 1}, {2, 127}};
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 3, 2);
+
+    for (i = 1; i <= 3; i++) {
+        for (j = 1; j <= 2; j++) {
+            mat47_set_at(m, i, j, a[i-1][j-1]);
+            cr_assert_eq(m->data[i-1][j-1], a[i-1][j-1], "i=%u, j=%u", i, j);
+            cr_assert_eq(mat47_at(m, i, j), a[i-1][j-1], "i=%u, j=%u", i, j);
+        }
+        cr_assert_eq(mat47_row_ptr(m, i), m->data[i-1], "i=%u", i);
+    }
+
+    mat47_del(m);
+}
+
+Test(elem, checked_row_ptr)
+{
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 3, 2);
+
+    mat47_errno = 0;
+    cr_assert_null(mat47__row_ptr(NULL, 1));
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+
+    mat47_errno = 0;
+    cr_assert_null(mat47__row_ptr(m, 4));
+    cr_assert_eq(mat47_errno, MAT47_ERR_INDEX_OUT_OF_RANGE);
+
+    cr_assert_eq(mat47__row_ptr(m, 3), m->data[2]);
+
+    mat47_del(m);
+}
+
+/* row/col */
+
+Test(row_col, errors)
+{
+    double buf[3];
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 3, 2);
+
+    assert_null_martix_ptr(no, mat47_get_row, 1, buf);
+    assert_null_martix_ptr(no, mat47_set_row, 1, buf);
+    assert_null_martix_ptr(no, mat47_get_col, 1, buf);
+    assert_null_martix_ptr(no, mat47_set_col, 1, buf);
+    assert_null_ptr(buf, no, mat47_get_row, m, 1, NULL);
+    assert_null_ptr(buf, no, mat47_set_col, m, 1, NULL);
+
+    mat47_errno = 0;
+    mat47_get_row(m, 4, buf);
+    cr_assert_eq(mat47_errno, MAT47_ERR_INDEX_OUT_OF_RANGE);
+    mat47_errno = 0;
+    mat47_set_row(m, 0, buf);
+    cr_assert_eq(mat47_errno, MAT47_ERR_INDEX_OUT_OF_RANGE);
+    mat47_errno = 0;
+    mat47_get_col(m, 3, buf);
+    cr_assert_eq(mat47_errno, MAT47_ERR_INDEX_OUT_OF_RANGE);
+    mat47_errno = 0;
+    mat47_set_col(m, 0, buf);
+    cr_assert_eq(mat47_errno, MAT47_ERR_INDEX_OUT_OF_RANGE);
+
+    mat47_del(m);
+}
+
+Test(row_col, row)
+{
+    unsigned int i, j;
+    double buf[2];
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 3, 2);
+
+    for (i = 1; i <= 3; i++) {
+        buf[0] = i; buf[1] = -(double)i;
+        mat47_set_row(m, i, buf);
+    }
+    for (i = 1; i <= 3; i++) {
+        mat47_get_row(m, i, buf);
+        for (j = 0; j < 2; j++) {
+            cr_assert_eq(m->data[i-1][j], j ? -(double)i : i, "i=%u, j=%u", i, j);
+            cr_assert_eq(buf[j], m->data[i-1][j], "i=%u, j=%u", i, j);
+        }
+    }
+
+    mat47_del(m);
+}
+
+Test(row_col, col)
+{
+    unsigned int i, j;
+    double buf[3];
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 3, 2);
+
+    for (j = 1; j <= 2; j++) {
+        buf[0] = j; buf[1] = 10 * j; buf[2] = 100 * j;
+        mat47_set_col(m, j, buf);
+    }
+    for (j = 1; j <= 2; j++) {
+        mat47_get_col(m, j, buf);
+        for (i = 0; i < 3; i++) {
+            cr_assert_eq(m->data[i][j-1], pow(10, i) * j, "i=%u, j=%u", i, j);
+            cr_assert_eq(buf[i], m->data[i][j-1], "i=%u, j=%u", i, j);
+        }
+    }
+
+    mat47_del(m);
+}
+
 /* submat */
 
 #define assert_get_submat_null_ret assert_null_ret_yes
@@ -543,3 +831,292 @@ Test(submat, set)
         mat47_del(m);
     }
 }
+
+/* into */
+
+Test(into, errors)
+{
+    double a[2][2] = {{1, 2}, {3, 4}}, flat[4] = {1, 2, 3, 4};
+    mat47_t *m, *dst;
+
+    create_matrix(m, mat47_init, 2, 2, ((double *[2]){a[0], a[1]}));
+    create_matrix(dst, mat47_zero, 2, 3);
+
+    assert_null_ptr(dst, no, mat47_copy_into, NULL, m);
+    assert_null_ptr(m, no, mat47_copy_into, dst, NULL);
+    assert_null_ptr(dst, no, mat47_zero_into, NULL);
+    assert_null_ptr(dst, no, mat47_init_into, NULL, ((double *[2]){a[0], a[1]}));
+    assert_null_ptr(dst, no, mat47_init_double_flat_into, NULL, flat, 2);
+    assert_null_ptr(dst, no, mat47_get_submat_into, NULL, m, 1, 1, 2, 2);
+
+    mat47_errno = 0;
+    mat47_copy_into(dst, m);
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+
+    mat47_errno = 0;
+    mat47_get_submat_into(dst, m, 1, 1, 2, 2);
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+
+    mat47_errno = 0;
+    mat47_get_submat_into(dst, m, 1, 1, 3, 2);
+    cr_assert_eq(mat47_errno, MAT47_ERR_INDEX_OUT_OF_RANGE);
+
+    mat47_errno = 0;
+    mat47_init_double_flat_into(dst, flat, 2);
+    cr_assert_eq(mat47_errno, MAT47_ERR_INVALID_ARG, "`ld` < `n_cols` is invalid");
+
+    // Left unchanged on failure
+    for (unsigned int i = 0; i < 2; i++)
+        for (unsigned int j = 0; j < 3; j++)
+            cr_assert_eq(dst->data[i][j], 0, "dst[%u,%u] = %f", i, j, dst->data[i][j]);
+
+    mat47_del(m); mat47_del(dst);
+}
+
+Test(into, into)
+{
+    unsigned int i, j;
+    int a[3][2] = {{-128, -1}, {0, 1}, {2, 127}};
+    double flat[8] = {1, 2, 0, 0, 3, 4, 0, 0};
+    mat47_t *m, *dst;
+
+    create_matrix(m, mat47__new, 3, 2, false);
+    create_matrix(dst, mat47__new, 3, 2, false);
+
+    mat47_errno = 0;
+    mat47_init_into(m, ((int *[3]){a[0], a[1], a[2]}));
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    for (i = 0; i < 3; i++)
+        for (j = 0; j < 2; j++)
+            cr_assert_eq(m->data[i][j], a[i][j], "m[%u,%u] = %f", i, j, m->data[i][j]);
+
+    mat47_copy_into(dst, m);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    for (i = 0; i < 3; i++)
+        for (j = 0; j < 2; j++)
+            cr_assert_eq(dst->data[i][j], a[i][j], "dst[%u,%u]", i, j);
+    mat47_copy_into(dst, dst);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+
+    mat47_zero_into(dst);
+    for (i = 0; i < 3; i++)
+        for (j = 0; j < 2; j++)
+            cr_assert_eq(dst->data[i][j], 0, "dst[%u,%u]", i, j);
+    mat47_del(dst);
+
+    create_matrix(dst, mat47__new, 2, 1, false);
+    mat47_get_submat_into(dst, m, 2, 2, 3, 2);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    cr_assert_eq(dst->data[0][0], 1);
+    cr_assert_eq(dst->data[1][0], 127);
+    mat47_del(dst);
+
+    create_matrix(dst, mat47__new, 2, 2, false);
+    mat47_init_double_flat_into(dst, flat, 4);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    for (i = 0; i < 2; i++)
+        for (j = 0; j < 2; j++)
+            cr_assert_eq(dst->data[i][j], flat[i * 4 + j], "dst[%u,%u]", i, j);
+
+    mat47_del(m); mat47_del(dst);
+}
+
+/* append_rows, resize, reshape */
+
+// Creates an `n_rows x n_cols` matrix where `m[i][j] = i * n_cols + j`
+static mat47_t *new_iota(unsigned int n_rows, unsigned int n_cols, bool contiguous)
+{
+    double buf[n_rows * n_cols];
+    mat47_t *m;
+
+    for (unsigned int i = 0; i < n_rows * n_cols; i++) buf[i] = i;
+    if (contiguous) return mat47_init_double_flat(n_rows, n_cols, buf, n_cols);
+
+    m = mat47__new(n_rows, n_cols, false);
+    for (unsigned int i = 0; i < n_rows; i++)
+        memcpy(m->data[i], buf + i * n_cols, sizeof(double) * n_cols);
+    return m;
+}
+
+#define assert_contiguous(m) \
+    for (unsigned int i_ = 0; i_ < (m)->n_rows; i_++) \
+        cr_assert_eq((m)->data[i_], (m)->block + (size_t)i_ * (m)->n_cols, "i=%u", i_)
+
+Test(grow, errors)
+{
+    mat47_t *m, *m2;
+
+    create_matrix(m, new_iota, 2, 3, false);
+    create_matrix(m2, mat47_zero, 1, 2);
+
+    assert_null_ptr(m, no, mat47_append_rows, NULL, m2);
+    assert_null_ptr(m2, no, mat47_append_rows, m, NULL);
+    assert_null_martix_ptr(no, mat47_resize, 2, 2);
+    assert_null_martix_ptr(no, mat47_reshape, 2, 2);
+
+    mat47_errno = 0;
+    mat47_append_rows(m, m2);
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+
+    mat47_errno = 0;
+    mat47_resize(m, 0, 3);
+    cr_assert_eq(mat47_errno, MAT47_ERR_ZERO_SIZE);
+
+    mat47_errno = 0;
+    mat47_reshape(m, 4, 2);
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+
+    // Left unchanged
+    cr_assert_eq(m->n_rows, 2);
+    cr_assert_eq(m->n_cols, 3);
+    for (unsigned int i = 0; i < 6; i++) cr_assert_eq(m->data[i / 3][i % 3], i);
+
+    mat47_del(m); mat47_del(m2);
+}
+
+Test(grow, append_rows)
+{
+    unsigned int i, j, n_grows, cap;
+    unsigned int contiguous;
+    mat47_t *m, *batch;
+
+    create_matrix(batch, new_iota, 3, 4, false);
+    for (contiguous = 0; contiguous <= 1; contiguous++) {
+        create_matrix(m, new_iota, 1, 4, contiguous);
+
+        for (n_grows = 0, cap = m->row_cap, i = 0; i < 300; i++) {
+            mat47_append_rows(m, batch);
+            cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+            if (m->row_cap != cap) n_grows++, cap = m->row_cap;
+        }
+        cr_assert_eq(m->n_rows, 901);
+        cr_assert_leq(n_grows, 10, "Room should grow geometrically: %u", n_grows);
+        if (contiguous) assert_contiguous(m);
+
+        for (j = 0; j < 4; j++) cr_assert_eq(m->data[0][j], j);
+        for (i = 1; i < m->n_rows; i++)
+            for (j = 0; j < 4; j++)
+                cr_assert_eq(m->data[i][j], (i - 1) % 3 * 4 + j, "[%u, %u]", i, j);
+
+        mat47_append_rows(m, m);
+        cr_assert_eq(m->n_rows, 1802);
+        for (j = 0; j < 4; j++) cr_assert_eq(m->data[901][j], j);
+        cr_assert_eq(m->data[1801][3], 11);
+
+        mat47_del(m);
+    }
+    mat47_del(batch);
+}
+
+Test(grow, append_rows_borrowed)
+{
+    double buf[4] = {1, 2, 3, 4};
+    mat47_t *m;
+
+    create_matrix(m, mat47_adopt, 2, 2, buf, NULL);
+    mat47_append_rows(m, m);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    assert_contiguous(m);
+
+    mat47_set_elem(m, 1, 1, 47);
+    cr_assert_eq(buf[0], 1, "The borrowed buffer should not be used anymore");
+    cr_assert_eq(m->data[3][1], 4);
+
+    mat47_del(m);
+}
+
+Test(grow, resize)
+{
+    unsigned int n, i, j;
+    unsigned int dims[][2] = {{5, 3}, {5, 6}, {2, 6}, {7, 2}, {1, 1}, {9, 4}};
+    unsigned int contiguous;
+    mat47_t *m;
+
+    for (contiguous = 0; contiguous <= 1; contiguous++) {
+        create_matrix(m, new_iota, 3, 4, contiguous);
+
+        for (n = 0; n < sizeof_arr(dims); n++) {
+            unsigned int n_rows = m->n_rows, n_cols = m->n_cols;
+            double old[n_rows][n_cols];
+
+            for (i = 0; i < n_rows; i++) memcpy(old[i], m->data[i], sizeof(old[i]));
+            mat47_resize(m, dims[n][0], dims[n][1]);
+            cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+            cr_assert_eq(m->n_rows, dims[n][0]);
+            cr_assert_eq(m->n_cols, dims[n][1]);
+            if (contiguous) assert_contiguous(m);
+
+            for (i = 0; i < m->n_rows; i++)
+                for (j = 0; j < m->n_cols; j++)
+                    cr_assert_eq(
+                        m->data[i][j], (i < n_rows && j < n_cols ? old[i][j] : 0),
+                        "%ux%u, contiguous=%u: [%u, %u]",
+                        dims[n][0], dims[n][1], contiguous, i, j
+                    );
+        }
+        mat47_del(m);
+    }
+}
+
+Test(grow, reshape)
+{
+    double *first;
+    mat47_t *m;
+
+    create_matrix(m, new_iota, 4, 6, true);
+    first = m->block;
+    mat47_reshape(m, 8, 3);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    cr_assert_eq(m->block, first, "Contiguous storage should not be copied");
+    assert_contiguous(m);
+    cr_assert_eq(m->data[7][2], 23);
+    mat47_reshape(m, 1, 24);
+    cr_assert_eq(m->data[0][13], 13);
+    mat47_del(m);
+
+    create_matrix(m, new_iota, 4, 6, false);
+    mat47_reshape(m, 3, 8);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    cr_assert_not_null(m->block, "Rows should be gathered into contiguous storage");
+    assert_contiguous(m);
+    for (unsigned int i = 0; i < 24; i++) cr_assert_eq(m->data[i / 8][i % 8], i);
+    mat47_del(m);
+}
+
+// AddressSanitizer aborts on failed allocations, instead of returning null
+#ifndef __SANITIZE_ADDRESS__
+Test(grow, failed_alloc)
+{
+    // Rows of 4 GiB, within a limit of 6 GiB more address space than already used
+    unsigned int n_cols = 1U << 29, contiguous;
+    unsigned long pages;
+    uint64_t version;
+    struct rlimit limit;
+    FILE *statm;
+    mat47_t *m;
+
+    cr_assert_not_null(statm = fopen("/proc/self/statm", "r"));
+    cr_assert_eq(fscanf(statm, "%lu", &pages), 1);
+    fclose(statm);
+    cr_assert_eq(getrlimit(RLIMIT_AS, &limit), 0);
+    limit.rlim_cur = pages * sysconf(_SC_PAGESIZE) + ((rlim_t)6 << 30);
+    cr_assert_eq(setrlimit(RLIMIT_AS, &limit), 0);
+
+    for (contiguous = 0; contiguous <= 1; contiguous++) {
+        create_matrix(m, new_iota, 3, 4, contiguous);
+        version = m->version;
+
+        mat47_resize(m, 3, n_cols);
+        cr_assert_eq(mat47_errno, MAT47_ERR_ALLOC, "contiguous=%u", contiguous);
+        cr_assert_eq(m->version, version, "Failures should not count");
+        cr_assert_eq(m->n_cols, 4);
+        for (unsigned int i = 0; i < 12; i++) cr_assert_eq(m->data[i / 4][i % 4], i);
+
+        mat47_errno = 0;
+        mat47_resize(m, 4, 4);
+        cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+        cr_assert_gt(m->version, version);
+        mat47_del(m);
+    }
+}
+#endif
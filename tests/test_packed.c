@@ -0,0 +1,235 @@
+#include <math.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/packed.c"
+#include "../src/mat47/blas.h"
+
+#include "helpers.h"
+
+
+static const enum mat47p_kind kinds[] = {
+    MAT47P_SYMMETRIC, MAT47P_LOWER, MAT47P_UPPER
+};
+
+// The value of element `(i, j)` of `m` packed as `kind`
+static double expected_elem(
+    const mat47_t *m, enum mat47p_kind kind, unsigned int i, unsigned int j
+)
+{
+    switch (kind) {
+    case MAT47P_SYMMETRIC: return i >= j ? m->data[i][j] : m->data[j][i];
+    case MAT47P_LOWER: return i >= j ? m->data[i][j] : 0;
+    default: return i <= j ? m->data[i][j] : 0;
+    }
+}
+
+// `m` with only the elements of `kind`
+static mat47_t *structured(const mat47_t *m, enum mat47p_kind kind)
+{
+    mat47_t *s;
+
+    create_matrix(s, mat47_zero, m->n_rows, m->n_cols);
+    for (unsigned int i = 0; i < m->n_rows; i++)
+        for (unsigned int j = 0; j < m->n_cols; j++)
+            s->data[i][j] = expected_elem(m, kind, i, j);
+
+    return s;
+}
+
+static void assert_close(const mat47_t *a, const mat47_t *b, double tol)
+{
+    cr_assert_eq(a->n_rows, b->n_rows);
+    cr_assert_eq(a->n_cols, b->n_cols);
+    for (unsigned int i = 0; i < a->n_rows; i++)
+        for (unsigned int j = 0; j < a->n_cols; j++)
+            cr_assert_float_eq(
+                a->data[i][j], b->data[i][j], tol, "[%u][%u]", i, j
+            );
+}
+
+
+Test(packed, errors)
+{
+    mat47_t *m, *v, *rect, *wide;
+    mat47p_t *p, *lower;
+
+    assert_error(MAT47_ERR_ZERO_SIZE, mat47p_zero(0, MAT47P_LOWER));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47p_zero(2, 0));
+    assert_error(MAT47_ERR_NULL_PTR, mat47p_pack(NULL, MAT47P_LOWER));
+    assert_error(MAT47_ERR_NULL_PTR, mat47p_unpack(NULL));
+
+    create_matrix(m, mat47_zero, 3, 3);
+    create_matrix(v, mat47_zero, 3, 1);
+    create_matrix(rect, mat47_zero, 3, 2);
+    create_matrix(wide, mat47_zero, 2, 3);
+    create_matrix(p, mat47p_zero, 3, MAT47P_SYMMETRIC);
+    create_matrix(lower, mat47p_zero, 3, MAT47P_LOWER);
+
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47p_pack(rect, MAT47P_LOWER));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47p_pack(m, MAT47P_UPPER + 1));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47p_pack_into(p, rect));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47p_unpack_into(rect, p));
+
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47p_gemv(v, 1, NULL, v, 0));
+    assert_void_error(MAT47_ERR_INVALID_ARG, mat47p_gemv(v, 1, p, v, 0));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47p_gemv(v, 1, p, rect, 0));
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47p_mul(p, NULL));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47p_mul(p, wide));
+    assert_void_error(MAT47_ERR_INVALID_ARG, mat47p_mul_into(rect, p, rect));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47p_mul_into(m, p, rect));
+
+    assert_void_error(MAT47_ERR_NULL_PTR, mat47p_syrk(NULL, 1, rect, 0));
+    assert_void_error(MAT47_ERR_INVALID_ARG, mat47p_syrk(lower, 1, rect, 0));
+    assert_void_error(MAT47_ERR_DIM_MISMATCH, mat47p_syrk(p, 1, wide, 0));
+
+    mat47_del(m); mat47_del(v); mat47_del(rect); mat47_del(wide);
+    mat47p_del(p); mat47p_del(lower);
+    mat47p_del(NULL);
+}
+
+Test(packed, round_trip)
+{
+    unsigned int n = 9;
+    mat47_t *m = new_wave(n, n), *u, *s;
+    mat47p_t *p;
+
+    for (size_t k = 0; k < sizeof_arr(kinds); k++) {
+        create_matrix(p, mat47p_pack, m, kinds[k]);
+        cr_assert_eq(p->n, n);
+        cr_assert_eq(p->kind, kinds[k]);
+
+        // Row-major layout of the stored triangle
+        for (unsigned int i = 0, e = 0; i < n; i++)
+            for (unsigned int j = 0; j < n; j++)
+                if (kinds[k] == MAT47P_UPPER ? j >= i : j <= i)
+                    cr_assert_eq(p->data[e++], m->data[i][j], "[%u][%u]", i, j);
+
+        create_matrix(u, mat47p_unpack, p);
+        s = structured(m, kinds[k]);
+        assert_close(u, s, 0);
+
+        // Into existing matrices
+        mat47_zero_into(u);
+        mat47p_unpack_into(u, p);
+        assert_close(u, s, 0);
+        memset(p->data, 0, sizeof(double) * n_elems(n));
+        mat47p_pack_into(p, m);
+        mat47p_unpack_into(u, p);
+        assert_close(u, s, 0);
+
+        mat47_del(u); mat47_del(s);
+        mat47p_del(p);
+    }
+    mat47_del(m);
+}
+
+Test(packed, gemv)
+{
+    // Spans two chunks, the last one partial
+    unsigned int n = GEMV_CHUNK + 37;
+    double alpha = 1.5, beta = -0.5, y0[GEMV_CHUNK + 37], sum;
+    mat47_t *m = new_wave(n, n), *x, *y;
+    mat47p_t *p;
+
+    for (size_t k = 0; k < sizeof_arr(kinds); k++) {
+        create_matrix(p, mat47p_pack, m, kinds[k]);
+
+        // Row and column vectors
+        for (int col = 0; col < 2; col++) {
+            create_matrix(x, mat47_zero, col ? n : 1, col ? 1 : n);
+            create_matrix(y, mat47_zero, col ? n : 1, col ? 1 : n);
+            for (unsigned int i = 0; i < n; i++) {
+                *(col ? x->data[i] : x->data[0] + i) = cos(i);
+                *(col ? y->data[i] : y->data[0] + i) = y0[i] = sin(i * 0.5);
+            }
+
+            mat47_errno = 0;
+            mat47p_gemv(y, alpha, p, x, beta);
+            cr_assert_eq(mat47_errno, 0);
+            for (unsigned int i = 0; i < n; i++) {
+                sum = 0;
+                for (unsigned int j = 0; j < n; j++)
+                    sum += expected_elem(m, kinds[k], i, j) * cos(j);
+                cr_assert_float_eq(
+                    col ? y->data[i][0] : y->data[0][i], alpha * sum + beta * y0[i],
+                    1e-12, "kind %d, [%u]", kinds[k], i
+                );
+            }
+            mat47_del(x); mat47_del(y);
+        }
+        mat47p_del(p);
+    }
+    mat47_del(m);
+}
+
+Test(packed, mul)
+{
+    // Spans several blocks, the last one partial
+    unsigned int n = 2 * MAT47P_BLOCK + 22, k = 7;
+    mat47_t *m = new_wave(n, n), *b = new_wave(n, k), *s, *expected, *c;
+    mat47p_t *p;
+
+    for (size_t i = 0; i < sizeof_arr(kinds); i++) {
+        create_matrix(p, mat47p_pack, m, kinds[i]);
+        s = structured(m, kinds[i]);
+        create_matrix(expected, mat47_mul, s, b);
+
+        create_matrix(c, mat47p_mul, p, b);
+        assert_close(c, expected, 1e-10);
+
+        // Overwrites the initial values
+        for (unsigned int r = 0; r < n; r++)
+            for (unsigned int j = 0; j < k; j++) c->data[r][j] = 5;
+        mat47_errno = 0;
+        mat47p_mul_into(c, p, b);
+        cr_assert_eq(mat47_errno, 0);
+        assert_close(c, expected, 1e-10);
+
+        mat47_del(s); mat47_del(expected); mat47_del(c);
+        mat47p_del(p);
+    }
+    mat47_del(m); mat47_del(b);
+}
+
+Test(packed, syrk)
+{
+    unsigned int n = MAT47P_BLOCK + 9, k = 5;
+    double alpha = 2, beta = 0.5;
+    mat47_t *a = new_wave(n, k), *m = new_wave(n, n), *u;
+    mat47p_t *c;
+
+    create_matrix(c, mat47p_pack, m, MAT47P_SYMMETRIC);
+    mat47_errno = 0;
+    mat47p_syrk(c, alpha, a, beta);
+    cr_assert_eq(mat47_errno, 0);
+
+    create_matrix(u, mat47p_unpack, c);
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int j = 0; j < n; j++) {
+            double dot = 0;
+
+            for (unsigned int l = 0; l < k; l++) dot += a->data[i][l] * a->data[j][l];
+            cr_assert_float_eq(
+                u->data[i][j],
+                alpha * dot + beta * expected_elem(m, MAT47P_SYMMETRIC, i, j),
+                1e-12, "[%u][%u]", i, j
+            );
+        }
+
+    // The initial values are ignored
+    for (size_t e = 0; e < n_elems(n); e++) c->data[e] = NAN;
+    mat47p_syrk(c, 1, a, 0);
+    mat47p_unpack_into(u, c);
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int j = 0; j <= i; j++) {
+            double dot = 0;
+
+            for (unsigned int l = 0; l < k; l++) dot += a->data[i][l] * a->data[j][l];
+            cr_assert_float_eq(u->data[i][j], dot, 1e-12, "[%u][%u]", i, j);
+        }
+
+    mat47_del(a); mat47_del(m); mat47_del(u);
+    mat47p_del(c);
+}
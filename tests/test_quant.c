@@ -0,0 +1,273 @@
+#include <math.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/quant.c"
+
+#include "helpers.h"
+
+
+/* init */
+
+Test(init, null_ptr)
+{
+    int8_t a[2] = {1, 2};
+    double scale = 1;
+
+    assert_error(
+        MAT47_ERR_NULL_PTR,
+        mat47q_init(1, 2, (int8_t **)NULL, MAT47Q_PER_TENSOR, &scale)
+    );
+    assert_error(
+        MAT47_ERR_NULL_PTR,
+        mat47q_init(2, 2, ((int8_t *[2]){a, NULL}), MAT47Q_PER_TENSOR, &scale)
+    );
+    assert_error(
+        MAT47_ERR_NULL_PTR,
+        mat47q_init(1, 2, ((int8_t *[1]){a}), MAT47Q_PER_TENSOR, NULL)
+    );
+}
+
+Test(init, invalid_scaling)
+{
+    int8_t a[2] = {1, 2};
+    double scale = 1;
+
+    assert_error(
+        MAT47_ERR_INVALID_ARG, mat47q_init(1, 2, ((int8_t *[1]){a}), 0, &scale)
+    );
+}
+
+#define TestInit(T) \
+Test(init, T) \
+{ \
+    unsigned int i, j; \
+    T a[3][2] = {{-128, -1}, {0, 1}, {2, 127}}; \
+    double scales[3] = {0.5, 1, 2}; \
+    mat47q_t *q; \
+    mat47_t *m; \
+\
+    create_matrix( \
+        q, mat47q_init, 3, 2, ((T *[3]){a[0], a[1], a[2]}), MAT47Q_PER_ROW, scales \
+    ); \
+    for (i = 0; i < 3; i++) \
+        for (j = 0; j < 2; j++) \
+            cr_assert_eq(((T *)q->data)[i * 2 + j], a[i][j]); \
+\
+    create_matrix(m, mat47q_dequantize, q); \
+    for (i = 0; i < 3; i++) \
+        for (j = 0; j < 2; j++) \
+            cr_assert_eq(m->data[i][j], scales[i] * a[i][j]); \
+\
+    mat47q_del(q); mat47_del(m); \
+}
+
+TestInit(int8_t)
+TestInit(int16_t)
+
+#undef TestInit
+
+/* quantize */
+
+Test(quantize, round_trip)
+{
+    unsigned int i, j, t, s;
+    enum mat47q_type types[] = {MAT47Q_INT8, MAT47Q_INT16};
+    enum mat47q_scaling scalings[] = {MAT47Q_PER_TENSOR, MAT47Q_PER_ROW};
+    double tolerance[] = {1.0 / 127, 1.0 / 32767};
+    mat47_t *m, *d;
+    mat47q_t *q;
+
+    create_matrix(m, mat47_zero, 5, 7);
+    for (i = 0; i < 5; i++)
+        for (j = 0; j < 7; j++) m->data[i][j] = sin(i * 7.0 + j);
+
+    for (t = 0; t < sizeof_arr(types); t++)
+        for (s = 0; s < sizeof_arr(scalings); s++) {
+            create_matrix(q, mat47q_quantize, m, types[t], scalings[s]);
+            create_matrix(d, mat47q_dequantize, q);
+            for (i = 0; i < 5; i++)
+                for (j = 0; j < 7; j++)
+                    cr_assert_leq(
+                        fabs(d->data[i][j] - m->data[i][j]), tolerance[t],
+                        "type=%d, scaling=%d: [%u, %u]", types[t], scalings[s], i, j
+                    );
+            mat47q_del(q); mat47_del(d);
+        }
+
+    mat47_del(m);
+}
+
+Test(quantize, zero)
+{
+    mat47_t *m;
+    mat47q_t *q;
+
+    create_matrix(m, mat47_zero, 2, 2);
+    create_matrix(q, mat47q_quantize, m, MAT47Q_INT8, MAT47Q_PER_TENSOR);
+    cr_assert_eq(q->scales[0], 1);
+    mat47q_del(q); mat47_del(m);
+}
+
+Test(quantize, non_finite)
+{
+    unsigned int i;
+    double values[] = {INFINITY, -INFINITY, NAN};
+    mat47_t *m;
+    mat47q_t *q;
+
+    create_matrix(m, mat47_zero, 2, 2);
+    create_matrix(q, mat47q_quantize, m, MAT47Q_INT8, MAT47Q_PER_ROW);
+    m->data[0][0] = 1;
+    for (i = 0; i < sizeof_arr(values); i++) {
+        m->data[1][1] = values[i];
+        assert_error(
+            MAT47_ERR_INVALID_ARG, mat47q_quantize(m, MAT47Q_INT8, MAT47Q_PER_TENSOR)
+        );
+
+        mat47_errno = 0;
+        mat47q_quantize_into(q, m);
+        cr_assert_eq(mat47_errno, MAT47_ERR_INVALID_ARG, "i=%u", i);
+        // Left unchanged
+        cr_assert_eq(q->scales[0], 1, "i=%u", i);
+        cr_assert_eq(((int8_t *)q->data)[0], 0, "i=%u", i);
+    }
+
+    mat47q_del(q); mat47_del(m);
+}
+
+Test(quantize, into)
+{
+    unsigned int i, j;
+    mat47_t *m, *d, *d_into, *wrong;
+    mat47q_t *q, *q_into;
+
+    create_matrix(m, mat47_zero, 3, 4);
+    for (i = 0; i < 3; i++)
+        for (j = 0; j < 4; j++) m->data[i][j] = cos(i * 4.0 + j) * (i + 1);
+    create_matrix(q, mat47q_quantize, m, MAT47Q_INT16, MAT47Q_PER_ROW);
+    create_matrix(d, mat47q_dequantize, q);
+    create_matrix(wrong, mat47_zero, 4, 3);
+    create_matrix(d_into, mat47_zero, 3, 4);
+    create_matrix(q_into, mat47q_quantize, d_into, MAT47Q_INT16, MAT47Q_PER_ROW);
+
+    mat47q_quantize_into(q_into, m);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    mat47q_dequantize_into(d_into, q_into);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    for (i = 0; i < 3; i++) {
+        cr_assert_eq(q_into->scales[i], q->scales[i], "i=%u", i);
+        for (j = 0; j < 4; j++)
+            cr_assert_eq(d_into->data[i][j], d->data[i][j], "[%u, %u]", i, j);
+    }
+
+    mat47_errno = 0;
+    mat47q_quantize_into(q_into, wrong);
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+    mat47_errno = 0;
+    mat47q_dequantize_into(wrong, q_into);
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+    mat47_errno = 0;
+    mat47q_dequantize_into(NULL, q_into);
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+
+    mat47q_del(q); mat47q_del(q_into);
+    mat47_del(m); mat47_del(d); mat47_del(d_into); mat47_del(wrong);
+}
+
+/* mul_t */
+
+Test(mul_t, mismatch)
+{
+    mat47_t *m1, *m2;
+    mat47q_t *q1, *q2, *q3;
+
+    create_matrix(m1, mat47_zero, 2, 3);
+    create_matrix(m2, mat47_zero, 2, 4);
+    create_matrix(q1, mat47q_quantize, m1, MAT47Q_INT8, MAT47Q_PER_ROW);
+    create_matrix(q2, mat47q_quantize, m2, MAT47Q_INT8, MAT47Q_PER_ROW);
+    create_matrix(q3, mat47q_quantize, m1, MAT47Q_INT16, MAT47Q_PER_ROW);
+
+    assert_error(MAT47_ERR_NULL_PTR, mat47q_mul_t(NULL, q1));
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47q_mul_t(q1, q2));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47q_mul_t(q1, q3));
+
+    mat47q_del(q1); mat47q_del(q2); mat47q_del(q3);
+    mat47_del(m1); mat47_del(m2);
+}
+
+Test(mul_t, exact)
+{
+    unsigned int i, j, k, t, n = 200, n_a = 9, n_b = 13;
+    enum mat47q_type types[] = {MAT47Q_INT8, MAT47Q_INT16};
+    double expected;
+    mat47_t *a, *b, *c, *da, *db;
+    mat47q_t *qa, *qb;
+
+    create_matrix(a, mat47_zero, n_a, n);
+    create_matrix(b, mat47_zero, n_b, n);
+    for (k = 0; k < n; k++) {
+        for (i = 0; i < n_a; i++) a->data[i][k] = cos(i * 3.0 + k);
+        for (j = 0; j < n_b; j++) b->data[j][k] = sin(j * 5.0 + k) * (j + 1);
+    }
+
+    for (t = 0; t < sizeof_arr(types); t++) {
+        create_matrix(qa, mat47q_quantize, a, types[t], MAT47Q_PER_ROW);
+        create_matrix(qb, mat47q_quantize, b, types[t], MAT47Q_PER_TENSOR);
+        create_matrix(da, mat47q_dequantize, qa);
+        create_matrix(db, mat47q_dequantize, qb);
+        create_matrix(c, mat47q_mul_t, qa, qb);
+
+        cr_assert_eq(c->n_rows, n_a);
+        cr_assert_eq(c->n_cols, n_b);
+        // Must equal the product of the dequantized matrices
+        for (i = 0; i < n_a; i++)
+            for (j = 0; j < n_b; j++) {
+                for (expected = 0, k = 0; k < n; k++)
+                    expected += da->data[i][k] * db->data[j][k];
+                cr_assert_float_eq(
+                    c->data[i][j], expected, 1e-9 * fabs(expected) + 1e-12,
+                    "type=%d: [%u, %u] = %f, expected %f",
+                    types[t], i, j, c->data[i][j], expected
+                );
+            }
+
+        mat47q_del(qa); mat47q_del(qb);
+        mat47_del(da); mat47_del(db); mat47_del(c);
+    }
+
+    mat47_del(a); mat47_del(b);
+}
+
+Test(mul_t, into)
+{
+    unsigned int i, j;
+    mat47_t *a, *b, *c, *c_into;
+    mat47q_t *qa, *qb;
+
+    create_matrix(a, mat47_zero, 3, 5);
+    create_matrix(b, mat47_zero, 2, 5);
+    for (j = 0; j < 5; j++) {
+        for (i = 0; i < 3; i++) a->data[i][j] = sin(i * 5.0 + j);
+        for (i = 0; i < 2; i++) b->data[i][j] = cos(i * 5.0 + j);
+    }
+    create_matrix(qa, mat47q_quantize, a, MAT47Q_INT8, MAT47Q_PER_ROW);
+    create_matrix(qb, mat47q_quantize, b, MAT47Q_INT8, MAT47Q_PER_ROW);
+    create_matrix(c, mat47q_mul_t, qa, qb);
+
+    create_matrix(c_into, mat47_zero, 2, 3);
+    mat47_errno = 0;
+    mat47q_mul_t_into(c_into, qa, qb);
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+    mat47_del(c_into);
+
+    create_matrix(c_into, mat47__new, 3, 2, false);
+    mat47q_mul_t_into(c_into, qa, qb);
+    cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+    for (i = 0; i < 3; i++)
+        for (j = 0; j < 2; j++)
+            cr_assert_eq(c_into->data[i][j], c->data[i][j], "[%u, %u]", i, j);
+
+    mat47q_del(qa); mat47q_del(qb);
+    mat47_del(a); mat47_del(b); mat47_del(c); mat47_del(c_into);
+}
@@ -0,0 +1,552 @@
+#include <math.h>
+
+#include <criterion/criterion.h>
+
+#include "../src/mat47/reduce.c"
+
+
+#define create_matrix(m, mat47_f, ...) \
+    mat47_errno = 0; \
+    m = mat47_f(__VA_ARGS__); \
+\
+    cr_assert_eq( \
+        mat47_errno, 0, "Error creating matrix: (%s)", mat47_strerror(mat47_errno) \
+    ); \
+    cr_assert_not_null(m, "`" #m "` is null")
+
+#define assert_error(errnum, expr) \
+    mat47_errno = 0; \
+    cr_assert(isnan(expr), #expr " should fail"); \
+    cr_assert_eq( \
+        mat47_errno, errnum, \
+        "%u (%s) was raised", mat47_errno, mat47_strerror(mat47_errno) \
+    )
+
+#define assert_error_null(errnum, expr) \
+    mat47_errno = 0; \
+    cr_assert_null(expr, #expr " should fail"); \
+    cr_assert_eq( \
+        mat47_errno, errnum, \
+        "%u (%s) was raised", mat47_errno, mat47_strerror(mat47_errno) \
+    )
+
+static const enum mat47_sum_mode modes[] = {
+    MAT47_SUM_FAST, MAT47_SUM_PAIRWISE, MAT47_SUM_KAHAN
+};
+
+/* Returns a new matrix with the elements `f(i, j)` */
+static mat47_t *new_filled(
+    unsigned int n_rows, unsigned int n_cols, double (*f)(unsigned int, unsigned int)
+) {
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, n_rows, n_cols);
+    for (unsigned int i = 0; i < n_rows; i++)
+        for (unsigned int j = 0; j < n_cols; j++) m->data[i][j] = f(i, j);
+
+    return m;
+}
+
+// Integral, hence summed exactly in any order
+static double index_sum(unsigned int i, unsigned int j)
+{
+    return (double)i - 2.0 * j;
+}
+
+static double wave(unsigned int i, unsigned int j)
+{
+    return sin(i * 7.0 + j * 3.0);
+}
+
+
+/* Errors */
+
+Test(reduce, null_ptr)
+{
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 2, 2);
+    assert_error(MAT47_ERR_NULL_PTR, mat47_sum(NULL, MAT47_SUM_FAST));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_dot(NULL, m, MAT47_SUM_FAST));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_dot(m, NULL, MAT47_SUM_FAST));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_norm_fro(NULL, MAT47_SUM_FAST));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_norm_1(NULL));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_norm_inf(NULL));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_min(NULL, NULL, NULL));
+    assert_error(MAT47_ERR_NULL_PTR, mat47_max(NULL, NULL, NULL));
+    mat47_del(m);
+}
+
+Test(reduce, invalid_mode)
+{
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 2, 2);
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_sum(m, 0));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_dot(m, m, MAT47_SUM_KAHAN + 1));
+    assert_error(MAT47_ERR_INVALID_ARG, mat47_norm_fro(m, -1));
+    mat47_del(m);
+}
+
+Test(reduce, dim_mismatch)
+{
+    mat47_t *a, *b;
+
+    create_matrix(a, mat47_zero, 2, 3);
+    create_matrix(b, mat47_zero, 3, 2);
+    assert_error(MAT47_ERR_DIM_MISMATCH, mat47_dot(a, b, MAT47_SUM_FAST));
+    mat47_del(a); mat47_del(b);
+}
+
+
+/* Sums */
+
+Test(reduce, sum)
+{
+    // Sizes exercising the vector loops and the scalar tails
+    unsigned int sizes[][2] = {{1, 1}, {1, 3}, {3, 5}, {4, 16}, {7, 37}, {300, 301}};
+    double expected;
+    mat47_t *m;
+
+    for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+        unsigned int n_rows = sizes[s][0], n_cols = sizes[s][1];
+
+        m = new_filled(n_rows, n_cols, index_sum);
+        expected = (
+            (double)n_cols * n_rows * (n_rows - 1) / 2
+            - (double)n_rows * n_cols * (n_cols - 1)
+        );
+        for (size_t k = 0; k < sizeof_arr(modes); k++)
+            cr_assert_eq(
+                mat47_sum(m, modes[k]), expected,
+                "%ux%u, mode=%d", n_rows, n_cols, modes[k]
+            );
+        mat47_del(m);
+    }
+}
+
+Test(reduce, accuracy)
+{
+    unsigned int n = 4099;
+    double fast, pairwise, kahan;
+    mat47_t *m;
+
+    // 1 + n * 2^-53; Each small element is lost when added to 1 alone
+    create_matrix(m, mat47_zero, 1, n + 1);
+    m->data[0][0] = 1;
+    for (unsigned int j = 1; j <= n; j++) m->data[0][j] = 0x1p-53;
+
+    fast = mat47_sum(m, MAT47_SUM_FAST);
+    pairwise = mat47_sum(m, MAT47_SUM_PAIRWISE);
+    kahan = mat47_sum(m, MAT47_SUM_KAHAN);
+    cr_assert_eq(kahan, 1 + n * 0x1p-53, "kahan=%.17g", kahan);
+    cr_assert_leq(
+        fabs(kahan - pairwise), fabs(kahan - fast), "fast=%.17g, pairwise=%.17g",
+        fast, pairwise
+    );
+    mat47_del(m);
+}
+
+Test(reduce, dot)
+{
+    unsigned int n_rows = 9, n_cols = 13;
+    double expected = 0;
+    mat47_t *a, *b;
+
+    a = new_filled(n_rows, n_cols, index_sum);
+    b = new_filled(n_rows, n_cols, index_sum);
+    for (unsigned int i = 0; i < n_rows; i++)
+        for (unsigned int j = 0; j < n_cols; j++)
+            expected += a->data[i][j] * a->data[i][j];
+
+    for (size_t k = 0; k < sizeof_arr(modes); k++) {
+        cr_assert_eq(mat47_dot(a, b, modes[k]), expected, "mode=%d", modes[k]);
+        cr_assert_float_eq(
+            mat47_norm_fro(a, modes[k]), sqrt(expected), 1e-12, "mode=%d", modes[k]
+        );
+    }
+    mat47_del(a); mat47_del(b);
+}
+
+Test(reduce, norms)
+{
+    double a[3][5] = {
+        {1, -2, 3, -4, 5},
+        {-6, 7, -8, 9, -10},
+        {0.5, 0, 0, 0, -21},
+    };
+    mat47_t *m;
+
+    create_matrix(m, mat47_init, 3, 5, ((double *[3]){a[0], a[1], a[2]}));
+    cr_assert_eq(mat47_norm_1(m), 36);
+    cr_assert_eq(mat47_norm_inf(m), 40);
+
+    m->data[2][2] = NAN;
+    cr_assert(isnan(mat47_norm_1(m)), "NaN should be propagated");
+    cr_assert(isnan(mat47_norm_inf(m)), "NaN should be propagated");
+    mat47_del(m);
+}
+
+Test(reduce, large)
+{
+    // Large enough to be split across threads
+    unsigned int n_rows = 1500, n_cols = 1100;
+    double sum = 0, norm_1 = 0, norm_inf = 0, row_sum, col_sum;
+    mat47_t *m;
+
+    m = new_filled(n_rows, n_cols, wave);
+    for (unsigned int i = 0; i < n_rows; i++) {
+        row_sum = 0;
+        for (unsigned int j = 0; j < n_cols; j++) {
+            sum += m->data[i][j];
+            row_sum += fabs(m->data[i][j]);
+        }
+        imax(norm_inf, row_sum);
+    }
+    for (unsigned int j = 0; j < n_cols; j++) {
+        col_sum = 0;
+        for (unsigned int i = 0; i < n_rows; i++) col_sum += fabs(m->data[i][j]);
+        imax(norm_1, col_sum);
+    }
+
+    for (size_t k = 0; k < sizeof_arr(modes); k++)
+        cr_assert_float_eq(mat47_sum(m, modes[k]), sum, 1e-9, "mode=%d", modes[k]);
+    cr_assert_float_eq(mat47_norm_1(m), norm_1, 1e-9);
+    cr_assert_float_eq(mat47_norm_inf(m), norm_inf, 1e-9);
+    mat47_del(m);
+}
+
+
+Test(reduce, tall)
+{
+    // More rows than `STACK_ROWS`, both in separate rows and in a single buffer
+    unsigned int n_rows = 100003, n_cols = 3;
+    double sum = 0, sum_sq = 0, norm_inf = 0, row_sum, *buf;
+    mat47_t *m, *flat;
+
+    m = new_filled(n_rows, n_cols, index_sum);
+    cr_assert_not_null(buf = malloc(sizeof(double) * n_rows * n_cols));
+    for (unsigned int i = 0; i < n_rows; i++) {
+        row_sum = 0;
+        for (unsigned int j = 0; j < n_cols; j++) {
+            buf[i * n_cols + j] = m->data[i][j];
+            sum += m->data[i][j];
+            sum_sq += m->data[i][j] * m->data[i][j];
+            row_sum += fabs(m->data[i][j]);
+        }
+        imax(norm_inf, row_sum);
+    }
+    create_matrix(flat, mat47_init_double_flat, n_rows, n_cols, buf, n_cols);
+    free(buf);
+    cr_assert_null(m->block);
+    cr_assert_not_null(flat->block);
+
+    for (size_t k = 0; k < sizeof_arr(modes); k++) {
+        cr_assert_eq(mat47_sum(m, modes[k]), sum, "mode=%d", modes[k]);
+        cr_assert_eq(mat47_sum(flat, modes[k]), sum, "mode=%d", modes[k]);
+        cr_assert_eq(mat47_dot(m, flat, modes[k]), sum_sq, "mode=%d", modes[k]);
+        cr_assert_eq(mat47_dot(flat, flat, modes[k]), sum_sq, "mode=%d", modes[k]);
+    }
+    cr_assert_eq(mat47_norm_inf(m), norm_inf);
+    cr_assert_eq(mat47_norm_inf(flat), norm_inf);
+
+    m->data[n_rows / 2][1] = NAN;
+    cr_assert(isnan(mat47_norm_inf(m)), "NaN should be propagated");
+    mat47_del(m); mat47_del(flat);
+}
+
+
+/* Extrema */
+
+Test(extremum, basic)
+{
+    unsigned int row, col;
+    mat47_t *m;
+
+    m = new_filled(11, 13, wave);
+    m->data[6][9] = 2;
+    m->data[3][12] = -2;
+
+    cr_assert_eq(mat47_max(m, &row, &col), 2);
+    cr_assert_eq(row, 7);
+    cr_assert_eq(col, 10);
+    cr_assert_eq(mat47_min(m, &row, &col), -2);
+    cr_assert_eq(row, 4);
+    cr_assert_eq(col, 13);
+    cr_assert_eq(mat47_max(m, NULL, NULL), 2);
+    mat47_del(m);
+}
+
+Test(extremum, ties)
+{
+    unsigned int row, col;
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 5, 11);
+    m->data[2][9] = m->data[2][3] = m->data[4][0] = 1;
+    m->data[1][10] = m->data[3][1] = -1;
+
+    cr_assert_eq(mat47_max(m, &row, &col), 1);
+    cr_assert_eq(row, 3);
+    cr_assert_eq(col, 4);
+    cr_assert_eq(mat47_min(m, &row, &col), -1);
+    cr_assert_eq(row, 2);
+    cr_assert_eq(col, 11);
+
+    // Every element
+    m->data[2][9] = m->data[2][3] = m->data[4][0] = 0;
+    m->data[1][10] = m->data[3][1] = 0;
+    cr_assert_eq(mat47_max(m, &row, &col), 0);
+    cr_assert_eq(row, 1);
+    cr_assert_eq(col, 1);
+    mat47_del(m);
+}
+
+Test(extremum, infinite)
+{
+    unsigned int row, col;
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 2, 9);
+    for (unsigned int j = 0; j < 9; j++) m->data[0][j] = m->data[1][j] = -INFINITY;
+    m->data[1][5] = INFINITY;
+
+    cr_assert_eq(mat47_max(m, &row, &col), INFINITY);
+    cr_assert_eq(row, 2);
+    cr_assert_eq(col, 6);
+    cr_assert_eq(mat47_min(m, &row, &col), -INFINITY);
+    cr_assert_eq(row, 1);
+    cr_assert_eq(col, 1);
+    mat47_del(m);
+}
+
+Test(extremum, nan)
+{
+    unsigned int row, col;
+    mat47_t *m;
+
+    create_matrix(m, mat47_zero, 3, 7);
+    for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int j = 0; j < 7; j++) m->data[i][j] = NAN;
+
+    cr_assert(isnan(mat47_max(m, &row, &col)));
+    cr_assert_eq(row, 1);
+    cr_assert_eq(col, 1);
+
+    m->data[2][6] = -3;
+    m->data[1][2] = 4;
+    cr_assert_eq(mat47_max(m, &row, &col), 4);
+    cr_assert_eq(row, 2);
+    cr_assert_eq(col, 3);
+    cr_assert_eq(mat47_min(m, &row, &col), -3);
+    cr_assert_eq(row, 3);
+    cr_assert_eq(col, 7);
+    mat47_del(m);
+}
+
+Test(extremum, chunks)
+{
+    unsigned int row, col;
+    mat47_t *m;
+
+    // Rows spanning several chunks, the first of which is only NaNs
+    create_matrix(m, mat47_zero, 2, 1500);
+    for (unsigned int j = 0; j < 600; j++) m->data[0][j] = NAN;
+    m->data[0][1400] = m->data[0][700] = m->data[1][3] = 3;
+    m->data[1][1030] = m->data[0][1499] = -3;
+
+    cr_assert_eq(mat47_max(m, &row, &col), 3);
+    cr_assert_eq(row, 1);
+    cr_assert_eq(col, 701);
+    cr_assert_eq(mat47_min(m, &row, &col), -3);
+    cr_assert_eq(row, 1);
+    cr_assert_eq(col, 1500);
+    mat47_del(m);
+}
+
+Test(extremum, large)
+{
+    unsigned int row, col, n_rows = 1200, n_cols = 1000;
+    mat47_t *m;
+
+    m = new_filled(n_rows, n_cols, wave);
+    m->data[1100][999] = 5;
+    m->data[700][3] = 5;
+    m->data[900][3] = -5;
+
+    cr_assert_eq(mat47_max(m, &row, &col), 5);
+    cr_assert_eq(row, 701);
+    cr_assert_eq(col, 4);
+    cr_assert_eq(mat47_min(m, &row, &col), -5);
+    cr_assert_eq(row, 901);
+    cr_assert_eq(col, 4);
+    mat47_del(m);
+}
+
+
+/* Row-wise and column-wise reductions */
+
+Test(axis, errors)
+{
+    mat47_t *m, *means = (mat47_t *)1;
+
+    create_matrix(m, mat47_zero, 3, 2);
+    assert_error_null(MAT47_ERR_NULL_PTR, mat47_row_sums(NULL, MAT47_SUM_FAST));
+    assert_error_null(MAT47_ERR_NULL_PTR, mat47_col_sums(NULL, MAT47_SUM_FAST));
+    assert_error_null(MAT47_ERR_NULL_PTR, mat47_col_means(NULL, MAT47_SUM_FAST));
+    assert_error_null(MAT47_ERR_NULL_PTR, mat47_col_var(NULL, 0, NULL));
+    assert_error_null(MAT47_ERR_INVALID_ARG, mat47_row_sums(m, 0));
+    assert_error_null(MAT47_ERR_INVALID_ARG, mat47_col_sums(m, 0));
+    assert_error_null(MAT47_ERR_INVALID_ARG, mat47_col_var(m, 3, &means));
+    cr_assert_null(means);
+
+    create_matrix(means, mat47_zero, 1, 3);
+    mat47_errno = 0;
+    mat47_col_sums_into(means, m, MAT47_SUM_FAST);
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+    mat47_errno = 0;
+    mat47_col_means_into(NULL, m, MAT47_SUM_FAST);
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+    mat47_errno = 0;
+    mat47_row_sums_into(means, m, MAT47_SUM_FAST);
+    cr_assert_eq(mat47_errno, MAT47_ERR_DIM_MISMATCH);
+    mat47_del(means);
+
+    create_matrix(means, mat47_zero, 1, 2);
+    mat47_errno = 0;
+    mat47_col_sums_into(means, m, 0);
+    cr_assert_eq(mat47_errno, MAT47_ERR_INVALID_ARG);
+    mat47_del(means);
+    mat47_del(m);
+}
+
+Test(axis, sums)
+{
+    // Sizes exercising the scalar tails, multiple blocks and pairwise recursion
+    unsigned int sizes[][2] = {{1, 1}, {5, 3}, {130, 7}, {700, 9}, {3000, 400}};
+    mat47_t *m, *rows, *cols, *means;
+
+    for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+        unsigned int n_rows = sizes[s][0], n_cols = sizes[s][1];
+
+        m = new_filled(n_rows, n_cols, index_sum);
+        for (size_t k = 0; k < sizeof_arr(modes); k++) {
+            create_matrix(rows, mat47_row_sums, m, modes[k]);
+            create_matrix(cols, mat47_col_sums, m, modes[k]);
+            create_matrix(means, mat47_col_means, m, modes[k]);
+            cr_assert_eq(rows->n_rows, n_rows);
+            cr_assert_eq(rows->n_cols, 1);
+            cr_assert_eq(cols->n_rows, 1);
+            cr_assert_eq(cols->n_cols, n_cols);
+
+            for (unsigned int i = 0; i < n_rows; i++)
+                cr_assert_eq(
+                    rows->data[i][0],
+                    (double)n_cols * i - (double)n_cols * (n_cols - 1),
+                    "%ux%u, mode=%d, row %u", n_rows, n_cols, modes[k], i
+                );
+            for (unsigned int j = 0; j < n_cols; j++) {
+                cr_assert_eq(
+                    cols->data[0][j],
+                    (double)n_rows * (n_rows - 1) / 2 - 2.0 * j * n_rows,
+                    "%ux%u, mode=%d, column %u", n_rows, n_cols, modes[k], j
+                );
+                cr_assert_float_eq(
+                    means->data[0][j], (n_rows - 1) / 2.0 - 2.0 * j, 1e-12
+                );
+            }
+            mat47_del(rows); mat47_del(cols); mat47_del(means);
+        }
+        mat47_del(m);
+    }
+}
+
+Test(axis, into)
+{
+    // Scratch space for the largest one doesn't fit on the stack
+    unsigned int sizes[][2] = {{5, 3}, {700, 9}, {3000, 400}};
+    mat47_t *m, *rows, *cols, *rows_into, *cols_into;
+
+    for (size_t s = 0; s < sizeof_arr(sizes); s++) {
+        unsigned int n_rows = sizes[s][0], n_cols = sizes[s][1];
+
+        m = new_filled(n_rows, n_cols, index_sum);
+        create_matrix(rows_into, mat47__new, n_rows, 1, false);
+        create_matrix(cols_into, mat47__new, 1, n_cols, false);
+        for (size_t k = 0; k < sizeof_arr(modes); k++) {
+            create_matrix(rows, mat47_row_sums, m, modes[k]);
+            create_matrix(cols, mat47_col_means, m, modes[k]);
+
+            mat47_row_sums_into(rows_into, m, modes[k]);
+            mat47_col_means_into(cols_into, m, modes[k]);
+            cr_assert_eq(mat47_errno, 0, "%s", mat47_strerror(mat47_errno));
+            for (unsigned int i = 0; i < n_rows; i++)
+                cr_assert_eq(rows_into->data[i][0], rows->data[i][0]);
+            for (unsigned int j = 0; j < n_cols; j++)
+                cr_assert_eq(cols_into->data[0][j], cols->data[0][j]);
+
+            mat47_col_sums_into(cols_into, m, modes[k]);
+            for (unsigned int j = 0; j < n_cols; j++)
+                cr_assert_float_eq(
+                    cols_into->data[0][j], cols->data[0][j] * n_rows, 1e-9
+                );
+            mat47_del(rows); mat47_del(cols);
+        }
+        mat47_del(rows_into); mat47_del(cols_into);
+        mat47_del(m);
+    }
+}
+
+Test(axis, col_sums_accuracy)
+{
+    unsigned int n = 5000;
+    mat47_t *m, *sums;
+
+    create_matrix(m, mat47_zero, n + 1, 3);
+    m->data[0][0] = m->data[0][1] = m->data[0][2] = 1;
+    for (unsigned int i = 1; i <= n; i++)
+        m->data[i][0] = m->data[i][1] = m->data[i][2] = 0x1p-53;
+
+    create_matrix(sums, mat47_col_sums, m, MAT47_SUM_KAHAN);
+    for (unsigned int j = 0; j < 3; j++)
+        cr_assert_eq(sums->data[0][j], 1 + n * 0x1p-53);
+    mat47_del(sums);
+
+    create_matrix(sums, mat47_col_sums, m, MAT47_SUM_FAST);
+    cr_assert_eq(sums->data[0][0], 1, "Plain summation should lose the small elements");
+    mat47_del(sums);
+    mat47_del(m);
+}
+
+Test(axis, col_var)
+{
+    unsigned int n_rows = 2000, n_cols = 700;
+    double mean, var;
+    mat47_t *m, *vars, *means;
+
+    m = new_filled(n_rows, n_cols, wave);
+    // Large offset, which the textbook one-pass formula wouldn't survive
+    for (unsigned int i = 0; i < n_rows; i++) m->data[i][5] += 1e9;
+
+    create_matrix(vars, mat47_col_var, m, 1, &means);
+    cr_assert_not_null(means);
+    for (unsigned int j = 0; j < n_cols; j++) {
+        mean = var = 0;
+        for (unsigned int i = 0; i < n_rows; i++) mean += m->data[i][j];
+        mean /= n_rows;
+        for (unsigned int i = 0; i < n_rows; i++)
+            var += (m->data[i][j] - mean) * (m->data[i][j] - mean);
+        var /= n_rows - 1;
+
+        cr_assert_float_eq(means->data[0][j], mean, 1e-6 * fmax(1, fabs(mean)));
+        cr_assert_float_eq(vars->data[0][j], var, 1e-9, "column %u", j);
+    }
+    mat47_del(m); mat47_del(vars); mat47_del(means);
+
+    // Population variance
+    m = new_filled(4, 2, index_sum);
+    create_matrix(vars, mat47_col_var, m, 0, NULL);
+    cr_assert_float_eq(vars->data[0][0], 1.25, 1e-15);
+    cr_assert_float_eq(vars->data[0][1], 1.25, 1e-15);
+    mat47_del(m); mat47_del(vars);
+}
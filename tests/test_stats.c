@@ -0,0 +1,202 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <criterion/criterion.h>
+
+#define MAT47_STATS
+#include "../src/mat47/stats.c"
+
+
+// Stand-ins for instrumented API functions
+
+static void fake_copy(size_t n_bytes)
+{
+    stats(COPY);
+    stats_alloc(2, n_bytes);
+    stats_copy(n_bytes);
+}
+
+static void fake_del(size_t n_bytes)
+{
+    stats(DEL);
+    stats_free(n_bytes);
+}
+
+static void fake_init(size_t n_bytes)
+{
+    stats(INIT);
+    fake_copy(n_bytes);  // Nested
+}
+
+static mat47_stats_t stats;
+
+static struct mat47_op_stats *snapshot(enum mat47_stats_op op)
+{
+    mat47_stats_snapshot(&stats);
+    return &stats.ops[op];
+}
+
+
+Test(stats, null_ptr)
+{
+    mat47_errno = 0;
+    mat47_stats_snapshot(NULL);
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+
+    mat47_errno = 0;
+    cr_assert_eq(mat47_stats_fprint_json(NULL, stdout), -1);
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+
+    mat47_errno = 0;
+    cr_assert_eq(mat47_stats_fprint_prometheus(&stats, NULL), -1);
+    cr_assert_eq(mat47_errno, MAT47_ERR_NULL_PTR);
+}
+
+Test(stats, counters)
+{
+    struct mat47_op_stats *s;
+
+    mat47_stats_reset();
+    fake_copy(100);
+    fake_copy(50);
+    fake_del(30);
+
+    s = snapshot(MAT47_STATS_OP_COPY);
+    cr_assert_str_eq(s->name, "mat47_copy");
+    cr_assert_eq(s->calls, 2);
+    cr_assert_eq(s->n_allocs, 4);
+    cr_assert_eq(s->bytes_allocated, 150);
+    cr_assert_eq(s->bytes_copied, 150);
+    cr_assert_eq(s->bytes_freed, 0);
+
+    s = snapshot(MAT47_STATS_OP_DEL);
+    cr_assert_eq(s->calls, 1);
+    cr_assert_eq(s->bytes_freed, 30);
+
+    // Outside any operation
+    stats_copy(10);
+    cr_assert_eq(snapshot(MAT47_STATS_OP_COPY)->bytes_copied, 150);
+}
+
+Test(stats, nested)
+{
+    struct mat47_op_stats *s;
+
+    mat47_stats_reset();
+    fake_init(64);
+
+    s = snapshot(MAT47_STATS_OP_INIT);
+    cr_assert_eq(s->calls, 1);
+    cr_assert_eq(s->bytes_allocated, 64);
+    cr_assert_eq(snapshot(MAT47_STATS_OP_COPY)->calls, 0);
+}
+
+Test(stats, time)
+{
+    mat47_stats_reset();
+    {
+        stats(ZERO);
+        nanosleep(&(struct timespec){0, 2000000}, NULL);
+    }
+
+    cr_assert_geq(snapshot(MAT47_STATS_OP_ZERO)->ns, 2000000);
+}
+
+Test(stats, reset)
+{
+    fake_copy(8);
+    mat47_stats_reset();
+    cr_assert_eq(snapshot(MAT47_STATS_OP_COPY)->calls, 0);
+
+    fake_copy(8);
+    cr_assert_eq(snapshot(MAT47_STATS_OP_COPY)->calls, 1);
+}
+
+static void *copy_from_thread(void *arg)
+{
+    fake_copy(*(size_t *)arg);
+
+    return NULL;
+}
+
+Test(stats, threads)
+{
+    pthread_t threads[4];
+    size_t n_bytes = 10;
+    int i;
+
+    mat47_stats_reset();
+    for (i = 0; i < 4; i++)
+        cr_assert_eq(pthread_create(&threads[i], NULL, copy_from_thread, &n_bytes), 0);
+    for (i = 0; i < 4; i++) pthread_join(threads[i], NULL);
+    fake_copy(n_bytes);
+
+    cr_assert_eq(snapshot(MAT47_STATS_OP_COPY)->calls, 5);
+    cr_assert_eq(stats.ops[MAT47_STATS_OP_COPY].bytes_copied, 50);
+}
+
+// Writes `stats` with `fprint` and returns the output
+static char *dump(intmax_t (*fprint)(const mat47_stats_t *, FILE *))
+{
+    static char output[1 << 16];
+    intmax_t n_bytes;
+    FILE *stream = tmpfile();
+
+    cr_assert_not_null(stream);
+    n_bytes = fprint(&stats, stream);
+    rewind(stream);
+    output[fread(output, 1, sizeof(output) - 1, stream)] = '\0';
+    fclose(stream);
+    cr_assert_eq(n_bytes, (intmax_t)strlen(output));
+
+    return output;
+}
+
+Test(stats, json)
+{
+    char *output;
+
+    mat47_stats_reset();
+    fake_copy(3);
+    mat47_stats_snapshot(&stats);
+    output = dump(mat47_stats_fprint_json);
+
+    cr_assert_eq(output[0], '{');
+    cr_assert_not_null(
+        strstr(
+            output,
+            "\"mat47_copy\": {\"calls\": 1, \"ns\": "
+        ),
+        "%s", output
+    );
+    cr_assert_not_null(
+        strstr(
+            output,
+            "\"n_allocs\": 2, \"bytes_allocated\": 3, \"bytes_freed\": 0, "
+            "\"bytes_copied\": 3}"
+        ),
+        "%s", output
+    );
+    cr_assert_not_null(strstr(output, "\"mat47q_quantize\": {"));
+}
+
+Test(stats, prometheus)
+{
+    char *output;
+
+    mat47_stats_reset();
+    fake_copy(3);
+    mat47_stats_snapshot(&stats);
+    stats.ops[MAT47_STATS_OP_DEL].ns = 1500000000;
+    output = dump(mat47_stats_fprint_prometheus);
+
+    cr_assert_not_null(strstr(output, "# TYPE mat47_calls_total counter\n"));
+    cr_assert_not_null(strstr(output, "\nmat47_calls_total{op=\"mat47_copy\"} 1\n"));
+    cr_assert_not_null(
+        strstr(output, "\nmat47_seconds_total{op=\"mat47_del\"} 1.500000000\n")
+    );
+    cr_assert_not_null(
+        strstr(output, "\nmat47_copied_bytes_total{op=\"mat47_copy\"} 3\n")
+    );
+}